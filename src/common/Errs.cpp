@@ -2,18 +2,224 @@
 
 #include "Errs.h"
 
+#include <chrono>
+#include <iostream>
+#include "util/Metrics.hpp"
+
 namespace rhino {
 RHINO_INLINE_NAMESPACE_BEGIN
 
+EGrp::EGrp(const int32_t code, std::string semanticCode) : code(code), semanticCode(std::move(semanticCode)) {
+    if (code == 0) {
+        throw std::runtime_error("you should not use zero as a error group code");
+    }
+    id = ErrRegistry::global().add(*this);
+}
+
+Err::Err(const int32_t code, std::string semanticCode, std::string defaultMsg)
+    : code(code), semanticCode(std::move(semanticCode)), msg(std::move(defaultMsg)) {
+    if (code == 0) {
+        throw std::runtime_error("errCode should not be 0!");
+    }
+    sysErr = code < 0;
+    id = ErrRegistry::global().add(*this);
+}
+
+// 线程退出时把计数槽位标记为空闲，槽位里的计数保留，由之后的新线程接着累加。
+// 归还之前先清空 localCounts：之后析构的 thread_local 里再发生的错误不能写进可能已经被新线程占用的槽位
+struct ErrRegistry::ThreadAttachment {
+    detail::ErrThreadCounts *counts = nullptr;
+
+    ~ThreadAttachment() {
+        localCounts = nullptr;
+        threadDetached = true;
+        if (counts != nullptr) {
+            counts->inUse.store(false, std::memory_order_release);
+        }
+    }
+};
+
+thread_local ErrRegistry::ThreadAttachment ErrRegistry::attachment;
+
+ErrRegistry::ErrRegistry() {
+    // 不经过 EGrp / Err 的构造函数，它们会反过来登记到这里
+    auto *group = new EGrp();
+    group->semanticCode = "UNKNOWN";
+    group->id = UNKNOWN_ID;
+    groups[UNKNOWN_ID].store(group, std::memory_order_release);
+    auto *err = new Err();
+    err->semanticCode = "UNKNOWN";
+    err->msg = "unknown error";
+    err->id = UNKNOWN_ID;
+    errs[UNKNOWN_ID].store(err, std::memory_order_release);
+}
+
+template <typename E>
+uint16_t ErrRegistry::add(std::unique_ptr<std::atomic<const E *>[]> &slots,
+                          std::unordered_map<int32_t, uint16_t> &codes,
+                          std::unordered_map<std::string, uint16_t> &names, uint16_t &nextId, const E &e,
+                          bool &inserted) {
+    std::lock_guard<std::mutex> lock(mtx);
+    inserted = false;
+    auto byCode = codes.find(e.code);
+    if (byCode != codes.end()) {
+        const E &existing = *slots[byCode->second].load(std::memory_order_relaxed);
+        if (existing.semanticCode != e.semanticCode) {
+            throw std::runtime_error("error code " + std::to_string(e.code) + " registered twice: " +
+                                     existing.semanticCode + " and " + e.semanticCode);
+        }
+        return byCode->second;
+    }
+    auto byName = names.find(e.semanticCode);
+    if (byName != names.end()) {
+        throw std::runtime_error("error " + e.semanticCode + " registered twice: code " +
+                                 std::to_string(slots[byName->second].load(std::memory_order_relaxed)->code) +
+                                 " and " + std::to_string(e.code));
+    }
+    if (nextId >= MAX_IDS) {
+        throw std::runtime_error("too many error codes registered");
+    }
+    const uint16_t id = nextId++;
+    // 登记表中的对象永不释放，编号在进程内一直有效
+    auto *copy = new E(e);
+    copy->id = id;
+    slots[id].store(copy, std::memory_order_release);
+    codes.emplace(e.code, id);
+    names.emplace(e.semanticCode, id);
+    inserted = true;
+    return id;
+}
+
+template <typename E>
+uint16_t ErrRegistry::find(const std::unique_ptr<std::atomic<const E *>[]> &slots,
+                           const std::unordered_map<int32_t, uint16_t> &codes, const E &e) const {
+    std::lock_guard<std::mutex> lock(mtx);
+    auto byCode = codes.find(e.code);
+    if (byCode == codes.end() ||
+        slots[byCode->second].load(std::memory_order_relaxed)->semanticCode != e.semanticCode) {
+        return 0;
+    }
+    return byCode->second;
+}
+
+uint16_t ErrRegistry::find(const EGrp &eGrp) const { return find(groups, groupCodes, eGrp); }
+
+uint16_t ErrRegistry::find(const Err &err) const { return find(errs, errCodes, err); }
+
+uint16_t ErrRegistry::add(const EGrp &eGrp) {
+    bool inserted;
+    return add(groups, groupCodes, groupNames, nextGroupId, eGrp, inserted);
+}
+
+uint16_t ErrRegistry::add(const Err &err) {
+    bool inserted;
+    const uint16_t id = add(errs, errCodes, errNames, nextErrId, err, inserted);
+    if (inserted) {
+        // 在登记表的锁外登记指标：读指标时会反过来调用 count
+        MetricsRegistry::global().add("errors." + err.semanticCode, this, [this, id] { return count(id); });
+    }
+    return id;
+}
+
+detail::ErrThreadCounts *ErrRegistry::attachThread() {
+    std::lock_guard<std::mutex> lock(mtx);
+    detail::ErrThreadCounts *counts = nullptr;
+    for (auto *c : threadCounts) {
+        bool free = false;
+        if (c->inUse.compare_exchange_strong(free, true, std::memory_order_acquire)) {
+            counts = c;
+            break;
+        }
+    }
+    if (counts == nullptr) {
+        counts = new detail::ErrThreadCounts();
+        threadCounts.push_back(counts);
+    }
+    attachment.counts = counts;
+    localCounts = counts;
+    return counts;
+}
+
+uint64_t ErrRegistry::count(uint16_t errId) const {
+    std::lock_guard<std::mutex> lock(mtx);
+    uint64_t total = detachedCounts[errId].load(std::memory_order_relaxed);
+    for (const auto *c : threadCounts) {
+        total += c->counts[errId].load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+int64_t ErrRegistry::nowMs() const {
+    if (const auto *clock = reportClock.load(std::memory_order_acquire)) {
+        return (*clock)();
+    }
+    return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+bool ErrRegistry::report(uint16_t errId, std::string_view line) {
+    uint64_t suppressed;
+    if (!admitReport(errId, suppressed)) {
+        return false;
+    }
+    emitReport(std::string(line), suppressed);
+    return true;
+}
+
+bool ErrRegistry::admitReport(uint16_t errId, uint64_t &suppressed) noexcept {
+    ReportWindow &w = windows[errId];
+    const int64_t second = nowMs() / 1000;
+    int64_t current = w.second.load(std::memory_order_relaxed);
+    if (current != second && w.second.compare_exchange_strong(current, second, std::memory_order_relaxed)) {
+        w.used.store(0, std::memory_order_relaxed);
+    }
+    if (w.used.fetch_add(1, std::memory_order_relaxed) >= reportPerSecond.load(std::memory_order_relaxed)) {
+        w.suppressed.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    suppressed = w.suppressed.exchange(0, std::memory_order_relaxed);
+    return true;
+}
+
+void ErrRegistry::emitReport(std::string out, uint64_t suppressed) {
+    if (suppressed > 0) {
+        out += " (" + std::to_string(suppressed) + " similar errors suppressed)";
+    }
+    std::lock_guard<std::mutex> lock(reportMtx);
+    if (reportOptions.sink) {
+        reportOptions.sink(out);
+    } else {
+        std::cout << out << std::endl;
+    }
+}
+
+void ErrRegistry::setReportOptions(ErrReportOptions options) {
+    std::lock_guard<std::mutex> lock(reportMtx);
+    reportPerSecond.store(options.perSecond, std::memory_order_relaxed);
+    const std::function<int64_t()> *clock = nullptr;
+    if (options.clock) {
+        clocks.push_back(std::make_unique<const std::function<int64_t()>>(options.clock));
+        clock = clocks.back().get();
+    }
+    reportClock.store(clock, std::memory_order_release);
+    reportOptions = std::move(options);
+}
+
 EGrp EGrp::INTERNAL = EGrp(-1, "INTERNAL");
 
 Err Err::SYS_ERR = Err(-1, "SYS_ERR", "system encounter some not know exception, plese retry later");
 
 Err Err::UNREACHABLE = Err(-2, "UNREACHABLE", "it should have not happen!");
 
+Err Err::IO_ERR = Err(-3, "IO_ERR", "system io call failed, please check errno");
+
 Err Err::FORMAT_ERR = Err(1, "FORMAT_ERR", "format wrong, please check input information");
 
 Err Err::QUEUE_FULL = Err(2, "QUEUE_FULL", "queue is full, please try later");
 
+Err Err::QUEUE_EMPTY = Err(3, "QUEUE_EMPTY", "queue is empty, please try later");
+
+Err Err::VALIDATION_ERR = Err(4, "VALIDATION_ERR", "validation failed, please check input information");
+
 RHINO_INLINE_NAMESPACE_END
 } // namespace rhino
\ No newline at end of file
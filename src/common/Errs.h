@@ -1,8 +1,16 @@
 #pragma once
 
+#include <atomic>
 #include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
 #include <stdexcept>
 #include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 #include "common/Version.h"
 #include "nlohmann/json.hpp"
 
@@ -14,15 +22,12 @@ struct EGrp {
 
     int32_t code{};
     std::string semanticCode;
+    // ErrRegistry 分配的编号，0 表示未登记
+    uint16_t id{};
 
     EGrp() = default;
 
-    EGrp(const int32_t code, std::string semanticCode)
-        : code(code), semanticCode(std::move(semanticCode)) {
-            if (code == 0) {
-                throw std::runtime_error("you should not use zero as a error group code");
-            }
-        }
+    EGrp(int32_t code, std::string semanticCode);
 
     NLOHMANN_DEFINE_TYPE_INTRUSIVE(EGrp, code, semanticCode);
 
@@ -35,15 +40,12 @@ struct Err {
     int32_t code{};
     std::string semanticCode;
     std::string msg;
+    // ErrRegistry 分配的编号，0 表示未登记
+    uint16_t id{};
 
-    Err(const int32_t code, std::string semanticCode, std::string defaultMsg)
-        : code(code), semanticCode(std::move(semanticCode)),
-          msg(std::move(defaultMsg)) {
-        if (code == 0) {
-            throw std::runtime_error("errCode should not be 0!");
-        }
-        sysErr = code < 0;
-    }
+    Err() = default;
+
+    Err(int32_t code, std::string semanticCode, std::string defaultMsg);
 
     NLOHMANN_DEFINE_TYPE_INTRUSIVE(Err, sysErr, code, semanticCode, msg);
 
@@ -51,9 +53,170 @@ struct Err {
 
     static Err UNREACHABLE;
 
+    static Err IO_ERR;
+
     static Err FORMAT_ERR;
 
     static Err QUEUE_FULL;
+
+    static Err QUEUE_EMPTY;
+
+    static Err VALIDATION_ERR;
+};
+
+struct ErrReportOptions {
+    // 每个错误码每秒最多输出的条数，超出的只计数，附在下一条输出里
+    uint32_t perSecond = 5;
+    // 输出目标，为空时写到 std::cout
+    std::function<void(const std::string &)> sink;
+    // 毫秒时钟，测试时可以替换；为空时使用 steady_clock
+    std::function<int64_t()> clock;
+};
+
+namespace detail {
+
+constexpr uint16_t MAX_ERR_IDS = 1024;
+
+// 一个线程的错误计数，只有所属线程写；线程退出后留给新线程接着用
+struct ErrThreadCounts {
+    std::atomic<uint64_t> counts[MAX_ERR_IDS]{};
+    std::atomic<bool> inUse{true};
+};
+
+} // namespace detail
+
+/**
+ * 错误登记表：每个错误组、错误在启动时分配一个 16 位编号，Ret 里只保存编号
+ *
+ * - EGrp / Err 的构造函数自动登记；同一个 (code, semanticCode) 重复登记得到同一个编号，
+ *   code 相同而 semanticCode 不同（或反过来）视为冲突，抛出 std::runtime_error
+ * - 登记的是一份拷贝，按编号取回的 Err 的 msg 是默认消息。0 留给“成功”，1 留给 UNKNOWN_ID
+ * - 对端发来的错误（JSON 反序列化）只用 find 查找，不登记：不认识或与本地登记冲突的错误码
+ *   记为 UNKNOWN_ID，原始的 code、semanticCode 由 Ret 自己保存
+ * - Ret::with 每构造一次失败就 record 一次，计数写在当前线程自己的槽位里，不加锁、没有共享写；
+ *   线程归还槽位之后（thread_local 析构阶段）的计数改为原子地加到共享的兜底计数上。
+ *   每个错误的累计次数登记为指标 errors.<semanticCode>
+ * - report 按错误码限流输出日志，错误风暴时每个错误码每秒最多输出 perSecond 条；
+ *   先用 admitReport 判断配额，被限流时不拼日志、不加锁
+ */
+class ErrRegistry {
+  public:
+    static constexpr uint16_t MAX_IDS = detail::MAX_ERR_IDS;
+
+    // 本进程没有登记过的错误组 / 错误共用的编号
+    static constexpr uint16_t UNKNOWN_ID = 1;
+
+    static ErrRegistry &global() {
+        // 不析构：静态对象析构阶段仍可能有 Ret 查询登记表
+        static ErrRegistry *registry = new ErrRegistry();
+        return *registry;
+    }
+
+    uint16_t add(const EGrp &eGrp);
+
+    uint16_t add(const Err &err);
+
+    // 编号对应的错误组，id 必须是 add 返回过的
+    const EGrp &group(uint16_t id) const noexcept { return *groups[id].load(std::memory_order_acquire); }
+
+    // 编号对应的错误，msg 是默认消息
+    const Err &err(uint16_t id) const noexcept { return *errs[id].load(std::memory_order_acquire); }
+
+    // EGrp / Err 自身带有编号时直接返回，否则（默认构造、JSON 反序列化得到的）按 code 查找或登记
+    uint16_t idOf(const EGrp &eGrp) { return eGrp.id != 0 ? eGrp.id : add(eGrp); }
+
+    uint16_t idOf(const Err &err) { return err.id != 0 ? err.id : add(err); }
+
+    // 已登记且 code、semanticCode 都相同时返回编号，否则返回 0；不登记、不抛异常
+    uint16_t find(const EGrp &eGrp) const;
+
+    uint16_t find(const Err &err) const;
+
+    // 记录错误 errId 发生了一次
+    void record(uint16_t errId) noexcept {
+        detail::ErrThreadCounts *local = localCounts;
+        if (local == nullptr) {
+            if (threadDetached) {
+                detachedCounts[errId].fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+            local = attachThread();
+        }
+        auto &counter = local->counts[errId];
+        counter.store(counter.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    }
+
+    // 所有线程（包括已退出的）累计的发生次数
+    uint64_t count(uint16_t errId) const;
+
+    /**
+     * 按错误码限流输出一行日志
+     *
+     * @return 被限流丢弃时返回 false
+     */
+    bool report(uint16_t errId, std::string_view line);
+
+    /**
+     * 占用 errId 本秒的一个输出配额，不拼接日志也不加锁
+     *
+     * @param suppressed 配额内时返回此前被丢弃的条数，交给 emitReport
+     * @return 被限流时返回 false，调用方不必再构造日志
+     */
+    bool admitReport(uint16_t errId, uint64_t &suppressed) noexcept;
+
+    // 输出 admitReport 放行的一行日志
+    void emitReport(std::string line, uint64_t suppressed);
+
+    void setReportOptions(ErrReportOptions options);
+
+  private:
+    struct ReportWindow {
+        std::atomic<int64_t> second{-1};
+        std::atomic<uint32_t> used{0};
+        std::atomic<uint64_t> suppressed{0};
+    };
+
+    // 线程退出时由 ThreadAttachment 清空，之后 threadDetached 为 true（平凡析构，线程结束前一直可访问）
+    static inline thread_local detail::ErrThreadCounts *localCounts = nullptr;
+    static inline thread_local bool threadDetached = false;
+
+    struct ThreadAttachment;
+    static thread_local ThreadAttachment attachment;
+
+    mutable std::mutex mtx;
+    std::unique_ptr<std::atomic<const EGrp *>[]> groups{new std::atomic<const EGrp *>[MAX_IDS]()};
+    std::unique_ptr<std::atomic<const Err *>[]> errs{new std::atomic<const Err *>[MAX_IDS]()};
+    std::unordered_map<int32_t, uint16_t> groupCodes;
+    std::unordered_map<int32_t, uint16_t> errCodes;
+    std::unordered_map<std::string, uint16_t> groupNames;
+    std::unordered_map<std::string, uint16_t> errNames;
+    uint16_t nextGroupId = UNKNOWN_ID + 1;
+    uint16_t nextErrId = UNKNOWN_ID + 1;
+    std::vector<detail::ErrThreadCounts *> threadCounts;
+    // 已经归还槽位的线程上发生的错误
+    std::unique_ptr<std::atomic<uint64_t>[]> detachedCounts{new std::atomic<uint64_t>[MAX_IDS]()};
+
+    std::unique_ptr<ReportWindow[]> windows{new ReportWindow[MAX_IDS]};
+    std::atomic<uint32_t> reportPerSecond{ErrReportOptions().perSecond};
+    std::mutex reportMtx;
+    ErrReportOptions reportOptions;
+    // 替换的时钟，读取时不加锁；换下来的旧时钟可能还在被并发调用，留在 clocks 里不释放
+    std::atomic<const std::function<int64_t()> *> reportClock{nullptr};
+    std::vector<std::unique_ptr<const std::function<int64_t()>>> clocks;
+
+    ErrRegistry();
+
+    detail::ErrThreadCounts *attachThread();
+
+    template <typename E>
+    uint16_t add(std::unique_ptr<std::atomic<const E *>[]> &slots, std::unordered_map<int32_t, uint16_t> &codes,
+                 std::unordered_map<std::string, uint16_t> &names, uint16_t &nextId, const E &e, bool &inserted);
+
+    template <typename E>
+    uint16_t find(const std::unique_ptr<std::atomic<const E *>[]> &slots,
+                  const std::unordered_map<int32_t, uint16_t> &codes, const E &e) const;
+
+    int64_t nowMs() const;
 };
 RHINO_INLINE_NAMESPACE_END
 } // namespace rhino
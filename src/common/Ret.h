@@ -2,8 +2,12 @@
 #pragma once
 
 #include "nlohmann/json.hpp"
-#include <sstream>
+#include <cstddef>
+#include <cstring>
+#include <new>
 #include <string>
+#include <string_view>
+#include <type_traits>
 #include <utility>
 #include "common/Version.h"
 #include "common/Errs.h"
@@ -13,45 +17,380 @@
 namespace rhino {
 RHINO_INLINE_NAMESPACE_BEGIN
 
-template <class T> class Ret {
+template <class T> class Ret;
+
+namespace detail {
+
+/**
+ * 失败时附带的自定义消息：长度和字符放在同一块内存里，只分配一次
+ *
+ * 对端发来的错误组或错误不在本进程的登记表中时，同一块内存里还带着原始的 code、semanticCode
+ */
+class ErrMsg {
+    size_t len;
+    int32_t grpCode = 0;
+    int32_t errCode = 0;
+    uint32_t grpNameLen = 0;
+    uint32_t errNameLen = 0;
+    bool errSys = false;
+
+    explicit ErrMsg(size_t len) noexcept : len(len) {}
+
+    char *chars() noexcept { return reinterpret_cast<char *>(this + 1); }
+
+    const char *chars() const noexcept { return reinterpret_cast<const char *>(this + 1); }
+
+    size_t bytes() const noexcept { return sizeof(ErrMsg) + len + grpNameLen + errNameLen; }
+
   public:
-    bool success = true;
-    T data{};
-    bool sysErr = false;
-    EGrp eGrp{};
-    Err err{};
-    NLOHMANN_DEFINE_TYPE_INTRUSIVE(Ret<T>, success, data, sysErr, eGrp, err)
+    static ErrMsg *make(std::string_view s) {
+        auto *m = new (::operator new(sizeof(ErrMsg) + s.size())) ErrMsg(s.size());
+        std::memcpy(m->chars(), s.data(), s.size());
+        return m;
+    }
+
+    // 保存对端错误的全部信息：msg 之后依次是错误组和错误的 semanticCode
+    static ErrMsg *makeForeign(const EGrp &eGrp, const Err &err) {
+        const size_t total = sizeof(ErrMsg) + err.msg.size() + eGrp.semanticCode.size() + err.semanticCode.size();
+        auto *m = new (::operator new(total)) ErrMsg(err.msg.size());
+        m->grpCode = eGrp.code;
+        m->errCode = err.code;
+        m->grpNameLen = static_cast<uint32_t>(eGrp.semanticCode.size());
+        m->errNameLen = static_cast<uint32_t>(err.semanticCode.size());
+        m->errSys = err.sysErr;
+        char *p = m->chars();
+        std::memcpy(p, err.msg.data(), err.msg.size());
+        std::memcpy(p + m->len, eGrp.semanticCode.data(), m->grpNameLen);
+        std::memcpy(p + m->len + m->grpNameLen, err.semanticCode.data(), m->errNameLen);
+        return m;
+    }
+
+    ErrMsg *clone() const {
+        auto *m = static_cast<ErrMsg *>(::operator new(bytes()));
+        std::memcpy(static_cast<void *>(m), this, bytes());
+        return m;
+    }
+
+    static void destroy(ErrMsg *m) noexcept { ::operator delete(m); }
+
+    std::string_view view() const noexcept { return {chars(), len}; }
+
+    int32_t foreignCode() const noexcept { return errCode; }
+
+    bool foreignSysErr() const noexcept { return errSys; }
+
+    EGrp foreignGroup() const {
+        EGrp eGrp;
+        eGrp.code = grpCode;
+        eGrp.semanticCode.assign(chars() + len, grpNameLen);
+        eGrp.id = ErrRegistry::UNKNOWN_ID;
+        return eGrp;
+    }
+
+    Err foreignErr() const {
+        Err err;
+        err.sysErr = errSys;
+        err.code = errCode;
+        err.semanticCode.assign(chars() + len + grpNameLen, errNameLen);
+        err.msg = std::string(view());
+        err.id = ErrRegistry::UNKNOWN_ID;
+        return err;
+    }
+};
+
+template <typename T> struct IsRetType : std::false_type {};
+template <typename T> struct IsRetType<Ret<T>> : std::true_type {};
+
+} // namespace detail
+
+/**
+ * 函数返回值：成功时是 T，失败时是错误组 + 错误码（+ 可选的自定义消息）
+ *
+ * 错误组和错误码只保存 ErrRegistry 分配的 16 位编号，成功时不构造任何字符串；自定义消息只在失败时
+ * 分配一块内存，指针与 T 共用存储。T 可以是只能移动的类型
+ *
+ * 布局：T 与一个指针的 union，后接 4 字节编号，再按对齐补齐。T 不超过指针大小时 Ret 是两个指针大小
+ * （64 位平台上 16 字节，见文件末尾的 static_assert），否则比 T 多 4 字节加上补齐
+ *
+ * value() 只在成功时有效，使用前先检查 failed()。JSON 格式与旧版一致：
+ * {"success", "data", "sysErr", "eGrp": {"code", "semanticCode"}, "err": {"sysErr", "code", "semanticCode", "msg"}}
+ */
+template <class T> class [[nodiscard]] Ret {
+    template <class> friend class Ret;
+
+    // 成功时是 data，失败时是 errMsg（nullptr 表示使用默认消息）
+    union {
+        T data;
+        detail::ErrMsg *errMsg;
+    };
+    uint16_t grpId = 0;
+    // 0 表示成功
+    uint16_t errId = 0;
+
+    struct Failure {};
+
+    Ret(Failure, uint16_t grpId, uint16_t errId, detail::ErrMsg *errMsg) noexcept
+        : errMsg(errMsg), grpId(grpId), errId(errId) {}
+
+    static Ret failure(const EGrp &eGrp, const Err &err, std::string_view msg) {
+        auto &registry = ErrRegistry::global();
+        const uint16_t id = registry.idOf(err);
+        // 与默认消息相同时不必保存
+        detail::ErrMsg *custom = msg == registry.err(id).msg ? nullptr : detail::ErrMsg::make(msg);
+        return Ret(Failure{}, registry.idOf(eGrp), id, custom);
+    }
+
+    // 对端发来的失败：只查找不登记，不认识的错误组 / 错误记为 UNKNOWN_ID，原始信息放进 errMsg
+    static Ret received(const EGrp &eGrp, const Err &err) {
+        auto &registry = ErrRegistry::global();
+        const uint16_t grp = registry.find(eGrp);
+        const uint16_t id = registry.find(err);
+        if (grp != 0 && id != 0) {
+            detail::ErrMsg *custom = err.msg == registry.err(id).msg ? nullptr : detail::ErrMsg::make(err.msg);
+            return Ret(Failure{}, grp, id, custom);
+        }
+        return Ret(Failure{}, grp != 0 ? grp : ErrRegistry::UNKNOWN_ID, id != 0 ? id : ErrRegistry::UNKNOWN_ID,
+                   detail::ErrMsg::makeForeign(eGrp, err));
+    }
+
+    bool foreignErr() const noexcept { return errId == ErrRegistry::UNKNOWN_ID; }
+
+    void destroy() noexcept {
+        if (errId == 0) {
+            data.~T();
+        } else if (errMsg != nullptr) {
+            detail::ErrMsg::destroy(errMsg);
+        }
+    }
+
+    template <typename R> void assign(R &&other) {
+        grpId = other.grpId;
+        errId = other.errId;
+        if (errId == 0) {
+            new (&data) T(std::forward<R>(other).data);
+        } else if (other.errMsg == nullptr) {
+            errMsg = nullptr;
+        } else if constexpr (std::is_rvalue_reference_v<R &&>) {
+            errMsg = other.errMsg;
+            other.errMsg = nullptr;
+        } else {
+            errMsg = other.errMsg->clone();
+        }
+    }
 
-    Ret() = default;
+    // 把失败原样转成另一种 Ret
+    template <typename U> Ret<U> transfer() const & {
+        return Ret<U>(typename Ret<U>::Failure{}, grpId, errId,
+                      errMsg == nullptr ? nullptr : errMsg->clone());
+    }
 
-    explicit Ret(T data) : data(data) {}
+    // 右值直接转交自定义消息，不再拷贝
+    template <typename U> Ret<U> transfer() && {
+        detail::ErrMsg *msg = errMsg;
+        errMsg = nullptr;
+        return Ret<U>(typename Ret<U>::Failure{}, grpId, errId, msg);
+    }
 
-    Ret(const bool success, const bool sysErr, EGrp eGrp, Err err)
-        : success(success), sysErr(sysErr), eGrp(std::move(eGrp)),
-          err(std::move(err)) {}
+  public:
+    Ret() : data() {}
 
-    bool failed() const { return !success; }
+    explicit Ret(T data) : data(std::move(data)) {}
 
-    EGrp getEGrp() const { return eGrp; }
+    Ret(const Ret &other) { assign(other); }
 
-    Err getErr() const { return err; }
+    Ret(Ret &&other) noexcept(std::is_nothrow_move_constructible_v<T>) { assign(std::move(other)); }
 
-    static Ret with(T data) { return Ret(data); }
+    Ret &operator=(const Ret &other) {
+        if (this != &other) {
+            Ret copy(other);
+            *this = std::move(copy);
+        }
+        return *this;
+    }
+
+    Ret &operator=(Ret &&other) noexcept(std::is_nothrow_move_constructible_v<T>) {
+        if (this != &other) {
+            destroy();
+            assign(std::move(other));
+        }
+        return *this;
+    }
+
+    ~Ret() { destroy(); }
+
+    bool failed() const noexcept { return errId != 0; }
+
+    T &value() & noexcept { return data; }
+
+    const T &value() const & noexcept { return data; }
+
+    T &&value() && noexcept { return std::move(data); }
+
+    // 错误码，成功时为 0
+    int32_t errCode() const noexcept {
+        if (errId == 0) {
+            return 0;
+        }
+        return foreignErr() ? errMsg->foreignCode() : ErrRegistry::global().err(errId).code;
+    }
+
+    bool sysErr() const noexcept {
+        if (errId == 0) {
+            return false;
+        }
+        return foreignErr() ? errMsg->foreignSysErr() : ErrRegistry::global().err(errId).sysErr;
+    }
+
+    uint16_t errorId() const noexcept { return errId; }
+
+    // 失败消息：有自定义消息时返回它，否则是错误的默认消息；成功时为空
+    std::string_view message() const noexcept {
+        if (errId == 0) {
+            return {};
+        }
+        return errMsg != nullptr ? errMsg->view() : std::string_view(ErrRegistry::global().err(errId).msg);
+    }
+
+    /**
+     * 失败时输出 "context: 消息"，按错误码限流（见 ErrRegistry::report）；成功时什么也不做
+     */
+    void report(std::string_view context) const {
+        uint64_t suppressed;
+        // 先占配额，被限流时不拼接日志
+        if (errId != 0 && ErrRegistry::global().admitReport(errId, suppressed)) {
+            std::string line(context);
+            line += ": ";
+            line += message();
+            ErrRegistry::global().emitReport(std::move(line), suppressed);
+        }
+    }
+
+    /**
+     * 失败时的错误组，成功时返回默认构造的 EGrp
+     */
+    EGrp getEGrp() const {
+        if (grpId == 0) {
+            return EGrp();
+        }
+        // 错误组认识而错误不认识时，errMsg 里同样有错误组的原始信息，以登记表为准
+        return grpId == ErrRegistry::UNKNOWN_ID ? errMsg->foreignGroup() : ErrRegistry::global().group(grpId);
+    }
+
+    /**
+     * 失败时构造出完整的 Err（msg 为实际消息），成功时返回默认构造的 Err
+     */
+    Err getErr() const {
+        if (errId == 0) {
+            return Err();
+        }
+        if (foreignErr()) {
+            return errMsg->foreignErr();
+        }
+        Err err = ErrRegistry::global().err(errId);
+        if (errMsg != nullptr) {
+            err.msg = std::string(errMsg->view());
+        }
+        return err;
+    }
+
+    static Ret with(T data) { return Ret(std::move(data)); }
 
     static Ret<void *> successOfNullptr;
 
-    static Ret with(EGrp &eGrp, Err &err) {
-        return Ret(false, err.sysErr, eGrp, err);
+    static Ret with(const EGrp &eGrp, const Err &err) { return with(eGrp, err, err.msg); }
+
+    // 每次调用都计入 ErrRegistry 中该错误的发生次数
+    static Ret with(const EGrp &eGrp, const Err &err, std::string_view errMsg) {
+        Ret ret = failure(eGrp, err, errMsg);
+        ErrRegistry::global().record(ret.errId);
+        return ret;
+    }
+
+    template <typename S> static Ret<T> FailureTransfer(const Ret<S> &source) { return source.template transfer<T>(); }
+
+    template <typename S> static Ret<T> FailureTransfer(Ret<S> &&source) {
+        return std::move(source).template transfer<T>();
     }
 
-    static Ret with(EGrp &eGrp, Err &err, const std::string &errMsg) {
-        err.msg = errMsg;
-        return Ret(false, err.sysErr, eGrp, err);
+    /**
+     * 成功时调用 fn(value) 并返回它的结果（必须是某种 Ret<U>），失败时原样转成 Ret<U>
+     */
+    template <typename F> auto andThen(F &&fn) const & {
+        using R = std::invoke_result_t<F, const T &>;
+        static_assert(detail::IsRetType<R>::value, "andThen expects fn to return Ret<U>");
+        return failed() ? transfer<typename R::ValueType>() : std::forward<F>(fn)(data);
     }
 
-    template <typename S> static Ret<T> FailureTransfer(Ret<S> source) {
-        return Ret(source.success, source.sysErr, source.eGrp, source.err);
+    template <typename F> auto andThen(F &&fn) && {
+        using R = std::invoke_result_t<F, T &&>;
+        static_assert(detail::IsRetType<R>::value, "andThen expects fn to return Ret<U>");
+        return failed() ? std::move(*this).template transfer<typename R::ValueType>()
+                        : std::forward<F>(fn)(std::move(data));
+    }
+
+    /**
+     * 成功时返回 Ret<U>(fn(value))，fn 返回 void 时得到 Ret<void *>；失败时原样转换
+     */
+    template <typename F> auto map(F &&fn) const & { return mapImpl<const T &>(*this, std::forward<F>(fn)); }
+
+    template <typename F> auto map(F &&fn) && { return mapImpl<T &&>(std::move(*this), std::forward<F>(fn)); }
+
+    /**
+     * 失败时调用 fn(err) 得到替代的 Ret<T>（可以恢复成成功），成功时原样返回
+     */
+    template <typename F> Ret orElse(F &&fn) const & { return failed() ? std::forward<F>(fn)(getErr()) : *this; }
+
+    template <typename F> Ret orElse(F &&fn) && {
+        return failed() ? std::forward<F>(fn)(getErr()) : std::move(*this);
+    }
+
+    using ValueType = T;
+
+    friend void to_json(nlohmann::json &j, const Ret &ret) {
+        const bool success = !ret.failed();
+        j["success"] = success;
+        if (success) {
+            j["data"] = ret.data;
+        } else if constexpr (std::is_default_constructible_v<T>) {
+            j["data"] = T();
+        } else {
+            j["data"] = nullptr;
+        }
+        j["sysErr"] = ret.sysErr();
+        j["eGrp"] = ret.getEGrp();
+        j["err"] = ret.getErr();
+    }
+
+    friend void from_json(const nlohmann::json &j, Ret &ret) {
+        if (j.at("success").get<bool>()) {
+            ret = Ret(j.at("data").get<T>());
+            return;
+        }
+        // 不登记、不因错误码冲突抛异常：对端的输入不能改变本进程的登记表
+        ret = received(j.at("eGrp").get<EGrp>(), j.at("err").get<Err>());
+    }
+
+  private:
+    template <typename V, typename Self, typename F> static auto mapImpl(Self &&self, F &&fn) {
+        using U = std::invoke_result_t<F, V>;
+        if constexpr (std::is_void_v<U>) {
+            if (self.failed()) {
+                return std::forward<Self>(self).template transfer<void *>();
+            }
+            std::forward<F>(fn)(static_cast<V>(self.data));
+            return Ret<void *>(nullptr);
+        } else {
+            if (self.failed()) {
+                return std::forward<Self>(self).template transfer<U>();
+            }
+            return Ret<U>(std::forward<F>(fn)(static_cast<V>(self.data)));
+        }
     }
 };
+
+static_assert(sizeof(Ret<int32_t>) == 2 * sizeof(void *), "Ret of a small T must be two pointers wide");
+static_assert(sizeof(Ret<void *>) == 2 * sizeof(void *), "Ret of a small T must be two pointers wide");
+static_assert(sizeof(Ret<bool>) == 2 * sizeof(void *), "Ret of a small T must be two pointers wide");
+
 RHINO_INLINE_NAMESPACE_END
 } // namespace rhino
@@ -0,0 +1,22 @@
+#pragma once
+
+#include "config/ConfigSchema.h"
+
+/*
+主程序的配置 schema（config/app.toml），新增配置项时在这里追加一行，并用 `rhino --schema` 重新生成 docs/config-schema.md
+线程放置 [placement.*] 由 PlacementConfig 单独解析，不在这里声明
+*/
+#define RHINO_APP_CONFIG(X)                                                                                   \
+    X(StringCfg, appName, "app.name", "rhino", "服务名，用于日志", NotBlank("app.name must not be blank"))     \
+    X(BoolCfg, metricsEnabled, "metrics.enabled", true, "是否定期输出指标")                                   \
+    X(Int32Cfg, metricsIntervalSeconds, "metrics.report_interval_s", 10, "指标输出间隔（秒）",               \
+      GreaterThan(0, "metrics.report_interval_s must be > 0")                                                \
+          LessOrEqualThan(3600, "metrics.report_interval_s must be <= 3600"))
+
+namespace rhino {
+RHINO_INLINE_NAMESPACE_BEGIN
+
+RHINO_DEFINE_CONFIG(AppConfig, RHINO_APP_CONFIG)
+
+RHINO_INLINE_NAMESPACE_END
+} // namespace rhino
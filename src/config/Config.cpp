@@ -0,0 +1,292 @@
+#include "config/Config.h"
+
+#include <cerrno>
+#include <charconv>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+#include <sys/epoll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#include "runtime/EventLoop.h"
+
+namespace rhino {
+RHINO_INLINE_NAMESPACE_BEGIN
+
+namespace {
+
+std::string quote(const std::string &s) {
+    std::string out = "\"";
+    for (char c : s) {
+        if (c == '"' || c == '\\') {
+            out.push_back('\\');
+        }
+        out.push_back(c);
+    }
+    out.push_back('"');
+    return out;
+}
+
+void logChanges(uint64_t version, const std::vector<ConfigChange> &changes) {
+    std::cout << "config version " << version << " published, " << changes.size() << " change(s)" << std::endl;
+    for (const auto &c : changes) {
+        std::cout << "  " << c.key << ": " << (c.before.empty() ? "<none>" : c.before) << " -> "
+                  << (c.after.empty() ? "<none>" : c.after) << std::endl;
+    }
+}
+
+bool sameCfg(const CfgValue &x, const CfgValue &y) {
+    if (x.index() != y.index()) {
+        return false;
+    }
+    return std::visit(
+        [&y](const auto &cfg) {
+            using Cfg = std::decay_t<decltype(cfg)>;
+            return cfg.val == std::get<Cfg>(y).val;
+        },
+        x);
+}
+
+} // namespace
+
+std::string renderCfg(const CfgValue &value) {
+    return std::visit(
+        [](const auto &cfg) -> std::string {
+            using Cfg = std::decay_t<decltype(cfg)>;
+            if constexpr (std::is_same_v<Cfg, StringCfg>) {
+                return quote(cfg.val);
+            } else if constexpr (std::is_same_v<Cfg, BoolCfg>) {
+                return cfg.val ? "true" : "false";
+            } else if constexpr (std::is_same_v<Cfg, DoubleCfg>) {
+                // 最短的可还原表示，保证不同的取值渲染结果也不同
+                char buf[32];
+                std::string out(buf, std::to_chars(buf, buf + sizeof(buf), cfg.val).ptr);
+                // toml 的浮点字面量必须带小数点或指数，inf / nan 原样保留
+                if (out.find_first_not_of("-0123456789") == std::string::npos) {
+                    out += ".0";
+                }
+                return out;
+            } else {
+                return std::to_string(cfg.val);
+            }
+        },
+        value);
+}
+
+std::vector<ConfigChange> diffConfig(const CfgEntries &before, const CfgEntries &after) {
+    std::vector<ConfigChange> changes;
+    auto b = before.begin();
+    auto a = after.begin();
+    while (b != before.end() || a != after.end()) {
+        if (a == after.end() || (b != before.end() && b->first < a->first)) {
+            changes.push_back(ConfigChange{b->first, renderCfg(b->second), ""});
+            ++b;
+        } else if (b == before.end() || a->first < b->first) {
+            changes.push_back(ConfigChange{a->first, "", renderCfg(a->second)});
+            ++a;
+        } else {
+            // 按类型化的值比较，类型变化（例如 1 -> "1"）也算变化
+            if (!sameCfg(b->second, a->second)) {
+                changes.push_back(ConfigChange{a->first, renderCfg(b->second), renderCfg(a->second)});
+            }
+            ++a;
+            ++b;
+        }
+    }
+    return changes;
+}
+
+class ConfigManager::Watcher final : public IoHandler {
+
+  public:
+    ConfigManager &owner;
+    EventLoop &loop;
+    int32_t fd;
+    std::string name;
+
+    Watcher(ConfigManager &owner, EventLoop &loop, int32_t fd, std::string name)
+        : owner(owner), loop(loop), fd(fd), name(std::move(name)) {}
+
+    void onEvents(uint32_t) noexcept override {
+        alignas(inotify_event) char buf[4096];
+        bool changed = false;
+        // 边缘触发，读到 EAGAIN 为止
+        while (true) {
+            const ssize_t n = read(fd, buf, sizeof(buf));
+            if (n <= 0) {
+                break;
+            }
+            for (char *p = buf; p < buf + n;) {
+                const auto *event = reinterpret_cast<const inotify_event *>(p);
+                if (event->len > 0 && name == event->name) {
+                    changed = true;
+                }
+                p += sizeof(inotify_event) + event->len;
+            }
+        }
+        if (changed) {
+            // 结果（差异或失败原因）已在 reload 中输出
+            (void)owner.reload();
+        }
+    }
+};
+
+ConfigManager::ConfigManager(std::string path, Loader loader) : file(std::move(path)), loader(std::move(loader)) {}
+
+ConfigManager::~ConfigManager() {
+    unwatch();
+    // 此时不应再有读者，直接释放；之前被替换的快照由 epoch 回收
+    delete current.load(std::memory_order_acquire);
+    delete previous;
+    for (auto &n : notifications) {
+        delete n.retired;
+    }
+}
+
+void ConfigManager::addValidator(Validator validator) {
+    std::lock_guard<std::mutex> lock(writeMutex);
+    validators.push_back(std::move(validator));
+}
+
+void ConfigManager::addListener(Listener listener) {
+    std::lock_guard<std::mutex> lock(writeMutex);
+    listeners.push_back(std::move(listener));
+}
+
+Ret<std::vector<ConfigChange>> ConfigManager::reload() {
+    std::unique_lock<std::mutex> lock(writeMutex);
+    const ConfigSnapshot *old = current.load(std::memory_order_relaxed);
+    const uint64_t keep = old == nullptr ? 0 : old->version();
+
+    auto loaded = loader(file);
+    if (loaded.failed()) {
+        loaded.report("config reload failed, keep version " + std::to_string(keep));
+        return Ret<std::vector<ConfigChange>>::FailureTransfer(std::move(loaded));
+    }
+
+    std::unique_ptr<ConfigSnapshot> next;
+    try {
+        for (auto &[key, value] : loaded.value()) {
+            std::visit([](auto &cfg) { cfg.PostProcess(); }, value);
+        }
+        next = std::make_unique<ConfigSnapshot>(nextVersion, std::move(loaded.value()));
+        for (const auto &validator : validators) {
+            validator(*next);
+        }
+    } catch (const std::invalid_argument &e) {
+        auto rejected = Ret<std::vector<ConfigChange>>::with(EGrp::INTERNAL, Err::VALIDATION_ERR, e.what());
+        rejected.report("config rejected, keep version " + std::to_string(keep));
+        return rejected;
+    }
+
+    auto changes = diffConfig(old == nullptr ? CfgEntries() : old->entries(), next->entries());
+    nextVersion++;
+    publish(next.release(), changes);
+    lock.unlock();
+    notifyListeners();
+    return Ret<std::vector<ConfigChange>>::with(changes);
+}
+
+Ret<void *> ConfigManager::rollback() {
+    std::unique_lock<std::mutex> lock(writeMutex);
+    if (previous == nullptr) {
+        return Ret<void *>::with(EGrp::INTERNAL, Err::VALIDATION_ERR, "no previous config snapshot to roll back to");
+    }
+    const ConfigSnapshot *old = current.load(std::memory_order_relaxed);
+    const ConfigSnapshot *back = previous;
+    auto changes = diffConfig(old->entries(), back->entries());
+    current.store(back, std::memory_order_release);
+    publishedVersion.store(back->version(), std::memory_order_release);
+    previous = nullptr;
+    std::cout << "config rolled back to version " << back->version() << std::endl;
+    logChanges(back->version(), changes);
+    notifications.push_back({back, std::move(changes), old});
+    lock.unlock();
+    notifyListeners();
+    return Ret<void *>::with(nullptr);
+}
+
+void ConfigManager::publish(const ConfigSnapshot *next, std::vector<ConfigChange> changes) {
+    const ConfigSnapshot *old = current.load(std::memory_order_relaxed);
+    current.store(next, std::memory_order_release);
+    publishedVersion.store(next->version(), std::memory_order_release);
+    logChanges(next->version(), changes);
+    notifications.push_back({next, std::move(changes), previous});
+    previous = old;
+}
+
+void ConfigManager::notifyListeners() {
+    std::unique_lock<std::mutex> lock(writeMutex);
+    if (notifying) {
+        return;
+    }
+    notifying = true;
+    while (!notifications.empty()) {
+        Notification n = std::move(notifications.front());
+        notifications.pop_front();
+        // 复制一份再解锁：监听器可能调用 addListener、reload 或 rollback
+        const std::vector<Listener> targets = listeners;
+        lock.unlock();
+        try {
+            for (const auto &listener : targets) {
+                listener(*n.snapshot, n.changes);
+            }
+        } catch (...) {
+            lock.lock();
+            if (n.retired != nullptr) {
+                epoch::Domain::global().retire(const_cast<ConfigSnapshot *>(n.retired));
+            }
+            notifying = false;
+            throw;
+        }
+        lock.lock();
+        if (n.retired != nullptr) {
+            epoch::Domain::global().retire(const_cast<ConfigSnapshot *>(n.retired));
+        }
+    }
+    notifying = false;
+}
+
+Ret<void *> ConfigManager::watch(EventLoop &loop) {
+    std::lock_guard<std::mutex> lock(writeMutex);
+    if (watcher != nullptr) {
+        return Ret<void *>::with(nullptr);
+    }
+    const auto slash = file.find_last_of('/');
+    const std::string dir = slash == std::string::npos ? "." : (slash == 0 ? "/" : file.substr(0, slash));
+    const std::string name = slash == std::string::npos ? file : file.substr(slash + 1);
+
+    const int32_t fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    // 监听目录而不是文件：rename 替换文件后，对旧文件的监听就失效了
+    if (fd < 0 || inotify_add_watch(fd, dir.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO) < 0) {
+        std::string msg = std::string("inotify: ") + std::strerror(errno);
+        if (fd >= 0) {
+            close(fd);
+        }
+        return Ret<void *>::with(EGrp::INTERNAL, Err::IO_ERR, msg);
+    }
+    auto w = std::make_unique<Watcher>(*this, loop, fd, name);
+    auto ret = loop.watch(fd, EPOLLIN, *w);
+    if (ret.failed()) {
+        close(fd);
+        return ret;
+    }
+    watcher = std::move(w);
+    return Ret<void *>::with(nullptr);
+}
+
+void ConfigManager::unwatch() {
+    std::unique_ptr<Watcher> w;
+    {
+        std::lock_guard<std::mutex> lock(writeMutex);
+        w = std::move(watcher);
+    }
+    if (w != nullptr) {
+        // 随后就关闭 fd，epoll 会自动移除它，失败也无妨
+        (void)w->loop.unwatch(w->fd, *w);
+        close(w->fd);
+    }
+}
+
+RHINO_INLINE_NAMESPACE_END
+} // namespace rhino
@@ -0,0 +1,213 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <variant>
+#include <vector>
+#include "common/Errs.h"
+#include "common/Ret.h"
+#include "common/Version.h"
+#include "config/ConfigTemplate.h"
+#include "util/Epoch.hpp"
+
+namespace rhino {
+RHINO_INLINE_NAMESPACE_BEGIN
+
+class EventLoop;
+
+// 一项配置的类型化取值
+using CfgValue = std::variant<StringCfg, Int32Cfg, BoolCfg, DoubleCfg>;
+
+// 扁平化后的配置：key 为点分路径，数组元素用 [i] 表示，例如 "placement.loop.cpus"、"Zhou[0].options.pose[1]"
+using CfgEntries = std::map<std::string, CfgValue>;
+
+/**
+ * 把 CfgValue 渲染为 toml 字面量（字符串带引号），用于差异日志和 dump
+ */
+std::string renderCfg(const CfgValue &value);
+
+/**
+ * 用 toml++ 解析配置文件并扁平化
+ *
+ * 整数超出 int32 范围、以及日期/时间等不支持的类型视为格式错误
+ *
+ * @return 失败时 Err::FORMAT_ERR，msg 中带有文件位置或出错的 key
+ */
+Ret<CfgEntries> loadTomlFile(const std::string &path);
+
+/**
+ * 不可变的配置快照，发布之后只读，多线程并发读取无需加锁
+ */
+class ConfigSnapshot {
+
+  public:
+    ConfigSnapshot(uint64_t version, CfgEntries entries) : ver(version), values(std::move(entries)) {}
+
+    uint64_t version() const noexcept { return ver; }
+
+    const CfgEntries &entries() const noexcept { return values; }
+
+    const CfgValue *find(const std::string &key) const {
+        auto it = values.find(key);
+        return it == values.end() ? nullptr : &it->second;
+    }
+
+    /**
+     * 按类型取配置项，key 不存在或类型不符时返回 nullptr
+     */
+    template <typename Cfg> const Cfg *get(const std::string &key) const {
+        const CfgValue *v = find(key);
+        return v == nullptr ? nullptr : std::get_if<Cfg>(v);
+    }
+
+    std::string getString(const std::string &key, const std::string &fallback = "") const {
+        const auto *c = get<StringCfg>(key);
+        return c == nullptr ? fallback : c->val;
+    }
+
+    int32_t getInt32(const std::string &key, int32_t fallback = 0) const {
+        const auto *c = get<Int32Cfg>(key);
+        return c == nullptr ? fallback : c->val;
+    }
+
+    bool getBool(const std::string &key, bool fallback = false) const {
+        const auto *c = get<BoolCfg>(key);
+        return c == nullptr ? fallback : c->val;
+    }
+
+    double getDouble(const std::string &key, double fallback = 0.0) const {
+        const auto *c = get<DoubleCfg>(key);
+        return c == nullptr ? fallback : c->val;
+    }
+
+  private:
+    uint64_t ver;
+    CfgEntries values;
+};
+
+// 两个快照之间一项配置的变化，before/after 为空串分别表示新增/删除
+struct ConfigChange {
+    std::string key;
+    std::string before;
+    std::string after;
+};
+
+/**
+ * 比较两个快照，按 key 排序返回变化的配置项
+ */
+std::vector<ConfigChange> diffConfig(const CfgEntries &before, const CfgEntries &after);
+
+/**
+ * 可热加载的配置
+ *
+ * - reload() 解析文件 -> 对每一项调用 PostProcess() -> 运行校验器 -> 通过后原子地发布新快照，
+ *   校验失败时保留旧快照（回滚），返回 Err::VALIDATION_ERR
+ * - 读路径：在 epoch::Guard 内调用 snapshot(guard)，一次 hazard 发布加一次 acquire 读，不加锁；
+ *   被替换的快照交给 epoch 回收，读者持有期间不会被释放
+ * - watch() 用 inotify 监听配置文件所在目录，文件被写入或替换（编辑器通常先写临时文件再 rename）时在事件循环线程上 reload
+ *
+ * 写操作（reload/rollback/watch）之间用互斥锁串行，可以在任意线程调用。监听器在锁外按发布顺序逐个调用，
+ * 因此可以在监听器里再次 reload/rollback；此时或者另一个线程正在调用监听器时，新的通知由正在通知的线程接着送达，
+ * reload/rollback 返回时监听器可能还没有被调用
+ */
+class ConfigManager {
+
+  public:
+    // 快照级校验器，抛出 std::invalid_argument 拒绝新配置
+    using Validator = std::function<void(const ConfigSnapshot &)>;
+    // 发布新快照之后在写锁外调用，同一时刻只有一个线程在调用监听器
+    using Listener = std::function<void(const ConfigSnapshot &, const std::vector<ConfigChange> &)>;
+    // 解析配置文件，默认为 loadTomlFile，测试时可以替换
+    using Loader = std::function<Ret<CfgEntries>(const std::string &)>;
+
+    explicit ConfigManager(std::string path, Loader loader = loadTomlFile);
+
+    ~ConfigManager();
+
+    ConfigManager(const ConfigManager &) = delete;
+    ConfigManager &operator=(const ConfigManager &) = delete;
+
+    void addValidator(Validator validator);
+
+    void addListener(Listener listener);
+
+    /**
+     * 重新加载配置文件，成功时返回与上一个快照的差异（首次加载时全部为新增）并输出差异日志
+     *
+     * @return 解析失败 Err::FORMAT_ERR，校验失败 Err::VALIDATION_ERR；失败时当前快照不变
+     */
+    Ret<std::vector<ConfigChange>> reload();
+
+    /**
+     * 回到上一次发布之前的快照
+     *
+     * @return 没有可回滚的快照时 Err::VALIDATION_ERR
+     */
+    Ret<void *> rollback();
+
+    /**
+     * 当前快照，在 guard 的生命周期内有效；尚未成功加载时返回 nullptr
+     *
+     * @param slot 使用的 hazard 槽，同一个 Guard 里还要保护其他指针时需要错开
+     */
+    const ConfigSnapshot *snapshot(epoch::Guard &guard, size_t slot = 0) const noexcept {
+        return guard.protect(current, slot);
+    }
+
+    uint64_t version() const noexcept { return publishedVersion.load(std::memory_order_acquire); }
+
+    const std::string &path() const noexcept { return file; }
+
+    /**
+     * 在 loop 上监听配置文件变化并自动 reload，需要在事件循环线程上（或 run() 之前）调用
+     *
+     * @return inotify 初始化失败时 Err::IO_ERR
+     */
+    Ret<void *> watch(EventLoop &loop);
+
+    /**
+     * 停止监听，需要在事件循环线程上调用
+     */
+    void unwatch();
+
+  private:
+    class Watcher;
+
+    const std::string file;
+    const Loader loader;
+    std::atomic<const ConfigSnapshot *> current{nullptr};
+    std::atomic<uint64_t> publishedVersion{0};
+
+    std::mutex writeMutex;
+    // 上一个快照，只在持有 writeMutex 时访问，rollback 时重新发布
+    const ConfigSnapshot *previous = nullptr;
+    uint64_t nextVersion = 1;
+    std::vector<Validator> validators;
+    std::vector<Listener> listeners;
+    std::unique_ptr<Watcher> watcher;
+
+    struct Notification {
+        const ConfigSnapshot *snapshot;
+        std::vector<ConfigChange> changes;
+        // 这次发布替换下来的快照：排在前面的通知可能还引用它，送达本通知之后才交给 epoch 回收
+        const ConfigSnapshot *retired;
+    };
+    // 等待送达监听器的通知，按发布顺序排列，只在持有 writeMutex 时访问
+    std::deque<Notification> notifications;
+    bool notifying = false;
+
+    // 发布 next，被替换的快照成为 previous，原来的 previous 在通知送达后回收
+    void publish(const ConfigSnapshot *next, std::vector<ConfigChange> changes);
+
+    // 在写锁外依次送达排队的通知；已有线程在送达时直接返回
+    void notifyListeners();
+};
+
+RHINO_INLINE_NAMESPACE_END
+} // namespace rhino
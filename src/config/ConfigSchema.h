@@ -0,0 +1,426 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#include <vector>
+#include <nlohmann/json.hpp>
+#include "common/Errs.h"
+#include "common/Ret.h"
+#include "common/Validation.h"
+#include "common/Version.h"
+#include "config/Config.h"
+#include "config/ConfigTemplate.h"
+#include "util/Epoch.hpp"
+
+/*
+编译期配置 schema：用 X-macro 声明一次，生成扁平结构体、类型化读写、toml/json 加载与导出和文档。
+
+每一项为 X(Cfg 类型, 成员名, toml key, 默认值, 说明, 校验...)，校验直接使用 common/Validation.h 中的宏
+（在 set_xxx 里对 value 执行，失败抛 std::invalid_argument）：
+
+#define DEMO_CONFIG(X)                                                                      \
+    X(Int32Cfg, threads, "executor.threads", 0, "工作线程数，0 表示 CPU 数",               \
+      GreaterOrEqualThan(0, "executor.threads must be >= 0"))                               \
+    X(StringCfg, name, "app.name", "rhino", "服务名", NotEmpty("app.name must not be empty"))
+
+RHINO_DEFINE_CONFIG(DemoConfig, DEMO_CONFIG)
+
+生成的 DemoConfig：
+- 成员 threads_（Int32Cfg，带说明和默认值），读 get_threads() 是一次成员读取，写 set_threads(v) 先校验
+- fromEntries/fromJson 加载（未声明的 key 被忽略，缺省的 key 使用默认值，默认值同样经过校验）
+- toEntries/toJson/toToml 导出，schemaDoc() 生成给运维看的 markdown 表格
+- key 重复在编译期报错（static_assert）
+*/
+
+namespace rhino {
+RHINO_INLINE_NAMESPACE_BEGIN
+
+namespace detail {
+
+template <typename Cfg> using CfgValueType = decltype(std::declval<Cfg>().val);
+
+template <typename Cfg, typename V> Cfg makeCfg(V &&value, const char *desc) {
+    Cfg cfg;
+    cfg.val = std::forward<V>(value);
+    cfg.desc = desc;
+    return cfg;
+}
+
+constexpr bool keyEquals(const char *a, const char *b) {
+    while (*a != '\0' && *a == *b) {
+        a++;
+        b++;
+    }
+    return *a == *b;
+}
+
+template <size_t N> constexpr bool uniqueKeys(const char *const (&keys)[N]) {
+    for (size_t i = 0; i < N; i++) {
+        for (size_t j = i + 1; j < N; j++) {
+            if (keyEquals(keys[i], keys[j])) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+/**
+ * 从扁平配置中取出 Cfg 类型的值，整数可以读进 DoubleCfg；类型不符时返回 false
+ */
+template <typename Cfg> bool extractCfg(const CfgValue &value, CfgValueType<Cfg> &out) {
+    if (const Cfg *c = std::get_if<Cfg>(&value)) {
+        out = c->val;
+        return true;
+    }
+    if constexpr (std::is_same_v<Cfg, DoubleCfg>) {
+        if (const Int32Cfg *i = std::get_if<Int32Cfg>(&value)) {
+            out = i->val;
+            return true;
+        }
+    }
+    return false;
+}
+
+template <typename T> Ret<T> configFailure(const Err &err, const std::string &msg) {
+    return Ret<T>::with(EGrp::INTERNAL, err, msg);
+}
+
+// "a.b[1].c" <-> "/a/b/1/c"
+inline std::string keyToPointer(const std::string &key) {
+    std::string out = "/";
+    for (char c : key) {
+        if (c == '.' || c == '[') {
+            out.push_back('/');
+        } else if (c != ']') {
+            out.push_back(c);
+        }
+    }
+    return out;
+}
+
+inline std::string pointerToKey(const std::string &pointer) {
+    std::string out;
+    std::stringstream ss(pointer);
+    std::string part;
+    while (std::getline(ss, part, '/')) {
+        if (part.empty()) {
+            continue;
+        }
+        if (std::all_of(part.begin(), part.end(), [](char c) { return c >= '0' && c <= '9'; }) && !out.empty()) {
+            out += "[" + part + "]";
+        } else {
+            out += out.empty() ? part : "." + part;
+        }
+    }
+    return out;
+}
+
+/**
+ * 把 json 文档扁平化为配置项，不支持的值（null）返回 false
+ */
+inline bool entriesFromJson(const nlohmann::json &json, CfgEntries &out, std::string &badKey) {
+    const nlohmann::json flat = json.flatten();
+    for (auto it = flat.begin(); it != flat.end(); ++it) {
+        const std::string key = pointerToKey(it.key());
+        const nlohmann::json &value = it.value();
+        if (value.is_string()) {
+            out.emplace(key, makeCfg<StringCfg>(value.get<std::string>(), ""));
+        } else if (value.is_boolean()) {
+            out.emplace(key, makeCfg<BoolCfg>(value.get<bool>(), ""));
+        } else if (value.is_number_integer() && value.get<int64_t>() >= INT32_MIN && value.get<int64_t>() <= INT32_MAX) {
+            out.emplace(key, makeCfg<Int32Cfg>(value.get<int32_t>(), ""));
+        } else if (value.is_number_float()) {
+            out.emplace(key, makeCfg<DoubleCfg>(value.get<double>(), ""));
+        } else {
+            badKey = key;
+            return false;
+        }
+    }
+    return true;
+}
+
+inline void jsonSet(nlohmann::json &json, const char *key, const CfgValue &value) {
+    auto &slot = json[nlohmann::json::json_pointer(keyToPointer(key))];
+    std::visit([&slot](const auto &cfg) { slot = cfg.val; }, value);
+}
+
+/**
+ * 按表分组输出 toml：没有点的 key 在最前面，其余按所在表输出 [table] 段；
+ * 最后一段带下标的 key（"pool.sizes[0]"）合并成数组，下标必须从 0 开始连续。
+ * 表名里带下标（"a[0].b"，即表数组）无法表示，抛 std::invalid_argument
+ */
+inline std::string renderToml(const std::vector<std::pair<std::string, CfgValue>> &items) {
+    // 表 -> 按首次出现顺序排列的 key，数组元素按下标排列
+    std::map<std::string, std::vector<std::pair<std::string, std::map<size_t, const CfgValue *>>>> tables;
+    for (const auto &[key, value] : items) {
+        const auto dot = key.find_last_of('.');
+        const std::string table = dot == std::string::npos ? "" : key.substr(0, dot);
+        std::string name = dot == std::string::npos ? key : key.substr(dot + 1);
+        if (table.find('[') != std::string::npos) {
+            throw std::invalid_argument(key + ": array of tables cannot be rendered as toml");
+        }
+        size_t index = 0;
+        bool indexed = false;
+        if (const auto bracket = name.find('['); bracket != std::string::npos) {
+            const std::string digits = name.substr(bracket + 1, name.size() - bracket - 2);
+            if (name.back() != ']' || digits.empty() || name.find('[', bracket + 1) != std::string::npos ||
+                !std::all_of(digits.begin(), digits.end(), [](char c) { return c >= '0' && c <= '9'; })) {
+                throw std::invalid_argument(key + ": only one-dimensional arrays can be rendered as toml");
+            }
+            index = std::stoul(digits);
+            indexed = true;
+            name.resize(bracket);
+        }
+        auto &keys = tables[table];
+        auto it = std::find_if(keys.begin(), keys.end(), [&name](const auto &k) { return k.first == name; });
+        if (it == keys.end()) {
+            keys.emplace_back(name, std::map<size_t, const CfgValue *>());
+            it = keys.end() - 1;
+        }
+        // 普通 key 记为下标 SIZE_MAX，与数组元素同名时视为冲突
+        const size_t slot = indexed ? index : SIZE_MAX;
+        if (!it->second.emplace(slot, &value).second || (it->second.count(SIZE_MAX) > 0 && it->second.size() > 1)) {
+            throw std::invalid_argument(key + ": conflicts with another key when rendered as toml");
+        }
+    }
+    auto comment = [](std::ostringstream &out, const CfgValue &value, const char *indent) {
+        std::visit([&out, indent](const auto &cfg) {
+            if (!cfg.desc.empty()) {
+                out << indent << "# " << cfg.desc << "\n";
+            }
+        }, value);
+    };
+    std::ostringstream out;
+    for (const auto &[table, keys] : tables) {
+        if (!table.empty()) {
+            out << (out.tellp() > 0 ? "\n[" : "[") << table << "]\n";
+        }
+        for (const auto &[name, values] : keys) {
+            if (values.count(SIZE_MAX) > 0) {
+                comment(out, *values.at(SIZE_MAX), "");
+                out << name << " = " << renderCfg(*values.at(SIZE_MAX)) << "\n";
+                continue;
+            }
+            if (values.rbegin()->first != values.size() - 1) {
+                throw std::invalid_argument((table.empty() ? name : table + "." + name) +
+                                            ": array indexes must be contiguous from 0");
+            }
+            // 多行数组，每个元素前面写它的说明
+            out << name << " = [\n";
+            for (const auto &[index, value] : values) {
+                comment(out, *value, "    ");
+                out << "    " << renderCfg(*value) << ",\n";
+            }
+            out << "]\n";
+        }
+    }
+    return out.str();
+}
+
+} // namespace detail
+
+/**
+ * 在 ConfigManager 之上发布类型化的配置结构体
+ *
+ * 新快照先经过 Schema::fromEntries 校验（失败时 ConfigManager 保留旧配置），校验时构造的 Schema 在发布时原子替换，
+ * 不再重复解析；rollback 时重新发布上一个 Schema。读取为 Guard 内一次 protect，之后的字段访问都是直接的成员读取
+ */
+template <typename Schema> class TypedConfig {
+
+  public:
+    explicit TypedConfig(std::string path, ConfigManager::Loader loader = loadTomlFile)
+        : config(std::move(path), std::move(loader)) {
+        config.addValidator([this](const ConfigSnapshot &snapshot) {
+            auto parsed = Schema::fromEntries(snapshot.entries());
+            if (parsed.failed()) {
+                throw std::invalid_argument(parsed.getErr().msg);
+            }
+            state.stage(snapshot.version(), std::make_unique<Schema>(std::move(parsed.value())));
+        });
+        config.addListener([this](const ConfigSnapshot &snapshot, const std::vector<ConfigChange> &) {
+            state.publish(snapshot.version());
+        });
+    }
+
+    TypedConfig(const TypedConfig &) = delete;
+    TypedConfig &operator=(const TypedConfig &) = delete;
+
+    /**
+     * 当前配置，在 guard 的生命周期内有效；尚未成功加载时返回 nullptr
+     */
+    const Schema *get(epoch::Guard &guard, size_t slot = 0) const noexcept {
+        return guard.protect(state.typed, slot);
+    }
+
+    ConfigManager &manager() noexcept { return config; }
+
+  private:
+    struct State {
+        std::atomic<const Schema *> typed{nullptr};
+        // 已通过校验、等待发布的 Schema，按快照版本索引。校验器在写锁内、监听器在写锁外调用，两者可能同时运行
+        std::mutex pendingMutex;
+        std::map<uint64_t, std::unique_ptr<Schema>> pending;
+        // 以下只由监听器访问，ConfigManager 保证监听器按发布顺序串行调用
+        // 被替换的 Schema，与 ConfigManager 的上一个快照对应
+        const Schema *previous = nullptr;
+        uint64_t previousVersion = 0;
+        uint64_t currentVersion = 0;
+
+        State() = default;
+        State(const State &) = delete;
+        State &operator=(const State &) = delete;
+
+        ~State() {
+            delete typed.load(std::memory_order_acquire);
+            delete previous;
+        }
+
+        void stage(uint64_t version, std::unique_ptr<Schema> schema) {
+            std::lock_guard<std::mutex> lock(pendingMutex);
+            // 被后面的校验器拒绝时版本号不变，下次 reload 直接覆盖
+            pending[version] = std::move(schema);
+        }
+
+        void publish(uint64_t version) {
+            std::unique_ptr<Schema> next;
+            {
+                std::lock_guard<std::mutex> lock(pendingMutex);
+                auto it = pending.find(version);
+                if (it != pending.end()) {
+                    next = std::move(it->second);
+                    pending.erase(pending.begin(), ++it);
+                }
+            }
+            const Schema *old = typed.load(std::memory_order_relaxed);
+            if (next != nullptr) {
+                typed.store(next.release(), std::memory_order_release);
+                if (previous != nullptr) {
+                    epoch::Domain::global().retire(const_cast<Schema *>(previous));
+                }
+                previous = old;
+                previousVersion = currentVersion;
+            } else if (previous != nullptr && previousVersion == version) {
+                // rollback：ConfigManager 重新发布上一个快照
+                typed.store(previous, std::memory_order_release);
+                previous = nullptr;
+                epoch::Domain::global().retire(const_cast<Schema *>(old));
+            }
+            currentVersion = version;
+        }
+    };
+
+    // 成员按声明的逆序析构：config 先析构（停止 watch，不会再调用监听器），之后 state 才释放 Schema
+    State state;
+    ConfigManager config;
+};
+
+RHINO_INLINE_NAMESPACE_END
+} // namespace rhino
+
+#define RHINO_CONFIG_FIELD(Cfg, name, key, def, desc, ...)                                                  \
+    Cfg name##_ = ::rhino::detail::makeCfg<Cfg>(def, desc);
+
+#define RHINO_CONFIG_KEY(Cfg, name, key, def, desc, ...) key,
+
+#define RHINO_CONFIG_ACCESSOR(Cfg, name, key, def, desc, ...)                                               \
+    const ::rhino::detail::CfgValueType<Cfg> &get_##name() const noexcept { return name##_.val; }             \
+    void set_##name(const ::rhino::detail::CfgValueType<Cfg> &value) {                                       \
+        __VA_ARGS__;                                                                                           \
+        name##_.val = value;                                                                                   \
+    }
+
+// 缺省的 key 也要 set 一次，保证默认值经过校验
+#define RHINO_CONFIG_LOAD(Cfg, name, key, def, desc, ...)                                                    \
+    {                                                                                                          \
+        ::rhino::detail::CfgValueType<Cfg> value = out.name##_.val;                                           \
+        auto it = entries.find(key);                                                                           \
+        if (it != entries.end() && !::rhino::detail::extractCfg<Cfg>(it->second, value)) {                    \
+            return ::rhino::detail::configFailure<Self>(::rhino::Err::FORMAT_ERR,                             \
+                                                        std::string(key) + " must be " + out.name##_.type);    \
+        }                                                                                                      \
+        try {                                                                                                  \
+            out.set_##name(value);                                                                             \
+        } catch (const std::invalid_argument &e) {                                                             \
+            return ::rhino::detail::configFailure<Self>(::rhino::Err::VALIDATION_ERR, e.what());               \
+        }                                                                                                      \
+    }
+
+#define RHINO_CONFIG_ITEM(Cfg, name, key, def, desc, ...) items.emplace_back(key, name##_);
+
+#define RHINO_CONFIG_DOC(Cfg, name, key, def, desc, ...)                                                     \
+    {                                                                                                          \
+        const Cfg defaults = ::rhino::detail::makeCfg<Cfg>(def, desc);                                       \
+        doc << "| `" << key << "` | " << defaults.type << " | `" << ::rhino::renderCfg(defaults) << "` | "     \
+            << desc << " |\n";                                                                                 \
+    }
+
+/**
+ * 由 SCHEMA(X) 生成名为 Name 的配置结构体，见文件开头的说明
+ */
+#define RHINO_DEFINE_CONFIG(Name, SCHEMA)                                                                     \
+    struct Name {                                                                                              \
+        using Self = Name;                                                                                     \
+        static constexpr const char *KEYS[] = {SCHEMA(RHINO_CONFIG_KEY)};                                      \
+        static constexpr size_t FIELD_COUNT = sizeof(KEYS) / sizeof(KEYS[0]);                                  \
+        static_assert(::rhino::detail::uniqueKeys(KEYS), "duplicate config key in " #Name);                    \
+                                                                                                               \
+        SCHEMA(RHINO_CONFIG_FIELD)                                                                             \
+        SCHEMA(RHINO_CONFIG_ACCESSOR)                                                                          \
+                                                                                                               \
+        static ::rhino::Ret<Name> fromEntries(const ::rhino::CfgEntries &entries) {                           \
+            Name out;                                                                                          \
+            SCHEMA(RHINO_CONFIG_LOAD)                                                                          \
+            return ::rhino::Ret<Name>::with(out);                                                              \
+        }                                                                                                      \
+                                                                                                               \
+        static ::rhino::Ret<Name> fromJson(const nlohmann::json &json) {                                      \
+            ::rhino::CfgEntries entries;                                                                       \
+            std::string badKey;                                                                                \
+            if (!::rhino::detail::entriesFromJson(json, entries, badKey)) {                                    \
+                return ::rhino::detail::configFailure<Name>(::rhino::Err::FORMAT_ERR,                         \
+                                                            badKey + " has unsupported json value");           \
+            }                                                                                                  \
+            return fromEntries(entries);                                                                       \
+        }                                                                                                      \
+                                                                                                               \
+        std::vector<std::pair<std::string, ::rhino::CfgValue>> items() const {                                \
+            std::vector<std::pair<std::string, ::rhino::CfgValue>> items;                                      \
+            items.reserve(FIELD_COUNT);                                                                        \
+            SCHEMA(RHINO_CONFIG_ITEM)                                                                          \
+            return items;                                                                                      \
+        }                                                                                                      \
+                                                                                                               \
+        ::rhino::CfgEntries toEntries() const {                                                                \
+            auto list = items();                                                                               \
+            return ::rhino::CfgEntries(list.begin(), list.end());                                              \
+        }                                                                                                      \
+                                                                                                               \
+        nlohmann::json toJson() const {                                                                        \
+            nlohmann::json json = nlohmann::json::object();                                                    \
+            for (const auto &[key, value] : items()) {                                                         \
+                ::rhino::detail::jsonSet(json, key.c_str(), value);                                            \
+            }                                                                                                  \
+            return json;                                                                                       \
+        }                                                                                                      \
+                                                                                                               \
+        std::string toToml() const { return ::rhino::detail::renderToml(items()); }                           \
+                                                                                                               \
+        static std::string schemaDoc() {                                                                       \
+            std::ostringstream doc;                                                                            \
+            doc << "| key | type | default | description |\n|---|---|---|---|\n";                             \
+            SCHEMA(RHINO_CONFIG_DOC)                                                                           \
+            return doc.str();                                                                                  \
+        }                                                                                                      \
+    };
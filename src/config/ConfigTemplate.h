@@ -22,15 +22,21 @@ struct  StringCfg final : PostProcessor {
 
 struct Int32Cfg final : PostProcessor {
     std::string desc;
-    int32_t val;
+    int32_t val{};
     std::string type = "int32";
 };
 
 struct BoolCfg final : PostProcessor {
     std::string desc;
-    bool val;
+    bool val{};
     std::string type = "bool";
 };
 
+struct DoubleCfg final : PostProcessor {
+    std::string desc;
+    double val{};
+    std::string type = "double";
+};
+
 RHINO_INLINE_NAMESPACE_END
 } // namespace rhino
\ No newline at end of file
@@ -0,0 +1,86 @@
+#include "config/PlacementConfig.h"
+
+#include <cstdint>
+#include <optional>
+#include "toml++/toml.hpp"
+
+namespace rhino {
+RHINO_INLINE_NAMESPACE_BEGIN
+
+namespace {
+
+Ret<topology::ThreadPlacement> formatFailure(const std::string &msg) {
+    return Ret<topology::ThreadPlacement>::with(EGrp::INTERNAL, Err::FORMAT_ERR, msg);
+}
+
+} // namespace
+
+Ret<topology::ThreadPlacement> loadPlacement(const std::string &path, const std::string &name) {
+    topology::ThreadPlacement placement;
+    placement.name = name;
+
+    toml::table root;
+    try {
+        root = toml::parse_file(path);
+    } catch (const toml::parse_error &e) {
+        return formatFailure(path + ": " + std::string(e.description()));
+    }
+    const toml::table *table = root["placement"][name].as_table();
+    if (table == nullptr) {
+        return Ret<topology::ThreadPlacement>::with(placement);
+    }
+    const std::string prefix = "placement." + name + ".";
+
+    if (auto node = (*table)["cpus"]) {
+        std::optional<std::string> cpus = node.value<std::string>();
+        if (!cpus) {
+            return formatFailure(prefix + "cpus must be a cpulist string like \"0-3,8\"");
+        }
+        placement.cpus = topology::parseCpuList(*cpus);
+        if (placement.cpus.empty() && !cpus->empty()) {
+            return formatFailure(prefix + "cpus is not a valid cpulist: " + *cpus);
+        }
+    }
+
+    if (auto node = (*table)["policy"]) {
+        std::optional<std::string> policy = node.value<std::string>();
+        if (!policy || !topology::parseSchedPolicy(*policy, placement.policy)) {
+            return formatFailure(prefix + "policy must be one of other/batch/idle/fifo/rr");
+        }
+    }
+
+    if (auto node = (*table)["priority"]) {
+        std::optional<int64_t> priority = node.value<int64_t>();
+        if (!priority || *priority < 0 || *priority > 99) {
+            return formatFailure(prefix + "priority must be an integer in [0, 99]");
+        }
+        placement.priority = static_cast<int32_t>(*priority);
+    }
+
+    if (auto node = (*table)["mem_node"]) {
+        if (node.is_string()) {
+            if (node.value<std::string>() != std::optional<std::string>("local")) {
+                return formatFailure(prefix + "mem_node must be a node id, -1 or \"local\"");
+            }
+            placement.memNode = topology::MEM_NODE_LOCAL;
+        } else {
+            std::optional<int64_t> memNode = node.value<int64_t>();
+            if (!memNode || *memNode < topology::MEM_NODE_NONE) {
+                return formatFailure(prefix + "mem_node must be a node id, -1 or \"local\"");
+            }
+            placement.memNode = static_cast<int32_t>(*memNode);
+        }
+    }
+
+    if (auto node = (*table)["strict_memory"]) {
+        std::optional<bool> strict = node.value<bool>();
+        if (!strict) {
+            return formatFailure(prefix + "strict_memory must be a boolean");
+        }
+        placement.strictMemory = *strict;
+    }
+    return Ret<topology::ThreadPlacement>::with(placement);
+}
+
+RHINO_INLINE_NAMESPACE_END
+} // namespace rhino
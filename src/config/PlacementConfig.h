@@ -0,0 +1,29 @@
+#pragma once
+
+#include <string>
+#include "common/Errs.h"
+#include "common/Ret.h"
+#include "common/Version.h"
+#include "runtime/Topology.h"
+
+namespace rhino {
+RHINO_INLINE_NAMESPACE_BEGIN
+
+/**
+ * 从 toml 配置文件读取名为 name 的线程放置方式，对应 [placement.<name>] 表：
+ *
+ *   [placement.loop]
+ *   cpus = "0-3"          # cpulist 格式，空或缺省表示不绑核
+ *   policy = "other"      # other/batch/idle/fifo/rr
+ *   priority = 0          # 只对 fifo/rr 有效
+ *   mem_node = "local"    # NUMA 节点编号；-1 不改变；"local" 为 cpus 中第一个 CPU 所在节点
+ *   strict_memory = false # true 时只能从 mem_node 分配
+ *
+ * 表不存在时返回只带线程名的默认放置方式（不改变任何设置）。
+ *
+ * @return 文件无法解析、字段类型或取值错误时返回 Err::FORMAT_ERR，msg 指出出错的字段
+ */
+Ret<topology::ThreadPlacement> loadPlacement(const std::string &path, const std::string &name);
+
+RHINO_INLINE_NAMESPACE_END
+} // namespace rhino
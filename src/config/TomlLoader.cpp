@@ -0,0 +1,86 @@
+#include "config/Config.h"
+
+#include <cstdint>
+#include <limits>
+#include <sstream>
+#include <string>
+#include "toml++/toml.hpp"
+
+namespace rhino {
+RHINO_INLINE_NAMESPACE_BEGIN
+
+namespace {
+
+// 递归展开表和数组，遇到不支持的值返回出错的 key
+bool flatten(const toml::node &node, const std::string &key, CfgEntries &out, std::string &badKey) {
+    if (const toml::table *table = node.as_table()) {
+        for (auto &&[k, child] : *table) {
+            const std::string childKey = key.empty() ? std::string(k.str()) : key + "." + std::string(k.str());
+            if (!flatten(child, childKey, out, badKey)) {
+                return false;
+            }
+        }
+        return true;
+    }
+    if (const toml::array *array = node.as_array()) {
+        for (size_t i = 0; i < array->size(); i++) {
+            if (!flatten((*array)[i], key + "[" + std::to_string(i) + "]", out, badKey)) {
+                return false;
+            }
+        }
+        return true;
+    }
+    if (const auto *s = node.as_string()) {
+        StringCfg cfg;
+        cfg.val = s->get();
+        out.emplace(key, std::move(cfg));
+        return true;
+    }
+    if (const auto *i = node.as_integer()) {
+        const int64_t v = i->get();
+        if (v < std::numeric_limits<int32_t>::min() || v > std::numeric_limits<int32_t>::max()) {
+            badKey = key + " (integer out of int32 range)";
+            return false;
+        }
+        Int32Cfg cfg;
+        cfg.val = static_cast<int32_t>(v);
+        out.emplace(key, std::move(cfg));
+        return true;
+    }
+    if (const auto *b = node.as_boolean()) {
+        BoolCfg cfg;
+        cfg.val = b->get();
+        out.emplace(key, std::move(cfg));
+        return true;
+    }
+    if (const auto *f = node.as_floating_point()) {
+        DoubleCfg cfg;
+        cfg.val = f->get();
+        out.emplace(key, std::move(cfg));
+        return true;
+    }
+    badKey = key + " (unsupported value type)";
+    return false;
+}
+
+} // namespace
+
+Ret<CfgEntries> loadTomlFile(const std::string &path) {
+    toml::table root;
+    try {
+        root = toml::parse_file(path);
+    } catch (const toml::parse_error &e) {
+        std::ostringstream msg;
+        msg << path << ":" << e.source().begin.line << ":" << e.source().begin.column << ": " << e.description();
+        return Ret<CfgEntries>::with(EGrp::INTERNAL, Err::FORMAT_ERR, msg.str());
+    }
+    CfgEntries entries;
+    std::string badKey;
+    if (!flatten(root, "", entries, badKey)) {
+        return Ret<CfgEntries>::with(EGrp::INTERNAL, Err::FORMAT_ERR, path + ": " + badKey);
+    }
+    return Ret<CfgEntries>::with(entries);
+}
+
+RHINO_INLINE_NAMESPACE_END
+} // namespace rhino
@@ -2,12 +2,108 @@
 #include <string>
 
 #ifndef COMPILE_WHEN_TEST
+#include <csignal>
+#include <sys/epoll.h>
+#include <sys/signalfd.h>
+#include <unistd.h>
 #include <boost/program_options.hpp>
+#include "config/AppConfig.h"
+#include "config/PlacementConfig.h"
+#include "runtime/EventLoop.h"
+#include "util/Metrics.hpp"
+
+// 收到 SIGINT/SIGTERM 时停止事件循环
+class SignalHandler : public rhino::IoHandler {
+    rhino::EventLoop &loop;
+    int fd;
+
+  public:
+    SignalHandler(rhino::EventLoop &loop, int fd) : loop(loop), fd(fd) {}
+
+    void onEvents(uint32_t) noexcept override {
+        signalfd_siginfo info{};
+        while (read(fd, &info, sizeof(info)) == sizeof(info)) {
+            std::cout << "received signal " << info.ssi_signo << ", stopping" << std::endl;
+            loop.stop();
+        }
+    }
+};
+
+static int runLoop() {
+    // 信号必须在创建任何线程之前屏蔽，之后统一从 signalfd 读取
+    sigset_t mask;
+    sigemptyset(&mask);
+    sigaddset(&mask, SIGINT);
+    sigaddset(&mask, SIGTERM);
+    sigprocmask(SIG_BLOCK, &mask, nullptr);
+    int sfd = signalfd(-1, &mask, SFD_NONBLOCK | SFD_CLOEXEC);
+    if (sfd < 0) {
+        std::cout << "signalfd failed" << std::endl;
+        return -1;
+    }
+
+    // 事件循环跑在主线程上，按配置绑核、设置调度策略和内存策略；配置有误时拒绝启动
+    auto placement = rhino::loadPlacement("config/app.toml", "loop");
+    if (placement.failed()) {
+        std::cout << placement.getErr().msg << std::endl;
+        return -1;
+    }
+    auto applied = rhino::topology::applyPlacement(placement.value());
+    if (applied.failed()) {
+        std::cout << "thread placement partially applied: " << applied.getErr().msg << std::endl;
+    }
+
+    rhino::EventLoop loop;
+    SignalHandler handler(loop, sfd);
+    auto ret = loop.watch(sfd, EPOLLIN, handler);
+    if (ret.failed()) {
+        std::cout << ret.getErr().msg << std::endl;
+        return -1;
+    }
+    // 配置文件修改后自动热加载，校验失败时保留旧配置
+    rhino::TypedConfig<rhino::AppConfig> config("config/app.toml");
+    auto loaded = config.manager().reload();
+    if (loaded.failed()) {
+        return -1;
+    }
+    auto watched = config.manager().watch(loop);
+    if (watched.failed()) {
+        std::cout << watched.getErr().msg << std::endl;
+    }
+    // 按配置的间隔输出指标，间隔和开关在热加载后的下一次触发时生效
+    auto interval = [&config] {
+        rhino::epoch::Guard guard;
+        return std::chrono::seconds(config.get(guard)->get_metricsIntervalSeconds());
+    };
+    rhino::FunctionTimer report([&loop, &config, &interval](rhino::TimerNode &self) {
+        bool enabled = false;
+        {
+            rhino::epoch::Guard guard;
+            enabled = config.get(guard)->get_metricsEnabled();
+        }
+        if (enabled) {
+            std::cout << rhino::MetricsRegistry::global().dump();
+        }
+        loop.scheduleAfter(self, interval());
+    });
+    loop.scheduleAfter(report, interval());
+
+    loop.run();
+    config.manager().unwatch();
+    loop.cancel(report);
+    (void)loop.unwatch(sfd, handler);
+    close(sfd);
+    std::cout << rhino::MetricsRegistry::global().dump();
+    return 0;
+}
+
 int main(int argc, char* argv[]) {
     boost::program_options::options_description opts("demo options");
     opts.add_options()
         ("about,a", "this is a about.")
-        ("version,v", "program version");//两个程序选项
+        ("version,v", "program version")
+        ("run,r", "run the event loop until SIGINT/SIGTERM")
+        ("schema,s", "print the config schema and defaults");
     boost::program_options::variables_map vm;//选项存储map容器
     boost::program_options::store(boost::program_options::parse_command_line(argc, argv, opts), vm);//解析存储
     if (vm.empty())
@@ -23,6 +119,14 @@ int main(int argc, char* argv[]) {
     {
         std::cout <<"version is V3.3.0" << std::endl;
     }
+    if (vm.count("schema"))
+    {
+        std::cout << rhino::AppConfig::schemaDoc() << std::endl << rhino::AppConfig().toToml();
+    }
+    if (vm.count("run"))
+    {
+        return runLoop();
+    }
     return 0;
 }
-#endif
\ No newline at end of file
+#endif
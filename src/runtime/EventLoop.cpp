@@ -0,0 +1,252 @@
+#include "runtime/EventLoop.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+#include "runtime/Topology.h"
+#include "util/Metrics.hpp"
+
+namespace rhino {
+RHINO_INLINE_NAMESPACE_BEGIN
+
+namespace {
+
+// 每次从延迟任务队列批量取出的任务数
+constexpr size_t DRAIN_BATCH = 256;
+
+thread_local EventLoop *currentLoop = nullptr;
+
+Ret<void *> ioFailure(const char *call) {
+    return Ret<void *>::with(EGrp::INTERNAL, Err::IO_ERR, std::string(call) + ": " + std::strerror(errno));
+}
+
+EventLoopOptions named(EventLoopOptions opts) {
+    if (opts.name.empty()) {
+        static std::atomic<uint32_t> sequence{0};
+        opts.name = "rhino-loop-" + std::to_string(sequence.fetch_add(1, std::memory_order_relaxed));
+    }
+    return opts;
+}
+
+} // namespace
+
+EventLoop::EventLoop(EventLoopOptions opts)
+    : options(named(std::move(opts))), tickSource(options.tickNs), timers(tickSource.now()),
+      deferred(options.deferredCapacity),
+      readyEvents(new epoll_event[static_cast<size_t>(options.maxEvents > 0 ? options.maxEvents : 1)]) {
+    if (options.maxEvents <= 0) {
+        options.maxEvents = 1;
+    }
+    drainBuffer.resize(DRAIN_BATCH);
+    // 构造函数抛异常时析构函数不会执行，已经打开的 fd 要在这里关掉
+    auto fail = [this]() {
+        std::string msg = std::string("event loop init failed: ") + std::strerror(errno);
+        if (wakeFd >= 0) {
+            close(wakeFd);
+        }
+        if (epollFd >= 0) {
+            close(epollFd);
+        }
+        throw std::runtime_error(msg);
+    };
+    epollFd = epoll_create1(EPOLL_CLOEXEC);
+    if (epollFd < 0) {
+        fail();
+    }
+    wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (wakeFd < 0) {
+        fail();
+    }
+    // eventfd 的 data.ptr 用 this 标记，与 IoHandler 区分
+    epoll_event ev{};
+    ev.events = EPOLLIN | EPOLLET;
+    ev.data.ptr = this;
+    if (epoll_ctl(epollFd, EPOLL_CTL_ADD, wakeFd, &ev) != 0) {
+        fail();
+    }
+
+    auto &registry = MetricsRegistry::global();
+    registry.add(options.name + ".iteration_ns", &iterationNs);
+    registry.add(options.name + ".iteration_work", &iterationItems);
+    registry.add(options.name + ".idle_iterations", &idleIterations);
+}
+
+EventLoop::~EventLoop() {
+    auto &registry = MetricsRegistry::global();
+    registry.remove(&iterationNs);
+    registry.remove(&iterationItems);
+    registry.remove(&idleIterations);
+
+    // 已经投递成功的任务保证会执行
+    stopping.store(true, std::memory_order_release);
+    Task *task = nullptr;
+    while (deferred.tryPop(task)) {
+        task->run();
+    }
+    close(wakeFd);
+    close(epollFd);
+}
+
+EventLoop *EventLoop::current() noexcept { return currentLoop; }
+
+Ret<void *> EventLoop::control(int32_t op, int32_t fd, uint32_t events, IoHandler *handler) {
+    epoll_event ev{};
+    ev.events = events | EPOLLET;
+    ev.data.ptr = handler;
+    if (epoll_ctl(epollFd, op, fd, &ev) != 0) {
+        return ioFailure("epoll_ctl");
+    }
+    return Ret<void *>::with(nullptr);
+}
+
+Ret<void *> EventLoop::watch(int32_t fd, uint32_t events, IoHandler &handler) {
+    return control(EPOLL_CTL_ADD, fd, events, &handler);
+}
+
+Ret<void *> EventLoop::modify(int32_t fd, uint32_t events, IoHandler &handler) {
+    return control(EPOLL_CTL_MOD, fd, events, &handler);
+}
+
+void EventLoop::removeSource(PollSource &source) {
+    sources.erase(std::remove(sources.begin(), sources.end(), &source), sources.end());
+}
+
+Ret<void *> EventLoop::unwatch(int32_t fd, IoHandler &handler) {
+    // 同一轮里排在后面的事件可能还指向这个 handler，清空后分发时跳过
+    for (size_t i = readyIndex; i < readyCount; i++) {
+        if (readyEvents[i].data.ptr == &handler) {
+            readyEvents[i].data.ptr = nullptr;
+        }
+    }
+    return control(EPOLL_CTL_DEL, fd, 0, nullptr);
+}
+
+void EventLoop::run() {
+    loopThread.store(std::this_thread::get_id(), std::memory_order_relaxed);
+    EventLoop *previous = currentLoop;
+    currentLoop = this;
+    // 线程名只用于排查问题，设置失败不影响运行
+    (void)topology::nameCurrentThread(options.name);
+
+    const bool busyPoll = options.mode == LoopMode::BUSY_POLL;
+    while (!stopping.load(std::memory_order_acquire)) {
+        iterate(busyPoll ? 0 : waitTimeoutMs());
+    }
+
+    currentLoop = previous;
+    loopThread.store(std::thread::id(), std::memory_order_relaxed);
+}
+
+void EventLoop::stop() noexcept {
+    stopping.store(true, std::memory_order_release);
+    wakeup();
+}
+
+void EventLoop::wakeup() noexcept {
+    const uint64_t one = 1;
+    // eventfd 计数器不会满（需要 2^64 次写），写失败只可能是 fd 已关闭，忽略
+    ssize_t ignored = write(wakeFd, &one, sizeof(one));
+    (void)ignored;
+}
+
+int32_t EventLoop::waitTimeoutMs() const noexcept {
+    const uint64_t maxTicks = static_cast<uint64_t>(options.maxWaitMs) * 1000000 / tickSource.tickNs();
+    const uint64_t elapsedTicks = tickSource.now() - timers.now();
+    const uint64_t untilNext = timers.ticksUntilNext(maxTicks + 1);
+    if (untilNext <= elapsedTicks) {
+        return 0;
+    }
+    // 向上取整到毫秒，宁可晚醒一点也不要提前醒来空转
+    const uint64_t ns = (untilNext - elapsedTicks) * tickSource.tickNs();
+    const uint64_t ms = (ns + 999999) / 1000000;
+    return static_cast<int32_t>(ms < static_cast<uint64_t>(options.maxWaitMs) ? ms : options.maxWaitMs);
+}
+
+size_t EventLoop::iterate(int32_t timeoutMs) {
+    if (timeoutMs != 0) {
+        // 先声明要挂起，再检查一次队列：defer 在入队之后检查 sleeping，两边至少有一边能看到对方
+        sleeping.store(true, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (hasPendingWork()) {
+            timeoutMs = 0;
+        }
+    }
+    const int32_t n = epoll_wait(epollFd, readyEvents.get(), options.maxEvents, timeoutMs);
+    sleeping.store(false, std::memory_order_relaxed);
+
+    const uint64_t begin = rdtsc();
+    size_t work = 0;
+    if (n > 0) {
+        work += dispatchEvents(static_cast<size_t>(n));
+    }
+    work += timers.advance(tickSource.now());
+    for (PollSource *source : sources) {
+        work += source->poll();
+    }
+    work += drainDeferred();
+
+    if (work == 0) {
+        idleIterations.store(idleIterations.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    } else {
+        iterationNs.record(calc_time_nano(begin, rdtsc()));
+        iterationItems.record(work);
+    }
+    return work;
+}
+
+bool EventLoop::hasPendingWork() const noexcept {
+    if (deferred.sizeApprox() > 0 || stopping.load(std::memory_order_acquire)) {
+        return true;
+    }
+    for (const PollSource *source : sources) {
+        if (source->pending()) {
+            return true;
+        }
+    }
+    return false;
+}
+
+size_t EventLoop::dispatchEvents(size_t count) {
+    size_t work = 0;
+    readyCount = count;
+    for (readyIndex = 0; readyIndex < readyCount; readyIndex++) {
+        epoll_event &ev = readyEvents[readyIndex];
+        if (ev.data.ptr == this) {
+            uint64_t value = 0;
+            ssize_t ignored = read(wakeFd, &value, sizeof(value));
+            (void)ignored;
+            continue;
+        }
+        if (ev.data.ptr == nullptr) {
+            continue;
+        }
+        static_cast<IoHandler *>(ev.data.ptr)->onEvents(ev.events);
+        work++;
+    }
+    readyCount = readyIndex = 0;
+    return work;
+}
+
+size_t EventLoop::drainDeferred() {
+    // 只执行本轮开始时已经在队列里的任务，任务里再投递的留到下一轮，避免饿死 fd 事件
+    size_t budget = deferred.sizeApprox();
+    size_t done = 0;
+    while (budget > 0) {
+        const size_t n = deferred.popN(drainBuffer.data(), budget < DRAIN_BATCH ? budget : DRAIN_BATCH);
+        if (n == 0) {
+            break;
+        }
+        for (size_t i = 0; i < n; i++) {
+            drainBuffer[i]->run();
+        }
+        done += n;
+        budget -= n;
+    }
+    return done;
+}
+
+RHINO_INLINE_NAMESPACE_END
+} // namespace rhino
@@ -0,0 +1,259 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+#include "common/Errs.h"
+#include "common/Ret.h"
+#include "common/Version.h"
+#include "runtime/Future.h"
+#include "runtime/TimerWheel.h"
+#include "util/Histogram.hpp"
+#include "util/MpmcQueue.hpp"
+
+struct epoll_event;
+
+namespace rhino {
+RHINO_INLINE_NAMESPACE_BEGIN
+
+/**
+ * 文件描述符事件回调，events 为 epoll 事件位（EPOLLIN、EPOLLOUT、EPOLLERR 等）
+ *
+ * 事件循环使用边缘触发，回调需要一直读/写到 EAGAIN
+ */
+class IoHandler {
+  public:
+    virtual ~IoHandler() = default;
+    virtual void onEvents(uint32_t events) noexcept = 0;
+};
+
+/**
+ * 每轮迭代轮询一次的工作来源（例如核间 SPSC 信箱），只在事件循环线程上被调用
+ *
+ * 向来源投递工作的一方投递后需要调用 EventLoop::notify()，pending() 用于挂起前的检查
+ */
+class PollSource {
+  public:
+    virtual ~PollSource() = default;
+
+    /**
+     * 处理已有的工作，返回处理的数量
+     */
+    virtual size_t poll() noexcept = 0;
+
+    /**
+     * 是否还有未处理的工作，事件循环挂起之前调用
+     */
+    virtual bool pending() const noexcept = 0;
+};
+
+enum class LoopMode {
+    // 没有事件时在 epoll_wait 上挂起，等待时间由最近的定时器决定
+    RUN_TO_COMPLETION,
+    // 从不挂起，epoll_wait 超时为 0，适合绑核的低延迟线程
+    BUSY_POLL,
+};
+
+struct EventLoopOptions {
+    // 线程名，同时作为指标名前缀；为空时使用 rhino-loop-<序号>，避免多个未命名的事件循环登记同名指标
+    std::string name;
+    LoopMode mode = LoopMode::RUN_TO_COMPLETION;
+    // 定时器 tick 的纳秒数，epoll_wait 的超时精度是毫秒，挂起模式下小于 1ms 没有意义
+    uint64_t tickNs = 1000000;
+    // 单次 epoll_wait 返回的最大事件数
+    int32_t maxEvents = 256;
+    // 跨线程投递任务的队列容量，满时 defer 返回 Err::QUEUE_FULL
+    size_t deferredCapacity = 65536;
+    // 没有定时器时单次挂起的最长时间
+    int32_t maxWaitMs = 1000;
+};
+
+/**
+ * 单线程 reactor：epoll 边缘触发 + eventfd 跨线程唤醒 + 时间轮定时器 + 延迟任务队列
+ *
+ * 每轮迭代依次：处理就绪的 fd 事件 -> 推进时间轮触发到期定时器 -> 轮询 PollSource -> 执行本轮开始前已投递的延迟任务，
+ * 全部执行完（run-to-completion）才进入下一轮的等待。
+ *
+ * 线程安全：defer()、notify()、stop()、wakeup() 可以在任意线程调用；其他方法只能在事件循环线程上调用
+ * （run() 之前可以在创建线程上调用）。
+ *
+ * 指标（登记在 MetricsRegistry 中，前缀为 options.name）：
+ * - <name>.iteration_ns：每轮有工作的迭代从醒来到处理完的耗时
+ * - <name>.iteration_work：每轮处理的事件 + 定时器 + 任务数
+ * - <name>.idle_iterations：没有任何工作的迭代次数（忙轮询模式下主要是空转）
+ */
+class EventLoop {
+
+  public:
+    explicit EventLoop(EventLoopOptions options = EventLoopOptions());
+
+    ~EventLoop();
+
+    EventLoop(const EventLoop &) = delete;
+    EventLoop &operator=(const EventLoop &) = delete;
+
+    /**
+     * 当前线程上正在运行的事件循环，不在事件循环线程上返回 nullptr
+     */
+    static EventLoop *current() noexcept;
+
+    /**
+     * 监听 fd，自动加上 EPOLLET；handler 的生命周期需要覆盖到 unwatch 之后
+     *
+     * @return epoll_ctl 失败时返回 Err::IO_ERR，err.msg 中是 errno 描述
+     */
+    Ret<void *> watch(int32_t fd, uint32_t events, IoHandler &handler);
+
+    Ret<void *> modify(int32_t fd, uint32_t events, IoHandler &handler);
+
+    /**
+     * 取消监听，本轮尚未分发的该 handler 的事件也会被丢弃，之后可以安全销毁 handler
+     */
+    Ret<void *> unwatch(int32_t fd, IoHandler &handler);
+
+    /**
+     * 投递任务到事件循环线程执行，任意线程可调用
+     *
+     * @return 队列满或事件循环已停止时返回 Err::QUEUE_FULL，任务不会执行
+     */
+    template <typename F> Ret<void *> defer(F &&fn) {
+        using Fn = std::decay_t<F>;
+        auto task = new detail::FunctionTask<Fn>(Fn(std::forward<F>(fn)));
+        auto ret = deferTask(task);
+        if (ret.failed()) {
+            delete task;
+        }
+        return ret;
+    }
+
+    /**
+     * 投递已经构造好的任务，失败时任务的所有权仍在调用方
+     */
+    Ret<void *> deferTask(Task *task) {
+        if (stopping.load(std::memory_order_relaxed) || !deferred.tryEmplace(task)) {
+            return Ret<void *>::with(EGrp::INTERNAL, Err::QUEUE_FULL);
+        }
+        notify();
+        return Ret<void *>::with(nullptr);
+    }
+
+    /**
+     * 注册轮询来源，只能在事件循环线程上（或 run() 之前）调用，来源的生命周期需要覆盖到 removeSource 之后
+     */
+    void addSource(PollSource &source) { sources.push_back(&source); }
+
+    void removeSource(PollSource &source);
+
+    /**
+     * 向 PollSource 投递工作之后调用：与事件循环挂起前的 sleeping 标记构成握手，只在对方可能挂起时写 eventfd
+     */
+    void notify() noexcept {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (sleeping.load(std::memory_order_relaxed)) {
+            wakeup();
+        }
+    }
+
+    /**
+     * delay 后在事件循环线程上触发 node.onExpire()
+     */
+    void scheduleAfter(TimerNode &node, std::chrono::nanoseconds delay) {
+        timers.schedule(node, tickSource.now() + tickSource.toTicks(delay));
+    }
+
+    bool cancel(TimerNode &node) noexcept { return timers.cancel(node); }
+
+    TimerWheel &timerWheel() noexcept { return timers; }
+
+    const TscTickSource &ticks() const noexcept { return tickSource; }
+
+    /**
+     * 在当前线程运行事件循环，直到 stop()
+     */
+    void run();
+
+    /**
+     * 执行一轮迭代，不挂起
+     *
+     * @return 本轮处理的工作数
+     */
+    size_t runOnce() { return iterate(0); }
+
+    /**
+     * 执行一个延迟任务，队列为空时返回 false；用于任务内部等待时的退避（不能重入 runOnce）
+     */
+    bool runDeferredOne() {
+        Task *task = nullptr;
+        if (!deferred.tryPop(task)) {
+            return false;
+        }
+        task->run();
+        return true;
+    }
+
+    /**
+     * 请求停止，任意线程可调用；run() 在当前迭代结束后返回
+     */
+    void stop() noexcept;
+
+    /**
+     * 唤醒挂起在 epoll_wait 上的事件循环
+     */
+    void wakeup() noexcept;
+
+    bool inLoopThread() const noexcept {
+        return loopThread.load(std::memory_order_relaxed) == std::this_thread::get_id();
+    }
+
+    bool stopped() const noexcept { return stopping.load(std::memory_order_acquire); }
+
+    const std::string &name() const noexcept { return options.name; }
+
+    const Histogram &iterationLatency() const noexcept { return iterationNs; }
+
+    const Histogram &iterationWork() const noexcept { return iterationItems; }
+
+  private:
+    EventLoopOptions options;
+    int32_t epollFd = -1;
+    int32_t wakeFd = -1;
+    TscTickSource tickSource;
+    TimerWheel timers;
+    MpmcQueue<Task *> deferred;
+    std::vector<Task *> drainBuffer;
+    std::vector<PollSource *> sources;
+
+    // 本轮 epoll_wait 返回的事件，unwatch 时把尚未分发的对应条目清空
+    std::unique_ptr<epoll_event[]> readyEvents;
+    size_t readyCount = 0;
+    size_t readyIndex = 0;
+
+    alignas(CACHE_LINE_SIZE) std::atomic<bool> sleeping{false};
+    std::atomic<bool> stopping{false};
+    std::atomic<std::thread::id> loopThread{};
+
+    Histogram iterationNs;
+    Histogram iterationItems;
+    std::atomic<uint64_t> idleIterations{0};
+
+    size_t iterate(int32_t timeoutMs);
+
+    size_t dispatchEvents(size_t count);
+
+    size_t drainDeferred();
+
+    bool hasPendingWork() const noexcept;
+
+    int32_t waitTimeoutMs() const noexcept;
+
+    Ret<void *> control(int32_t op, int32_t fd, uint32_t events, IoHandler *handler);
+};
+
+RHINO_INLINE_NAMESPACE_END
+} // namespace rhino
@@ -0,0 +1,242 @@
+#include "runtime/Executor.h"
+
+#include <algorithm>
+#include <string>
+#include <thread>
+
+namespace rhino {
+RHINO_INLINE_NAMESPACE_BEGIN
+
+namespace {
+
+// 空闲时在挂起之前的自旋轮数
+constexpr int32_t IDLE_SPINS = 64;
+
+} // namespace
+
+class Executor::Worker final : public WorkerContext {
+
+  public:
+    Executor *owner;
+    size_t index;
+    WorkStealingDeque<Task *> local;
+    uint64_t seed;
+    std::thread thread;
+
+    Worker(Executor *owner, size_t index, int64_t localCapacity)
+        : owner(owner), index(index), local(localCapacity),
+          seed(0x9E3779B97F4A7C15ULL * (index + 1)) {}
+
+    bool runOne() override {
+        Task *task = nullptr;
+        if (owner->findTask(this, task)) {
+            task->run();
+            return true;
+        }
+        return false;
+    }
+
+    uint64_t nextRandom() noexcept {
+        seed ^= seed << 13;
+        seed ^= seed >> 7;
+        seed ^= seed << 17;
+        return seed;
+    }
+};
+
+Executor::Executor(ExecutorOptions options) : injection(options.injectionCapacity) {
+    size_t threads = options.threads;
+    if (threads == 0) {
+        threads = std::max(1U, std::thread::hardware_concurrency());
+    }
+    workers.reserve(threads);
+    for (size_t i = 0; i < threads; i++) {
+        workers.push_back(std::make_unique<Worker>(this, i, options.localCapacity));
+    }
+    for (size_t i = 0; i < threads; i++) {
+        Worker *w = workers[i].get();
+        topology::ThreadPlacement placement;
+        placement.name = options.name + "-" + std::to_string(i);
+        if (!options.cpus.empty()) {
+            placement.cpus.push_back(options.cpus[i % options.cpus.size()]);
+            placement.memNode = options.localMemory ? topology::MEM_NODE_LOCAL : topology::MEM_NODE_NONE;
+        }
+        placement.policy = options.policy;
+        placement.priority = options.priority;
+        w->thread = topology::startThread(std::move(placement), [this, w] { workerLoop(w); });
+    }
+}
+
+Executor::~Executor() { shutdown(); }
+
+Executor &Executor::shared() {
+    static Executor executor;
+    return executor;
+}
+
+Executor::Worker *&Executor::localWorker() noexcept {
+    static thread_local Worker *worker = nullptr;
+    return worker;
+}
+
+Executor *Executor::current() noexcept {
+    Worker *w = localWorker();
+    return w == nullptr ? nullptr : w->owner;
+}
+
+int32_t Executor::workerIndex() const noexcept {
+    Worker *w = localWorker();
+    return w != nullptr && w->owner == this ? static_cast<int32_t>(w->index) : -1;
+}
+
+void Executor::shutdown() {
+    if (stopping.exchange(true)) {
+        return;
+    }
+    wakeEpoch.fetch_add(1, std::memory_order_release);
+    futexWake(&wakeEpoch);
+    for (auto &w : workers) {
+        if (w->thread.joinable()) {
+            w->thread.join();
+        }
+    }
+    // 与 schedule 中 inflight 加一后检查 stopping 配对：此后不会再有任务入队
+    while (inflight.load(std::memory_order_seq_cst) != 0) {
+        std::this_thread::yield();
+    }
+    // 工作线程退出后残留的任务（例如关闭过程中提交的），在调用线程上执行完，保证 Future 都能完成
+    Task *task = nullptr;
+    for (;;) {
+        bool found = injection.tryPop(task);
+        for (size_t i = 0; !found && i < workers.size(); i++) {
+            found = workers[i]->local.steal(task);
+        }
+        if (!found) {
+            break;
+        }
+        task->run();
+    }
+}
+
+bool Executor::schedule(Task *task) {
+    inflight.fetch_add(1, std::memory_order_seq_cst);
+    if (stopping.load(std::memory_order_seq_cst)) {
+        inflight.fetch_sub(1, std::memory_order_release);
+        return false;
+    }
+    Worker *w = localWorker();
+    bool queued = true;
+    if (w != nullptr && w->owner == this) {
+        // 本地和全局都满了时直接执行，避免工作线程之间互相等待导致死锁
+        queued = w->local.push(task) || injection.tryEmplace(task);
+        if (queued) {
+            notify();
+        }
+        inflight.fetch_sub(1, std::memory_order_release);
+        if (!queued) {
+            task->run();
+        }
+        return true;
+    }
+    queued = injection.tryEmplace(task);
+    if (queued) {
+        notify();
+    }
+    inflight.fetch_sub(1, std::memory_order_release);
+    return queued;
+}
+
+bool Executor::findTask(Worker *self, Task *&task) {
+    if (self->local.pop(task)) {
+        return true;
+    }
+    if (injection.tryPop(task)) {
+        return true;
+    }
+    const size_t n = workers.size();
+    if (n <= 1) {
+        return false;
+    }
+    // 从随机位置开始遍历一圈其他工作线程
+    const size_t start = self->nextRandom() % n;
+    for (size_t i = 0; i < n; i++) {
+        Worker *victim = workers[(start + i) % n].get();
+        if (victim != self && victim->local.steal(task)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void Executor::notify() noexcept {
+    // 已经有工作线程在自旋找任务时不必唤醒：它找到任务后会接力唤醒下一个（见 workerLoop），
+    // 放弃自旋时登记为 sleeper 之前还会再找一次
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (searching.load(std::memory_order_relaxed) == 0) {
+        wakeSleeper();
+    }
+}
+
+void Executor::wakeSleeper() noexcept {
+    // 与 workerLoop 中 sleepers.fetch_add + 重新查找任务构成握手，保证不会丢失唤醒
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (sleepers.load(std::memory_order_relaxed) != 0) {
+        wakeEpoch.fetch_add(1, std::memory_order_release);
+        futexWake(&wakeEpoch, 1);
+    }
+}
+
+void Executor::workerLoop(Worker *self) {
+    WorkerContext::current() = self;
+    localWorker() = self;
+    Task *task = nullptr;
+    // 刚被唤醒的线程已经处于自旋找任务状态
+    bool woken = false;
+    for (;;) {
+        if (!woken) {
+            if (findTask(self, task)) {
+                task->run();
+                continue;
+            }
+            searching.fetch_add(1, std::memory_order_seq_cst);
+        }
+        woken = false;
+        bool found = false;
+        for (int32_t i = 0; i < IDLE_SPINS && !found; i++) {
+            found = findTask(self, task);
+            if (!found) {
+                cpuRelax();
+            }
+        }
+        const bool lastSearcher = searching.fetch_sub(1, std::memory_order_seq_cst) == 1;
+        if (found) {
+            // 自旋期间提交方没有唤醒任何线程，后面可能还有一批任务，接力唤醒一个挂起的线程
+            if (lastSearcher) {
+                wakeSleeper();
+            }
+            task->run();
+            continue;
+        }
+
+        const uint32_t epoch = wakeEpoch.load(std::memory_order_acquire);
+        sleepers.fetch_add(1, std::memory_order_seq_cst);
+        if (findTask(self, task)) {
+            sleepers.fetch_sub(1, std::memory_order_relaxed);
+            task->run();
+            continue;
+        }
+        if (stopping.load(std::memory_order_acquire)) {
+            sleepers.fetch_sub(1, std::memory_order_relaxed);
+            break;
+        }
+        futexWait(&wakeEpoch, epoch);
+        sleepers.fetch_sub(1, std::memory_order_relaxed);
+        searching.fetch_add(1, std::memory_order_seq_cst);
+        woken = true;
+    }
+    WorkerContext::current() = nullptr;
+    localWorker() = nullptr;
+}
+
+RHINO_INLINE_NAMESPACE_END
+} // namespace rhino
@@ -0,0 +1,143 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "common/Errs.h"
+#include "common/Version.h"
+#include "runtime/Future.h"
+#include "runtime/Topology.h"
+#include "util/CpuUtil.hpp"
+#include "util/MpmcQueue.hpp"
+#include "util/WorkStealingDeque.hpp"
+
+namespace rhino {
+RHINO_INLINE_NAMESPACE_BEGIN
+
+struct ExecutorOptions {
+    // 工作线程数，0 表示使用 std::thread::hardware_concurrency()
+    size_t threads = 0;
+    // 非空时第 i 个工作线程绑定到 cpus[i % cpus.size()]
+    std::vector<int32_t> cpus;
+    // 线程名前缀（会被截断到 15 个字符以内）
+    std::string name = "rhino-worker";
+    // 工作线程的调度策略，实时策略需要 CAP_SYS_NICE，设置失败时保持默认策略
+    topology::SchedPolicy policy = topology::SchedPolicy::OTHER;
+    int32_t priority = 0;
+    // 绑核时是否让工作线程优先从所在 NUMA 节点分配内存
+    bool localMemory = false;
+    // 外部线程提交任务的全局队列容量，满时 submit 返回 Err::QUEUE_FULL
+    size_t injectionCapacity = 65536;
+    // 每个工作线程本地双端队列容量（2 的幂），满时任务进入全局队列
+    int64_t localCapacity = 4096;
+};
+
+/**
+ * 工作窃取线程池
+ *
+ * - 每个工作线程一个 Chase-Lev 双端队列，工作线程内提交的任务进入本地队列
+ * - 外部线程提交的任务进入全局 MpmcQueue
+ * - 本地队列空时依次尝试全局队列、随机选择的其他工作线程（窃取）
+ * - 都取不到任务时自旋一小段时间，然后在 futex 上挂起，有新任务时只在存在挂起线程时才唤醒；
+ *   有线程在自旋找任务时提交方不唤醒，由最后一个找到任务的自旋线程唤醒下一个（接力），
+ *   被唤醒的线程同样先进入自旋状态
+ *
+ * submit() 返回 Future<T>，任务返回 Ret<T> 时失败原样透传，全程不使用异常
+ */
+class Executor {
+
+  public:
+    explicit Executor(ExecutorOptions options = ExecutorOptions());
+
+    ~Executor();
+
+    Executor(const Executor &) = delete;
+    Executor &operator=(const Executor &) = delete;
+
+    /**
+     * 进程级共享线程池，首次使用时按默认参数创建
+     */
+    static Executor &shared();
+
+    /**
+     * 当前线程所属的线程池，非工作线程返回 nullptr
+     */
+    static Executor *current() noexcept;
+
+    /**
+     * 提交任务
+     *
+     * @param fn 可调用对象：返回 Ret<T> 时得到 Future<T>，返回 void 时得到 Future<void *>，
+     *           返回其他类型 U 时得到 Future<U>
+     * @return 全局队列满或线程池已关闭时返回已失败的 Future（Err::QUEUE_FULL）
+     */
+    template <typename F> Future<detail::FutureValueOf<std::decay_t<F>>> submit(F &&fn) {
+        using Fn = std::decay_t<F>;
+        using T = detail::FutureValueOf<Fn>;
+        auto task = new detail::FutureTask<T, Fn>(Fn(std::forward<F>(fn)));
+        if (!schedule(task)) {
+            task->complete(Ret<T>::with(EGrp::INTERNAL, Err::QUEUE_FULL));
+            task->release();
+        }
+        return Future<T>(task);
+    }
+
+    /**
+     * 提交不需要结果的任务，全局队列满时在调用线程直接执行
+     */
+    template <typename F> void post(F &&fn) {
+        using Fn = std::decay_t<F>;
+        auto task = new detail::FunctionTask<Fn>(Fn(std::forward<F>(fn)));
+        if (!schedule(task)) {
+            task->run();
+        }
+    }
+
+    size_t size() const noexcept { return workers.size(); }
+
+    /**
+     * 当前线程若是本线程池的工作线程，返回其下标，否则返回 -1
+     */
+    int32_t workerIndex() const noexcept;
+
+    /**
+     * 停止并回收工作线程，尚未执行的任务在调用线程上执行完，可重复调用
+     */
+    void shutdown();
+
+  private:
+    class Worker;
+
+    std::vector<std::unique_ptr<Worker>> workers;
+    MpmcQueue<Task *> injection;
+
+    alignas(CACHE_LINE_SIZE) std::atomic<uint32_t> wakeEpoch{0};
+    std::atomic<uint32_t> sleepers{0};
+    std::atomic<uint32_t> searching{0};
+    std::atomic<bool> stopping{false};
+    // 已通过 stopping 检查、尚未入队完成的 schedule 调用数，shutdown 等它归零后再做最后的清理
+    std::atomic<uint32_t> inflight{0};
+
+    // 当前线程对应的工作线程（任意线程池），非工作线程为 nullptr
+    // 不能直接转换 WorkerContext::current()：其他运行时（例如 ShardRuntime）也会设置它
+    static Worker *&localWorker() noexcept;
+
+    bool schedule(Task *task);
+
+    bool findTask(Worker *self, Task *&task);
+
+    void notify() noexcept;
+
+    void wakeSleeper() noexcept;
+
+    void workerLoop(Worker *self);
+};
+
+RHINO_INLINE_NAMESPACE_END
+} // namespace rhino
@@ -0,0 +1,241 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include "common/Errs.h"
+#include "common/Ret.h"
+#include "common/Version.h"
+#include "util/CpuUtil.hpp"
+#include "util/Futex.hpp"
+
+namespace rhino {
+RHINO_INLINE_NAMESPACE_BEGIN
+
+/**
+ * 可调度的任务，run() 负责在执行完后释放自己
+ */
+class Task {
+  public:
+    virtual ~Task() = default;
+    virtual void run() noexcept = 0;
+};
+
+/**
+ * 工作线程上下文：在工作线程上等待 Future 时，不挂起线程，而是继续执行其他任务，
+ * 否则 fork/join 式的嵌套等待会把所有工作线程都卡住
+ */
+class WorkerContext {
+  public:
+    virtual ~WorkerContext() = default;
+
+    /**
+     * 取一个任务执行，没有任务时返回 false
+     */
+    virtual bool runOne() = 0;
+
+    /**
+     * 当前线程所属的工作线程上下文，非工作线程返回 nullptr
+     */
+    static WorkerContext *&current() noexcept {
+        static thread_local WorkerContext *ctx = nullptr;
+        return ctx;
+    }
+};
+
+template <typename T> struct IsRet : std::false_type {};
+template <typename T> struct IsRet<Ret<T>> : std::true_type {};
+
+namespace detail {
+
+/**
+ * 统一把函数返回值包装成 Ret：返回 Ret<T> 的原样返回，返回 void 的包装成 Ret<void *>，
+ * 其他类型 U 包装成 Ret<U>
+ */
+template <typename F> auto invokeAsRet(F &f) {
+    using R = decltype(f());
+    if constexpr (IsRet<R>::value) {
+        return f();
+    } else if constexpr (std::is_void<R>::value) {
+        f();
+        return Ret<void *>::with(nullptr);
+    } else {
+        return Ret<R>::with(f());
+    }
+}
+
+template <typename F> using RetOf = decltype(invokeAsRet(std::declval<F &>()));
+
+template <typename R> struct RetValue;
+template <typename T> struct RetValue<Ret<T>> {
+    using type = T;
+};
+
+// 函数 F 提交后得到的 Future 的值类型
+template <typename F> using FutureValueOf = typename RetValue<RetOf<F>>::type;
+
+} // namespace detail
+
+/**
+ * Future 的共享状态：执行者和 Future 各持有一个引用
+ *
+ * 状态：PENDING 未完成，WAITING 未完成且有线程在 futex 上等待，DONE 已完成
+ * 只有存在等待者时完成方才会发起 futexWake
+ */
+template <typename T> class FutureState : public Task {
+
+    static constexpr uint32_t PENDING = 0;
+    static constexpr uint32_t WAITING = 1;
+    static constexpr uint32_t DONE = 2;
+
+    std::atomic<uint32_t> refs;
+    std::atomic<uint32_t> state{PENDING};
+    Ret<T> result;
+
+  public:
+    explicit FutureState(uint32_t refs = 2) : refs(refs) {}
+
+    void run() noexcept override {}
+
+    void complete(Ret<T> &&value) noexcept {
+        result = std::move(value);
+        if (state.exchange(DONE, std::memory_order_acq_rel) == WAITING) {
+            futexWake(&state);
+        }
+    }
+
+    bool isDone() const noexcept { return state.load(std::memory_order_acquire) == DONE; }
+
+    void block() noexcept {
+        uint32_t expected = PENDING;
+        state.compare_exchange_strong(expected, WAITING, std::memory_order_acq_rel);
+        while (state.load(std::memory_order_acquire) != DONE) {
+            futexWait(&state, WAITING);
+        }
+    }
+
+    Ret<T> &value() noexcept { return result; }
+
+    void release() noexcept {
+        if (refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            delete this;
+        }
+    }
+};
+
+/**
+ * 轻量 Future：结果是 Ret<T>，失败信息（EGrp/Err）原样传递，不使用异常
+ *
+ * 只能移动，get() 只能调用一次
+ */
+template <typename T> class Future {
+
+    FutureState<T> *state = nullptr;
+
+  public:
+    Future() = default;
+
+    explicit Future(FutureState<T> *state) noexcept : state(state) {}
+
+    Future(Future &&other) noexcept : state(std::exchange(other.state, nullptr)) {}
+
+    Future &operator=(Future &&other) noexcept {
+        if (this != &other) {
+            reset();
+            state = std::exchange(other.state, nullptr);
+        }
+        return *this;
+    }
+
+    Future(const Future &) = delete;
+    Future &operator=(const Future &) = delete;
+
+    ~Future() { reset(); }
+
+    /**
+     * 直接构造一个已失败的 Future（例如提交时队列已满）
+     */
+    static Future failed(EGrp &eGrp, Err &err) {
+        auto s = new FutureState<T>(1);
+        s->complete(Ret<T>::with(eGrp, err));
+        return Future(s);
+    }
+
+    bool valid() const noexcept { return state != nullptr; }
+
+    bool ready() const noexcept { return state != nullptr && state->isDone(); }
+
+    /**
+     * 等待完成：工作线程上一边等一边执行其他任务，其他线程 futex 挂起
+     */
+    void wait() const noexcept {
+        if (state == nullptr || state->isDone()) {
+            return;
+        }
+        WorkerContext *ctx = WorkerContext::current();
+        if (ctx == nullptr) {
+            state->block();
+            return;
+        }
+        int32_t idle = 0;
+        while (!state->isDone()) {
+            if (ctx->runOne()) {
+                idle = 0;
+            } else if (++idle < 64) {
+                cpuRelax();
+            } else {
+                std::this_thread::yield();
+            }
+        }
+    }
+
+    Ret<T> get() {
+        wait();
+        Ret<T> ret = std::move(state->value());
+        reset();
+        return ret;
+    }
+
+  private:
+    void reset() noexcept {
+        if (state != nullptr) {
+            state->release();
+            state = nullptr;
+        }
+    }
+};
+
+namespace detail {
+
+template <typename T, typename F> class FutureTask final : public FutureState<T> {
+
+    F fn;
+
+  public:
+    explicit FutureTask(F &&fn) : fn(std::move(fn)) {}
+
+    void run() noexcept override {
+        this->complete(invokeAsRet(fn));
+        this->release();
+    }
+};
+
+template <typename F> class FunctionTask final : public Task {
+
+    F fn;
+
+  public:
+    explicit FunctionTask(F &&fn) : fn(std::move(fn)) {}
+
+    void run() noexcept override {
+        fn();
+        delete this;
+    }
+};
+
+} // namespace detail
+
+RHINO_INLINE_NAMESPACE_END
+} // namespace rhino
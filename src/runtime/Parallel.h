@@ -0,0 +1,318 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "common/Version.h"
+#include "runtime/Executor.h"
+#include "runtime/Future.h"
+#include "util/CpuUtil.hpp"
+#include "util/Futex.hpp"
+
+namespace rhino {
+RHINO_INLINE_NAMESPACE_BEGIN
+
+struct ParallelOptions {
+    // 每个分块的元素数，0 表示自适应：按线程数切成若干块，空闲线程动态领取
+    size_t grain = 0;
+    // 分块边界只由数据量决定、与线程数无关，规约按分块顺序合并，浮点结果可复现
+    bool deterministic = false;
+    // 使用的线程池，nullptr 表示 Executor::shared()
+    Executor *executor = nullptr;
+};
+
+namespace detail {
+
+// 元素太少时并行的调度开销大于收益，直接在调用线程执行
+constexpr size_t PARALLEL_MIN_GRAIN = 512;
+// 自适应模式下每个线程平均分到的块数，块越多负载越均衡，调度开销越大
+constexpr size_t PARALLEL_CHUNKS_PER_WORKER = 8;
+// 确定性模式下的块数上限（块大小只取决于 n）
+constexpr size_t PARALLEL_DETERMINISTIC_CHUNKS = 256;
+
+inline size_t chunkSize(size_t n, size_t workers, const ParallelOptions &options) {
+    if (options.grain > 0) {
+        return options.grain;
+    }
+    size_t chunks = options.deterministic ? PARALLEL_DETERMINISTIC_CHUNKS
+                                          : workers * PARALLEL_CHUNKS_PER_WORKER;
+    return std::max(PARALLEL_MIN_GRAIN, (n + chunks - 1) / chunks);
+}
+
+/**
+ * 把 [0, n) 切成大小为 grain 的块，由调用线程和线程池中的辅助任务动态领取执行
+ *
+ * body(chunkIndex, begin, end)。调用线程等待所有块执行完才返回；辅助任务持有共享状态，
+ * 晚到的辅助任务领不到块会直接退出，不会访问 body，所以 body 可以引用调用方的栈。
+ */
+template <typename Body>
+void runChunks(size_t n, size_t grain, size_t chunks, Executor &executor, const Body &body) {
+    if (chunks <= 1 || executor.size() <= 1) {
+        for (size_t c = 0; c < chunks; c++) {
+            body(c, c * grain, std::min(n, (c + 1) * grain));
+        }
+        return;
+    }
+
+    struct State {
+        std::atomic<size_t> next{0};
+        std::atomic<uint32_t> pending;
+        size_t n;
+        size_t grain;
+        size_t chunks;
+        const Body *body;
+
+        explicit State(size_t chunks) : pending(static_cast<uint32_t>(chunks)) {}
+
+        // 领取并执行块，直到没有剩余块
+        void drain() {
+            for (;;) {
+                const size_t c = next.fetch_add(1, std::memory_order_relaxed);
+                if (c >= chunks) {
+                    return;
+                }
+                (*body)(c, c * grain, std::min(n, (c + 1) * grain));
+                if (pending.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                    futexWake(&pending);
+                }
+            }
+        }
+    };
+
+    auto state = std::make_shared<State>(chunks);
+    state->n = n;
+    state->grain = grain;
+    state->chunks = chunks;
+    state->body = &body;
+
+    const size_t helpers = std::min(executor.size(), chunks) - 1;
+    for (size_t i = 0; i < helpers; i++) {
+        executor.post([state] { state->drain(); });
+    }
+    state->drain();
+
+    // 剩余的块正在被其他线程执行：工作线程上继续帮忙执行其他任务，外部线程挂起等待
+    WorkerContext *ctx = WorkerContext::current();
+    for (uint32_t p = state->pending.load(std::memory_order_acquire); p != 0;
+         p = state->pending.load(std::memory_order_acquire)) {
+        if (ctx != nullptr) {
+            if (!ctx->runOne()) {
+                cpuRelax();
+            }
+        } else {
+            futexWait(&state->pending, p);
+        }
+    }
+}
+
+template <typename It> decltype(auto) elementAt(It first, size_t i) {
+    if constexpr (std::is_integral<It>::value) {
+        return static_cast<It>(first + static_cast<It>(i));
+    } else {
+        return first[static_cast<typename std::iterator_traits<It>::difference_type>(i)];
+    }
+}
+
+template <typename It> size_t distanceOf(It first, It last) {
+    if constexpr (std::is_integral<It>::value) {
+        return last > first ? static_cast<size_t>(last - first) : 0;
+    } else {
+        return static_cast<size_t>(std::distance(first, last));
+    }
+}
+
+} // namespace detail
+
+/**
+ * 并行 for
+ *
+ * @param first/last 整数区间 [first, last)（fn 收到下标）或随机访问迭代器区间（fn 收到元素引用）
+ * @param fn 对每个下标/元素调用一次，不同元素可能在不同线程上并发调用
+ */
+template <typename It, typename F>
+void parallel_for(It first, It last, F &&fn, ParallelOptions options = ParallelOptions()) {
+    Executor &executor = options.executor != nullptr ? *options.executor : Executor::shared();
+    const size_t n = detail::distanceOf(first, last);
+    if (n == 0) {
+        return;
+    }
+    const size_t grain = detail::chunkSize(n, executor.size(), options);
+    const size_t chunks = (n + grain - 1) / grain;
+    detail::runChunks(n, grain, chunks, executor, [&](size_t, size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) {
+            fn(detail::elementAt(first, i));
+        }
+    });
+}
+
+/**
+ * 并行变换：out[i] = fn(first[i])，out 需要有足够空间
+ */
+template <typename InIt, typename OutIt, typename F>
+void parallel_transform(InIt first, InIt last, OutIt out, F &&fn,
+                        ParallelOptions options = ParallelOptions()) {
+    Executor &executor = options.executor != nullptr ? *options.executor : Executor::shared();
+    const size_t n = detail::distanceOf(first, last);
+    if (n == 0) {
+        return;
+    }
+    const size_t grain = detail::chunkSize(n, executor.size(), options);
+    const size_t chunks = (n + grain - 1) / grain;
+    detail::runChunks(n, grain, chunks, executor, [&](size_t, size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) {
+            detail::elementAt(out, i) = fn(detail::elementAt(first, i));
+        }
+    });
+}
+
+/**
+ * 并行规约：先对每个元素做 transform，再用 reduce 合并
+ *
+ * 每个块内从左到右规约，块的结果再按块的顺序依次合并到 init 上。
+ * reduce 需要满足结合律；浮点求和需要结果可复现时打开 options.deterministic。
+ *
+ * @param init 初始值，只参与一次合并
+ * @param reduce (T, T) -> T
+ * @param transform 元素 -> T
+ */
+template <typename It, typename T, typename Reduce, typename Transform>
+T parallel_reduce(It first, It last, T init, Reduce &&reduce, Transform &&transform,
+                  ParallelOptions options = ParallelOptions()) {
+    Executor &executor = options.executor != nullptr ? *options.executor : Executor::shared();
+    const size_t n = detail::distanceOf(first, last);
+    if (n == 0) {
+        return init;
+    }
+    const size_t grain = detail::chunkSize(n, executor.size(), options);
+    const size_t chunks = (n + grain - 1) / grain;
+
+    // 每个块的结果放在独立的缓存行上，避免伪共享
+    struct alignas(CACHE_LINE_SIZE) Partial {
+        T value;
+    };
+    std::vector<Partial> partials(chunks, Partial{init});
+    detail::runChunks(n, grain, chunks, executor, [&](size_t c, size_t begin, size_t end) {
+        T acc = transform(detail::elementAt(first, begin));
+        for (size_t i = begin + 1; i < end; i++) {
+            acc = reduce(std::move(acc), transform(detail::elementAt(first, i)));
+        }
+        partials[c].value = std::move(acc);
+    });
+
+    T result = std::move(init);
+    for (auto &p : partials) {
+        result = reduce(std::move(result), std::move(p.value));
+    }
+    return result;
+}
+
+template <typename It, typename T, typename Reduce>
+T parallel_reduce(It first, It last, T init, Reduce &&reduce,
+                  ParallelOptions options = ParallelOptions()) {
+    return parallel_reduce(
+        first, last, std::move(init), std::forward<Reduce>(reduce),
+        [](const auto &v) -> T { return v; }, options);
+}
+
+namespace detail {
+
+/**
+ * 并行归并两个有序段 [a, aEnd) 和 [b, bEnd) 到 out
+ *
+ * 在较长的段上等距取分割点，在另一段上二分找到对应位置，各子段独立归并。
+ * 相等元素保持 a 段在前，和 std::merge 一致。
+ */
+template <typename It, typename OutIt, typename Compare>
+void parallelMerge(It a, It aEnd, It b, It bEnd, OutIt out, Compare &comp, Executor &executor) {
+    const size_t na = static_cast<size_t>(aEnd - a);
+    const size_t nb = static_cast<size_t>(bEnd - b);
+    const size_t total = na + nb;
+    const size_t pieces = std::max<size_t>(1, std::min(executor.size() * 4, total / (PARALLEL_MIN_GRAIN * 8)));
+    if (pieces <= 1) {
+        std::merge(std::make_move_iterator(a), std::make_move_iterator(aEnd),
+                   std::make_move_iterator(b), std::make_move_iterator(bEnd), out, comp);
+        return;
+    }
+    // 先算好所有分割点再归并：归并会把元素移走，不能边归并边在源序列上二分
+    const bool splitA = na >= nb;
+    std::vector<std::pair<size_t, size_t>> cuts(pieces + 1);
+    cuts[pieces] = {na, nb};
+    for (size_t k = 1; k < pieces; k++) {
+        if (splitA) {
+            const size_t ia = na * k / pieces;
+            cuts[k] = {ia, static_cast<size_t>(std::lower_bound(b, bEnd, a[ia], comp) - b)};
+        } else {
+            const size_t ib = nb * k / pieces;
+            cuts[k] = {static_cast<size_t>(std::upper_bound(a, aEnd, b[ib], comp) - a), ib};
+        }
+    }
+    runChunks(pieces, 1, pieces, executor, [&](size_t k, size_t, size_t) {
+        const auto [a0, b0] = cuts[k];
+        const auto [a1, b1] = cuts[k + 1];
+        std::merge(std::make_move_iterator(a + a0), std::make_move_iterator(a + a1),
+                   std::make_move_iterator(b + b0), std::make_move_iterator(b + b1),
+                   out + (a0 + b0), comp);
+    });
+}
+
+} // namespace detail
+
+/**
+ * 并行排序（不稳定）：各块并行 std::sort，再逐轮两两并行归并（需要 n 个元素的辅助缓冲）
+ */
+template <typename It, typename Compare>
+void parallel_sort(It first, It last, Compare comp, ParallelOptions options = ParallelOptions()) {
+    using T = typename std::iterator_traits<It>::value_type;
+    Executor &executor = options.executor != nullptr ? *options.executor : Executor::shared();
+    const size_t n = static_cast<size_t>(last - first);
+    if (n <= detail::PARALLEL_MIN_GRAIN * 4 || executor.size() <= 1) {
+        std::sort(first, last, comp);
+        return;
+    }
+
+    // 块数取 2 的幂，便于逐轮两两归并
+    size_t runs = 1;
+    while (runs < executor.size() * 2 && n / (runs * 2) >= detail::PARALLEL_MIN_GRAIN) {
+        runs <<= 1;
+    }
+    const size_t grain = (n + runs - 1) / runs;
+    detail::runChunks(n, grain, runs, executor, [&](size_t, size_t begin, size_t end) {
+        std::sort(first + begin, first + end, comp);
+    });
+
+    std::vector<T> buffer(n);
+    bool inBuffer = false;
+    for (size_t width = grain; width < n; width *= 2) {
+        const size_t pairs = (n + 2 * width - 1) / (2 * width);
+        for (size_t p = 0; p < pairs; p++) {
+            const size_t lo = p * 2 * width;
+            const size_t mid = std::min(n, lo + width);
+            const size_t hi = std::min(n, lo + 2 * width);
+            if (inBuffer) {
+                auto src = buffer.begin();
+                detail::parallelMerge(src + lo, src + mid, src + mid, src + hi, first + lo, comp, executor);
+            } else {
+                detail::parallelMerge(first + lo, first + mid, first + mid, first + hi,
+                                      buffer.begin() + lo, comp, executor);
+            }
+        }
+        inBuffer = !inBuffer;
+    }
+    if (inBuffer) {
+        std::move(buffer.begin(), buffer.end(), first);
+    }
+}
+
+template <typename It> void parallel_sort(It first, It last, ParallelOptions options = ParallelOptions()) {
+    parallel_sort(first, last, std::less<typename std::iterator_traits<It>::value_type>(), options);
+}
+
+RHINO_INLINE_NAMESPACE_END
+} // namespace rhino
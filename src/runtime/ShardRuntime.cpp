@@ -0,0 +1,182 @@
+#include "runtime/ShardRuntime.h"
+
+#include <thread>
+
+namespace rhino {
+RHINO_INLINE_NAMESPACE_BEGIN
+
+namespace {
+
+// 当前线程所属的运行时和分片下标
+struct LocalShard {
+    const ShardRuntime *runtime;
+    size_t index;
+};
+
+thread_local LocalShard localShard{nullptr, 0};
+
+} // namespace
+
+class ShardRuntime::Shard final : public WorkerContext, public PollSource {
+
+  public:
+    using Mailbox = SpscRing<Task *, MAILBOX_CAPACITY>;
+
+    size_t index;
+    topology::CpuInfo cpu;
+    EventLoop loop;
+    // inbox[i] 是分片 i 发给本分片的信箱
+    std::vector<std::unique_ptr<Mailbox>> inbox;
+    std::unique_ptr<std::pmr::unsynchronized_pool_resource> pool;
+    std::thread thread;
+    // 轮询信箱的起点，每轮后移一位，避免编号小的分片总是先被处理
+    size_t cursor = 0;
+
+    Shard(size_t index, const topology::CpuInfo &cpu, size_t shardCount, EventLoopOptions loopOptions)
+        : index(index), cpu(cpu), loop(std::move(loopOptions)) {
+        inbox.reserve(shardCount);
+        for (size_t i = 0; i < shardCount; i++) {
+            inbox.push_back(std::make_unique<Mailbox>());
+        }
+    }
+
+    // 逐条 tryPop 而不是批量 claimRead：任务里等待 Future 时会重入 runOne，逐条处理可以安全重入
+    size_t poll() noexcept override {
+        size_t done = 0;
+        const size_t n = inbox.size();
+        for (size_t k = 0; k < n; k++) {
+            Mailbox &box = *inbox[(cursor + k) % n];
+            Task *task = nullptr;
+            for (size_t budget = MAILBOX_CAPACITY; budget > 0 && box.tryPop(task); budget--) {
+                task->run();
+                done++;
+            }
+        }
+        cursor++;
+        return done;
+    }
+
+    bool pending() const noexcept override {
+        for (const auto &box : inbox) {
+            if (!box->empty()) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // 信箱之外还要处理溢出到延迟队列的消息，否则两个分片都在等对方的溢出队列时会互相卡住
+    bool runOne() override {
+        Task *task = nullptr;
+        for (auto &box : inbox) {
+            if (box->tryPop(task)) {
+                task->run();
+                return true;
+            }
+        }
+        return loop.runDeferredOne();
+    }
+};
+
+ShardRuntime::ShardRuntime(ShardRuntimeOptions options) {
+    const auto cpus = topology::discover(options.sysRoot);
+    const size_t count = options.shards > 0 ? options.shards : topology::physicalCores(cpus);
+    const auto picked = topology::pickShardCpus(cpus, count);
+    shards.reserve(count);
+    for (size_t i = 0; i < count; i++) {
+        EventLoopOptions loopOptions;
+        loopOptions.name = options.name + "-" + std::to_string(i);
+        shards.push_back(std::make_unique<Shard>(i, picked[i], count, std::move(loopOptions)));
+    }
+
+    std::atomic<size_t> started{0};
+    for (size_t i = 0; i < count; i++) {
+        Shard *s = shards[i].get();
+        topology::ThreadPlacement placement;
+        placement.name = options.name + "-" + std::to_string(i);
+        if (options.pin) {
+            placement.cpus.push_back(s->cpu.cpu);
+            placement.memNode = options.localMemory ? s->cpu.node : topology::MEM_NODE_NONE;
+        }
+        placement.policy = options.policy;
+        placement.priority = options.priority;
+        s->thread = topology::startThread(std::move(placement), [this, s, &started] {
+            // 绑核和设置内存策略之后再创建内存池，首次访问的页落在本节点上
+            s->pool = std::make_unique<std::pmr::unsynchronized_pool_resource>();
+            localShard = LocalShard{this, s->index};
+            WorkerContext::current() = s;
+            s->loop.addSource(*s);
+            started.fetch_add(1, std::memory_order_release);
+            s->loop.run();
+            s->loop.removeSource(*s);
+            WorkerContext::current() = nullptr;
+            localShard = LocalShard{nullptr, 0};
+        });
+    }
+    while (started.load(std::memory_order_acquire) < count) {
+        std::this_thread::yield();
+    }
+}
+
+ShardRuntime::~ShardRuntime() { stop(); }
+
+int32_t ShardRuntime::currentShard() const noexcept {
+    return localShard.runtime == this ? static_cast<int32_t>(localShard.index) : -1;
+}
+
+const topology::CpuInfo &ShardRuntime::cpuOf(size_t shard) const noexcept { return shards[shard]->cpu; }
+
+EventLoop &ShardRuntime::loop(size_t shard) noexcept { return shards[shard]->loop; }
+
+std::pmr::memory_resource *ShardRuntime::resource(size_t shard) noexcept { return shards[shard]->pool.get(); }
+
+bool ShardRuntime::deliver(size_t shard, Task *task) {
+    inflight.fetch_add(1, std::memory_order_seq_cst);
+    if (stopping.load(std::memory_order_seq_cst)) {
+        inflight.fetch_sub(1, std::memory_order_release);
+        return false;
+    }
+    Shard &to = *shards[shard];
+    bool delivered = false;
+    if (localShard.runtime == this && to.inbox[localShard.index]->tryEmplace(task)) {
+        to.loop.notify();
+        delivered = true;
+    } else {
+        delivered = !to.loop.deferTask(task).failed();
+    }
+    inflight.fetch_sub(1, std::memory_order_release);
+    return delivered;
+}
+
+bool ShardRuntime::pollOnce() noexcept {
+    if (localShard.runtime != this) {
+        return false;
+    }
+    return shards[localShard.index]->runOne();
+}
+
+void ShardRuntime::stop() {
+    if (stopping.exchange(true)) {
+        return;
+    }
+    for (auto &s : shards) {
+        s->loop.stop();
+    }
+    for (auto &s : shards) {
+        if (s->thread.joinable()) {
+            s->thread.join();
+        }
+    }
+    // 与 deliver 中 inflight 加一后检查 stopping 配对：此后不会再有消息投递进来
+    while (inflight.load(std::memory_order_seq_cst) != 0) {
+        std::this_thread::yield();
+    }
+    // 分片线程退出后信箱里残留的任务在调用线程上执行完，保证 Future 都能完成
+    for (auto &s : shards) {
+        while (s->runOne()) {
+        }
+    }
+}
+
+RHINO_INLINE_NAMESPACE_END
+} // namespace rhino
@@ -0,0 +1,132 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <memory_resource>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "common/Errs.h"
+#include "common/Version.h"
+#include "runtime/EventLoop.h"
+#include "runtime/Future.h"
+#include "runtime/Topology.h"
+#include "util/SpscRing.hpp"
+
+namespace rhino {
+RHINO_INLINE_NAMESPACE_BEGIN
+
+struct ShardRuntimeOptions {
+    // 分片数，0 表示物理核数
+    size_t shards = 0;
+    // 是否把分片线程绑定到挑选出的 CPU
+    bool pin = true;
+    // 绑核时是否让分片线程优先从所在 NUMA 节点分配内存（MPOL_PREFERRED）
+    bool localMemory = true;
+    // 分片线程的调度策略，设置失败时保持默认策略
+    topology::SchedPolicy policy = topology::SchedPolicy::OTHER;
+    int32_t priority = 0;
+    // 线程名前缀，同时作为各分片事件循环的指标名前缀
+    std::string name = "rhino-shard";
+    // CPU 拓扑来源
+    std::string sysRoot = "/sys/devices/system/cpu";
+};
+
+/**
+ * 每核一个分片的 shared-nothing 运行时
+ *
+ * - 每个分片一个绑核线程，运行自己的 EventLoop，拥有自己的内存池（在分片线程上设置 NUMA 策略之后创建，内存就近分配）
+ * - 分片之间只通过 SPSC 信箱通信：分片 i 发给分片 j 的消息走 mailbox[j][i]，无锁、无 RMW 指令
+ * - 非分片线程发来的消息、以及信箱满时溢出的消息走目标事件循环的 MPMC 延迟任务队列
+ * - 分片按 NUMA 节点聚集挑选 CPU（见 topology::pickShardCpus）
+ *
+ * 分片上等待另一个分片的 Future 时，会继续处理自己信箱里的消息，互相等待不会死锁；
+ * 但等待期间不会处理 fd 事件和定时器，长时间等待应改为回调式（在回复消息里继续）。
+ * 同一对分片之间经信箱投递的消息保持顺序，溢出路径不保证。
+ */
+class ShardRuntime {
+
+  public:
+    static constexpr size_t MAILBOX_CAPACITY = 1024;
+
+    explicit ShardRuntime(ShardRuntimeOptions options = ShardRuntimeOptions());
+
+    ~ShardRuntime();
+
+    ShardRuntime(const ShardRuntime &) = delete;
+    ShardRuntime &operator=(const ShardRuntime &) = delete;
+
+    size_t size() const noexcept { return shards.size(); }
+
+    /**
+     * 当前线程若是本运行时的分片线程，返回分片下标，否则返回 -1
+     */
+    int32_t currentShard() const noexcept;
+
+    const topology::CpuInfo &cpuOf(size_t shard) const noexcept;
+
+    EventLoop &loop(size_t shard) noexcept;
+
+    /**
+     * 分片自己的内存池（unsynchronized_pool_resource），只能在该分片线程上使用
+     */
+    std::pmr::memory_resource *resource(size_t shard) noexcept;
+
+    /**
+     * 在 shard 上执行 fn，返回值语义与 Executor::submit 相同
+     *
+     * @return 信箱和溢出队列都满、或运行时已停止时返回已失败的 Future（Err::QUEUE_FULL）
+     */
+    template <typename F> Future<detail::FutureValueOf<std::decay_t<F>>> submit_to(size_t shard, F &&fn) {
+        using Fn = std::decay_t<F>;
+        using T = detail::FutureValueOf<Fn>;
+        auto task = new detail::FutureTask<T, Fn>(Fn(std::forward<F>(fn)));
+        if (!deliver(shard, task)) {
+            task->complete(Ret<T>::with(EGrp::INTERNAL, Err::QUEUE_FULL));
+            task->release();
+        }
+        return Future<T>(task);
+    }
+
+    /**
+     * 在 shard 上执行 fn，不需要结果
+     *
+     * @return 信箱和溢出队列都满、或运行时已停止时返回 false，fn 不会执行
+     */
+    template <typename F> bool post_to(size_t shard, F &&fn) {
+        using Fn = std::decay_t<F>;
+        auto task = new detail::FunctionTask<Fn>(Fn(std::forward<F>(fn)));
+        if (!deliver(shard, task)) {
+            delete task;
+            return false;
+        }
+        return true;
+    }
+
+    /**
+     * 在分片线程上处理一条信箱（或溢出队列）消息，没有消息时返回 false；用于信箱满时的退避
+     */
+    bool pollOnce() noexcept;
+
+    /**
+     * 停止所有分片并回收线程，可重复调用
+     */
+    void stop();
+
+  private:
+    class Shard;
+
+    std::vector<std::unique_ptr<Shard>> shards;
+    std::atomic<bool> stopping{false};
+    // 已通过 stopping 检查、尚未投递完成的 deliver 调用数，stop 等它归零后再做最后的清理
+    std::atomic<uint32_t> inflight{0};
+
+    bool deliver(size_t shard, Task *task);
+};
+
+RHINO_INLINE_NAMESPACE_END
+} // namespace rhino
@@ -0,0 +1,231 @@
+#include "runtime/TimerWheel.h"
+
+#include <thread>
+
+namespace rhino {
+RHINO_INLINE_NAMESPACE_BEGIN
+
+TimerNode::~TimerNode() {
+    TimerWheel *wheel = owner.load(std::memory_order_acquire);
+    if (wheel != nullptr) {
+        wheel->cancel(*this);
+    }
+}
+
+TimerWheel::TimerWheel(uint64_t startTick, uint32_t id)
+    : current(startTick), wheelId(id), slots(new Slot[LEVELS * SLOTS]) {
+    for (uint32_t i = 0; i < LEVELS * SLOTS; i++) {
+        TimerNode &head = slots[i].head;
+        head.prev = head.next = &head;
+    }
+}
+
+TimerWheel::~TimerWheel() {
+    // 时间轮先于节点销毁时，把节点都摘下来，避免节点析构时访问已释放的时间轮
+    for (uint32_t i = 0; i < LEVELS * SLOTS; i++) {
+        TimerNode &head = slots[i].head;
+        for (TimerNode *node = head.next; node != &head;) {
+            TimerNode *next = node->next;
+            node->prev = node->next = nullptr;
+            node->owner.store(nullptr, std::memory_order_release);
+            node = next;
+        }
+        head.prev = head.next = nullptr;
+    }
+}
+
+void TimerWheel::schedule(TimerNode &node, uint64_t expireTick) noexcept {
+    TimerWheel *old = node.owner.load(std::memory_order_relaxed);
+    if (old != nullptr) {
+        old->cancel(node);
+    }
+    node.expire = expireTick <= current ? current + 1 : expireTick;
+    node.owner.store(this, std::memory_order_release);
+    link(node);
+    count++;
+}
+
+bool TimerWheel::cancel(TimerNode &node) noexcept {
+    if (node.owner.load(std::memory_order_relaxed) != this) {
+        return false;
+    }
+    unlink(node);
+    node.owner.store(nullptr, std::memory_order_release);
+    count--;
+    return true;
+}
+
+void TimerWheel::link(TimerNode &node) noexcept {
+    // 与下一个待处理 tick 的距离决定层级：第 k 层容纳距离在 [64^k, 64^(k+1)) 内的节点
+    const uint64_t next = current + 1;
+    uint64_t delta = node.expire - next;
+    uint64_t expire = node.expire;
+    if (delta > MAX_DELTA) {
+        delta = MAX_DELTA;
+        expire = next + MAX_DELTA;
+    }
+    uint32_t level = 0;
+    while (level + 1 < LEVELS && delta >= (uint64_t(1) << (SLOT_BITS * (level + 1)))) {
+        level++;
+    }
+    const auto idx = static_cast<uint32_t>((expire >> (SLOT_BITS * level)) & (SLOTS - 1));
+    TimerNode &head = slotAt(level, idx).head;
+    node.prev = head.prev;
+    node.next = &head;
+    head.prev->next = &node;
+    head.prev = &node;
+    occupied[level] |= uint64_t(1) << idx;
+}
+
+void TimerWheel::unlink(TimerNode &node) noexcept {
+    TimerNode *prev = node.prev;
+    TimerNode *next = node.next;
+    prev->next = next;
+    next->prev = prev;
+    node.prev = node.next = nullptr;
+    // 槽变空时清除位图：槽头是自己的前驱和后继
+    if (prev == next) {
+        const auto offset = static_cast<size_t>(reinterpret_cast<char *>(prev) -
+                                                reinterpret_cast<char *>(slots.get())) / sizeof(Slot);
+        if (offset < LEVELS * SLOTS) {
+            occupied[offset / SLOTS] &= ~(uint64_t(1) << (offset % SLOTS));
+        }
+    }
+}
+
+void TimerWheel::cascade(uint64_t tick) noexcept {
+    // tick 是 64 的整数倍：把第 1 层对应的槽重新分配到第 0 层，若第 1 层也转了一圈则继续处理第 2 层
+    for (uint32_t level = 1; level < LEVELS; level++) {
+        const auto idx = static_cast<uint32_t>((tick >> (SLOT_BITS * level)) & (SLOTS - 1));
+        if (occupied[level] & (uint64_t(1) << idx)) {
+            TimerNode &head = slotAt(level, idx).head;
+            TimerNode *node = head.next;
+            head.prev = head.next = &head;
+            occupied[level] &= ~(uint64_t(1) << idx);
+            // 调用时 current == tick - 1，节点按与 tick 的距离重新分配到下层
+            while (node != &head) {
+                TimerNode *next = node->next;
+                link(*node);
+                node = next;
+            }
+        }
+        if (idx != 0) {
+            break;
+        }
+    }
+}
+
+uint64_t TimerWheel::nextCascade() const noexcept {
+    // 第 0 层为空时，下一个有事可做的 tick 是某个高层非空槽被重新分配的时刻：
+    // 第 k 层的槽 m & 63 在 tick = m * 64^k 时重新分配，m 取 current 之后第一个对应槽非空的值
+    uint64_t earliest = UINT64_MAX;
+    for (uint32_t level = 1; level < LEVELS; level++) {
+        if (occupied[level] == 0) {
+            continue;
+        }
+        const uint32_t shift = SLOT_BITS * level;
+        const uint64_t m0 = (current >> shift) + 1;
+        const auto i0 = static_cast<uint32_t>(m0 & (SLOTS - 1));
+        const uint64_t bits = occupied[level];
+        const uint64_t rotated = i0 == 0 ? bits : (bits >> i0) | (bits << (SLOTS - i0));
+        const uint64_t tick = (m0 + static_cast<uint64_t>(__builtin_ctzll(rotated))) << shift;
+        if (tick < earliest) {
+            earliest = tick;
+        }
+    }
+    return earliest;
+}
+
+bool TimerWheel::takeSlot(uint32_t idx, std::vector<TimerNode *> &out) {
+    if ((occupied[0] & (uint64_t(1) << idx)) == 0) {
+        return false;
+    }
+    TimerNode &head = slotAt(0, idx).head;
+    for (TimerNode *node = head.next; node != &head;) {
+        TimerNode *next = node->next;
+        node->prev = node->next = nullptr;
+        node->owner.store(nullptr, std::memory_order_release);
+        out.push_back(node);
+        node = next;
+    }
+    head.prev = head.next = &head;
+    occupied[0] &= ~(uint64_t(1) << idx);
+    count -= out.size();
+    return true;
+}
+
+uint64_t TimerWheel::ticksUntilNext(uint64_t limit) const noexcept {
+    if (count == 0) {
+        return limit;
+    }
+    const uint64_t next = current + 1;
+    const auto idx = static_cast<uint32_t>(next & (SLOTS - 1));
+    uint64_t ticks;
+    const uint64_t rest = occupied[0] >> idx;
+    if (rest != 0) {
+        ticks = static_cast<uint64_t>(__builtin_ctzll(rest)) + 1;
+    } else if (occupied[0] != 0) {
+        // 第 0 层本轮剩余的槽为空，下一轮开始时（64 的整数倍）需要处理
+        ticks = SLOTS - idx + 1;
+    } else {
+        ticks = nextCascade() - current;
+    }
+    return ticks < limit ? ticks : limit;
+}
+
+TscTickSource::TscTickSource(uint64_t tickNs) : baseTsc(rdtsc()), tickNanos(tickNs == 0 ? 1 : tickNs) {
+    // 借用 calc_time_nano 缓存的校准结果换算每个 TSC 计数的纳秒数，校准失败时 rdtsc 本身就是纳秒
+    constexpr uint64_t SAMPLE = uint64_t(1) << 32;
+    const double nsPerTsc = static_cast<double>(calc_time_nano(0, SAMPLE)) / static_cast<double>(SAMPLE);
+    ticksPerTsc = nsPerTsc / static_cast<double>(tickNanos);
+}
+
+ShardedTimerWheel::ShardedTimerWheel(size_t shardCount, uint64_t startTick) {
+    if (shardCount == 0) {
+        shardCount = std::max(1U, std::thread::hardware_concurrency());
+    }
+    shards.reserve(shardCount);
+    for (size_t i = 0; i < shardCount; i++) {
+        shards.push_back(std::make_unique<Shard>(startTick, static_cast<uint32_t>(i)));
+    }
+}
+
+size_t ShardedTimerWheel::currentShard() const noexcept {
+    static std::atomic<size_t> nextThread{0};
+    static thread_local size_t threadIndex = nextThread.fetch_add(1, std::memory_order_relaxed);
+    return threadIndex % shards.size();
+}
+
+void ShardedTimerWheel::schedule(size_t shard, TimerNode &node, uint64_t expireTick) {
+    // 节点挂在其他分片上时先取消，不能在持有本分片锁时去拿其他分片的锁
+    TimerWheel *old = node.owner.load(std::memory_order_acquire);
+    if (old != nullptr && old->id() != shard) {
+        cancel(node);
+    }
+    Shard &s = *shards[shard];
+    std::lock_guard<SpinMutex> lock(s.mtx);
+    s.wheel.schedule(node, expireTick);
+}
+
+bool ShardedTimerWheel::cancel(TimerNode &node) {
+    TimerWheel *wheel = node.owner.load(std::memory_order_acquire);
+    if (wheel == nullptr) {
+        return false;
+    }
+    Shard &s = *shards[wheel->id()];
+    std::lock_guard<SpinMutex> lock(s.mtx);
+    // 拿到锁之前节点可能已经到期或被重新调度到其他分片，cancel 内部会再次检查
+    return s.wheel.cancel(node);
+}
+
+size_t ShardedTimerWheel::size() const {
+    size_t total = 0;
+    for (const auto &s : shards) {
+        std::lock_guard<SpinMutex> lock(s->mtx);
+        total += s->wheel.size();
+    }
+    return total;
+}
+
+RHINO_INLINE_NAMESPACE_END
+} // namespace rhino
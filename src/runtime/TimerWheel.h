@@ -0,0 +1,323 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+#include "common/Version.h"
+#include "util/CpuUtil.hpp"
+#include "util/MeasureUtil.hpp"
+#include "util/SpinMutex.hpp"
+
+namespace rhino {
+RHINO_INLINE_NAMESPACE_BEGIN
+
+class TimerWheel;
+class ShardedTimerWheel;
+
+/**
+ * 侵入式定时器节点，嵌入到业务对象中（请求、会话等），调度和取消都不分配内存
+ *
+ * 节点析构时会自动从 TimerWheel 上摘除；同一个节点同一时刻只能挂在一个时间轮上，
+ * 也不能被多个线程同时调度。挂在 ShardedTimerWheel 上的节点析构前需要先调用其 cancel。
+ */
+class TimerNode {
+
+    friend class TimerWheel;
+    friend class ShardedTimerWheel;
+
+    TimerNode *prev = nullptr;
+    TimerNode *next = nullptr;
+    // 分片模式下取消操作需要在不持锁的情况下读取所属时间轮，所以用原子变量
+    std::atomic<TimerWheel *> owner{nullptr};
+    uint64_t expire = 0;
+
+  public:
+    TimerNode() = default;
+    TimerNode(const TimerNode &) = delete;
+    TimerNode &operator=(const TimerNode &) = delete;
+
+    virtual ~TimerNode();
+
+    /**
+     * 到期回调，调用前节点已经从时间轮上摘除，回调中可以重新调度或销毁自己
+     */
+    virtual void onExpire() noexcept {}
+
+    bool scheduled() const noexcept { return owner.load(std::memory_order_acquire) != nullptr; }
+
+    uint64_t expireTick() const noexcept { return expire; }
+};
+
+/**
+ * 回调为可调用对象的定时器
+ */
+template <typename F> class FunctionTimer final : public TimerNode {
+    F fn;
+
+  public:
+    explicit FunctionTimer(F fn) : fn(std::move(fn)) {}
+
+    void onExpire() noexcept override { fn(*this); }
+};
+
+/**
+ * 分层哈希时间轮（Varghese & Lauck），非线程安全
+ *
+ * - LEVELS 层，每层 64 个槽，第 k 层每个槽覆盖 64^k 个 tick，总范围 2^36 个 tick
+ * - 调度、取消 O(1)：节点挂在槽的双向链表上
+ * - 推进时逐 tick 处理第 0 层的槽，跨过 64 的整数倍时把上一层对应槽的节点重新分配到下层
+ * - 每层用一个 64 位位图记录非空槽，大段空闲的 tick 可以直接跳到下一个非空槽
+ *
+ * tick 的时间含义由调用方决定，通常配合 TscTickSource 使用
+ */
+class TimerWheel {
+
+  public:
+    static constexpr uint32_t SLOT_BITS = 6;
+    static constexpr uint32_t SLOTS = 1U << SLOT_BITS;
+    static constexpr uint32_t LEVELS = 6;
+    // 超出范围的定时器先挂在最高层，重新分配时再计算位置
+    static constexpr uint64_t MAX_DELTA = (uint64_t(1) << (SLOT_BITS * LEVELS)) - 1;
+
+    /**
+     * @param startTick 起始 tick，now() 的初值
+     * @param id 标识，分片模式下是分片下标
+     */
+    explicit TimerWheel(uint64_t startTick = 0, uint32_t id = 0);
+
+    ~TimerWheel();
+
+    TimerWheel(const TimerWheel &) = delete;
+    TimerWheel &operator=(const TimerWheel &) = delete;
+
+    /**
+     * 在 expireTick 到期，已到期的时间（<= now()）会在下一次推进时触发
+     * 节点已经调度过时先取消再重新调度
+     */
+    void schedule(TimerNode &node, uint64_t expireTick) noexcept;
+
+    void scheduleAfter(TimerNode &node, uint64_t delayTicks) noexcept {
+        schedule(node, current + delayTicks);
+    }
+
+    /**
+     * @return 节点挂在本时间轮上并被摘除时返回 true，已经触发或从未调度返回 false
+     */
+    bool cancel(TimerNode &node) noexcept;
+
+    /**
+     * 推进到 tick（包含），依次触发到期节点的 onExpire()
+     *
+     * @return 触发的节点数
+     */
+    size_t advance(uint64_t tick) {
+        return advance(tick, [](TimerNode *const *nodes, size_t count) {
+            for (size_t i = 0; i < count; i++) {
+                nodes[i]->onExpire();
+            }
+        });
+    }
+
+    /**
+     * 推进到 tick（包含），同一个 tick 到期的节点作为一批交给 batch(TimerNode *const *nodes, size_t count)
+     *
+     * 交给 batch 时节点已经摘除，batch 中可以重新调度，已到期的时间会落到下一个 tick
+     */
+    template <typename F> size_t advance(uint64_t tick, F &&batch) {
+        size_t fired = 0;
+        while (current < tick) {
+            if (count == 0) {
+                current = tick;
+                break;
+            }
+            const uint64_t t = current + 1;
+            const uint32_t idx = static_cast<uint32_t>(t & (SLOTS - 1));
+            if (occupied[0] == 0) {
+                // 第 0 层为空，直接跳到下一次有节点需要重新分配的 tick 之前
+                const uint64_t target = nextCascade();
+                if (target - 1 > current) {
+                    current = target - 1 < tick ? target - 1 : tick;
+                    continue;
+                }
+            }
+            if (idx == 0) {
+                cascade(t);
+            } else if (occupied[0] >> idx == 0) {
+                // 第 0 层本轮剩余的槽都是空的，直接跳到下一个 64 的整数倍之前
+                const uint64_t boundary = (t | (SLOTS - 1));
+                current = boundary < tick ? boundary : tick;
+                continue;
+            }
+            current = t;
+            if (!takeSlot(idx, expired)) {
+                continue;
+            }
+            fired += expired.size();
+            batch(expired.data(), expired.size());
+            expired.clear();
+        }
+        return fired;
+    }
+
+    /**
+     * 距下一次可能有定时器到期的 tick 数（保守估计，可能提前），没有定时器时返回 limit
+     * 用于计算 epoll_wait 之类的等待时间
+     */
+    uint64_t ticksUntilNext(uint64_t limit) const noexcept;
+
+    /**
+     * 已经处理到的 tick
+     */
+    uint64_t now() const noexcept { return current; }
+
+    size_t size() const noexcept { return count; }
+
+    bool empty() const noexcept { return count == 0; }
+
+    uint32_t id() const noexcept { return wheelId; }
+
+  private:
+    struct Slot {
+        TimerNode head;
+    };
+
+    uint64_t current;
+    size_t count = 0;
+    uint32_t wheelId;
+    uint64_t occupied[LEVELS] = {};
+    std::unique_ptr<Slot[]> slots;
+    std::vector<TimerNode *> expired;
+
+    Slot &slotAt(uint32_t level, uint32_t idx) noexcept { return slots[level * SLOTS + idx]; }
+
+    void link(TimerNode &node) noexcept;
+
+    void unlink(TimerNode &node) noexcept;
+
+    void cascade(uint64_t tick) noexcept;
+
+    uint64_t nextCascade() const noexcept;
+
+    bool takeSlot(uint32_t idx, std::vector<TimerNode *> &out);
+};
+
+/**
+ * 基于 TSC 的 tick 源，单次读取只需要一条 rdtsc 和一次乘法
+ */
+class TscTickSource {
+
+    uint64_t baseTsc;
+    uint64_t tickNanos;
+    double ticksPerTsc;
+
+  public:
+    /**
+     * @param tickNs 每个 tick 的纳秒数，默认 1ms
+     */
+    explicit TscTickSource(uint64_t tickNs = 1000000);
+
+    uint64_t now() const noexcept {
+        return static_cast<uint64_t>(static_cast<double>(rdtsc() - baseTsc) * ticksPerTsc);
+    }
+
+    uint64_t tickNs() const noexcept { return tickNanos; }
+
+    /**
+     * 时长换算为 tick 数（向上取整，保证不会提前到期）
+     */
+    uint64_t toTicks(std::chrono::nanoseconds duration) const noexcept {
+        const auto ns = static_cast<uint64_t>(duration.count() < 0 ? 0 : duration.count());
+        return (ns + tickNanos - 1) / tickNanos;
+    }
+};
+
+/**
+ * 分片时间轮：每个分片一个 TimerWheel + SpinMutex，线程默认使用固定的分片（通常每个核一个），
+ * 调度几乎不会竞争；每个分片由各自的线程推进，也可以由一个线程统一推进
+ *
+ * 到期回调在锁外执行，所以 cancel 返回 false 时回调可能正在执行
+ */
+class ShardedTimerWheel {
+
+  public:
+    /**
+     * @param shards 分片数，0 表示 std::thread::hardware_concurrency()
+     */
+    explicit ShardedTimerWheel(size_t shards = 0, uint64_t startTick = 0);
+
+    size_t shardCount() const noexcept { return shards.size(); }
+
+    /**
+     * 当前线程默认使用的分片：线程首次使用时按轮转分配
+     */
+    size_t currentShard() const noexcept;
+
+    void schedule(TimerNode &node, uint64_t expireTick) { schedule(currentShard(), node, expireTick); }
+
+    void schedule(size_t shard, TimerNode &node, uint64_t expireTick);
+
+    bool cancel(TimerNode &node);
+
+    /**
+     * 推进指定分片到 tick，触发到期节点的 onExpire()
+     */
+    size_t advance(size_t shard, uint64_t tick) {
+        return advance(shard, tick, [](TimerNode *const *nodes, size_t count) {
+            for (size_t i = 0; i < count; i++) {
+                nodes[i]->onExpire();
+            }
+        });
+    }
+
+    /**
+     * 推进指定分片到 tick：持锁收集到期节点，释放锁后整批交给 batch
+     */
+    template <typename F> size_t advance(size_t shard, uint64_t tick, F &&batch) {
+        Shard &s = *shards[shard];
+        {
+            std::lock_guard<SpinMutex> lock(s.mtx);
+            s.wheel.advance(tick, [&s](TimerNode *const *nodes, size_t count) {
+                s.pending.insert(s.pending.end(), nodes, nodes + count);
+            });
+        }
+        const size_t fired = s.pending.size();
+        if (fired > 0) {
+            batch(s.pending.data(), fired);
+            s.pending.clear();
+        }
+        return fired;
+    }
+
+    /**
+     * 依次推进所有分片
+     */
+    size_t advanceAll(uint64_t tick) {
+        size_t fired = 0;
+        for (size_t i = 0; i < shards.size(); i++) {
+            fired += advance(i, tick);
+        }
+        return fired;
+    }
+
+    size_t size() const;
+
+  private:
+    struct alignas(CACHE_LINE_SIZE) Shard {
+        mutable SpinMutex mtx;
+        TimerWheel wheel;
+        // 只由推进该分片的线程访问
+        std::vector<TimerNode *> pending;
+
+        Shard(uint64_t startTick, uint32_t id) : wheel(startTick, id) {}
+    };
+
+    std::vector<std::unique_ptr<Shard>> shards;
+};
+
+RHINO_INLINE_NAMESPACE_END
+} // namespace rhino
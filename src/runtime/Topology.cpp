@@ -0,0 +1,364 @@
+#include "runtime/Topology.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <climits>
+#include <cstring>
+#include <dirent.h>
+#include <fstream>
+#include <pthread.h>
+#include <sched.h>
+#include <set>
+#include <sstream>
+#include <sys/syscall.h>
+#include <thread>
+#include <tuple>
+#include <unistd.h>
+#include <utility>
+
+namespace rhino {
+RHINO_INLINE_NAMESPACE_BEGIN
+
+namespace topology {
+
+namespace {
+
+bool readFile(const std::string &path, std::string &out) {
+    std::ifstream in(path);
+    if (!in) {
+        return false;
+    }
+    std::getline(in, out);
+    return true;
+}
+
+int32_t readInt(const std::string &path, int32_t fallback) {
+    std::string text;
+    if (!readFile(path, text)) {
+        return fallback;
+    }
+    try {
+        return std::stoi(text);
+    } catch (const std::exception &) {
+        return fallback;
+    }
+}
+
+// cpuN 目录下的 nodeM 链接给出所属 NUMA 节点
+int32_t nodeOf(const std::string &cpuDir) {
+    DIR *dir = opendir(cpuDir.c_str());
+    if (dir == nullptr) {
+        return 0;
+    }
+    int32_t node = 0;
+    while (dirent *entry = readdir(dir)) {
+        const std::string name = entry->d_name;
+        if (name.size() > 4 && name.compare(0, 4, "node") == 0 &&
+            std::all_of(name.begin() + 4, name.end(), [](char c) { return c >= '0' && c <= '9'; })) {
+            node = std::stoi(name.substr(4));
+            break;
+        }
+    }
+    closedir(dir);
+    return node;
+}
+
+// cache/indexN 中 level 为 3 的那一项给出共享 L3 的 CPU 列表
+int32_t l3Of(const std::string &cpuDir, int32_t fallback) {
+    for (int32_t i = 0; i < 16; i++) {
+        const std::string index = cpuDir + "/cache/index" + std::to_string(i);
+        if (readInt(index + "/level", -1) != 3) {
+            continue;
+        }
+        std::string shared;
+        if (readFile(index + "/shared_cpu_list", shared)) {
+            auto list = parseCpuList(shared);
+            if (!list.empty()) {
+                return list.front();
+            }
+        }
+    }
+    return fallback;
+}
+
+// set_mempolicy/mbind 的模式，<numaif.h> 属于 libnuma，这里直接走系统调用
+constexpr int32_t MPOL_DEFAULT_MODE = 0;
+constexpr int32_t MPOL_PREFERRED_MODE = 1;
+constexpr int32_t MPOL_BIND_MODE = 2;
+constexpr uint32_t MPOL_MF_MOVE_FLAG = 1U << 1;
+constexpr size_t MASK_BITS = sizeof(unsigned long) * CHAR_BIT;
+
+Ret<void *> failure(const char *call, int32_t error) {
+    return Ret<void *>::with(EGrp::INTERNAL, Err::IO_ERR, std::string(call) + ": " + std::strerror(error));
+}
+
+std::vector<unsigned long> nodeMask(int32_t node) {
+    std::vector<unsigned long> mask(static_cast<size_t>(node) / MASK_BITS + 1, 0);
+    mask[static_cast<size_t>(node) / MASK_BITS] |= 1UL << (static_cast<size_t>(node) % MASK_BITS);
+    return mask;
+}
+
+std::vector<int32_t> collect(const std::vector<CpuInfo> &cpus, int32_t cpu, bool (*same)(const CpuInfo &, const CpuInfo &)) {
+    std::vector<int32_t> result;
+    auto self = std::find_if(cpus.begin(), cpus.end(), [cpu](const CpuInfo &c) { return c.cpu == cpu; });
+    if (self == cpus.end()) {
+        return result;
+    }
+    for (const auto &c : cpus) {
+        if (same(*self, c)) {
+            result.push_back(c.cpu);
+        }
+    }
+    return result;
+}
+
+} // namespace
+
+std::vector<int32_t> parseCpuList(const std::string &text) {
+    std::vector<int32_t> cpus;
+    std::stringstream ss(text);
+    std::string part;
+    while (std::getline(ss, part, ',')) {
+        int32_t lo = 0;
+        int32_t hi = 0;
+        char dash = 0;
+        std::stringstream ps(part);
+        if (!(ps >> lo)) {
+            continue;
+        }
+        hi = lo;
+        if (ps >> dash && dash == '-' && !(ps >> hi)) {
+            continue;
+        }
+        for (int32_t c = lo; c <= hi; c++) {
+            cpus.push_back(c);
+        }
+    }
+    std::sort(cpus.begin(), cpus.end());
+    cpus.erase(std::unique(cpus.begin(), cpus.end()), cpus.end());
+    return cpus;
+}
+
+std::vector<CpuInfo> discover(const std::string &sysRoot) {
+    std::vector<CpuInfo> result;
+    std::string online;
+    if (readFile(sysRoot + "/online", online)) {
+        for (int32_t cpu : parseCpuList(online)) {
+            const std::string dir = sysRoot + "/cpu" + std::to_string(cpu);
+            CpuInfo info;
+            info.cpu = cpu;
+            info.core = readInt(dir + "/topology/core_id", cpu);
+            info.package = readInt(dir + "/topology/physical_package_id", 0);
+            info.node = nodeOf(dir);
+            info.l3 = l3Of(dir, info.package);
+            result.push_back(info);
+        }
+    }
+    if (result.empty()) {
+        const auto n = static_cast<int32_t>(std::max(1U, std::thread::hardware_concurrency()));
+        for (int32_t cpu = 0; cpu < n; cpu++) {
+            result.push_back(CpuInfo{cpu, cpu, 0, 0, 0});
+        }
+    }
+    return result;
+}
+
+size_t physicalCores(const std::vector<CpuInfo> &cpus) {
+    std::set<std::pair<int32_t, int32_t>> cores;
+    for (const auto &c : cpus) {
+        cores.emplace(c.package, c.core);
+    }
+    return cores.size();
+}
+
+size_t numaNodes(const std::vector<CpuInfo> &cpus) {
+    std::set<int32_t> nodes;
+    for (const auto &c : cpus) {
+        nodes.insert(c.node);
+    }
+    return nodes.size();
+}
+
+std::vector<int32_t> siblingsOf(const std::vector<CpuInfo> &cpus, int32_t cpu) {
+    return collect(cpus, cpu, [](const CpuInfo &a, const CpuInfo &b) { return a.package == b.package && a.core == b.core; });
+}
+
+std::vector<int32_t> l3DomainOf(const std::vector<CpuInfo> &cpus, int32_t cpu) {
+    return collect(cpus, cpu, [](const CpuInfo &a, const CpuInfo &b) { return a.l3 == b.l3; });
+}
+
+std::vector<int32_t> cpusOfNode(const std::vector<CpuInfo> &cpus, int32_t node) {
+    std::vector<int32_t> result;
+    for (const auto &c : cpus) {
+        if (c.node == node) {
+            result.push_back(c.cpu);
+        }
+    }
+    return result;
+}
+
+int32_t nodeOfCpu(const std::vector<CpuInfo> &cpus, int32_t cpu) {
+    for (const auto &c : cpus) {
+        if (c.cpu == cpu) {
+            return c.node;
+        }
+    }
+    return -1;
+}
+
+std::vector<CpuInfo> pickShardCpus(const std::vector<CpuInfo> &cpus, size_t count) {
+    // 按 (节点, package, 核, cpu) 排序后，第一轮取每个物理核的第一个逻辑 CPU，第二轮取兄弟，依此类推
+    std::vector<CpuInfo> sorted = cpus;
+    std::sort(sorted.begin(), sorted.end(), [](const CpuInfo &a, const CpuInfo &b) {
+        return std::tie(a.node, a.package, a.core, a.cpu) < std::tie(b.node, b.package, b.core, b.cpu);
+    });
+    std::vector<std::vector<CpuInfo>> rounds;
+    for (size_t i = 0; i < sorted.size();) {
+        size_t j = i;
+        while (j < sorted.size() && sorted[j].package == sorted[i].package && sorted[j].core == sorted[i].core &&
+               sorted[j].node == sorted[i].node) {
+            if (rounds.size() <= j - i) {
+                rounds.emplace_back();
+            }
+            rounds[j - i].push_back(sorted[j]);
+            j++;
+        }
+        i = j;
+    }
+    std::vector<CpuInfo> picked;
+    for (const auto &round : rounds) {
+        for (const auto &c : round) {
+            if (picked.size() == count) {
+                break;
+            }
+            picked.push_back(c);
+        }
+    }
+    // 分片比逻辑 CPU 还多时循环复用
+    for (size_t i = 0; picked.size() < count && !sorted.empty(); i++) {
+        picked.push_back(picked[i % sorted.size()]);
+    }
+    // 同一节点的分片相邻
+    std::stable_sort(picked.begin(), picked.end(),
+                     [](const CpuInfo &a, const CpuInfo &b) { return a.node < b.node; });
+    return picked;
+}
+
+bool parseSchedPolicy(const std::string &text, SchedPolicy &policy) {
+    std::string lower = text;
+    std::transform(lower.begin(), lower.end(), lower.begin(), [](unsigned char c) { return std::tolower(c); });
+    static const std::pair<const char *, SchedPolicy> NAMES[] = {
+        {"other", SchedPolicy::OTHER}, {"batch", SchedPolicy::BATCH}, {"idle", SchedPolicy::IDLE},
+        {"fifo", SchedPolicy::FIFO},   {"rr", SchedPolicy::RR},
+    };
+    for (const auto &[name, value] : NAMES) {
+        if (lower == name) {
+            policy = value;
+            return true;
+        }
+    }
+    return false;
+}
+
+Ret<void *> pinCurrentThread(int32_t cpu) { return pinCurrentThread(std::vector<int32_t>{cpu}); }
+
+Ret<void *> pinCurrentThread(const std::vector<int32_t> &cpus) {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (int32_t cpu : cpus) {
+        if (cpu < 0 || cpu >= CPU_SETSIZE) {
+            return failure("pthread_setaffinity_np", EINVAL);
+        }
+        CPU_SET(cpu, &set);
+    }
+    const int32_t rc = pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+    return rc == 0 ? Ret<void *>::with(nullptr) : failure("pthread_setaffinity_np", rc);
+}
+
+Ret<void *> nameCurrentThread(const std::string &name) {
+    // 内核限制线程名 16 字节（含结尾 0）
+    const std::string truncated = name.size() > 15 ? name.substr(name.size() - 15) : name;
+    const int32_t rc = pthread_setname_np(pthread_self(), truncated.c_str());
+    return rc == 0 ? Ret<void *>::with(nullptr) : failure("pthread_setname_np", rc);
+}
+
+Ret<void *> scheduleCurrentThread(SchedPolicy policy, int32_t priority) {
+    int32_t native = SCHED_OTHER;
+    switch (policy) {
+    case SchedPolicy::OTHER:
+        native = SCHED_OTHER;
+        break;
+    case SchedPolicy::BATCH:
+        native = SCHED_BATCH;
+        break;
+    case SchedPolicy::IDLE:
+        native = SCHED_IDLE;
+        break;
+    case SchedPolicy::FIFO:
+        native = SCHED_FIFO;
+        break;
+    case SchedPolicy::RR:
+        native = SCHED_RR;
+        break;
+    }
+    sched_param param{};
+    // 非实时策略的优先级必须为 0
+    param.sched_priority = (policy == SchedPolicy::FIFO || policy == SchedPolicy::RR) ? priority : 0;
+    const int32_t rc = pthread_setschedparam(pthread_self(), native, &param);
+    return rc == 0 ? Ret<void *>::with(nullptr) : failure("pthread_setschedparam", rc);
+}
+
+Ret<void *> bindCurrentThreadMemory(int32_t node, bool strict) {
+    long rc = 0;
+    if (node < 0) {
+        rc = syscall(SYS_set_mempolicy, MPOL_DEFAULT_MODE, nullptr, 0);
+    } else {
+        auto mask = nodeMask(node);
+        // 内核按 maxnode - 1 位读取掩码
+        rc = syscall(SYS_set_mempolicy, strict ? MPOL_BIND_MODE : MPOL_PREFERRED_MODE, mask.data(),
+                     mask.size() * MASK_BITS + 1);
+    }
+    return rc == 0 ? Ret<void *>::with(nullptr) : failure("set_mempolicy", errno);
+}
+
+Ret<void *> bindMemory(void *addr, size_t len, int32_t node, bool strict, bool move) {
+    if (node < 0) {
+        return failure("mbind", EINVAL);
+    }
+    auto mask = nodeMask(node);
+    const long rc = syscall(SYS_mbind, addr, len, strict ? MPOL_BIND_MODE : MPOL_PREFERRED_MODE, mask.data(),
+                            mask.size() * MASK_BITS + 1, move ? MPOL_MF_MOVE_FLAG : 0U);
+    return rc == 0 ? Ret<void *>::with(nullptr) : failure("mbind", errno);
+}
+
+Ret<void *> applyPlacement(const ThreadPlacement &placement) {
+    Ret<void *> first = Ret<void *>::with(nullptr);
+    auto keep = [&first](Ret<void *> ret) {
+        if (ret.failed() && !first.failed()) {
+            first = std::move(ret);
+        }
+    };
+    if (!placement.name.empty()) {
+        keep(nameCurrentThread(placement.name));
+    }
+    if (!placement.cpus.empty()) {
+        keep(pinCurrentThread(placement.cpus));
+    }
+    if (placement.policy != SchedPolicy::OTHER) {
+        keep(scheduleCurrentThread(placement.policy, placement.priority));
+    }
+    int32_t node = placement.memNode;
+    if (node == MEM_NODE_LOCAL && !placement.cpus.empty()) {
+        node = nodeOfCpu(discover(), placement.cpus.front());
+    }
+    if (node >= 0) {
+        keep(bindCurrentThreadMemory(node, placement.strictMemory));
+    }
+    return first;
+}
+
+} // namespace topology
+
+RHINO_INLINE_NAMESPACE_END
+} // namespace rhino
@@ -0,0 +1,165 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+#include "common/Errs.h"
+#include "common/Ret.h"
+#include "common/Version.h"
+
+namespace rhino {
+RHINO_INLINE_NAMESPACE_BEGIN
+
+namespace topology {
+
+// 一个逻辑 CPU（超线程）的位置
+struct CpuInfo {
+    int32_t cpu{};
+    // 物理核编号，只在同一个 package 内唯一
+    int32_t core{};
+    int32_t package{};
+    // NUMA 节点，非 NUMA 机器上为 0
+    int32_t node{};
+    // 共享 L3 的域，取共享该 L3 的最小 cpu 编号；读不到缓存信息时按 package 划分
+    int32_t l3{};
+};
+
+/**
+ * 解析 cpulist 格式（例如 "0-3,8,10-11"），格式错误的片段被忽略
+ */
+std::vector<int32_t> parseCpuList(const std::string &text);
+
+/**
+ * 从 sysfs 读取在线 CPU 的拓扑，按 cpu 编号排序；读取失败时按 hardware_concurrency 返回扁平拓扑
+ *
+ * @param sysRoot /sys/devices/system/cpu，测试时可以指向伪造的目录
+ */
+std::vector<CpuInfo> discover(const std::string &sysRoot = "/sys/devices/system/cpu");
+
+/**
+ * 为 count 个分片挑选 CPU：先每个物理核取一个逻辑 CPU，不够时再使用超线程兄弟；
+ * 结果按 NUMA 节点聚集，相邻分片尽量在同一个节点上
+ */
+std::vector<CpuInfo> pickShardCpus(const std::vector<CpuInfo> &cpus, size_t count);
+
+/**
+ * 物理核数量
+ */
+size_t physicalCores(const std::vector<CpuInfo> &cpus);
+
+/**
+ * NUMA 节点数量
+ */
+size_t numaNodes(const std::vector<CpuInfo> &cpus);
+
+/**
+ * 与 cpu 同一个物理核的逻辑 CPU（超线程兄弟），包含 cpu 自己
+ */
+std::vector<int32_t> siblingsOf(const std::vector<CpuInfo> &cpus, int32_t cpu);
+
+/**
+ * 与 cpu 共享 L3 的逻辑 CPU，包含 cpu 自己
+ */
+std::vector<int32_t> l3DomainOf(const std::vector<CpuInfo> &cpus, int32_t cpu);
+
+/**
+ * NUMA 节点 node 上的逻辑 CPU
+ */
+std::vector<int32_t> cpusOfNode(const std::vector<CpuInfo> &cpus, int32_t node);
+
+/**
+ * cpu 所在的 NUMA 节点，cpu 不在列表中时返回 -1
+ */
+int32_t nodeOfCpu(const std::vector<CpuInfo> &cpus, int32_t cpu);
+
+enum class SchedPolicy {
+    // SCHED_OTHER，默认的分时调度
+    OTHER,
+    // SCHED_BATCH，吞吐优先的后台线程
+    BATCH,
+    // SCHED_IDLE，只在 CPU 空闲时运行
+    IDLE,
+    // SCHED_FIFO / SCHED_RR 实时调度，需要 CAP_SYS_NICE
+    FIFO,
+    RR,
+};
+
+/**
+ * 解析调度策略名（other/batch/idle/fifo/rr，不区分大小写），无法识别时返回 false
+ */
+bool parseSchedPolicy(const std::string &text, SchedPolicy &policy);
+
+// 内存绑定到线程所在 CPU 的节点
+constexpr int32_t MEM_NODE_LOCAL = -2;
+// 不改变内存策略
+constexpr int32_t MEM_NODE_NONE = -1;
+
+// 线程的放置方式，所有字段的默认值都表示"不改变"
+struct ThreadPlacement {
+    // 线程名，超过 15 个字符时保留末尾 15 个（末尾通常是区分线程的编号）
+    std::string name;
+    // 允许运行的 CPU，空表示不绑核
+    std::vector<int32_t> cpus;
+    SchedPolicy policy = SchedPolicy::OTHER;
+    // 只对 FIFO/RR 有效，范围 1-99
+    int32_t priority = 0;
+    // 内存分配的 NUMA 节点：MEM_NODE_NONE 不改变，MEM_NODE_LOCAL 为 cpus[0] 所在节点，其他值为节点编号
+    int32_t memNode = MEM_NODE_NONE;
+    // true 时只能从 memNode 分配（MPOL_BIND），false 时优先 memNode、不够再用其他节点（MPOL_PREFERRED）
+    bool strictMemory = false;
+};
+
+/**
+ * 把当前线程绑定到一个或一组 CPU
+ *
+ * @return 失败时 Err::IO_ERR，msg 中带有系统错误信息
+ */
+Ret<void *> pinCurrentThread(int32_t cpu);
+
+Ret<void *> pinCurrentThread(const std::vector<int32_t> &cpus);
+
+/**
+ * 设置当前线程名，超过 15 个字符时保留末尾 15 个
+ */
+Ret<void *> nameCurrentThread(const std::string &name);
+
+/**
+ * 设置当前线程的调度策略，实时策略没有权限时失败
+ */
+Ret<void *> scheduleCurrentThread(SchedPolicy policy, int32_t priority = 0);
+
+/**
+ * 设置当前线程之后分配内存的 NUMA 策略（set_mempolicy），node 为 MEM_NODE_NONE 时恢复默认策略
+ *
+ * 只影响之后首次访问的页，已经分配的内存用 bindMemory 迁移
+ */
+Ret<void *> bindCurrentThreadMemory(int32_t node, bool strict = false);
+
+/**
+ * 把一段内存绑定到 NUMA 节点（mbind），addr 必须按页对齐；move 为 true 时迁移已经分配的页
+ */
+Ret<void *> bindMemory(void *addr, size_t len, int32_t node, bool strict = false, bool move = false);
+
+/**
+ * 对当前线程应用放置方式：依次设置线程名、绑核、调度策略、内存策略
+ *
+ * 某一步失败不影响后续步骤，返回第一个失败
+ */
+Ret<void *> applyPlacement(const ThreadPlacement &placement);
+
+/**
+ * 创建线程，线程函数开始执行之前应用放置方式（放置失败不会阻止线程运行）
+ */
+template <typename F> std::thread startThread(ThreadPlacement placement, F &&fn) {
+    return std::thread([placement = std::move(placement), fn = std::forward<F>(fn)]() mutable {
+        (void)applyPlacement(placement);
+        fn();
+    });
+}
+
+} // namespace topology
+
+RHINO_INLINE_NAMESPACE_END
+} // namespace rhino
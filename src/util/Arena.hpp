@@ -0,0 +1,194 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include "common/Version.h"
+
+namespace rhino {
+RHINO_INLINE_NAMESPACE_BEGIN
+
+/**
+ * 请求级的 bump-pointer 内存池，同时是一个 std::pmr::memory_resource
+ *
+ * - 分配只是指针前移，释放是空操作。只有最后一次分配可以原地收回，这只对后进先出的临时缓冲区有用；
+ *   vector/string 扩容时先分配新缓冲区再释放旧的，旧缓冲区不是最后一次分配，要等 reset() 才收回，
+ *   能预估大小时先 reserve()
+ * - reset() 把指针拨回第一个块，已申请的块全部保留给下一个请求复用，稳态下不再向 upstream 申请内存
+ * - 块不够时按 2 倍增长（上限 MAX_CHUNK_SIZE），超大的分配单独申请一个刚好够用的块
+ *
+ * 不是线程安全的：一个请求一个 Arena，或者每个线程一个 Arena 在请求之间 reset()。
+ * 用它分配的 pmr 容器不能活过 reset()，需要带出请求的结果（例如 Ret 中的错误信息）应使用普通的 std::string
+ *
+ *   Arena arena;
+ *   std::pmr::vector<std::pmr::string> fields = split(line, ",", &arena);
+ *   ...
+ *   arena.reset();
+ */
+class Arena final : public std::pmr::memory_resource {
+
+  public:
+    static constexpr size_t DEFAULT_CHUNK_SIZE = 4096;
+    static constexpr size_t MAX_CHUNK_SIZE = 1 << 20;
+
+    explicit Arena(size_t chunkSize = DEFAULT_CHUNK_SIZE,
+                   std::pmr::memory_resource *upstream = std::pmr::new_delete_resource()) noexcept
+        : nextSize(std::max(chunkSize, sizeof(Chunk) * 2)), upstream(upstream) {}
+
+    /**
+     * 先用调用方提供的缓冲区（例如栈上数组），用完再向 upstream 申请；缓冲区需要比 Arena 活得久
+     */
+    Arena(void *buffer, size_t size, std::pmr::memory_resource *upstream = std::pmr::new_delete_resource()) noexcept
+        : Arena(size * 2, upstream) {
+        if (buffer != nullptr && size > sizeof(Chunk) + alignof(std::max_align_t)) {
+            void *aligned = buffer;
+            size_t space = size;
+            std::align(alignof(Chunk), sizeof(Chunk), aligned, space);
+            head = new (aligned) Chunk{nullptr, space, false};
+            rewind(head);
+        }
+    }
+
+    ~Arena() override { release(); }
+
+    Arena(const Arena &) = delete;
+    Arena &operator=(const Arena &) = delete;
+
+    /**
+     * 回到第一个块重新分配，之前分配的内存全部失效，但块不归还 upstream
+     */
+    void reset() noexcept {
+        used = 0;
+        allocations = 0;
+        if (head != nullptr) {
+            rewind(head);
+        }
+    }
+
+    /**
+     * 把自己申请的块全部归还 upstream，调用方提供的缓冲区保留
+     */
+    void release() noexcept {
+        Chunk *keep = nullptr;
+        for (Chunk *c = head; c != nullptr;) {
+            Chunk *next = c->next;
+            if (c->owned) {
+                reserved -= c->size;
+                upstream->deallocate(c, c->size, alignof(std::max_align_t));
+            } else {
+                keep = c;
+            }
+            c = next;
+        }
+        head = keep;
+        if (head != nullptr) {
+            head->next = nullptr;
+        }
+        current = nullptr;
+        cursor = end = nullptr;
+        reset();
+    }
+
+    // 自上次 reset() 以来分配出去的字节数（不含对齐填充）
+    size_t bytesUsed() const noexcept { return used; }
+
+    // 向 upstream 申请、目前持有的字节数
+    size_t bytesReserved() const noexcept { return reserved; }
+
+    // 自上次 reset() 以来的分配次数
+    size_t allocationCount() const noexcept { return allocations; }
+
+    size_t chunkCount() const noexcept {
+        size_t n = 0;
+        for (const Chunk *c = head; c != nullptr; c = c->next) {
+            n++;
+        }
+        return n;
+    }
+
+  protected:
+    void *do_allocate(size_t bytes, size_t alignment) override {
+        void *p = bump(bytes, alignment);
+        if (p == nullptr) {
+            advance(bytes, alignment);
+            p = bump(bytes, alignment);
+        }
+        used += bytes;
+        allocations++;
+        return p;
+    }
+
+    void do_deallocate(void *p, size_t bytes, size_t) override {
+        // 只收回最后一次分配，其余的等 reset()
+        if (static_cast<char *>(p) + bytes == cursor) {
+            cursor = static_cast<char *>(p);
+            used -= bytes;
+        }
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override { return this == &other; }
+
+  private:
+    // 块头放在块的起始位置，块按申请顺序组成单链表
+    struct alignas(std::max_align_t) Chunk {
+        Chunk *next;
+        size_t size;
+        bool owned;
+    };
+
+    size_t nextSize;
+    std::pmr::memory_resource *upstream;
+    Chunk *head = nullptr;
+    Chunk *current = nullptr;
+    char *cursor = nullptr;
+    char *end = nullptr;
+    size_t used = 0;
+    size_t reserved = 0;
+    size_t allocations = 0;
+
+    void rewind(Chunk *chunk) noexcept {
+        current = chunk;
+        cursor = reinterpret_cast<char *>(chunk) + sizeof(Chunk);
+        end = reinterpret_cast<char *>(chunk) + chunk->size;
+    }
+
+    void *bump(size_t bytes, size_t alignment) noexcept {
+        if (cursor == nullptr) {
+            return nullptr;
+        }
+        const auto addr = reinterpret_cast<uintptr_t>(cursor);
+        const uintptr_t aligned = (addr + alignment - 1) & ~static_cast<uintptr_t>(alignment - 1);
+        if (aligned + bytes > reinterpret_cast<uintptr_t>(end)) {
+            return nullptr;
+        }
+        cursor = reinterpret_cast<char *>(aligned + bytes);
+        return reinterpret_cast<void *>(aligned);
+    }
+
+    // 切到下一个放得下的块：先复用 reset() 之前留下的块，不够再向 upstream 申请并接在当前块之后
+    void advance(size_t bytes, size_t alignment) {
+        const size_t need = sizeof(Chunk) + bytes + alignment;
+        Chunk *next = current == nullptr ? head : current->next;
+        while (next != nullptr && next->size < need) {
+            next = next->next;
+        }
+        if (next == nullptr) {
+            const size_t size = std::max(need, nextSize);
+            nextSize = std::min(nextSize * 2, MAX_CHUNK_SIZE);
+            next = new (upstream->allocate(size, alignof(std::max_align_t))) Chunk{nullptr, size, true};
+            reserved += size;
+            if (current == nullptr) {
+                next->next = head;
+                head = next;
+            } else {
+                next->next = current->next;
+                current->next = next;
+            }
+        }
+        rewind(next);
+    }
+};
+
+RHINO_INLINE_NAMESPACE_END
+} // namespace rhino
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <atomic>
+#include "common/Version.h"
+
+#if defined(__linux__)
+#include <linux/membarrier.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#if defined(__SANITIZE_THREAD__)
+#define RHINO_TSAN 1
+#elif defined(__has_feature)
+#if __has_feature(thread_sanitizer)
+#define RHINO_TSAN 1
+#endif
+#endif
+
+namespace rhino {
+RHINO_INLINE_NAMESPACE_BEGIN
+
+/**
+ * 非对称内存屏障：频繁的一侧只需要编译器屏障（lightFence），罕见的一侧用 membarrier 让所有运行中的线程
+ * 执行一次完整屏障（heavyFence），两者配对时等价于两侧都执行 seq_cst fence
+ *
+ * 内核不支持 membarrier（< 4.14）或在 TSan 下（TSan 不理解 membarrier，也不建模独立的 fence）时退化为
+ * 两侧都使用 seq_cst fence
+ */
+inline bool asymmetricFences() noexcept {
+#if defined(__linux__) && !defined(RHINO_TSAN)
+    static const bool enabled =
+        syscall(SYS_membarrier, MEMBARRIER_CMD_REGISTER_PRIVATE_EXPEDITED, 0, 0) == 0;
+    return enabled;
+#else
+    return false;
+#endif
+}
+
+inline void lightFence() noexcept {
+    if (asymmetricFences()) {
+        std::atomic_signal_fence(std::memory_order_seq_cst);
+    } else {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+    }
+}
+
+inline void heavyFence() noexcept {
+#if defined(__linux__) && !defined(RHINO_TSAN)
+    if (asymmetricFences()) {
+        syscall(SYS_membarrier, MEMBARRIER_CMD_PRIVATE_EXPEDITED, 0, 0);
+        return;
+    }
+#endif
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+}
+
+RHINO_INLINE_NAMESPACE_END
+} // namespace rhino
@@ -0,0 +1,695 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "common/Version.h"
+#include "util/CpuUtil.hpp"
+
+#if defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+namespace rhino {
+RHINO_INLINE_NAMESPACE_BEGIN
+
+namespace detail {
+
+/**
+ * 节点内查找：返回有序数组 keys[0, n) 中小于 x（OrEqual 时小于等于 x）的键的个数，即 lower_bound / upper_bound 的下标
+ */
+template <typename K, typename Less, typename = void> struct NodeSearch {
+    template <bool OrEqual> static size_t count(const K *keys, size_t n, const K &x, const Less &less) {
+        if constexpr (OrEqual) {
+            return static_cast<size_t>(std::upper_bound(keys, keys + n, x, less) - keys);
+        } else {
+            return static_cast<size_t>(std::lower_bound(keys, keys + n, x, less) - keys);
+        }
+    }
+};
+
+/**
+ * 32/64 位整数键：节点只有几个缓存行，整块 SIMD 比较后数比特，比二分少了难预测的分支
+ */
+template <typename K>
+struct NodeSearch<K, std::less<K>, std::enable_if_t<std::is_integral_v<K> && (sizeof(K) == 4 || sizeof(K) == 8)>> {
+    template <bool OrEqual> static size_t count(const K *keys, size_t n, K x, const std::less<K> &) {
+        size_t i = 0;
+        size_t c = 0;
+#if defined(__AVX2__)
+        if constexpr (sizeof(K) == 4) {
+            // 无符号数翻转符号位后按有符号比较
+            const __m256i bias = _mm256_set1_epi32(std::is_signed_v<K> ? 0 : INT32_MIN);
+            const __m256i vx = _mm256_xor_si256(_mm256_set1_epi32(static_cast<int32_t>(x)), bias);
+            for (; i + 8 <= n; i += 8) {
+                const __m256i vk =
+                    _mm256_xor_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(keys + i)), bias);
+                c += countLanes<OrEqual, 8>(_mm256_movemask_ps(
+                    _mm256_castsi256_ps(OrEqual ? _mm256_cmpgt_epi32(vk, vx) : _mm256_cmpgt_epi32(vx, vk))));
+            }
+        } else {
+            const __m256i bias = _mm256_set1_epi64x(std::is_signed_v<K> ? 0 : INT64_MIN);
+            const __m256i vx = _mm256_xor_si256(_mm256_set1_epi64x(static_cast<int64_t>(x)), bias);
+            for (; i + 4 <= n; i += 4) {
+                const __m256i vk =
+                    _mm256_xor_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(keys + i)), bias);
+                c += countLanes<OrEqual, 4>(_mm256_movemask_pd(
+                    _mm256_castsi256_pd(OrEqual ? _mm256_cmpgt_epi64(vk, vx) : _mm256_cmpgt_epi64(vx, vk))));
+            }
+        }
+#elif defined(__SSE2__)
+        if constexpr (sizeof(K) == 4) {
+            const __m128i bias = _mm_set1_epi32(std::is_signed_v<K> ? 0 : INT32_MIN);
+            const __m128i vx = _mm_xor_si128(_mm_set1_epi32(static_cast<int32_t>(x)), bias);
+            for (; i + 4 <= n; i += 4) {
+                const __m128i vk = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i *>(keys + i)), bias);
+                c += countLanes<OrEqual, 4>(
+                    _mm_movemask_ps(_mm_castsi128_ps(OrEqual ? _mm_cmpgt_epi32(vk, vx) : _mm_cmpgt_epi32(vx, vk))));
+            }
+        }
+#endif
+        // 剩余部分（以及没有 64 位比较指令时）用无分支的标量循环，编译器也能向量化
+        for (; i < n; i++) {
+            c += OrEqual ? !(x < keys[i]) : keys[i] < x;
+        }
+        return c;
+    }
+
+  private:
+    // cmpgt(vk, vx) 的掩码是大于 x 的键，OrEqual 时取反
+    template <bool OrEqual, int Lanes> static size_t countLanes(int mask) noexcept {
+        const auto bits = static_cast<size_t>(__builtin_popcount(static_cast<unsigned>(mask)));
+        return OrEqual ? Lanes - bits : bits;
+    }
+};
+
+} // namespace detail
+
+/**
+ * 缓存友好的 B+ 树有序表，替代热路径上的 std::map
+ *
+ * - 节点按 NodeBytes（默认 512 字节，8 个缓存行；也可以设成页大小）对齐分配，一个节点放下几十个键，
+ *   树高比红黑树低得多，一次查找只访问几个连续的内存块
+ * - 键和值分两个数组存放，节点内查找只扫键数组；std::less 比较的 32/64 位整数键用 SIMD 比较
+ * - 所有元素都在叶子上，叶子之间有链表，范围扫描是顺序读；forRange 直接遍历叶子数组
+ * - fromSorted 从已排序的输入自底向上批量构建，不经过逐个插入
+ *
+ * K 和 V 需要可默认构造（节点内是定长数组）。与 std::map 不同，插入和删除会在节点之间搬移元素，
+ * 迭代器和元素引用在任何修改之后都失效；迭代器是单向的，解引用得到 std::pair<const K &, V &>
+ */
+template <typename K, typename V, typename Less = std::less<K>, size_t NodeBytes = 512> class BTreeMap {
+
+    struct Node {
+        uint16_t count = 0;
+        bool leaf;
+
+        explicit Node(bool isLeaf) : leaf(isLeaf) {}
+    };
+
+    static constexpr size_t HEADER = sizeof(Node) < sizeof(void *) ? sizeof(void *) : sizeof(Node);
+
+  public:
+    // 叶子和内部节点能放下的键个数
+    static constexpr size_t LEAF_KEYS = std::max<size_t>(4, (NodeBytes - HEADER - 2 * sizeof(void *)) / (sizeof(K) + sizeof(V)));
+    static constexpr size_t INNER_KEYS = std::max<size_t>(4, (NodeBytes - HEADER - sizeof(void *)) / (sizeof(K) + sizeof(void *)));
+
+  private:
+    static_assert(LEAF_KEYS < 65536 && INNER_KEYS < 65536, "node too large");
+
+    static constexpr size_t MIN_LEAF = LEAF_KEYS / 2;
+    static constexpr size_t MIN_INNER = (INNER_KEYS - 1) / 2;
+
+    struct alignas(CACHE_LINE_SIZE) Leaf : Node {
+        Leaf *prev = nullptr;
+        Leaf *next = nullptr;
+        K keys[LEAF_KEYS];
+        V values[LEAF_KEYS];
+
+        Leaf() : Node(true) {}
+    };
+
+    // children[i] 中的键都小于 keys[i]，children[i + 1] 中的键都不小于 keys[i]
+    struct alignas(CACHE_LINE_SIZE) Inner : Node {
+        K keys[INNER_KEYS];
+        Node *children[INNER_KEYS + 1];
+
+        Inner() : Node(false) {}
+    };
+
+    using Search = detail::NodeSearch<K, Less>;
+
+  public:
+    template <bool Const> class Iter {
+        friend class BTreeMap;
+        template <bool> friend class Iter;
+        using LeafPtr = std::conditional_t<Const, const Leaf *, Leaf *>;
+        using ValueRef = std::conditional_t<Const, const V &, V &>;
+
+      public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = std::pair<const K, V>;
+        using difference_type = std::ptrdiff_t;
+        using reference = std::pair<const K &, ValueRef>;
+
+        struct pointer {
+            reference ref;
+            const reference *operator->() const noexcept { return &ref; }
+        };
+
+        Iter() noexcept = default;
+
+        // iterator 可以转换为 const_iterator
+        template <bool C = Const, typename = std::enable_if_t<C>>
+        Iter(const Iter<false> &other) noexcept : leaf(other.leaf), index(other.index) {}
+
+        const K &key() const noexcept { return leaf->keys[index]; }
+
+        ValueRef value() const noexcept { return leaf->values[index]; }
+
+        reference operator*() const noexcept { return {leaf->keys[index], leaf->values[index]}; }
+
+        pointer operator->() const noexcept { return {**this}; }
+
+        Iter &operator++() noexcept {
+            if (++index == leaf->count) {
+                leaf = leaf->next;
+                index = 0;
+            }
+            return *this;
+        }
+
+        Iter operator++(int) noexcept {
+            Iter old = *this;
+            ++*this;
+            return old;
+        }
+
+        bool operator==(const Iter &o) const noexcept { return leaf == o.leaf && index == o.index; }
+
+        bool operator!=(const Iter &o) const noexcept { return !(*this == o); }
+
+      private:
+        LeafPtr leaf = nullptr;
+        size_t index = 0;
+
+        Iter(LeafPtr l, size_t i) noexcept : leaf(l), index(i) {
+            // 落在叶子末尾时移到下一个叶子的开头，end() 是 {nullptr, 0}
+            if (leaf != nullptr && index == leaf->count) {
+                leaf = leaf->next;
+                index = 0;
+            }
+        }
+    };
+
+    using iterator = Iter<false>;
+    using const_iterator = Iter<true>;
+
+    BTreeMap() = default;
+
+    BTreeMap(const BTreeMap &other) {
+        std::vector<std::pair<K, V>> items;
+        items.reserve(other.size());
+        for (auto [k, v] : other) {
+            items.emplace_back(k, v);
+        }
+        build(items.begin(), items.end());
+    }
+
+    BTreeMap(BTreeMap &&other) noexcept { swap(other); }
+
+    BTreeMap &operator=(BTreeMap other) noexcept {
+        swap(other);
+        return *this;
+    }
+
+    ~BTreeMap() { clear(); }
+
+    void swap(BTreeMap &other) noexcept {
+        std::swap(root, other.root);
+        std::swap(head, other.head);
+        std::swap(count, other.count);
+        std::swap(leafCount, other.leafCount);
+        std::swap(innerCount, other.innerCount);
+        std::swap(less, other.less);
+    }
+
+    /**
+     * 从按键严格升序的 [first, last)（元素为 pair<K, V>）批量构建，键不是严格升序时抛 std::invalid_argument
+     */
+    template <typename It> static BTreeMap fromSorted(It first, It last) {
+        BTreeMap map;
+        map.build(first, last);
+        return map;
+    }
+
+    size_t size() const noexcept { return count; }
+
+    bool empty() const noexcept { return count == 0; }
+
+    // 根到叶子的层数，空树为 0
+    size_t height() const noexcept {
+        size_t h = 0;
+        for (const Node *n = root; n != nullptr; n = n->leaf ? nullptr : static_cast<const Inner *>(n)->children[0]) {
+            h++;
+        }
+        return h;
+    }
+
+    // 所有节点占用的字节数
+    size_t memoryBytes() const noexcept { return sizeof(*this) + leafCount * sizeof(Leaf) + innerCount * sizeof(Inner); }
+
+    iterator begin() noexcept { return iterator(head, 0); }
+    iterator end() noexcept { return iterator(); }
+    const_iterator begin() const noexcept { return const_iterator(head, 0); }
+    const_iterator end() const noexcept { return const_iterator(); }
+
+    iterator find(const K &key) {
+        auto [leaf, i] = locate<false>(key);
+        return leaf != nullptr && i < leaf->count && !less(key, leaf->keys[i]) ? iterator(leaf, i) : end();
+    }
+
+    const_iterator find(const K &key) const { return const_cast<BTreeMap *>(this)->find(key); }
+
+    // 找不到时返回 nullptr
+    V *get(const K &key) {
+        auto it = find(key);
+        return it == end() ? nullptr : &it.value();
+    }
+
+    const V *get(const K &key) const { return const_cast<BTreeMap *>(this)->get(key); }
+
+    bool contains(const K &key) const { return find(key) != end(); }
+
+    iterator lowerBound(const K &key) {
+        auto [leaf, i] = locate<false>(key);
+        return iterator(leaf, i);
+    }
+
+    const_iterator lowerBound(const K &key) const { return const_cast<BTreeMap *>(this)->lowerBound(key); }
+
+    iterator upperBound(const K &key) {
+        auto [leaf, i] = locate<true>(key);
+        return iterator(leaf, i);
+    }
+
+    const_iterator upperBound(const K &key) const { return const_cast<BTreeMap *>(this)->upperBound(key); }
+
+    /**
+     * 按键的顺序对 [low, high) 中的元素调用 fn(const K &, const V &)
+     */
+    template <typename Fn> void forRange(const K &low, const K &high, Fn &&fn) const {
+        auto [leaf, i] = const_cast<BTreeMap *>(this)->template locate<false>(low);
+        for (; leaf != nullptr; leaf = leaf->next, i = 0) {
+            for (; i < leaf->count; i++) {
+                if (!less(leaf->keys[i], high)) {
+                    return;
+                }
+                fn(leaf->keys[i], leaf->values[i]);
+            }
+        }
+    }
+
+    /**
+     * 键已存在时不覆盖，返回已有元素和 false
+     */
+    std::pair<iterator, bool> insert(K key, V value) { return insertImpl(std::move(key), std::move(value), false); }
+
+    // 键已存在时覆盖值
+    std::pair<iterator, bool> insertOrAssign(K key, V value) {
+        return insertImpl(std::move(key), std::move(value), true);
+    }
+
+    V &operator[](const K &key) {
+        if (V *v = get(key)) {
+            return *v;
+        }
+        return insertImpl(K(key), V(), false).first.value();
+    }
+
+    // 返回删除的元素个数（0 或 1）
+    size_t erase(const K &key) {
+        if (root == nullptr || !eraseFrom(root, key)) {
+            return 0;
+        }
+        count--;
+        if (root->leaf && root->count == 0) {
+            freeNode(root);
+            root = nullptr;
+            head = nullptr;
+        } else if (!root->leaf && root->count == 0) {
+            Node *old = root;
+            root = static_cast<Inner *>(old)->children[0];
+            freeNode(old);
+        }
+        return 1;
+    }
+
+    void clear() noexcept {
+        if (root != nullptr) {
+            destroy(root);
+        }
+        root = nullptr;
+        head = nullptr;
+        count = 0;
+    }
+
+  private:
+    Node *root = nullptr;
+    // 最左边的叶子
+    Leaf *head = nullptr;
+    size_t count = 0;
+    size_t leafCount = 0;
+    size_t innerCount = 0;
+    Less less;
+
+    template <bool OrEqual> std::pair<Leaf *, size_t> locate(const K &key) {
+        if (root == nullptr) {
+            return {nullptr, 0};
+        }
+        Node *node = root;
+        while (!node->leaf) {
+            auto *inner = static_cast<Inner *>(node);
+            node = inner->children[Search::template count<true>(inner->keys, inner->count, key, less)];
+        }
+        auto *leaf = static_cast<Leaf *>(node);
+        return {leaf, Search::template count<OrEqual>(leaf->keys, leaf->count, key, less)};
+    }
+
+    Leaf *newLeaf() {
+        leafCount++;
+        return new Leaf();
+    }
+
+    Inner *newInner() {
+        innerCount++;
+        return new Inner();
+    }
+
+    void freeNode(Node *node) noexcept {
+        if (node->leaf) {
+            leafCount--;
+            delete static_cast<Leaf *>(node);
+        } else {
+            innerCount--;
+            delete static_cast<Inner *>(node);
+        }
+    }
+
+    void destroy(Node *node) noexcept {
+        if (!node->leaf) {
+            auto *inner = static_cast<Inner *>(node);
+            for (size_t i = 0; i <= inner->count; i++) {
+                destroy(inner->children[i]);
+            }
+        }
+        freeNode(node);
+    }
+
+    template <typename It> void build(It first, It last) {
+        clear();
+        if (std::adjacent_find(first, last, [&](const auto &a, const auto &b) { return !less(a.first, b.first); }) !=
+            last) {
+            throw std::invalid_argument("BTreeMap::fromSorted requires strictly ascending keys");
+        }
+        const auto n = static_cast<size_t>(std::distance(first, last));
+        if (n == 0) {
+            return;
+        }
+        // 每层取最少的节点数，元素平均分给各节点，每个节点都不低于最小填充
+        std::vector<Node *> level;
+        std::vector<K> lowKeys;
+        const size_t leaves = (n + LEAF_KEYS - 1) / LEAF_KEYS;
+        Leaf *prev = nullptr;
+        for (size_t l = 0; l < leaves; l++) {
+            Leaf *leaf = newLeaf();
+            const size_t take = n / leaves + (l < n % leaves ? 1 : 0);
+            for (size_t i = 0; i < take; i++, ++first) {
+                leaf->keys[i] = first->first;
+                leaf->values[i] = first->second;
+            }
+            leaf->count = static_cast<uint16_t>(take);
+            leaf->prev = prev;
+            if (prev != nullptr) {
+                prev->next = leaf;
+            } else {
+                head = leaf;
+            }
+            prev = leaf;
+            level.push_back(leaf);
+            lowKeys.push_back(leaf->keys[0]);
+        }
+        while (level.size() > 1) {
+            const size_t groups = (level.size() + INNER_KEYS) / (INNER_KEYS + 1);
+            std::vector<Node *> upper;
+            std::vector<K> upperKeys;
+            size_t c = 0;
+            for (size_t g = 0; g < groups; g++) {
+                Inner *inner = newInner();
+                const size_t take = level.size() / groups + (g < level.size() % groups ? 1 : 0);
+                upperKeys.push_back(lowKeys[c]);
+                for (size_t i = 0; i < take; i++, c++) {
+                    inner->children[i] = level[c];
+                    if (i > 0) {
+                        inner->keys[i - 1] = lowKeys[c];
+                    }
+                }
+                inner->count = static_cast<uint16_t>(take - 1);
+                upper.push_back(inner);
+            }
+            level.swap(upper);
+            lowKeys.swap(upperKeys);
+        }
+        root = level[0];
+        count = n;
+    }
+
+    struct Split {
+        K key;
+        Node *right = nullptr;
+    };
+
+    std::pair<iterator, bool> insertImpl(K &&key, V &&value, bool assign) {
+        if (root == nullptr) {
+            root = head = newLeaf();
+        }
+        Split split;
+        std::pair<Leaf *, size_t> at{nullptr, 0};
+        bool inserted = false;
+        insertInto(root, key, value, assign, split, at, inserted);
+        if (split.right != nullptr) {
+            Inner *top = newInner();
+            top->count = 1;
+            top->keys[0] = std::move(split.key);
+            top->children[0] = root;
+            top->children[1] = split.right;
+            root = top;
+        }
+        if (inserted) {
+            count++;
+        }
+        return {iterator(at.first, at.second), inserted};
+    }
+
+    void insertInto(Node *node, K &key, V &value, bool assign, Split &split, std::pair<Leaf *, size_t> &at,
+                    bool &inserted) {
+        if (node->leaf) {
+            auto *leaf = static_cast<Leaf *>(node);
+            size_t i = Search::template count<false>(leaf->keys, leaf->count, key, less);
+            if (i < leaf->count && !less(key, leaf->keys[i])) {
+                if (assign) {
+                    leaf->values[i] = std::move(value);
+                }
+                at = {leaf, i};
+                return;
+            }
+            if (leaf->count == LEAF_KEYS) {
+                Leaf *right = splitLeaf(leaf);
+                split.key = right->keys[0];
+                split.right = right;
+                if (i > leaf->count) {
+                    i -= leaf->count;
+                    leaf = right;
+                }
+            }
+            std::move_backward(leaf->keys + i, leaf->keys + leaf->count, leaf->keys + leaf->count + 1);
+            std::move_backward(leaf->values + i, leaf->values + leaf->count, leaf->values + leaf->count + 1);
+            leaf->keys[i] = std::move(key);
+            leaf->values[i] = std::move(value);
+            leaf->count++;
+            at = {leaf, i};
+            inserted = true;
+            return;
+        }
+
+        auto *inner = static_cast<Inner *>(node);
+        size_t ci = Search::template count<true>(inner->keys, inner->count, key, less);
+        Split child;
+        insertInto(inner->children[ci], key, value, assign, child, at, inserted);
+        if (child.right == nullptr) {
+            return;
+        }
+        if (inner->count == INNER_KEYS) {
+            // 中间的键上移，右半边放进新节点
+            const size_t mid = INNER_KEYS / 2;
+            Inner *right = newInner();
+            right->count = static_cast<uint16_t>(INNER_KEYS - mid - 1);
+            std::move(inner->keys + mid + 1, inner->keys + INNER_KEYS, right->keys);
+            std::copy(inner->children + mid + 1, inner->children + INNER_KEYS + 1, right->children);
+            split.key = std::move(inner->keys[mid]);
+            split.right = right;
+            inner->count = static_cast<uint16_t>(mid);
+            if (ci > mid) {
+                ci -= mid + 1;
+                inner = right;
+            }
+        }
+        std::move_backward(inner->keys + ci, inner->keys + inner->count, inner->keys + inner->count + 1);
+        std::copy_backward(inner->children + ci + 1, inner->children + inner->count + 1,
+                           inner->children + inner->count + 2);
+        inner->keys[ci] = std::move(child.key);
+        inner->children[ci + 1] = child.right;
+        inner->count++;
+    }
+
+    Leaf *splitLeaf(Leaf *leaf) {
+        const size_t keep = LEAF_KEYS / 2;
+        Leaf *right = newLeaf();
+        right->count = static_cast<uint16_t>(LEAF_KEYS - keep);
+        std::move(leaf->keys + keep, leaf->keys + LEAF_KEYS, right->keys);
+        std::move(leaf->values + keep, leaf->values + LEAF_KEYS, right->values);
+        leaf->count = static_cast<uint16_t>(keep);
+        right->next = leaf->next;
+        right->prev = leaf;
+        if (leaf->next != nullptr) {
+            leaf->next->prev = right;
+        }
+        leaf->next = right;
+        return right;
+    }
+
+    bool eraseFrom(Node *node, const K &key) {
+        if (node->leaf) {
+            auto *leaf = static_cast<Leaf *>(node);
+            const size_t i = Search::template count<false>(leaf->keys, leaf->count, key, less);
+            if (i == leaf->count || less(key, leaf->keys[i])) {
+                return false;
+            }
+            std::move(leaf->keys + i + 1, leaf->keys + leaf->count, leaf->keys + i);
+            std::move(leaf->values + i + 1, leaf->values + leaf->count, leaf->values + i);
+            leaf->count--;
+            return true;
+        }
+        auto *inner = static_cast<Inner *>(node);
+        const size_t ci = Search::template count<true>(inner->keys, inner->count, key, less);
+        if (!eraseFrom(inner->children[ci], key)) {
+            return false;
+        }
+        Node *child = inner->children[ci];
+        if (child->count < (child->leaf ? MIN_LEAF : MIN_INNER)) {
+            rebalance(inner, ci);
+        }
+        return true;
+    }
+
+    // children[i] 低于最小填充：先向左右兄弟借一个，都借不到就与兄弟合并
+    void rebalance(Inner *parent, size_t i) {
+        Node *child = parent->children[i];
+        const size_t min = child->leaf ? MIN_LEAF : MIN_INNER;
+        Node *left = i > 0 ? parent->children[i - 1] : nullptr;
+        Node *right = i < parent->count ? parent->children[i + 1] : nullptr;
+        if (left != nullptr && left->count > min) {
+            borrowFromLeft(parent, i);
+        } else if (right != nullptr && right->count > min) {
+            borrowFromRight(parent, i);
+        } else if (left != nullptr) {
+            merge(parent, i - 1);
+        } else {
+            merge(parent, i);
+        }
+    }
+
+    void borrowFromLeft(Inner *parent, size_t i) {
+        if (parent->children[i]->leaf) {
+            auto *child = static_cast<Leaf *>(parent->children[i]);
+            auto *left = static_cast<Leaf *>(parent->children[i - 1]);
+            std::move_backward(child->keys, child->keys + child->count, child->keys + child->count + 1);
+            std::move_backward(child->values, child->values + child->count, child->values + child->count + 1);
+            child->keys[0] = std::move(left->keys[left->count - 1]);
+            child->values[0] = std::move(left->values[left->count - 1]);
+            parent->keys[i - 1] = child->keys[0];
+            left->count--;
+            child->count++;
+            return;
+        }
+        auto *child = static_cast<Inner *>(parent->children[i]);
+        auto *left = static_cast<Inner *>(parent->children[i - 1]);
+        std::move_backward(child->keys, child->keys + child->count, child->keys + child->count + 1);
+        std::copy_backward(child->children, child->children + child->count + 1, child->children + child->count + 2);
+        child->keys[0] = std::move(parent->keys[i - 1]);
+        child->children[0] = left->children[left->count];
+        parent->keys[i - 1] = std::move(left->keys[left->count - 1]);
+        left->count--;
+        child->count++;
+    }
+
+    void borrowFromRight(Inner *parent, size_t i) {
+        if (parent->children[i]->leaf) {
+            auto *child = static_cast<Leaf *>(parent->children[i]);
+            auto *right = static_cast<Leaf *>(parent->children[i + 1]);
+            child->keys[child->count] = std::move(right->keys[0]);
+            child->values[child->count] = std::move(right->values[0]);
+            std::move(right->keys + 1, right->keys + right->count, right->keys);
+            std::move(right->values + 1, right->values + right->count, right->values);
+            child->count++;
+            right->count--;
+            parent->keys[i] = right->keys[0];
+            return;
+        }
+        auto *child = static_cast<Inner *>(parent->children[i]);
+        auto *right = static_cast<Inner *>(parent->children[i + 1]);
+        child->keys[child->count] = std::move(parent->keys[i]);
+        child->children[child->count + 1] = right->children[0];
+        parent->keys[i] = std::move(right->keys[0]);
+        std::move(right->keys + 1, right->keys + right->count, right->keys);
+        std::copy(right->children + 1, right->children + right->count + 1, right->children);
+        child->count++;
+        right->count--;
+    }
+
+    // 把 children[i + 1] 合并进 children[i]，并从 parent 删掉分隔键 keys[i]
+    void merge(Inner *parent, size_t i) {
+        Node *leftNode = parent->children[i];
+        Node *rightNode = parent->children[i + 1];
+        if (leftNode->leaf) {
+            auto *left = static_cast<Leaf *>(leftNode);
+            auto *right = static_cast<Leaf *>(rightNode);
+            std::move(right->keys, right->keys + right->count, left->keys + left->count);
+            std::move(right->values, right->values + right->count, left->values + left->count);
+            left->count = static_cast<uint16_t>(left->count + right->count);
+            left->next = right->next;
+            if (right->next != nullptr) {
+                right->next->prev = left;
+            }
+        } else {
+            auto *left = static_cast<Inner *>(leftNode);
+            auto *right = static_cast<Inner *>(rightNode);
+            left->keys[left->count] = std::move(parent->keys[i]);
+            std::move(right->keys, right->keys + right->count, left->keys + left->count + 1);
+            std::copy(right->children, right->children + right->count + 1, left->children + left->count + 1);
+            left->count = static_cast<uint16_t>(left->count + 1 + right->count);
+        }
+        std::move(parent->keys + i + 1, parent->keys + parent->count, parent->keys + i);
+        std::copy(parent->children + i + 2, parent->children + parent->count + 1, parent->children + i + 1);
+        parent->count--;
+        freeNode(rightNode);
+    }
+};
+
+RHINO_INLINE_NAMESPACE_END
+} // namespace rhino
@@ -0,0 +1,543 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "common/Version.h"
+#include "util/CpuUtil.hpp"
+#include "util/FastHash.hpp"
+#include "util/Metrics.hpp"
+#include "util/SpinMutex.hpp"
+
+namespace rhino {
+RHINO_INLINE_NAMESPACE_BEGIN
+
+struct CacheOptions {
+    // 指标名前缀，为空时使用 cache-<序号>，避免多个未命名的缓存登记同名指标
+    std::string name;
+    // 所有分片合计的容量（按 CacheWeigher 计算的字节数）
+    size_t capacityBytes = 64 << 20;
+    // 分片数，向上取整到 2 的幂
+    size_t shards = 16;
+    // 小队列占分片容量的比例
+    double smallRatio = 0.1;
+    // put / getOrLoad 不指定 TTL 时使用，0 表示永不过期
+    std::chrono::milliseconds defaultTtl{0};
+    // 毫秒时钟，测试时可以替换；为空时使用 steady_clock
+    std::function<int64_t()> clock;
+};
+
+struct CacheStats {
+    uint64_t hits;
+    uint64_t misses;
+    uint64_t evictions;
+    uint64_t expirations;
+    uint64_t loads;
+    // 等待别的线程加载结果、没有自己调用 loader 的次数
+    uint64_t coalesced;
+};
+
+namespace detail {
+
+template <typename T> size_t heapBytes(const T &) noexcept { return 0; }
+
+inline size_t heapBytes(const std::string &s) noexcept { return s.capacity() > 15 ? s.capacity() + 1 : 0; }
+
+template <typename T> size_t heapBytes(const std::vector<T> &v) noexcept { return v.capacity() * sizeof(T); }
+
+} // namespace detail
+
+/**
+ * 缓存条目占用的字节数：键值本身加上 std::string / std::vector 的堆内存，再加上每个条目的固定开销
+ */
+template <typename K, typename V> struct CacheWeigher {
+    size_t operator()(const K &key, const V &value) const noexcept {
+        return 64 + sizeof(K) + sizeof(V) + detail::heapBytes(key) + detail::heapBytes(value);
+    }
+};
+
+/**
+ * 分片的内存缓存，每个分片用 S3-FIFO 淘汰
+ *
+ * S3-FIFO：新条目进入小 FIFO（约占容量 10%），在小队列里被访问过的才晋升到主 FIFO，
+ * 没被访问过的直接淘汰并把键的哈希记进幽灵队列；幽灵队列中的键再次插入时直接进主队列。
+ * 主队列淘汰时访问过的条目（频率减一）重新排到队尾，相当于 CLOCK。
+ * 命中只把条目上的 2 位频率计数加一，不移动任何链表节点，一次扫描性的访问也冲不掉热点数据。
+ *
+ * - 容量按字节计算（CacheWeigher），单个条目超过分片容量时不缓存
+ * - 每个条目可以有自己的 TTL，过期的条目在读到或淘汰时清除
+ * - getOrLoad 合并同一个键上并发的未命中：只有一个线程调用 loader，其余线程等待它的结果（包括异常）；
+ *   加载期间该键被 put / erase / clear 过时，加载结果只返回给调用者，不写入缓存，避免用旧值覆盖新值
+ *
+ * 指标（登记在 MetricsRegistry 中，前缀为 options.name）：
+ * - <name>.hits / <name>.misses：get 和 getOrLoad 的命中与未命中
+ * - <name>.evictions / <name>.expirations：因容量淘汰和因过期清除的条目数
+ * - <name>.loads / <name>.coalesced：调用 loader 的次数，以及共享别人加载结果的次数
+ */
+template <typename K, typename V, typename Hash = FastHash<K>, typename Eq = std::equal_to<K>,
+          typename Weigher = CacheWeigher<K, V>>
+class Cache {
+
+    struct Entry {
+        K key;
+        V value;
+        size_t bytes;
+        // 0 表示永不过期
+        int64_t expireMs;
+        uint8_t freq = 0;
+        bool inMain = false;
+        // 已被删除或覆盖，还留在队列里等待弹出
+        bool dead = false;
+    };
+
+    // 一次进行中的加载
+    struct Pending {
+        std::mutex mutex;
+        std::condition_variable cv;
+        bool done = false;
+        std::optional<V> value;
+        std::exception_ptr error;
+        // 加载期间该键被 put / erase / clear 过，持分片锁访问
+        bool superseded = false;
+    };
+
+    struct alignas(CACHE_LINE_SIZE) Shard {
+        SpinMutex mutex;
+        std::unordered_map<K, Entry *, Hash, Eq> index;
+        std::deque<Entry *> small;
+        std::deque<Entry *> main;
+        size_t smallBytes = 0;
+        size_t mainBytes = 0;
+        size_t deadCount = 0;
+        // 幽灵队列：最近从小队列淘汰的键的哈希
+        std::deque<size_t> ghost;
+        std::unordered_map<size_t, uint32_t> ghostCount;
+        std::unordered_map<K, std::shared_ptr<Pending>, Hash, Eq> loading;
+    };
+
+    static constexpr uint8_t MAX_FREQ = 3;
+
+  public:
+    explicit Cache(CacheOptions opts = CacheOptions())
+        : options(named(std::move(opts))), shardCount(roundUp(options.shards)), shards(new Shard[shardCount]) {
+        shardCapacity = std::max<size_t>(options.capacityBytes / shardCount, 1);
+        smallCapacity = static_cast<size_t>(static_cast<double>(shardCapacity) * options.smallRatio);
+        auto &registry = MetricsRegistry::global();
+        registry.add(options.name + ".hits", &hits);
+        registry.add(options.name + ".misses", &misses);
+        registry.add(options.name + ".evictions", &evictions);
+        registry.add(options.name + ".expirations", &expirations);
+        registry.add(options.name + ".loads", &loads);
+        registry.add(options.name + ".coalesced", &coalesced);
+    }
+
+    ~Cache() {
+        auto &registry = MetricsRegistry::global();
+        for (const auto *counter : {&hits, &misses, &evictions, &expirations, &loads, &coalesced}) {
+            registry.remove(counter);
+        }
+        for (size_t i = 0; i < shardCount; i++) {
+            clearShard(shards[i]);
+        }
+    }
+
+    Cache(const Cache &) = delete;
+    Cache &operator=(const Cache &) = delete;
+
+    std::optional<V> get(const K &key) {
+        Shard &shard = shardOf(key);
+        std::lock_guard<SpinMutex> lock(shard.mutex);
+        if (Entry *entry = lookup(shard, key)) {
+            return entry->value;
+        }
+        return std::nullopt;
+    }
+
+    void put(K key, V value) { put(std::move(key), std::move(value), options.defaultTtl); }
+
+    // ttl 为 0 表示永不过期
+    void put(K key, V value, std::chrono::milliseconds ttl) {
+        Shard &shard = shardOf(key);
+        std::lock_guard<SpinMutex> lock(shard.mutex);
+        supersede(shard, key);
+        insert(shard, std::move(key), std::move(value), ttl);
+    }
+
+    bool erase(const K &key) {
+        Shard &shard = shardOf(key);
+        std::lock_guard<SpinMutex> lock(shard.mutex);
+        supersede(shard, key);
+        auto it = shard.index.find(key);
+        if (it == shard.index.end()) {
+            return false;
+        }
+        kill(shard, it);
+        return true;
+    }
+
+    /**
+     * 命中时返回缓存的值，否则调用 loader(key) 加载并缓存
+     *
+     * loader 返回 V，或者返回 std::optional<V>（std::nullopt 表示不存在，不缓存），getOrLoad 的返回类型与之相同。
+     * 同一个键上并发的未命中只有一个线程调用 loader，loader 抛出的异常会抛给所有等待的线程，且不缓存
+     */
+    template <typename Loader> auto getOrLoad(const K &key, Loader &&loader) {
+        return getOrLoad(key, std::forward<Loader>(loader), options.defaultTtl);
+    }
+
+    template <typename Loader> auto getOrLoad(const K &key, Loader &&loader, std::chrono::milliseconds ttl) {
+        using R = std::invoke_result_t<Loader &, const K &>;
+        constexpr bool OPTIONAL = std::is_same_v<R, std::optional<V>>;
+        static_assert(OPTIONAL || std::is_convertible_v<R, V>, "loader must return V or std::optional<V>");
+
+        Shard &shard = shardOf(key);
+        std::shared_ptr<Pending> pending;
+        bool leader = false;
+        {
+            std::lock_guard<SpinMutex> lock(shard.mutex);
+            if (Entry *entry = lookup(shard, key)) {
+                return R(entry->value);
+            }
+            auto it = shard.loading.find(key);
+            if (it != shard.loading.end()) {
+                pending = it->second;
+            } else {
+                pending = std::make_shared<Pending>();
+                shard.loading.emplace(key, pending);
+                leader = true;
+            }
+        }
+
+        if (!leader) {
+            coalesced.fetch_add(1, std::memory_order_relaxed);
+            std::unique_lock<std::mutex> lock(pending->mutex);
+            pending->cv.wait(lock, [&] { return pending->done; });
+            if (pending->error) {
+                std::rethrow_exception(pending->error);
+            }
+            if constexpr (OPTIONAL) {
+                return pending->value;
+            } else {
+                return R(*pending->value);
+            }
+        }
+
+        loads.fetch_add(1, std::memory_order_relaxed);
+        std::optional<V> value;
+        std::exception_ptr error;
+        try {
+            if constexpr (OPTIONAL) {
+                value = loader(key);
+            } else {
+                value.emplace(loader(key));
+            }
+        } catch (...) {
+            error = std::current_exception();
+        }
+        {
+            std::lock_guard<SpinMutex> lock(shard.mutex);
+            if (value.has_value() && !pending->superseded) {
+                insert(shard, key, *value, ttl);
+            }
+            shard.loading.erase(key);
+        }
+        {
+            std::lock_guard<std::mutex> lock(pending->mutex);
+            pending->value = value;
+            pending->error = error;
+            pending->done = true;
+        }
+        pending->cv.notify_all();
+        if (error) {
+            std::rethrow_exception(error);
+        }
+        if constexpr (OPTIONAL) {
+            return value;
+        } else {
+            return R(std::move(*value));
+        }
+    }
+
+    void clear() {
+        for (size_t i = 0; i < shardCount; i++) {
+            std::lock_guard<SpinMutex> lock(shards[i].mutex);
+            for (auto &[key, pending] : shards[i].loading) {
+                pending->superseded = true;
+            }
+            clearShard(shards[i]);
+        }
+    }
+
+    // 条目数
+    size_t size() const {
+        size_t n = 0;
+        for (size_t i = 0; i < shardCount; i++) {
+            std::lock_guard<SpinMutex> lock(shards[i].mutex);
+            n += shards[i].index.size();
+        }
+        return n;
+    }
+
+    // 条目占用的字节数合计
+    size_t bytes() const {
+        size_t n = 0;
+        for (size_t i = 0; i < shardCount; i++) {
+            std::lock_guard<SpinMutex> lock(shards[i].mutex);
+            n += shards[i].smallBytes + shards[i].mainBytes;
+        }
+        return n;
+    }
+
+    CacheStats stats() const noexcept {
+        return CacheStats{hits.load(std::memory_order_relaxed),        misses.load(std::memory_order_relaxed),
+                          evictions.load(std::memory_order_relaxed),   expirations.load(std::memory_order_relaxed),
+                          loads.load(std::memory_order_relaxed),       coalesced.load(std::memory_order_relaxed)};
+    }
+
+  private:
+    const CacheOptions options;
+    const size_t shardCount;
+    size_t shardCapacity;
+    size_t smallCapacity;
+    std::unique_ptr<Shard[]> shards;
+    Hash hasher;
+    Weigher weigher;
+
+    std::atomic<uint64_t> hits{0};
+    std::atomic<uint64_t> misses{0};
+    std::atomic<uint64_t> evictions{0};
+    std::atomic<uint64_t> expirations{0};
+    std::atomic<uint64_t> loads{0};
+    std::atomic<uint64_t> coalesced{0};
+
+    static CacheOptions named(CacheOptions opts) {
+        if (opts.name.empty()) {
+            static std::atomic<uint32_t> sequence{0};
+            opts.name = "cache-" + std::to_string(sequence.fetch_add(1, std::memory_order_relaxed));
+        }
+        return opts;
+    }
+
+    static size_t roundUp(size_t n) noexcept {
+        size_t p = 1;
+        while (p < n) {
+            p <<= 1;
+        }
+        return p;
+    }
+
+    int64_t nowMs() const {
+        if (options.clock) {
+            return options.clock();
+        }
+        return std::chrono::duration_cast<std::chrono::milliseconds>(
+                   std::chrono::steady_clock::now().time_since_epoch())
+            .count();
+    }
+
+    size_t hashOf(const K &key) const { return static_cast<size_t>(hasher(key)); }
+
+    Shard &shardOf(const K &key) const noexcept { return shards[(hashOf(key) >> 32) & (shardCount - 1)]; }
+
+    bool expired(const Entry *entry, int64_t now) const noexcept {
+        return entry->expireMs != 0 && entry->expireMs <= now;
+    }
+
+    // 持锁：命中时频率加一并返回条目，过期的条目顺便删除
+    Entry *lookup(Shard &shard, const K &key) {
+        auto it = shard.index.find(key);
+        if (it == shard.index.end()) {
+            misses.fetch_add(1, std::memory_order_relaxed);
+            return nullptr;
+        }
+        Entry *entry = it->second;
+        if (expired(entry, nowMs())) {
+            kill(shard, it);
+            expirations.fetch_add(1, std::memory_order_relaxed);
+            misses.fetch_add(1, std::memory_order_relaxed);
+            return nullptr;
+        }
+        entry->freq = static_cast<uint8_t>(std::min<int>(entry->freq + 1, MAX_FREQ));
+        hits.fetch_add(1, std::memory_order_relaxed);
+        return entry;
+    }
+
+    void insert(Shard &shard, K key, V value, std::chrono::milliseconds ttl) {
+        auto it = shard.index.find(key);
+        if (it != shard.index.end()) {
+            kill(shard, it);
+        }
+        const size_t bytes = weigher(key, value);
+        if (bytes > shardCapacity) {
+            return;
+        }
+        const size_t hash = hashOf(key);
+        auto *entry = new Entry{std::move(key), std::move(value), bytes, ttl.count() > 0 ? nowMs() + ttl.count() : 0};
+        auto ghost = shard.ghostCount.find(hash);
+        if (ghost != shard.ghostCount.end()) {
+            // 最近刚被淘汰又回来了，直接进主队列；幽灵队列里的记录等它自然出队
+            entry->inMain = true;
+            shard.main.push_back(entry);
+            shard.mainBytes += bytes;
+        } else {
+            shard.small.push_back(entry);
+            shard.smallBytes += bytes;
+        }
+        shard.index.emplace(entry->key, entry);
+        while (shard.smallBytes + shard.mainBytes > shardCapacity) {
+            evictOne(shard);
+        }
+        compactIfNeeded(shard);
+    }
+
+    // 持锁：key 上有进行中的加载时，让它的结果不再写入缓存
+    void supersede(Shard &shard, const K &key) {
+        if (shard.loading.empty()) {
+            return;
+        }
+        auto it = shard.loading.find(key);
+        if (it != shard.loading.end()) {
+            it->second->superseded = true;
+        }
+    }
+
+    // 持锁：从索引中删除条目并扣掉字节数，条目本身留在队列里等弹出时释放
+    void kill(Shard &shard, typename std::unordered_map<K, Entry *, Hash, Eq>::iterator it) {
+        Entry *entry = it->second;
+        (entry->inMain ? shard.mainBytes : shard.smallBytes) -= entry->bytes;
+        entry->dead = true;
+        shard.deadCount++;
+        shard.index.erase(it);
+    }
+
+    // 删除很多却一直没有淘汰时，队列里的死条目会越积越多
+    void compactIfNeeded(Shard &shard) {
+        if (shard.deadCount <= shard.index.size() + 64) {
+            return;
+        }
+        for (auto *queue : {&shard.small, &shard.main}) {
+            auto end = std::remove_if(queue->begin(), queue->end(), [](Entry *e) {
+                if (e->dead) {
+                    delete e;
+                    return true;
+                }
+                return false;
+            });
+            queue->erase(end, queue->end());
+        }
+        shard.deadCount = 0;
+    }
+
+    void evictOne(Shard &shard) {
+        if (shard.smallBytes > smallCapacity || shard.mainBytes == 0) {
+            if (evictSmall(shard)) {
+                return;
+            }
+        }
+        evictMain(shard);
+    }
+
+    // 返回 false 表示小队列空了（条目都晋升到了主队列）
+    bool evictSmall(Shard &shard) {
+        const int64_t now = nowMs();
+        while (!shard.small.empty()) {
+            Entry *entry = shard.small.front();
+            shard.small.pop_front();
+            if (popDead(shard, entry)) {
+                continue;
+            }
+            if (entry->freq > 0 && !expired(entry, now)) {
+                entry->freq = 0;
+                entry->inMain = true;
+                shard.smallBytes -= entry->bytes;
+                shard.mainBytes += entry->bytes;
+                shard.main.push_back(entry);
+                continue;
+            }
+            remember(shard, hashOf(entry->key));
+            drop(shard, entry, now);
+            return true;
+        }
+        return false;
+    }
+
+    void evictMain(Shard &shard) {
+        const int64_t now = nowMs();
+        while (!shard.main.empty()) {
+            Entry *entry = shard.main.front();
+            shard.main.pop_front();
+            if (popDead(shard, entry)) {
+                continue;
+            }
+            if (entry->freq > 0 && !expired(entry, now)) {
+                entry->freq--;
+                shard.main.push_back(entry);
+                continue;
+            }
+            drop(shard, entry, now);
+            return;
+        }
+    }
+
+    bool popDead(Shard &shard, Entry *entry) {
+        if (!entry->dead) {
+            return false;
+        }
+        delete entry;
+        shard.deadCount--;
+        return true;
+    }
+
+    // 淘汰一个还在索引中的条目
+    void drop(Shard &shard, Entry *entry, int64_t now) {
+        (expired(entry, now) ? expirations : evictions).fetch_add(1, std::memory_order_relaxed);
+        (entry->inMain ? shard.mainBytes : shard.smallBytes) -= entry->bytes;
+        shard.index.erase(entry->key);
+        delete entry;
+    }
+
+    // 幽灵队列的长度与缓存的条目数相当
+    void remember(Shard &shard, size_t hash) {
+        shard.ghost.push_back(hash);
+        shard.ghostCount[hash]++;
+        while (shard.ghost.size() > std::max<size_t>(shard.index.size(), 16)) {
+            auto it = shard.ghostCount.find(shard.ghost.front());
+            if (--it->second == 0) {
+                shard.ghostCount.erase(it);
+            }
+            shard.ghost.pop_front();
+        }
+    }
+
+    void clearShard(Shard &shard) {
+        for (auto *queue : {&shard.small, &shard.main}) {
+            for (Entry *entry : *queue) {
+                delete entry;
+            }
+            queue->clear();
+        }
+        shard.index.clear();
+        shard.ghost.clear();
+        shard.ghostCount.clear();
+        shard.smallBytes = 0;
+        shard.mainBytes = 0;
+        shard.deadCount = 0;
+    }
+};
+
+RHINO_INLINE_NAMESPACE_END
+} // namespace rhino
@@ -0,0 +1,176 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <string>
+#include <thread>
+#include "common/Version.h"
+#include "util/CpuUtil.hpp"
+#include "util/SeqLock.hpp"
+
+namespace rhino {
+RHINO_INLINE_NAMESPACE_BEGIN
+
+/**
+ * 粗粒度时钟：由后台线程（或事件循环）周期性发布当前时间，热路径只读缓存
+ *
+ * 适用于只需要毫秒级墙上时间的场景（日志时间戳、超时判断、过期时间等），
+ * 读 nowMs()/nowUs() 只是一次原子 load，snapshot() 是 seqlock 保护下的一次拷贝。
+ *
+ * 注意：
+ * - 精度取决于发布间隔（默认 1ms），并且发布线程被调度延迟时时间会"停住"
+ * - 不需要后台线程时，可以不调用 start()，而是由事件循环每轮调用 update()
+ */
+class CoarseClock {
+
+  public:
+    // 格式化时间字符串 "YYYY-MM-DD HH:MM:SS.mmm"（本地时区），加结尾 '\0' 共 24 字节
+    static constexpr size_t DATE_SIZE = 24;
+
+    struct Snapshot {
+        int64_t epochUs;
+        int64_t epochMs;
+        char date[DATE_SIZE];
+    };
+
+    static_assert(sizeof(Snapshot) % sizeof(uint64_t) == 0,
+                  "Snapshot should be copied by words");
+
+    CoarseClock() { update(); }
+
+    ~CoarseClock() { stop(); }
+
+    CoarseClock(const CoarseClock &) = delete;
+    CoarseClock &operator=(const CoarseClock &) = delete;
+
+    /**
+     * 进程级共享实例
+     */
+    static CoarseClock &global() {
+        static CoarseClock clock;
+        return clock;
+    }
+
+    /**
+     * 启动后台发布线程，重复调用无副作用
+     *
+     * @param interval 发布间隔
+     */
+    void start(std::chrono::microseconds interval = std::chrono::microseconds(1000)) {
+        bool expected = false;
+        if (!running.compare_exchange_strong(expected, true)) {
+            return;
+        }
+        worker = std::thread([this, interval] {
+            while (running.load(std::memory_order_relaxed)) {
+                update();
+                std::this_thread::sleep_for(interval);
+            }
+        });
+    }
+
+    void stop() {
+        bool expected = true;
+        if (!running.compare_exchange_strong(expected, false)) {
+            return;
+        }
+        if (worker.joinable()) {
+            worker.join();
+        }
+    }
+
+    bool isRunning() const { return running.load(std::memory_order_relaxed); }
+
+    /**
+     * 读取真实时钟并发布，只能由一个线程调用（后台线程或事件循环线程）
+     */
+    void update() noexcept {
+        timespec ts{};
+        clock_gettime(CLOCK_REALTIME, &ts);
+        const int64_t us = static_cast<int64_t>(ts.tv_sec) * 1000000 + ts.tv_nsec / 1000;
+        const int64_t ms = us / 1000;
+
+        Snapshot next{};
+        next.epochUs = us;
+        next.epochMs = ms;
+        formatDate(ts.tv_sec, static_cast<int32_t>(ms % 1000), next.date);
+
+        slot.lock.writeLock();
+        seqStore(slot.snapshot, next);
+        slot.lock.writeUnlock();
+
+        slot.epochUs.store(us, std::memory_order_release);
+        slot.epochMs.store(ms, std::memory_order_release);
+    }
+
+    /**
+     * 缓存的 unix 毫秒时间戳，一次原子 load
+     */
+    int64_t nowMs() const noexcept {
+        return slot.epochMs.load(std::memory_order_acquire);
+    }
+
+    /**
+     * 缓存的 unix 微秒时间戳，一次原子 load（精度仍然受发布间隔限制）
+     */
+    int64_t nowUs() const noexcept {
+        return slot.epochUs.load(std::memory_order_acquire);
+    }
+
+    /**
+     * 一致的时间快照（时间戳和格式化字符串来自同一次发布）
+     */
+    Snapshot snapshot() const noexcept {
+        Snapshot snap;
+        uint32_t seq;
+        do {
+            seq = slot.lock.readBegin();
+            seqLoad(snap, slot.snapshot);
+        } while (slot.lock.readRetry(seq));
+        return snap;
+    }
+
+    std::string dateString() const { return snapshot().date; }
+
+  private:
+    // 读者访问的字段放在同一个缓存行里，和写者的其他状态隔离
+    struct alignas(CACHE_LINE_SIZE) Slot {
+        std::atomic<int64_t> epochMs{0};
+        std::atomic<int64_t> epochUs{0};
+        SeqLock lock;
+        Snapshot snapshot{};
+    };
+
+    static_assert(sizeof(Slot) == CACHE_LINE_SIZE, "Slot should fit in one cache line");
+
+    Slot slot;
+
+    // 以下只由发布线程访问：同一秒内复用已格式化的 "YYYY-MM-DD HH:MM:SS" 前缀
+    time_t cachedSec{-1};
+    char cachedPrefix[DATE_SIZE]{};
+
+    std::atomic<bool> running{false};
+    std::thread worker;
+
+    void formatDate(time_t sec, int32_t millis, char (&out)[DATE_SIZE]) noexcept {
+        if (sec != cachedSec) {
+            tm local{};
+            localtime_r(&sec, &local);
+            std::strftime(cachedPrefix, sizeof(cachedPrefix), "%Y-%m-%d %H:%M:%S", &local);
+            cachedSec = sec;
+        }
+        std::memcpy(out, cachedPrefix, 19);
+        out[19] = '.';
+        out[20] = static_cast<char>('0' + millis / 100);
+        out[21] = static_cast<char>('0' + millis / 10 % 10);
+        out[22] = static_cast<char>('0' + millis % 10);
+        out[23] = '\0';
+    }
+};
+
+RHINO_INLINE_NAMESPACE_END
+} // namespace rhino
@@ -0,0 +1,415 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <utility>
+#include <vector>
+#include "common/Version.h"
+#include "util/CpuUtil.hpp"
+#include "util/Epoch.hpp"
+#include "util/FastHash.hpp"
+#include "util/SpinMutex.hpp"
+
+namespace rhino {
+RHINO_INLINE_NAMESPACE_BEGIN
+
+struct ConcurrentHashMapOptions {
+    // 分片数，向上取整到 2 的幂；写者只锁自己的分片
+    size_t shards = 64;
+    // 每个分片的初始槽数，向上取整到 2 的幂
+    size_t initialCapacity = 16;
+    // 扩容期间每次写操作顺带迁移的旧表槽数
+    size_t migrateBatch = 64;
+};
+
+/**
+ * 分片的并发哈希表，替代 Locked<std::unordered_map>
+ *
+ * - 按哈希的高位分成若干分片，每个分片是一张线性探测的开放寻址表，写者只持有所在分片的锁
+ * - 读者不加锁：槽里存放不可变的节点指针，修改和删除换上新节点或墓碑，旧节点经 epoch 延迟回收；
+ *   每个槽旁边有一字节哈希标签，标签不符的槽不去解引用节点
+ * - 扩容只发生在单个分片内，并且是渐进的：新表建好后，之后每次写操作迁移旧表的 migrateBatch 个槽，
+ *   迁移完成前读者先查旧表再查新表。读者没找到时检查分片的扩容序号，期间换过表就重查，不会漏掉正在迁移的键
+ *
+ * 值通过拷贝（get）或在读侧临界区内回调（visit）返回，回调里不能持有引用到临界区之外。
+ * 所有 map 共用全局 epoch 域，使用约束见 epoch::Domain；读操作占用 3 个 hazard 槽，
+ * 在调用方自己的 Guard 内调用时从外层已用的槽之后编号，不会覆盖外层的保护
+ */
+template <typename K, typename V, typename Hash = FastHash<K>, typename Eq = std::equal_to<>,
+          typename Mutex = SpinMutex>
+class ConcurrentHashMap {
+
+    struct Node {
+        size_t hash;
+        K key;
+        V value;
+    };
+
+    struct Table {
+        size_t capacity;
+        std::unique_ptr<std::atomic<Node *>[]> slots;
+        // 槽中节点哈希的标签，0 表示从未使用；只是过滤用的提示，最终以节点上的键为准
+        std::unique_ptr<std::atomic<uint8_t>[]> tags;
+
+        explicit Table(size_t cap)
+            : capacity(cap), slots(new std::atomic<Node *>[cap]), tags(new std::atomic<uint8_t>[cap]) {
+            for (size_t i = 0; i < cap; i++) {
+                slots[i].store(nullptr, std::memory_order_relaxed);
+                tags[i].store(0, std::memory_order_relaxed);
+            }
+        }
+    };
+
+    struct alignas(CACHE_LINE_SIZE) Shard {
+        std::atomic<Table *> current{nullptr};
+        // 扩容期间的旧表，迁移完成后置空
+        std::atomic<Table *> previous{nullptr};
+        // 每次开始或结束扩容加一
+        std::atomic<uint64_t> resizeSeq{0};
+        std::atomic<size_t> live{0};
+        Mutex mutex;
+        // 以下字段只在持锁时访问
+        size_t used = 0;
+        size_t migrated = 0;
+    };
+
+  public:
+    explicit ConcurrentHashMap(const ConcurrentHashMapOptions &options = {})
+        : shardCount(roundUp(options.shards)), initialCapacity(roundUp(std::max<size_t>(options.initialCapacity, 8))),
+          migrateBatch(std::max<size_t>(options.migrateBatch, 1)), shards(new Shard[shardCount]) {
+        for (size_t i = 0; i < shardCount; i++) {
+            shards[i].current.store(new Table(initialCapacity), std::memory_order_relaxed);
+        }
+    }
+
+    ConcurrentHashMap(const ConcurrentHashMap &) = delete;
+    ConcurrentHashMap &operator=(const ConcurrentHashMap &) = delete;
+
+    // 析构时不能再有其他线程访问
+    ~ConcurrentHashMap() {
+        for (size_t i = 0; i < shardCount; i++) {
+            freeTable(shards[i].previous.load(std::memory_order_relaxed));
+            freeTable(shards[i].current.load(std::memory_order_relaxed));
+        }
+    }
+
+    /**
+     * 找到 key 时在读侧临界区内调用 fn(const V &)
+     */
+    template <typename Q, typename Fn> bool visit(const Q &key, Fn &&fn) const {
+        const size_t hash = hashOf(key);
+        const Shard &shard = shardOf(hash);
+        epoch::Guard guard;
+        while (true) {
+            const uint64_t seq = shard.resizeSeq.load(std::memory_order_acquire);
+            const Table *previous = guard.protect(shard.previous, 1);
+            const Table *current = guard.protect(shard.current, 2);
+            // 迁移时先写新表再在旧表留墓碑，所以先查旧表
+            const Node *node = previous == nullptr ? nullptr : lookup(guard, previous, hash, key);
+            if (node == nullptr) {
+                node = lookup(guard, current, hash, key);
+            }
+            if (node != nullptr) {
+                fn(static_cast<const V &>(node->value));
+                return true;
+            }
+            if (shard.resizeSeq.load(std::memory_order_acquire) == seq) {
+                return false;
+            }
+        }
+    }
+
+    template <typename Q> std::optional<V> get(const Q &key) const {
+        std::optional<V> result;
+        visit(key, [&](const V &v) { result.emplace(v); });
+        return result;
+    }
+
+    template <typename Q> bool contains(const Q &key) const {
+        return visit(key, [](const V &) {});
+    }
+
+    /**
+     * 键不存在时插入，返回是否插入
+     */
+    bool insert(K key, V value) { return write(std::move(key), std::move(value), false); }
+
+    // 键已存在时覆盖，返回是否是新插入
+    bool insertOrAssign(K key, V value) { return write(std::move(key), std::move(value), true); }
+
+    /**
+     * 键存在时用 fn(const V &) 的返回值替换旧值，返回是否找到；fn 在分片锁内调用
+     */
+    template <typename Q, typename Fn> bool update(const Q &key, Fn &&fn) {
+        const size_t hash = hashOf(key);
+        Shard &shard = shardOf(hash);
+        std::lock_guard<Mutex> lock(shard.mutex);
+        Table *table = prepare(shard, hash, key);
+        const size_t index = probe(table, hash, key).first;
+        if (index == NOT_FOUND) {
+            return false;
+        }
+        Node *old = table->slots[index].load(std::memory_order_relaxed);
+        table->slots[index].store(new Node{hash, old->key, fn(static_cast<const V &>(old->value))},
+                                  std::memory_order_release);
+        epoch::retire(old);
+        return true;
+    }
+
+    template <typename Q> bool erase(const Q &key) {
+        const size_t hash = hashOf(key);
+        Shard &shard = shardOf(hash);
+        std::lock_guard<Mutex> lock(shard.mutex);
+        Table *table = prepare(shard, hash, key);
+        const size_t index = probe(table, hash, key).first;
+        if (index == NOT_FOUND) {
+            return false;
+        }
+        // 先摘除再退休
+        Node *old = table->slots[index].load(std::memory_order_relaxed);
+        table->slots[index].store(tombstone(), std::memory_order_release);
+        epoch::retire(old);
+        shard.live.fetch_sub(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    /**
+     * 逐个分片在锁内调用 fn(const K &, const V &)，同一分片内是一致的快照
+     */
+    template <typename Fn> void forEach(Fn &&fn) const {
+        for (size_t i = 0; i < shardCount; i++) {
+            Shard &shard = shards[i];
+            std::lock_guard<Mutex> lock(shard.mutex);
+            for (Table *table : {shard.previous.load(std::memory_order_relaxed),
+                                 shard.current.load(std::memory_order_relaxed)}) {
+                for (size_t s = 0; table != nullptr && s < table->capacity; s++) {
+                    const Node *node = table->slots[s].load(std::memory_order_relaxed);
+                    if (isNode(node)) {
+                        fn(node->key, static_cast<const V &>(node->value));
+                    }
+                }
+            }
+        }
+    }
+
+    void clear() {
+        for (size_t i = 0; i < shardCount; i++) {
+            Shard &shard = shards[i];
+            std::lock_guard<Mutex> lock(shard.mutex);
+            Table *previous = shard.previous.load(std::memory_order_relaxed);
+            Table *current = shard.current.load(std::memory_order_relaxed);
+            shard.resizeSeq.fetch_add(1, std::memory_order_release);
+            shard.current.store(new Table(initialCapacity), std::memory_order_release);
+            shard.previous.store(nullptr, std::memory_order_release);
+            shard.live.store(0, std::memory_order_relaxed);
+            shard.used = 0;
+            retireTable(previous);
+            retireTable(current);
+        }
+    }
+
+    // 并发修改时是近似值
+    size_t size() const noexcept {
+        size_t n = 0;
+        for (size_t i = 0; i < shardCount; i++) {
+            n += shards[i].live.load(std::memory_order_relaxed);
+        }
+        return n;
+    }
+
+  private:
+    static constexpr size_t NOT_FOUND = ~size_t(0);
+
+    const size_t shardCount;
+    const size_t initialCapacity;
+    const size_t migrateBatch;
+    std::unique_ptr<Shard[]> shards;
+    Hash hasher;
+    Eq eq;
+
+    static size_t roundUp(size_t n) noexcept {
+        size_t p = 1;
+        while (p < n) {
+            p <<= 1;
+        }
+        return p;
+    }
+
+    static Node *tombstone() noexcept { return reinterpret_cast<Node *>(alignof(Node)); }
+
+    static bool isNode(const Node *p) noexcept { return p != nullptr && p != tombstone(); }
+
+    static uint8_t tagOf(size_t hash) noexcept { return static_cast<uint8_t>(hash >> 56) | 1; }
+
+    template <typename Q> size_t hashOf(const Q &key) const { return static_cast<size_t>(hasher(key)); }
+
+    // 高位选分片，低位选槽
+    Shard &shardOf(size_t hash) const noexcept { return shards[(hash >> 40) & (shardCount - 1)]; }
+
+    template <typename Q>
+    const Node *lookup(epoch::Guard &guard, const Table *table, size_t hash, const Q &key) const {
+        const size_t mask = table->capacity - 1;
+        const uint8_t tag = tagOf(hash);
+        for (size_t i = hash & mask, n = 0; n < table->capacity; i = (i + 1) & mask, n++) {
+            const Node *node = table->slots[i].load(std::memory_order_acquire);
+            if (node == nullptr) {
+                return nullptr;
+            }
+            if (node != tombstone() && table->tags[i].load(std::memory_order_relaxed) == tag) {
+                node = guard.protect(table->slots[i], 0);
+                if (isNode(node) && node->hash == hash && eq(node->key, key)) {
+                    return node;
+                }
+            }
+        }
+        return nullptr;
+    }
+
+    /**
+     * 持锁时在表中找 key：返回 {所在槽, 第一个可用槽}，不存在时所在槽为 NOT_FOUND
+     */
+    template <typename Q> std::pair<size_t, size_t> probe(const Table *table, size_t hash, const Q &key) const {
+        const size_t mask = table->capacity - 1;
+        size_t free = NOT_FOUND;
+        for (size_t i = hash & mask, n = 0; n < table->capacity; i = (i + 1) & mask, n++) {
+            const Node *node = table->slots[i].load(std::memory_order_relaxed);
+            if (node == nullptr) {
+                return {NOT_FOUND, free == NOT_FOUND ? i : free};
+            }
+            if (node == tombstone()) {
+                free = free == NOT_FOUND ? i : free;
+            } else if (node->hash == hash && eq(node->key, key)) {
+                return {i, free};
+            }
+        }
+        return {NOT_FOUND, free};
+    }
+
+    // 持锁时把节点放进表中的空槽（调用方保证键不在表中且有空位）
+    void place(Shard &shard, Table *table, size_t slot, Node *node) {
+        if (table->slots[slot].load(std::memory_order_relaxed) == nullptr) {
+            shard.used++;
+        }
+        table->tags[slot].store(tagOf(node->hash), std::memory_order_relaxed);
+        table->slots[slot].store(node, std::memory_order_release);
+    }
+
+    /**
+     * 写操作的公共前半段（持锁）：推进迁移，并把 key 从旧表提前迁到新表，返回之后要操作的表
+     */
+    template <typename Q> Table *prepare(Shard &shard, size_t hash, const Q &key) {
+        Table *previous = shard.previous.load(std::memory_order_relaxed);
+        Table *current = shard.current.load(std::memory_order_relaxed);
+        if (previous == nullptr) {
+            return current;
+        }
+        const size_t index = probe(previous, hash, key).first;
+        if (index != NOT_FOUND) {
+            moveSlot(shard, previous, current, index);
+        }
+        migrate(shard, migrateBatch);
+        return current;
+    }
+
+    // 先写新表，再在旧表留墓碑
+    void moveSlot(Shard &shard, Table *from, Table *to, size_t index) {
+        Node *node = from->slots[index].load(std::memory_order_relaxed);
+        place(shard, to, probe(to, node->hash, node->key).second, node);
+        from->slots[index].store(tombstone(), std::memory_order_release);
+    }
+
+    void migrate(Shard &shard, size_t budget) {
+        Table *previous = shard.previous.load(std::memory_order_relaxed);
+        Table *current = shard.current.load(std::memory_order_relaxed);
+        for (; budget > 0 && shard.migrated < previous->capacity; budget--, shard.migrated++) {
+            if (isNode(previous->slots[shard.migrated].load(std::memory_order_relaxed))) {
+                moveSlot(shard, previous, current, shard.migrated);
+            }
+        }
+        if (shard.migrated == previous->capacity) {
+            shard.resizeSeq.fetch_add(1, std::memory_order_release);
+            shard.previous.store(nullptr, std::memory_order_release);
+            epoch::retire(previous);
+        }
+    }
+
+    // 新表容量让迁移期间的插入也不会再触发扩容；全是墓碑时原地重建
+    void startResize(Shard &shard) {
+        if (shard.previous.load(std::memory_order_relaxed) != nullptr) {
+            migrate(shard, ~size_t(0));
+        }
+        Table *current = shard.current.load(std::memory_order_relaxed);
+        const size_t live = shard.live.load(std::memory_order_relaxed) + 1;
+        size_t capacity = current->capacity;
+        while (live > capacity * 3 / 8) {
+            capacity *= 2;
+        }
+        shard.resizeSeq.fetch_add(1, std::memory_order_release);
+        shard.previous.store(current, std::memory_order_release);
+        shard.current.store(new Table(capacity), std::memory_order_release);
+        shard.used = 0;
+        shard.migrated = 0;
+    }
+
+    bool write(K &&key, V &&value, bool assign) {
+        const size_t hash = hashOf(key);
+        Shard &shard = shardOf(hash);
+        std::lock_guard<Mutex> lock(shard.mutex);
+        Table *table = prepare(shard, hash, key);
+        auto [index, free] = probe(table, hash, key);
+        if (index != NOT_FOUND) {
+            if (assign) {
+                Node *old = table->slots[index].load(std::memory_order_relaxed);
+                table->slots[index].store(new Node{hash, std::move(key), std::move(value)}, std::memory_order_release);
+                epoch::retire(old);
+            }
+            return false;
+        }
+        // 负载（含墓碑）超过 3/4 时扩容
+        if (free == NOT_FOUND || (table->slots[free].load(std::memory_order_relaxed) == nullptr &&
+                                  (shard.used + 1) * 4 > table->capacity * 3)) {
+            startResize(shard);
+            table = shard.current.load(std::memory_order_relaxed);
+            free = probe(table, hash, key).second;
+        }
+        place(shard, table, free, new Node{hash, std::move(key), std::move(value)});
+        shard.live.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    static void freeTable(Table *table) noexcept {
+        if (table == nullptr) {
+            return;
+        }
+        for (size_t i = 0; i < table->capacity; i++) {
+            Node *node = table->slots[i].load(std::memory_order_relaxed);
+            if (isNode(node)) {
+                delete node;
+            }
+        }
+        delete table;
+    }
+
+    // 表和其中的节点都可能还在被读者访问：节点先在槽里换成墓碑再退休，读者重读槽时不会再拿到它
+    static void retireTable(Table *table) {
+        if (table == nullptr) {
+            return;
+        }
+        for (size_t i = 0; i < table->capacity; i++) {
+            Node *node = table->slots[i].load(std::memory_order_relaxed);
+            if (isNode(node)) {
+                table->slots[i].store(tombstone(), std::memory_order_release);
+                epoch::retire(node);
+            }
+        }
+        epoch::retire(table);
+    }
+};
+
+RHINO_INLINE_NAMESPACE_END
+} // namespace rhino
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstddef>
+#include "common/Version.h"
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#elif defined(__i386__) || defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
+namespace rhino {
+RHINO_INLINE_NAMESPACE_BEGIN
+
+// 缓存行大小，用于 alignas 隔离读写热点，避免伪共享
+// （std::hardware_destructive_interference_size 在 gcc 下会触发 ABI 警告，这里直接写死 64）
+constexpr size_t CACHE_LINE_SIZE = 64;
+
+/**
+ * 自旋等待时让出流水线（x86 上为 pause 指令）
+ *
+ * 降低自旋循环的功耗，并减少退出自旋时因内存序冲突导致的流水线清空
+ */
+inline void cpuRelax() noexcept {
+#if defined(__i386__) || defined(__x86_64__) || defined(_M_IX86) || defined(_M_X64)
+    _mm_pause();
+#elif defined(__aarch64__)
+    __asm__ __volatile__("yield" ::: "memory");
+#elif defined(__GNUC__) || defined(__clang__)
+    __asm__ __volatile__("" ::: "memory");
+#endif
+}
+
+RHINO_INLINE_NAMESPACE_END
+} // namespace rhino
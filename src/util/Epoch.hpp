@@ -0,0 +1,404 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <mutex>
+#include <utility>
+#include <vector>
+#include "common/Version.h"
+#include "util/AsymmetricFence.hpp"
+#include "util/CpuUtil.hpp"
+
+namespace rhino {
+RHINO_INLINE_NAMESPACE_BEGIN
+
+namespace epoch {
+
+namespace detail {
+
+// TSan 下 fence 退化后（见 AsymmetricFence.hpp），发布操作同时使用 seq_cst 读写，保证 TSan 能看到 happens-before
+#if defined(RHINO_TSAN)
+constexpr std::memory_order PUBLISH_ORDER = std::memory_order_seq_cst;
+#else
+constexpr std::memory_order PUBLISH_ORDER = std::memory_order_release;
+#endif
+
+} // namespace detail
+
+class Guard;
+
+/**
+ * 基于 epoch 的内存回收域，hazard pointer 兜底
+ *
+ * 读者用 Guard 进入临界区并通过 Guard::protect 读取共享指针；写者把节点从结构中摘除后调用 retire，
+ * 节点在确认没有读者还能访问它时才被释放：
+ *
+ * - 快速路径（epoch）：进入临界区的线程宣告当前全局 epoch；所有活跃线程都追上全局 epoch 时全局 epoch 加一，
+ *   在 epoch e 退休的节点在全局 epoch 到达 e + 2 后释放，不需要逐个检查节点
+ * - 兜底路径（hazard pointer）：protect 同时把指针写入线程的 hazard 槽。某个线程停在临界区里会让 epoch
+ *   无法推进，此时本线程待回收的节点超过 LIMBO_LIMIT 就扫描所有 hazard 槽，释放没有被保护的节点。
+ *   因此即使有线程卡住，每个线程积压的节点也不超过 LIMBO_LIMIT 加上全部 hazard 槽数
+ *
+ * 读者一侧不执行任何 RMW 或完整屏障（见 lightFence），代价集中在回收一侧。
+ *
+ * 使用约束：
+ * - 临界区内解引用的、可能被 retire 的指针都必须经 protect 取得，每个线程同时最多持有 HAZARD_SLOTS 个；
+ *   嵌套的 Guard 从外层已经用到的槽之后开始编号，内层的 protect 不会覆盖外层的保护。
+ *   内层 Guard 存活期间外层不能再用新的槽号
+ * - 节点 retire 之前必须已经从结构中摘除，retire 之后不能再被发布
+ * - 用过某个 Domain 的线程必须在该 Domain 析构之前退出（全局域除外）
+ */
+class Domain {
+
+  public:
+    // 每个线程可以同时保护的指针数
+    static constexpr size_t HAZARD_SLOTS = 8;
+    // 每退休这么多个节点尝试推进一次 epoch
+    static constexpr size_t RETIRE_BATCH = 64;
+    // 线程积压超过这个数量且 epoch 推进不动时走 hazard 扫描
+    static constexpr size_t LIMBO_LIMIT = 4096;
+
+    Domain() : id(nextId().fetch_add(1, std::memory_order_relaxed)) { asymmetricFences(); }
+
+    ~Domain() {
+        forgetLocal();
+        for (Record *r = records.load(std::memory_order_acquire); r != nullptr;) {
+            Record *next = r->next;
+            for (auto &node : r->limbo) {
+                node.deleter(node.ptr);
+            }
+            delete r;
+            r = next;
+        }
+        for (auto &node : orphans) {
+            node.deleter(node.ptr);
+        }
+    }
+
+    Domain(const Domain &) = delete;
+    Domain &operator=(const Domain &) = delete;
+
+    static Domain &global() {
+        static Domain domain;
+        return domain;
+    }
+
+    /**
+     * 退休一个已经从结构中摘除的节点，确认安全后在某个线程上调用 deleter(ptr)
+     */
+    void retire(void *ptr, void (*deleter)(void *)) {
+        Record &r = local();
+        r.limbo.push_back(Retired{ptr, deleter, globalEpoch.load(std::memory_order_acquire)});
+        pendingCount.fetch_add(1, std::memory_order_relaxed);
+        if (r.limbo.size() % RETIRE_BATCH == 0) {
+            collect(r, r.limbo.size() > LIMBO_LIMIT);
+        }
+    }
+
+    template <typename T> void retire(T *ptr) {
+        retire(static_cast<void *>(ptr), [](void *p) { delete static_cast<T *>(p); });
+    }
+
+    /**
+     * 立即尝试推进 epoch 并回收本线程（以及已退出线程遗留）的节点，包括 hazard 扫描
+     *
+     * @return 释放的节点数
+     */
+    size_t reclaim() {
+        Record &r = local();
+        {
+            std::lock_guard<std::mutex> lock(orphanMutex);
+            r.limbo.insert(r.limbo.end(), orphans.begin(), orphans.end());
+            orphans.clear();
+        }
+        // 合并进来的节点 epoch 不再有序，按 epoch 排序以便前缀回收
+        std::stable_sort(r.limbo.begin(), r.limbo.end(),
+                         [](const Retired &a, const Retired &b) { return a.epoch < b.epoch; });
+        size_t freed = collect(r, false);
+        freed += collect(r, true);
+        return freed;
+    }
+
+    uint64_t currentEpoch() const noexcept { return globalEpoch.load(std::memory_order_acquire); }
+
+    /**
+     * 已退休但还没有释放的节点数（近似值）
+     */
+    size_t pendingApprox() const noexcept {
+        const int64_t n = pendingCount.load(std::memory_order_relaxed);
+        return n > 0 ? static_cast<size_t>(n) : 0;
+    }
+
+  private:
+    friend class Guard;
+
+    struct Retired {
+        void *ptr;
+        void (*deleter)(void *);
+        uint64_t epoch;
+    };
+
+    // 每个线程一条记录，线程退出后记录留在链表里供新线程复用，Domain 析构时释放
+    struct alignas(CACHE_LINE_SIZE) Record {
+        // 0 表示不在临界区，否则为进入临界区时宣告的 epoch
+        std::atomic<uint64_t> epoch{0};
+        std::atomic<const void *> hazards[HAZARD_SLOTS] = {};
+        std::atomic<bool> inUse{true};
+        // 以下字段只由持有记录的线程访问
+        uint32_t nesting = 0;
+        // 存活的 Guard 已经用到的槽数，嵌套的 Guard 从这里开始编号
+        uint32_t slotsUsed = 0;
+        std::vector<Retired> limbo;
+        Record *next = nullptr;
+    };
+
+    // 线程退出时归还本线程在各个 Domain 上持有的记录
+    struct LocalRecords {
+        struct Entry {
+            uint64_t domainId;
+            Domain *domain;
+            Record *record;
+        };
+        std::vector<Entry> entries;
+        // 最近使用的一项，绝大多数线程只用一个 Domain
+        uint64_t cachedId = 0;
+        Record *cached = nullptr;
+
+        ~LocalRecords() {
+            for (auto &e : entries) {
+                e.domain->release(e.record);
+            }
+            entries.clear();
+            destroyed() = true;
+        }
+
+        // 平凡析构的 thread_local 在线程退出前一直可访问，用来判断 LocalRecords 是否已经析构
+        static bool &destroyed() noexcept {
+            static thread_local bool flag = false;
+            return flag;
+        }
+    };
+
+    static std::atomic<uint64_t> &nextId() noexcept {
+        static std::atomic<uint64_t> id{1};
+        return id;
+    }
+
+    static LocalRecords &localRecords() noexcept {
+        static thread_local LocalRecords records;
+        return records;
+    }
+
+    const uint64_t id;
+    alignas(CACHE_LINE_SIZE) std::atomic<uint64_t> globalEpoch{1};
+    alignas(CACHE_LINE_SIZE) std::atomic<Record *> records{nullptr};
+    std::atomic<int64_t> pendingCount{0};
+    std::mutex orphanMutex;
+    std::vector<Retired> orphans;
+
+    Record &local() {
+        LocalRecords &lr = localRecords();
+        if (lr.cachedId == id) {
+            return *lr.cached;
+        }
+        Record *r = nullptr;
+        for (auto &e : lr.entries) {
+            if (e.domainId == id) {
+                r = e.record;
+                break;
+            }
+        }
+        if (r == nullptr) {
+            r = acquire();
+            lr.entries.push_back(LocalRecords::Entry{id, this, r});
+        }
+        lr.cachedId = id;
+        lr.cached = r;
+        return *r;
+    }
+
+    // 析构线程（通常是主线程）上的记录由析构函数统一释放，这里只是从线程局部表中去掉
+    void forgetLocal() noexcept {
+        // 全局域在静态析构阶段销毁，此时主线程的 LocalRecords 已经析构并归还了记录
+        if (LocalRecords::destroyed()) {
+            return;
+        }
+        LocalRecords &lr = localRecords();
+        lr.entries.erase(std::remove_if(lr.entries.begin(), lr.entries.end(),
+                                        [this](const LocalRecords::Entry &e) { return e.domainId == id; }),
+                         lr.entries.end());
+        if (lr.cachedId == id) {
+            lr.cachedId = 0;
+            lr.cached = nullptr;
+        }
+    }
+
+    Record *acquire() {
+        for (Record *r = records.load(std::memory_order_acquire); r != nullptr; r = r->next) {
+            bool expected = false;
+            if (!r->inUse.load(std::memory_order_relaxed) &&
+                r->inUse.compare_exchange_strong(expected, true, std::memory_order_acquire)) {
+                return r;
+            }
+        }
+        auto r = new Record();
+        r->next = records.load(std::memory_order_relaxed);
+        while (!records.compare_exchange_weak(r->next, r, std::memory_order_release, std::memory_order_relaxed)) {
+        }
+        return r;
+    }
+
+    void release(Record *r) noexcept {
+        if (!r->limbo.empty()) {
+            std::lock_guard<std::mutex> lock(orphanMutex);
+            orphans.insert(orphans.end(), r->limbo.begin(), r->limbo.end());
+            r->limbo.clear();
+        }
+        r->epoch.store(0, std::memory_order_release);
+        for (auto &h : r->hazards) {
+            h.store(nullptr, std::memory_order_release);
+        }
+        r->nesting = 0;
+        r->slotsUsed = 0;
+        r->inUse.store(false, std::memory_order_release);
+    }
+
+    // 所有在临界区里的线程都已宣告当前 epoch 时推进一次
+    bool tryAdvance() noexcept {
+        const uint64_t e = globalEpoch.load(std::memory_order_acquire);
+        heavyFence();
+        for (Record *r = records.load(std::memory_order_acquire); r != nullptr; r = r->next) {
+            const uint64_t announced = r->epoch.load(std::memory_order_acquire);
+            if (announced != 0 && announced != e) {
+                return false;
+            }
+        }
+        uint64_t expected = e;
+        return globalEpoch.compare_exchange_strong(expected, e + 1, std::memory_order_acq_rel);
+    }
+
+    size_t collect(Record &r, bool scanHazards) {
+        tryAdvance();
+        const uint64_t e = globalEpoch.load(std::memory_order_acquire);
+        // limbo 按退休时的 epoch 有序，释放 epoch + 2 <= e 的前缀
+        size_t safe = 0;
+        while (safe < r.limbo.size() && r.limbo[safe].epoch + 2 <= e) {
+            safe++;
+        }
+        std::vector<Retired> ready(r.limbo.begin(), r.limbo.begin() + static_cast<std::ptrdiff_t>(safe));
+        r.limbo.erase(r.limbo.begin(), r.limbo.begin() + static_cast<std::ptrdiff_t>(safe));
+
+        if (scanHazards && !r.limbo.empty()) {
+            // 摘除节点的写入和这里的 heavyFence 与读者 protect 中的发布 + lightFence 构成 Dekker 式握手：
+            // 要么这里看到读者的 hazard，要么读者校验时看到节点已被摘除
+            heavyFence();
+            std::vector<const void *> protectedPtrs;
+            for (Record *rec = records.load(std::memory_order_acquire); rec != nullptr; rec = rec->next) {
+                for (auto &h : rec->hazards) {
+                    if (const void *p = h.load(std::memory_order_acquire)) {
+                        protectedPtrs.push_back(p);
+                    }
+                }
+            }
+            std::sort(protectedPtrs.begin(), protectedPtrs.end());
+            auto keep = std::stable_partition(r.limbo.begin(), r.limbo.end(), [&](const Retired &node) {
+                return std::binary_search(protectedPtrs.begin(), protectedPtrs.end(), node.ptr);
+            });
+            ready.insert(ready.end(), keep, r.limbo.end());
+            r.limbo.erase(keep, r.limbo.end());
+        }
+
+        // 先从 limbo 中移除再调用 deleter，deleter 里可以再次 retire
+        for (auto &node : ready) {
+            node.deleter(node.ptr);
+        }
+        pendingCount.fetch_sub(static_cast<int64_t>(ready.size()), std::memory_order_relaxed);
+        return ready.size();
+    }
+};
+
+/**
+ * 读侧临界区，可以嵌套；每个 Guard 的槽号相对于进入时外层已用的槽，离开时清空自己用过的槽
+ */
+class Guard {
+
+  public:
+    explicit Guard(Domain &domain = Domain::global())
+        : record(domain.local()), domain(domain), base(record.slotsUsed) {
+        if (record.nesting++ == 0) {
+            // 宣告的 epoch 可能已经过时，那只会让推进更保守；之后的 lightFence 保证回收方扫描时能看到宣告
+            record.epoch.store(domain.globalEpoch.load(std::memory_order_acquire), detail::PUBLISH_ORDER);
+            lightFence();
+        }
+    }
+
+    ~Guard() {
+        for (uint32_t i = base; i < record.slotsUsed; i++) {
+            record.hazards[i].store(nullptr, std::memory_order_release);
+        }
+        record.slotsUsed = base;
+        if (--record.nesting == 0) {
+            record.epoch.store(0, std::memory_order_release);
+        }
+    }
+
+    Guard(const Guard &) = delete;
+    Guard &operator=(const Guard &) = delete;
+
+    /**
+     * 读取 src 并用 slot 号 hazard 槽保护，返回的指针在本 Guard（或槽被复用）之前一直有效
+     */
+    template <typename T> T *protect(const std::atomic<T *> &src, size_t slot = 0) noexcept {
+        std::atomic<const void *> &hazard = use(slot);
+        T *p = src.load(std::memory_order_relaxed);
+        while (true) {
+            hazard.store(p, detail::PUBLISH_ORDER);
+            lightFence();
+            T *q = src.load(std::memory_order_acquire);
+            if (q == p) {
+                return p;
+            }
+            p = q;
+        }
+    }
+
+    /**
+     * 提前释放一个槽，例如遍历链表时交替使用两个槽
+     */
+    void clear(size_t slot) noexcept { use(slot).store(nullptr, std::memory_order_release); }
+
+    Domain &owner() const noexcept { return domain; }
+
+  private:
+    Domain::Record &record;
+    Domain &domain;
+    // 本 Guard 的 0 号槽在记录中的位置
+    const uint32_t base;
+
+    std::atomic<const void *> &use(size_t slot) noexcept {
+        const size_t index = base + slot;
+        // 嵌套太深时槽不够用，静默覆盖别人的保护会导致释放后使用，直接终止
+        if (index >= Domain::HAZARD_SLOTS) {
+            std::terminate();
+        }
+        if (index >= record.slotsUsed) {
+            record.slotsUsed = static_cast<uint32_t>(index + 1);
+        }
+        return record.hazards[index];
+    }
+};
+
+/**
+ * 在全局域上退休节点，用 delete 释放
+ */
+template <typename T> void retire(T *ptr) { Domain::global().retire(ptr); }
+
+inline void retire(void *ptr, void (*deleter)(void *)) { Domain::global().retire(ptr, deleter); }
+
+} // namespace epoch
+
+RHINO_INLINE_NAMESPACE_END
+} // namespace rhino
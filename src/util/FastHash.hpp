@@ -0,0 +1,79 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include "common/Version.h"
+
+namespace rhino {
+RHINO_INLINE_NAMESPACE_BEGIN
+
+namespace detail {
+
+// 64 位乘法混合（splitmix64 的终结函数），让低位和高位都依赖输入的每一位
+inline uint64_t mix64(uint64_t x) noexcept {
+    x ^= x >> 30;
+    x *= 0xbf58476d1ce4e5b9ULL;
+    x ^= x >> 27;
+    x *= 0x94d049bb133111ebULL;
+    x ^= x >> 31;
+    return x;
+}
+
+inline uint64_t load64(const char *p) noexcept {
+    uint64_t v;
+    std::memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+// 每次吃 8 字节的字符串哈希，尾部不足 8 字节时按长度拼成一个字
+inline uint64_t hashBytes(const char *p, size_t n) noexcept {
+    uint64_t h = 0x9e3779b97f4a7c15ULL ^ (n * 0xff51afd7ed558ccdULL);
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        h = mix64(h ^ load64(p + i));
+    }
+    uint64_t tail = 0;
+    std::memcpy(&tail, p + i, n - i);
+    return mix64(h ^ tail);
+}
+
+} // namespace detail
+
+/**
+ * 适合开放寻址表的哈希：std::hash 对整数是恒等映射，低位直接当桶号时冲突严重，这里对所有位做一次混合
+ *
+ * 支持整数、枚举、指针和字符串（std::string / std::string_view / const char*，可以互相透明查找），
+ * 其余类型在 std::hash 的结果上再混合一次
+ */
+template <typename T, typename = void> struct FastHash {
+    size_t operator()(const T &v) const noexcept { return detail::mix64(std::hash<T>{}(v)); }
+};
+
+template <typename T>
+struct FastHash<T, std::enable_if_t<std::is_integral_v<T> || std::is_enum_v<T> || std::is_pointer_v<T>>> {
+    size_t operator()(T v) const noexcept {
+        if constexpr (std::is_pointer_v<T>) {
+            return detail::mix64(reinterpret_cast<uintptr_t>(v));
+        } else {
+            return detail::mix64(static_cast<uint64_t>(v));
+        }
+    }
+};
+
+template <> struct FastHash<std::string_view> {
+    using is_transparent = void;
+
+    size_t operator()(std::string_view s) const noexcept { return detail::hashBytes(s.data(), s.size()); }
+};
+
+template <> struct FastHash<std::string> : FastHash<std::string_view> {};
+
+template <> struct FastHash<const char *> : FastHash<std::string_view> {};
+
+RHINO_INLINE_NAMESPACE_END
+} // namespace rhino
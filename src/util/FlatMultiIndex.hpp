@@ -0,0 +1,606 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "common/Version.h"
+#include "util/FastHash.hpp"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace rhino {
+RHINO_INLINE_NAMESPACE_BEGIN
+
+/**
+ * 取成员作为键：MemberKey<&Data::id>
+ */
+template <auto Member> struct MemberKey;
+
+template <typename C, typename K, K C::*Member> struct MemberKey<Member> {
+    const K &operator()(const C &v) const noexcept { return v.*Member; }
+};
+
+// 唯一哈希索引，Hash 为 void 时使用 FastHash<Key>
+template <typename KeyFn, typename Hash = void, typename Eq = std::equal_to<>> struct HashedUnique {};
+
+// 唯一有序索引
+template <typename KeyFn, typename Less = std::less<>> struct OrderedUnique {};
+
+// 非唯一有序索引，相同键的元素按插入顺序排列
+template <typename KeyFn, typename Less = std::less<>> struct OrderedNonUnique {};
+
+namespace detail {
+
+constexpr uint32_t FLAT_NPOS = 0xffffffffU;
+
+template <typename T, typename KeyFn> using IndexKey = std::decay_t<std::invoke_result_t<const KeyFn &, const T &>>;
+
+/**
+ * 只存 uint32_t 元素位置的 Swiss table
+ *
+ * ctrl 每字节对应一个槽：EMPTY / DELETED 最高位为 1，已占用的槽存哈希低 7 位。
+ * 查找时 16 个槽为一组，用 SSE2 一次比较整组控制字节，只有低 7 位相同的槽才去比较键；
+ * 组之间按三角数步长探测，组里出现 EMPTY 即可停止。最大负载 7/8
+ */
+class FlatHashTable {
+
+  public:
+    static constexpr int8_t EMPTY = -128;
+    static constexpr int8_t DELETED = -2;
+    static constexpr size_t GROUP = 16;
+
+    size_t size() const noexcept { return count; }
+
+    size_t memoryBytes() const noexcept { return ctrl.capacity() + slots.capacity() * sizeof(uint32_t); }
+
+    uint32_t at(size_t index) const noexcept { return slots[index]; }
+
+    void setAt(size_t index, uint32_t pos) noexcept { slots[index] = pos; }
+
+    void clear() noexcept {
+        std::fill(ctrl.begin(), ctrl.end(), EMPTY);
+        count = 0;
+        growthLeft = ctrl.size() * 7 / 8;
+    }
+
+    /**
+     * 返回第一个满足 eq(pos) 的槽号，找不到返回 FLAT_NPOS
+     */
+    template <typename Eq> size_t find(size_t hash, Eq &&eq) const {
+        if (ctrl.empty()) {
+            return FLAT_NPOS;
+        }
+        const auto h2 = static_cast<int8_t>(hash & 0x7f);
+        const size_t mask = ctrl.size() / GROUP - 1;
+        size_t g = (hash >> 7) & mask;
+        for (size_t step = 1;; step++) {
+            const int8_t *group = ctrl.data() + g * GROUP;
+            for (uint32_t bits = match(group, h2); bits != 0; bits &= bits - 1) {
+                const size_t index = g * GROUP + static_cast<size_t>(__builtin_ctz(bits));
+                if (eq(slots[index])) {
+                    return index;
+                }
+            }
+            if (match(group, EMPTY) != 0) {
+                return FLAT_NPOS;
+            }
+            // 组数是 2 的幂，三角数步长会遍历每一个组
+            g = (g + step) & mask;
+        }
+    }
+
+    /**
+     * 插入位置 pos，调用方保证不重复；扩容时用 hashOf(pos) 重新计算已有元素的哈希
+     */
+    template <typename HashOf> void insert(size_t hash, uint32_t pos, HashOf &&hashOf) {
+        if (growthLeft == 0) {
+            // 大部分是墓碑时原地重建即可，否则翻倍
+            rehash(count * 2 >= ctrl.size() * 7 / 8 ? std::max(GROUP, ctrl.size() * 2) : ctrl.size(), hashOf);
+        }
+        const size_t index = findFree(hash);
+        if (ctrl[index] == EMPTY) {
+            growthLeft--;
+        }
+        ctrl[index] = static_cast<int8_t>(hash & 0x7f);
+        slots[index] = pos;
+        count++;
+    }
+
+    void eraseAt(size_t index) noexcept {
+        // 组里的 EMPTY 只会在重建时产生，组里还有 EMPTY 说明从没有元素越过这个组，可以直接置空而不留墓碑
+        if (match(ctrl.data() + index / GROUP * GROUP, EMPTY) != 0) {
+            ctrl[index] = EMPTY;
+            growthLeft++;
+        } else {
+            ctrl[index] = DELETED;
+        }
+        count--;
+    }
+
+    template <typename HashOf> void reserve(size_t n, HashOf &&hashOf) {
+        size_t cap = GROUP;
+        while (cap * 7 / 8 < n) {
+            cap *= 2;
+        }
+        if (cap > ctrl.size()) {
+            rehash(cap, hashOf);
+        }
+    }
+
+  private:
+    std::vector<int8_t> ctrl;
+    std::vector<uint32_t> slots;
+    size_t count = 0;
+    size_t growthLeft = 0;
+
+    static uint32_t match(const int8_t *group, int8_t h) noexcept {
+#if defined(__SSE2__)
+        const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i *>(group));
+        return static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(bytes, _mm_set1_epi8(h))));
+#else
+        uint32_t bits = 0;
+        for (size_t i = 0; i < GROUP; i++) {
+            bits |= static_cast<uint32_t>(group[i] == h) << i;
+        }
+        return bits;
+#endif
+    }
+
+    // EMPTY 和 DELETED，即最高位为 1 的字节
+    static uint32_t matchFree(const int8_t *group) noexcept {
+#if defined(__SSE2__)
+        return static_cast<uint32_t>(_mm_movemask_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(group))));
+#else
+        uint32_t bits = 0;
+        for (size_t i = 0; i < GROUP; i++) {
+            bits |= static_cast<uint32_t>(group[i] < 0) << i;
+        }
+        return bits;
+#endif
+    }
+
+    size_t findFree(size_t hash) const noexcept {
+        const size_t mask = ctrl.size() / GROUP - 1;
+        size_t g = (hash >> 7) & mask;
+        for (size_t step = 1;; step++) {
+            const uint32_t bits = matchFree(ctrl.data() + g * GROUP);
+            if (bits != 0) {
+                return g * GROUP + static_cast<size_t>(__builtin_ctz(bits));
+            }
+            g = (g + step) & mask;
+        }
+    }
+
+    template <typename HashOf> void rehash(size_t cap, HashOf &&hashOf) {
+        std::vector<int8_t> oldCtrl(cap, EMPTY);
+        std::vector<uint32_t> oldSlots(cap);
+        oldCtrl.swap(ctrl);
+        oldSlots.swap(slots);
+        growthLeft = cap * 7 / 8 - count;
+        for (size_t i = 0; i < oldCtrl.size(); i++) {
+            if (oldCtrl[i] >= 0) {
+                const size_t hash = hashOf(oldSlots[i]);
+                const size_t index = findFree(hash);
+                ctrl[index] = static_cast<int8_t>(hash & 0x7f);
+                slots[index] = oldSlots[i];
+            }
+        }
+    }
+};
+
+template <typename T, typename Spec> class Index;
+
+template <typename T, typename KeyFn, typename HashSpec, typename Eq> class Index<T, HashedUnique<KeyFn, HashSpec, Eq>> {
+
+  public:
+    using Key = IndexKey<T, KeyFn>;
+    using Hash = std::conditional_t<std::is_void_v<HashSpec>, FastHash<Key>, HashSpec>;
+    static constexpr bool UNIQUE = true;
+
+    decltype(auto) keyOf(const T &v) const { return keyFn(v); }
+
+    template <typename K> uint32_t find(const K &key, const std::vector<T> &values) const {
+        const size_t index = table.find(hash(key), [&](uint32_t pos) { return eq(keyFn(values[pos]), key); });
+        return index == FLAT_NPOS ? FLAT_NPOS : table.at(index);
+    }
+
+    // 除 self 之外是否有元素的键等于 key，self 的键已从 oldKey 改成了 key
+    bool conflicts(const Key &key, uint32_t self, const Key &, const std::vector<T> &values) const {
+        return table.find(hash(key), [&](uint32_t pos) { return pos != self && eq(keyFn(values[pos]), key); }) !=
+               FLAT_NPOS;
+    }
+
+    void insert(uint32_t pos, const std::vector<T> &values) {
+        table.insert(hash(keyFn(values[pos])), pos, [&](uint32_t p) { return hash(keyFn(values[p])); });
+    }
+
+    // 按插入时的键 key 删除 pos，此时 values[pos] 可能已经被修改
+    void erase(uint32_t pos, const Key &key, const std::vector<T> &) {
+        table.eraseAt(table.find(hash(key), [pos](uint32_t p) { return p == pos; }));
+    }
+
+    // 元素从 from 搬到了 to，values[to] 已经是它
+    void relocate(uint32_t from, uint32_t to, const std::vector<T> &values) {
+        table.setAt(table.find(hash(keyFn(values[to])), [from](uint32_t p) { return p == from; }), to);
+    }
+
+    void reserve(size_t n, const std::vector<T> &values) {
+        table.reserve(n, [&](uint32_t p) { return hash(keyFn(values[p])); });
+    }
+
+    void clear() noexcept { table.clear(); }
+
+    size_t memoryBytes() const noexcept { return table.memoryBytes(); }
+
+  private:
+    FlatHashTable table;
+    KeyFn keyFn;
+    Hash hasher;
+    Eq eq;
+
+    template <typename K> size_t hash(const K &key) const { return static_cast<size_t>(hasher(key)); }
+};
+
+/**
+ * 按键排序的位置数组：查找和范围遍历是二分，插入删除要搬动数组，适合读多写少的场景
+ */
+template <typename T, typename KeyFn, typename Less, bool Unique> class OrderedIndex {
+
+  public:
+    using Key = IndexKey<T, KeyFn>;
+    static constexpr bool UNIQUE = Unique;
+
+    decltype(auto) keyOf(const T &v) const { return keyFn(v); }
+
+    template <typename K> uint32_t find(const K &key, const std::vector<T> &values) const {
+        auto it = lowerBound(key, values);
+        return it != order.end() && !less(key, keyFn(values[*it])) ? *it : FLAT_NPOS;
+    }
+
+    bool conflicts(const Key &key, uint32_t self, const Key &oldKey, const std::vector<T> &values) const {
+        if constexpr (Unique) {
+            // self 还排在 oldKey 的位置上
+            auto keyAt = [&](uint32_t p) -> decltype(auto) { return p == self ? oldKey : keyFn(values[p]); };
+            auto it = std::lower_bound(order.begin(), order.end(), key,
+                                       [&](uint32_t p, const Key &k) { return less(keyAt(p), k); });
+            for (; it != order.end() && !less(key, keyAt(*it)); ++it) {
+                if (*it != self) {
+                    return true;
+                }
+            }
+        }
+        return false;
+    }
+
+    void insert(uint32_t pos, const std::vector<T> &values) {
+        order.insert(upperBound(keyFn(values[pos]), values), pos);
+    }
+
+    void erase(uint32_t pos, const Key &key, const std::vector<T> &values) { order.erase(locate(pos, key, values)); }
+
+    void relocate(uint32_t from, uint32_t to, const std::vector<T> &values) {
+        *locate(from, keyFn(values[to]), values) = to;
+    }
+
+    void reserve(size_t n, const std::vector<T> &) { order.reserve(n); }
+
+    void clear() noexcept { order.clear(); }
+
+    size_t memoryBytes() const noexcept { return order.capacity() * sizeof(uint32_t); }
+
+    template <typename K> auto lowerBound(const K &key, const std::vector<T> &values) const {
+        return std::lower_bound(order.begin(), order.end(), key,
+                                [&](uint32_t pos, const K &k) { return less(keyFn(values[pos]), k); });
+    }
+
+    template <typename K> auto upperBound(const K &key, const std::vector<T> &values) const {
+        return std::upper_bound(order.begin(), order.end(), key,
+                                [&](const K &k, uint32_t pos) { return less(k, keyFn(values[pos])); });
+    }
+
+    const std::vector<uint32_t> &positions() const noexcept { return order; }
+
+  private:
+    std::vector<uint32_t> order;
+    KeyFn keyFn;
+    Less less;
+
+    // pos 在 order 中的位置；values[pos] 可能已被修改或移走，比较时用 key 代替它的键
+    std::vector<uint32_t>::iterator locate(uint32_t pos, const Key &key, const std::vector<T> &values) {
+        auto keyAt = [&](uint32_t p) -> decltype(auto) { return p == pos ? key : keyFn(values[p]); };
+        auto it = std::lower_bound(order.begin(), order.end(), key,
+                                   [&](uint32_t p, const Key &k) { return less(keyAt(p), k); });
+        while (*it != pos) {
+            ++it;
+        }
+        return it;
+    }
+};
+
+template <typename T, typename KeyFn, typename Less>
+class Index<T, OrderedUnique<KeyFn, Less>> : public OrderedIndex<T, KeyFn, Less, true> {};
+
+template <typename T, typename KeyFn, typename Less>
+class Index<T, OrderedNonUnique<KeyFn, Less>> : public OrderedIndex<T, KeyFn, Less, false> {};
+
+} // namespace detail
+
+/**
+ * 缓存友好的多索引容器，替代热路径上的 boost::multi_index_container
+ *
+ * - 元素连续存放在一个数组里，删除时把最后一个元素搬到空位，数组始终紧凑，遍历就是顺序扫描
+ * - 索引只存元素在数组中的位置（uint32_t），不再为每个元素单独分配节点：
+ *   HashedUnique 是 SIMD 探测的 Swiss table，OrderedUnique / OrderedNonUnique 是按键排序的位置数组
+ * - Handle 在元素被删除前一直有效，不受其他元素插入、删除和搬迁的影响；元素删除后旧 Handle 失效
+ * - 元素只能通过 modify() 修改，之后只重建键发生变化的索引
+ *
+ * find 返回的指针和 begin/end 在下一次插入、删除或 modify 之前有效，需要长期持有元素时用 Handle
+ *
+ *   FlatMultiIndex<Data, HashedUnique<MemberKey<&Data::id>>, OrderedNonUnique<MemberKey<&Data::value>>> c;
+ *   auto [handle, inserted] = c.emplace(1, "a");
+ *   const Data *d = c.find<0>(1);
+ */
+template <typename T, typename... Specs> class FlatMultiIndex {
+
+    static_assert(sizeof...(Specs) > 0, "FlatMultiIndex needs at least one index");
+
+    using Indexes = std::tuple<detail::Index<T, Specs>...>;
+
+    template <size_t I> using IndexAt = std::tuple_element_t<I, Indexes>;
+
+  public:
+    template <size_t I> using KeyOf = typename IndexAt<I>::Key;
+
+    struct Handle {
+        uint32_t slot = detail::FLAT_NPOS;
+        uint32_t generation = 0;
+
+        bool operator==(const Handle &o) const noexcept { return slot == o.slot && generation == o.generation; }
+
+        bool operator!=(const Handle &o) const noexcept { return !(*this == o); }
+    };
+
+    size_t size() const noexcept { return values.size(); }
+
+    bool empty() const noexcept { return values.empty(); }
+
+    const T *begin() const noexcept { return values.data(); }
+
+    const T *end() const noexcept { return values.data() + values.size(); }
+
+    void reserve(size_t n) {
+        values.reserve(n);
+        denseSlot.reserve(n);
+        slots.reserve(n);
+        forEachIndex([&](auto &index) { index.reserve(n, values); });
+    }
+
+    void clear() {
+        for (uint32_t slot : denseSlot) {
+            release(slot);
+        }
+        values.clear();
+        denseSlot.clear();
+        forEachIndex([](auto &index) { index.clear(); });
+    }
+
+    /**
+     * 插入元素；与某个唯一索引上的已有元素冲突时不插入，返回该元素的 Handle 和 false
+     */
+    std::pair<Handle, bool> insert(T value) {
+        uint32_t clash = detail::FLAT_NPOS;
+        forEachIndex([&](const auto &index) {
+            if constexpr (std::decay_t<decltype(index)>::UNIQUE) {
+                if (clash == detail::FLAT_NPOS) {
+                    clash = index.find(index.keyOf(value), values);
+                }
+            }
+        });
+        if (clash != detail::FLAT_NPOS) {
+            return {handleAt(clash), false};
+        }
+        const auto pos = static_cast<uint32_t>(values.size());
+        values.push_back(std::move(value));
+        uint32_t slot;
+        if (!freeSlots.empty()) {
+            slot = freeSlots.back();
+            freeSlots.pop_back();
+        } else {
+            slot = static_cast<uint32_t>(slots.size());
+            slots.push_back(Slot{});
+        }
+        slots[slot].dense = pos;
+        denseSlot.push_back(slot);
+        forEachIndex([&](auto &index) { index.insert(pos, values); });
+        return {Handle{slot, slots[slot].generation}, true};
+    }
+
+    template <typename... Args> std::pair<Handle, bool> emplace(Args &&...args) {
+        return insert(T(std::forward<Args>(args)...));
+    }
+
+    /**
+     * 通过第 I 个索引查找，非唯一索引上有多个匹配时返回排在最前的一个
+     */
+    template <size_t I, typename K> const T *find(const K &key) const {
+        const uint32_t pos = std::get<I>(indexes).find(key, values);
+        return pos == detail::FLAT_NPOS ? nullptr : &values[pos];
+    }
+
+    template <size_t I, typename K> Handle findHandle(const K &key) const {
+        const uint32_t pos = std::get<I>(indexes).find(key, values);
+        return pos == detail::FLAT_NPOS ? Handle{} : handleAt(pos);
+    }
+
+    template <size_t I, typename K> size_t count(const K &key) const {
+        const auto &index = std::get<I>(indexes);
+        if constexpr (IndexAt<I>::UNIQUE) {
+            return index.find(key, values) == detail::FLAT_NPOS ? 0 : 1;
+        } else {
+            return static_cast<size_t>(index.upperBound(key, values) - index.lowerBound(key, values));
+        }
+    }
+
+    // Handle 已失效时返回 nullptr
+    const T *get(Handle h) const noexcept {
+        const uint32_t pos = denseOf(h);
+        return pos == detail::FLAT_NPOS ? nullptr : &values[pos];
+    }
+
+    // p 必须指向本容器中的元素
+    Handle handleOf(const T *p) const noexcept { return handleAt(static_cast<uint32_t>(p - values.data())); }
+
+    bool erase(Handle h) {
+        const uint32_t pos = denseOf(h);
+        if (pos == detail::FLAT_NPOS) {
+            return false;
+        }
+        eraseAt(pos);
+        return true;
+    }
+
+    // 删除第 I 个索引上键等于 key 的所有元素，返回删除的个数
+    template <size_t I, typename K> size_t eraseKey(const K &key) {
+        size_t n = 0;
+        for (uint32_t pos = std::get<I>(indexes).find(key, values); pos != detail::FLAT_NPOS;
+             pos = std::get<I>(indexes).find(key, values)) {
+            eraseAt(pos);
+            n++;
+        }
+        return n;
+    }
+
+    /**
+     * 用 fn(T&) 修改元素，然后重建键发生变化的索引
+     *
+     * @return Handle 已失效时返回 false；修改后与唯一索引上的其他元素冲突时，
+     *         与 boost::multi_index 的 modify 一样删除该元素并返回 false
+     */
+    template <typename Fn> bool modify(Handle h, Fn &&fn) {
+        const uint32_t pos = denseOf(h);
+        if (pos == detail::FLAT_NPOS) {
+            return false;
+        }
+        auto oldKeys = keysOf(values[pos], std::index_sequence_for<Specs...>());
+        fn(values[pos]);
+        return reindex(pos, oldKeys, std::index_sequence_for<Specs...>());
+    }
+
+    /**
+     * 按第 I 个有序索引的顺序，对键在 [low, high) 中的元素调用 fn(const T&)
+     */
+    template <size_t I, typename Fn> void forRange(const KeyOf<I> &low, const KeyOf<I> &high, Fn &&fn) const {
+        const auto &index = std::get<I>(indexes);
+        const auto last = index.lowerBound(high, values);
+        for (auto it = index.lowerBound(low, values); it < last; ++it) {
+            fn(values[*it]);
+        }
+    }
+
+    // 按第 I 个有序索引的顺序遍历所有元素
+    template <size_t I, typename Fn> void forEachOrdered(Fn &&fn) const {
+        for (uint32_t pos : std::get<I>(indexes).positions()) {
+            fn(values[pos]);
+        }
+    }
+
+    /**
+     * 容器自身占用的字节数（元素数组、Handle 表和所有索引），不含元素内部的堆内存
+     */
+    size_t memoryBytes() const noexcept {
+        size_t bytes = values.capacity() * sizeof(T) + denseSlot.capacity() * sizeof(uint32_t) +
+                       slots.capacity() * sizeof(Slot) + freeSlots.capacity() * sizeof(uint32_t);
+        std::apply([&](const auto &...index) { ((bytes += index.memoryBytes()), ...); }, indexes);
+        return bytes;
+    }
+
+  private:
+    struct Slot {
+        uint32_t dense = detail::FLAT_NPOS;
+        uint32_t generation = 0;
+    };
+
+    std::vector<T> values;
+    // values[i] 所属的 Handle 槽
+    std::vector<uint32_t> denseSlot;
+    std::vector<Slot> slots;
+    std::vector<uint32_t> freeSlots;
+    Indexes indexes;
+
+    template <typename Fn> void forEachIndex(Fn &&fn) {
+        std::apply([&](auto &...index) { (fn(index), ...); }, indexes);
+    }
+
+    Handle handleAt(uint32_t pos) const noexcept {
+        const uint32_t slot = denseSlot[pos];
+        return Handle{slot, slots[slot].generation};
+    }
+
+    uint32_t denseOf(Handle h) const noexcept {
+        if (h.slot >= slots.size() || slots[h.slot].generation != h.generation) {
+            return detail::FLAT_NPOS;
+        }
+        return slots[h.slot].dense;
+    }
+
+    void release(uint32_t slot) {
+        slots[slot].dense = detail::FLAT_NPOS;
+        slots[slot].generation++;
+        freeSlots.push_back(slot);
+    }
+
+    template <size_t... I> auto keysOf(const T &value, std::index_sequence<I...>) const {
+        return std::make_tuple(KeyOf<I>(std::get<I>(indexes).keyOf(value))...);
+    }
+
+    template <typename Keys, size_t... I> bool reindex(uint32_t pos, const Keys &oldKeys, std::index_sequence<I...>) {
+        // 先检查所有索引再改动，冲突时元素按旧键从各索引删除
+        const bool conflict =
+            (std::get<I>(indexes).conflicts(std::get<I>(indexes).keyOf(values[pos]), pos, std::get<I>(oldKeys), values) ||
+             ...);
+        if (conflict) {
+            (std::get<I>(indexes).erase(pos, std::get<I>(oldKeys), values), ...);
+            compact(pos);
+            return false;
+        }
+        (reindexOne<I>(pos, std::get<I>(oldKeys)), ...);
+        return true;
+    }
+
+    template <size_t I> void reindexOne(uint32_t pos, const KeyOf<I> &oldKey) {
+        auto &index = std::get<I>(indexes);
+        if (!(index.keyOf(values[pos]) == oldKey)) {
+            index.erase(pos, oldKey, values);
+            index.insert(pos, values);
+        }
+    }
+
+    void eraseAt(uint32_t pos) {
+        forEachIndex([&](auto &index) { index.erase(pos, index.keyOf(values[pos]), values); });
+        compact(pos);
+    }
+
+    // pos 已从所有索引中移除：释放它的 Handle，把最后一个元素搬过来并更新它的索引项
+    void compact(uint32_t pos) {
+        release(denseSlot[pos]);
+        const auto last = static_cast<uint32_t>(values.size() - 1);
+        if (pos != last) {
+            values[pos] = std::move(values[last]);
+            denseSlot[pos] = denseSlot[last];
+            slots[denseSlot[pos]].dense = pos;
+            forEachIndex([&](auto &index) { index.relocate(last, pos, values); });
+        }
+        values.pop_back();
+        denseSlot.pop_back();
+    }
+};
+
+RHINO_INLINE_NAMESPACE_END
+} // namespace rhino
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include "common/Version.h"
+
+#if defined(__linux__)
+#include <climits>
+#include <ctime>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace rhino {
+RHINO_INLINE_NAMESPACE_BEGIN
+
+/**
+ * futex 等待：*addr == expected 时挂起当前线程，直到被 futexWake 唤醒
+ *
+ * 注意：
+ * - 可能虚假唤醒，调用方必须在循环里重新检查条件
+ * - 非 Linux 平台退化为 yield，语义不变但会空转
+ *
+ * @param addr 等待的 32 位原子变量
+ * @param expected 期望值，不相等时立即返回
+ */
+inline void futexWait(std::atomic<uint32_t> *addr, uint32_t expected) noexcept {
+#if defined(__linux__)
+    syscall(SYS_futex, reinterpret_cast<uint32_t *>(addr), FUTEX_WAIT_PRIVATE, expected,
+            nullptr, nullptr, 0);
+#else
+    if (addr->load(std::memory_order_acquire) == expected) {
+        std::this_thread::yield();
+    }
+#endif
+}
+
+/**
+ * 带超时的 futex 等待
+ *
+ * @param timeoutNs 相对超时时间（纳秒）
+ */
+inline void futexWaitFor(std::atomic<uint32_t> *addr, uint32_t expected,
+                         int64_t timeoutNs) noexcept {
+#if defined(__linux__)
+    timespec ts{};
+    ts.tv_sec = static_cast<time_t>(timeoutNs / 1000000000);
+    ts.tv_nsec = static_cast<long>(timeoutNs % 1000000000);
+    syscall(SYS_futex, reinterpret_cast<uint32_t *>(addr), FUTEX_WAIT_PRIVATE, expected,
+            &ts, nullptr, 0);
+#else
+    (void)timeoutNs;
+    futexWait(addr, expected);
+#endif
+}
+
+/**
+ * 唤醒在 addr 上等待的线程
+ *
+ * @param count 最多唤醒的线程数，默认唤醒全部
+ */
+inline void futexWake(std::atomic<uint32_t> *addr, int count = INT32_MAX) noexcept {
+#if defined(__linux__)
+    syscall(SYS_futex, reinterpret_cast<uint32_t *>(addr), FUTEX_WAKE_PRIVATE, count,
+            nullptr, nullptr, 0);
+#else
+    (void)addr;
+    (void)count;
+#endif
+}
+
+RHINO_INLINE_NAMESPACE_END
+} // namespace rhino
@@ -0,0 +1,123 @@
+#pragma once
+
+#include <cstddef>
+#include <cstring>
+#include <functional>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include "common/Version.h"
+#include "util/SmallVector.hpp"
+
+namespace rhino {
+RHINO_INLINE_NAMESPACE_BEGIN
+
+template <typename Sig, size_t Bytes = 48> class InlineFunction;
+
+/**
+ * 不分配内存的类型擦除可调用对象，替代回调场景中的 std::function
+ *
+ * - 可调用对象必须放得进 Bytes 字节的内联存储，放不下在编译期报错（而不是像 std::function 那样悄悄去堆上分配），
+ *   这时应增大 Bytes 或改为捕获指针
+ * - 只能移动不能复制，因此可以保存只能移动的 lambda（例如捕获了 std::unique_ptr）
+ * - 平凡可重定位的可调用对象（见 IsTriviallyRelocatable）移动时直接复制整块存储，不经过函数指针
+ * - 与 std::function 一样 operator() 是 const 的；调用空的 InlineFunction 抛 std::bad_function_call
+ */
+template <typename R, typename... Args, size_t Bytes> class InlineFunction<R(Args...), Bytes> {
+
+  public:
+    InlineFunction() noexcept = default;
+
+    InlineFunction(std::nullptr_t) noexcept {}
+
+    template <typename F, typename Fn = std::decay_t<F>,
+              typename = std::enable_if_t<!std::is_same_v<Fn, InlineFunction> && std::is_invocable_r_v<R, Fn &, Args...>>>
+    InlineFunction(F &&f) {
+        static_assert(sizeof(Fn) <= Bytes, "callable does not fit into InlineFunction, increase Bytes");
+        static_assert(alignof(Fn) <= alignof(std::max_align_t), "over-aligned callable is not supported");
+        static_assert(std::is_nothrow_move_constructible_v<Fn>, "callable must be nothrow move constructible");
+        new (storage) Fn(std::forward<F>(f));
+        ops = &OPS<Fn>;
+    }
+
+    InlineFunction(InlineFunction &&other) noexcept { take(other); }
+
+    InlineFunction &operator=(InlineFunction &&other) noexcept {
+        if (this != &other) {
+            reset();
+            take(other);
+        }
+        return *this;
+    }
+
+    InlineFunction &operator=(std::nullptr_t) noexcept {
+        reset();
+        return *this;
+    }
+
+    InlineFunction(const InlineFunction &) = delete;
+    InlineFunction &operator=(const InlineFunction &) = delete;
+
+    ~InlineFunction() { reset(); }
+
+    R operator()(Args... args) const {
+        if (ops == nullptr) {
+            throw std::bad_function_call();
+        }
+        return ops->invoke(const_cast<unsigned char *>(storage), std::forward<Args>(args)...);
+    }
+
+    explicit operator bool() const noexcept { return ops != nullptr; }
+
+    void reset() noexcept {
+        if (ops != nullptr && ops->destroy != nullptr) {
+            ops->destroy(storage);
+        }
+        ops = nullptr;
+    }
+
+    static constexpr size_t capacity() noexcept { return Bytes; }
+
+  private:
+    struct Ops {
+        R (*invoke)(void *, Args &&...);
+        // nullptr 表示按字节复制即可
+        void (*relocate)(void *dst, void *src) noexcept;
+        // nullptr 表示平凡析构
+        void (*destroy)(void *) noexcept;
+        size_t size;
+    };
+
+    template <typename Fn> static R invokeImpl(void *p, Args &&...args) {
+        return std::invoke(*static_cast<Fn *>(p), std::forward<Args>(args)...);
+    }
+
+    template <typename Fn> static void relocateImpl(void *dst, void *src) noexcept {
+        detail::relocate(static_cast<Fn *>(src), 1, static_cast<Fn *>(dst));
+    }
+
+    template <typename Fn> static void destroyImpl(void *p) noexcept { static_cast<Fn *>(p)->~Fn(); }
+
+    template <typename Fn>
+    static constexpr Ops OPS = {&invokeImpl<Fn>, IsTriviallyRelocatable<Fn>::value ? nullptr : &relocateImpl<Fn>,
+                                std::is_trivially_destructible_v<Fn> ? nullptr : &destroyImpl<Fn>, sizeof(Fn)};
+
+    alignas(std::max_align_t) unsigned char storage[Bytes];
+    const Ops *ops = nullptr;
+
+    void take(InlineFunction &other) noexcept {
+        if (other.ops == nullptr) {
+            return;
+        }
+        if (other.ops->relocate == nullptr) {
+            std::memcpy(storage, other.storage, other.ops->size);
+        } else {
+            other.ops->relocate(storage, other.storage);
+        }
+        ops = other.ops;
+        other.ops = nullptr;
+    }
+};
+
+RHINO_INLINE_NAMESPACE_END
+} // namespace rhino
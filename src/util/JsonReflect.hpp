@@ -0,0 +1,638 @@
+#pragma once
+
+#include <bitset>
+#include <charconv>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+#include "common/Version.h"
+#include "util/JsonUtil.hpp"
+
+#define RHINO_REFLECT_NAME(field) #field,
+#define RHINO_REFLECT_VISIT(field) visitor(field);
+
+/**
+ * 在结构体内声明需要序列化的字段，参数与 NLOHMANN_DEFINE_TYPE_INTRUSIVE 相同，并且同时生成它的 to_json/from_json，
+ * 原来用 nlohmann 的地方不受影响；writeJson/readJson 则直接按字段流式读写，不经过 nlohmann::json 树
+ */
+#define RHINO_REFLECT(Type, ...)                                                                                      \
+    NLOHMANN_DEFINE_TYPE_INTRUSIVE(Type, __VA_ARGS__)                                                                 \
+    static constexpr std::string_view rhinoFieldNames[] = {                                                           \
+        NLOHMANN_JSON_EXPAND(NLOHMANN_JSON_PASTE(RHINO_REFLECT_NAME, __VA_ARGS__))};                                  \
+    template <typename Visitor> void rhinoVisit(Visitor &&visitor) {                                                  \
+        NLOHMANN_JSON_EXPAND(NLOHMANN_JSON_PASTE(RHINO_REFLECT_VISIT, __VA_ARGS__))                                   \
+    }                                                                                                                 \
+    template <typename Visitor> void rhinoVisit(Visitor &&visitor) const {                                            \
+        NLOHMANN_JSON_EXPAND(NLOHMANN_JSON_PASTE(RHINO_REFLECT_VISIT, __VA_ARGS__))                                   \
+    }
+
+namespace rhino {
+RHINO_INLINE_NAMESPACE_BEGIN
+
+namespace detail {
+
+template <typename T, typename = void> struct IsReflected : std::false_type {};
+template <typename T> struct IsReflected<T, std::void_t<decltype(T::rhinoFieldNames)>> : std::true_type {};
+
+template <typename T> struct IsOptional : std::false_type {};
+template <typename T> struct IsOptional<std::optional<T>> : std::true_type {};
+
+template <typename T> struct IsVector : std::false_type {};
+template <typename T, typename A> struct IsVector<std::vector<T, A>> : std::true_type {};
+
+template <typename T> struct IsStringMap : std::false_type {};
+template <typename V, typename C, typename A> struct IsStringMap<std::map<std::string, V, C, A>> : std::true_type {};
+template <typename V, typename H, typename E, typename A>
+struct IsStringMap<std::unordered_map<std::string, V, H, E, A>> : std::true_type {};
+
+} // namespace detail
+
+/**
+ * 把值直接写成紧凑的 JSON 追加到 out 后面
+ *
+ * 支持 bool、整数、浮点、字符串、std::optional（空时写 null，与 JsonUtil 中的 adl_serializer 一致）、
+ * std::vector、以 std::string 为键的 map 和 RHINO_REFLECT 声明过的类型；其他类型退回 nlohmann::json 序列化。
+ * 字段按声明顺序输出（nlohmann 默认按键名排序），浮点数格式与 nlohmann 相同（整数值带 .0，非有限值写 null）
+ */
+class JsonWriter {
+    std::string &out;
+
+  public:
+    explicit JsonWriter(std::string &out) noexcept : out(out) {}
+
+    template <typename T> void write(const T &value) {
+        if constexpr (std::is_same_v<T, bool>) {
+            out += value ? "true" : "false";
+        } else if constexpr (std::is_integral_v<T>) {
+            char buf[24];
+            out.append(buf, std::to_chars(buf, buf + sizeof(buf), value).ptr);
+        } else if constexpr (std::is_floating_point_v<T>) {
+            writeFloat(static_cast<double>(value));
+        } else if constexpr (std::is_convertible_v<const T &, std::string_view>) {
+            writeString(value);
+        } else if constexpr (std::is_same_v<T, std::nullptr_t> || std::is_same_v<T, void *>) {
+            out += "null";
+        } else if constexpr (detail::IsOptional<T>::value) {
+            if (value) {
+                write(*value);
+            } else {
+                out += "null";
+            }
+        } else if constexpr (detail::IsVector<T>::value) {
+            out += '[';
+            bool first = true;
+            for (const auto &e : value) {
+                if (!first) {
+                    out += ',';
+                }
+                first = false;
+                write(static_cast<const typename T::value_type &>(e));
+            }
+            out += ']';
+        } else if constexpr (detail::IsStringMap<T>::value) {
+            out += '{';
+            bool first = true;
+            for (const auto &[k, v] : value) {
+                if (!first) {
+                    out += ',';
+                }
+                first = false;
+                writeString(k);
+                out += ':';
+                write(v);
+            }
+            out += '}';
+        } else if constexpr (detail::IsReflected<T>::value) {
+            out += '{';
+            size_t i = 0;
+            value.rhinoVisit([this, &i](const auto &field) {
+                if (i > 0) {
+                    out += ',';
+                }
+                // 字段名是合法的标识符，不需要转义
+                out += '"';
+                out += T::rhinoFieldNames[i++];
+                out += "\":";
+                write(field);
+            });
+            out += '}';
+        } else {
+            out += nlohmann::json(value).dump();
+        }
+    }
+
+  private:
+    void writeFloat(double v) {
+        if (!std::isfinite(v)) {
+            out += "null";
+            return;
+        }
+        char buf[32];
+        char *end = std::to_chars(buf, buf + sizeof(buf), v).ptr;
+        out.append(buf, end);
+        for (const char *p = buf; p != end; p++) {
+            if (*p == '.' || *p == 'e') {
+                return;
+            }
+        }
+        out += ".0";
+    }
+
+    void writeString(std::string_view s) {
+        static constexpr char HEX[] = "0123456789abcdef";
+        out += '"';
+        size_t run = 0;
+        for (size_t i = 0; i < s.size(); i++) {
+            const auto c = static_cast<unsigned char>(s[i]);
+            if (c >= 0x20 && c != '"' && c != '\\') {
+                continue;
+            }
+            out.append(s.data() + run, i - run);
+            run = i + 1;
+            switch (c) {
+            case '"':
+                out += "\\\"";
+                break;
+            case '\\':
+                out += "\\\\";
+                break;
+            case '\b':
+                out += "\\b";
+                break;
+            case '\f':
+                out += "\\f";
+                break;
+            case '\n':
+                out += "\\n";
+                break;
+            case '\r':
+                out += "\\r";
+                break;
+            case '\t':
+                out += "\\t";
+                break;
+            default:
+                out += "\\u00";
+                out += HEX[c >> 4];
+                out += HEX[c & 0xF];
+            }
+        }
+        out.append(s.data() + run, s.size() - run);
+        out += '"';
+    }
+};
+
+/**
+ * 从 JSON 文本直接填充值，不构造 nlohmann::json 树
+ *
+ * 支持的类型与 JsonWriter 相同。RHINO_REFLECT 类型：未声明的键被跳过，缺少非 optional 字段时报错，
+ * null 读进 optional 得到 std::nullopt。格式错误、类型不符时抛出 std::invalid_argument，消息带出错的偏移
+ */
+class JsonReader {
+    const char *begin;
+    const char *p;
+    const char *end;
+    // 带转义的键名解码到这里
+    std::string keyScratch;
+
+  public:
+    explicit JsonReader(std::string_view in) noexcept : begin(in.data()), p(in.data()), end(in.data() + in.size()) {}
+
+    template <typename T> void read(T &value) {
+        skipWs();
+        if constexpr (std::is_same_v<T, bool>) {
+            if (consumeWord("true")) {
+                value = true;
+            } else if (consumeWord("false")) {
+                value = false;
+            } else {
+                fail("expected boolean");
+            }
+        } else if constexpr (std::is_integral_v<T>) {
+            readInteger(value);
+        } else if constexpr (std::is_floating_point_v<T>) {
+            value = static_cast<T>(readDouble());
+        } else if constexpr (std::is_same_v<T, std::string>) {
+            value.clear();
+            readString(value);
+        } else if constexpr (std::is_same_v<T, void *>) {
+            skipValue();
+            value = nullptr;
+        } else if constexpr (detail::IsOptional<T>::value) {
+            if (consumeWord("null")) {
+                value.reset();
+            } else {
+                read(value.emplace());
+            }
+        } else if constexpr (detail::IsVector<T>::value) {
+            value.clear();
+            expect('[');
+            if (consumeAfterWs(']')) {
+                return;
+            }
+            do {
+                if constexpr (std::is_same_v<typename T::value_type, bool>) {
+                    bool b;
+                    read(b);
+                    value.push_back(b);
+                } else {
+                    read(value.emplace_back());
+                }
+            } while (consumeAfterWs(','));
+            expectAfterWs(']');
+        } else if constexpr (detail::IsStringMap<T>::value) {
+            value.clear();
+            expect('{');
+            if (consumeAfterWs('}')) {
+                return;
+            }
+            do {
+                skipWs();
+                std::string key;
+                readString(key);
+                expectAfterWs(':');
+                read(value[std::move(key)]);
+            } while (consumeAfterWs(','));
+            expectAfterWs('}');
+        } else if constexpr (detail::IsReflected<T>::value) {
+            readObject(value);
+        } else {
+            const char *start = p;
+            skipValue();
+            nlohmann::json::parse(start, p).get_to(value);
+        }
+    }
+
+    // 顶层值之后只能有空白
+    void finish() {
+        skipWs();
+        if (p != end) {
+            fail("unexpected trailing characters");
+        }
+    }
+
+  private:
+    [[noreturn]] void fail(const char *what) const {
+        throw std::invalid_argument(std::string("json: ") + what + " at offset " + std::to_string(p - begin));
+    }
+
+    void skipWs() noexcept {
+        while (p != end && (*p == ' ' || *p == '\n' || *p == '\r' || *p == '\t')) {
+            p++;
+        }
+    }
+
+    bool consumeAfterWs(char c) noexcept {
+        skipWs();
+        if (p != end && *p == c) {
+            p++;
+            return true;
+        }
+        return false;
+    }
+
+    void expect(char c) {
+        if (p == end || *p != c) {
+            fail(c == '{' ? "expected object" : c == '[' ? "expected array" : "unexpected character");
+        }
+        p++;
+    }
+
+    void expectAfterWs(char c) {
+        skipWs();
+        expect(c);
+    }
+
+    bool consumeWord(std::string_view word) noexcept {
+        if (static_cast<size_t>(end - p) >= word.size() && std::string_view(p, word.size()) == word) {
+            p += word.size();
+            return true;
+        }
+        return false;
+    }
+
+    template <typename T> void readObject(T &value) {
+        constexpr size_t N = std::size(T::rhinoFieldNames);
+        std::bitset<N> seen;
+        expect('{');
+        if (!consumeAfterWs('}')) {
+            do {
+                skipWs();
+                const std::string_view key = readKey();
+                expectAfterWs(':');
+                size_t index = 0;
+                while (index < N && T::rhinoFieldNames[index] != key) {
+                    index++;
+                }
+                if (index == N) {
+                    skipWs();
+                    skipValue();
+                    continue;
+                }
+                size_t i = 0;
+                value.rhinoVisit([this, &i, index](auto &field) {
+                    if (i++ == index) {
+                        read(field);
+                    }
+                });
+                seen.set(index);
+            } while (consumeAfterWs(','));
+            expectAfterWs('}');
+        }
+        if (seen.all()) {
+            return;
+        }
+        size_t i = 0;
+        value.rhinoVisit([&seen, &i](auto &field) {
+            using F = std::decay_t<decltype(field)>;
+            if (!seen[i]) {
+                if constexpr (detail::IsOptional<F>::value) {
+                    field.reset();
+                } else {
+                    throw std::invalid_argument("json: missing field " + std::string(T::rhinoFieldNames[i]));
+                }
+            }
+            i++;
+        });
+    }
+
+    template <typename T> void readInteger(T &value) {
+        bool isFloat = false;
+        const char *stop = scanNumber(isFloat);
+        if (isFloat) {
+            // 与 nlohmann 一致：浮点数读进整数时截断
+            value = static_cast<T>(readDouble());
+            return;
+        }
+        auto [ptr, ec] = std::from_chars(p, stop, value);
+        if (ec != std::errc() || ptr != stop) {
+            fail("integer out of range");
+        }
+        p = stop;
+    }
+
+    double readDouble() {
+        bool isFloat = false;
+        const char *stop = scanNumber(isFloat);
+        double v;
+        if (!parseJsonDouble(p, stop, v)) {
+            fail("number out of range");
+        }
+        p = stop;
+        return v;
+    }
+
+    // 按 RFC 8259 的语法 -?(0|[1-9][0-9]*)(.[0-9]+)?([eE][+-]?[0-9]+)? 扫描一个数字，返回结尾但不移动 p；
+    // from_chars 自己还接受 nan、inf、.5、1. 之类 JSON 不允许的写法，所以先在这里检查
+    const char *scanNumber(bool &isFloat) const {
+        const char *q = p;
+        auto digits = [&q, this]() {
+            const char *first = q;
+            while (q != end && *q >= '0' && *q <= '9') {
+                q++;
+            }
+            return q != first;
+        };
+        if (q != end && *q == '-') {
+            q++;
+        }
+        if (q != end && *q == '0') {
+            q++;
+        } else if (!digits()) {
+            fail("expected number");
+        }
+        if (q != end && *q == '.') {
+            q++;
+            isFloat = true;
+            if (!digits()) {
+                fail("invalid number");
+            }
+        }
+        if (q != end && (*q == 'e' || *q == 'E')) {
+            q++;
+            isFloat = true;
+            if (q != end && (*q == '+' || *q == '-')) {
+                q++;
+            }
+            if (!digits()) {
+                fail("invalid number");
+            }
+        }
+        return q;
+    }
+
+    // 没有转义时直接返回输入中的切片
+    std::string_view readKey() {
+        if (p == end || *p != '"') {
+            fail("expected key");
+        }
+        const char *start = p + 1;
+        for (const char *q = start; q != end; q++) {
+            if (*q == '"') {
+                p = q + 1;
+                return {start, static_cast<size_t>(q - start)};
+            }
+            if (*q == '\\') {
+                break;
+            }
+        }
+        keyScratch.clear();
+        readString(keyScratch);
+        return keyScratch;
+    }
+
+    void readString(std::string &out) {
+        if (p == end || *p != '"') {
+            fail("expected string");
+        }
+        p++;
+        while (true) {
+            const char *run = p;
+            while (p != end && *p != '"' && *p != '\\') {
+                if (static_cast<unsigned char>(*p) < 0x20) {
+                    fail("control character in string");
+                }
+                p++;
+            }
+            out.append(run, p);
+            if (p == end) {
+                fail("unterminated string");
+            }
+            if (*p++ == '"') {
+                return;
+            }
+            if (p == end) {
+                fail("unterminated string");
+            }
+            switch (*p++) {
+            case '"':
+                out += '"';
+                break;
+            case '\\':
+                out += '\\';
+                break;
+            case '/':
+                out += '/';
+                break;
+            case 'b':
+                out += '\b';
+                break;
+            case 'f':
+                out += '\f';
+                break;
+            case 'n':
+                out += '\n';
+                break;
+            case 'r':
+                out += '\r';
+                break;
+            case 't':
+                out += '\t';
+                break;
+            case 'u':
+                appendUtf8(out, readCodePoint());
+                break;
+            default:
+                fail("invalid escape");
+            }
+        }
+    }
+
+    uint32_t readHex4() {
+        if (end - p < 4) {
+            fail("invalid \\u escape");
+        }
+        uint32_t v = 0;
+        for (int32_t i = 0; i < 4; i++) {
+            const char c = *p++;
+            v <<= 4;
+            if (c >= '0' && c <= '9') {
+                v |= static_cast<uint32_t>(c - '0');
+            } else if ((c | 0x20) >= 'a' && (c | 0x20) <= 'f') {
+                v |= static_cast<uint32_t>((c | 0x20) - 'a' + 10);
+            } else {
+                fail("invalid \\u escape");
+            }
+        }
+        return v;
+    }
+
+    uint32_t readCodePoint() {
+        const uint32_t high = readHex4();
+        if (high < 0xD800 || high > 0xDFFF) {
+            return high;
+        }
+        if (high > 0xDBFF || !consumeWord("\\u")) {
+            fail("invalid surrogate pair");
+        }
+        const uint32_t low = readHex4();
+        if (low < 0xDC00 || low > 0xDFFF) {
+            fail("invalid surrogate pair");
+        }
+        return 0x10000 + ((high - 0xD800) << 10) + (low - 0xDC00);
+    }
+
+    static void appendUtf8(std::string &out, uint32_t cp) {
+        if (cp < 0x80) {
+            out += static_cast<char>(cp);
+        } else if (cp < 0x800) {
+            out += static_cast<char>(0xC0 | (cp >> 6));
+            out += static_cast<char>(0x80 | (cp & 0x3F));
+        } else if (cp < 0x10000) {
+            out += static_cast<char>(0xE0 | (cp >> 12));
+            out += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+            out += static_cast<char>(0x80 | (cp & 0x3F));
+        } else {
+            out += static_cast<char>(0xF0 | (cp >> 18));
+            out += static_cast<char>(0x80 | ((cp >> 12) & 0x3F));
+            out += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+            out += static_cast<char>(0x80 | (cp & 0x3F));
+        }
+    }
+
+    // 跳过一个完整的值（未声明的键、void * 字段），只检查括号配对和字符串边界
+    void skipValue() {
+        if (p == end) {
+            fail("expected value");
+        }
+        if (*p != '{' && *p != '[') {
+            if (*p == '"') {
+                skipString();
+                return;
+            }
+            const char *start = p;
+            while (p != end && *p != ',' && *p != '}' && *p != ']' && *p != ' ' && *p != '\n' && *p != '\r' &&
+                   *p != '\t') {
+                p++;
+            }
+            if (start == p) {
+                fail("expected value");
+            }
+            return;
+        }
+        int32_t depth = 0;
+        do {
+            if (p == end) {
+                fail("unterminated value");
+            }
+            const char c = *p;
+            if (c == '"') {
+                skipString();
+                continue;
+            }
+            depth += (c == '{' || c == '[') ? 1 : (c == '}' || c == ']') ? -1 : 0;
+            p++;
+        } while (depth > 0);
+    }
+
+    void skipString() {
+        for (p++; p != end; p++) {
+            if (*p == '\\') {
+                if (++p == end) {
+                    break;
+                }
+            } else if (*p == '"') {
+                p++;
+                return;
+            }
+        }
+        fail("unterminated string");
+    }
+};
+
+/**
+ * 把 obj 序列化进 buffer（先清空），buffer 在多次调用间复用时不再重新分配
+ */
+template <typename T> void writeJson(const T &obj, std::string &buffer) {
+    buffer.clear();
+    JsonWriter(buffer).write(obj);
+}
+
+template <typename T> std::string writeJson(const T &obj) {
+    std::string buffer;
+    writeJson(obj, buffer);
+    return buffer;
+}
+
+template <typename T> void readJson(std::string_view in, T &obj) {
+    JsonReader reader(in);
+    reader.read(obj);
+    reader.finish();
+}
+
+template <typename T> T readJson(std::string_view in) {
+    T obj{};
+    readJson(in, obj);
+    return obj;
+}
+
+RHINO_INLINE_NAMESPACE_END
+} // namespace rhino
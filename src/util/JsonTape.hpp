@@ -0,0 +1,877 @@
+#pragma once
+
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+#include "common/Version.h"
+#include "util/JsonUtil.hpp"
+
+#if defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+namespace rhino {
+RHINO_INLINE_NAMESPACE_BEGIN
+
+enum class JsonType : uint8_t { Null, Bool, Int64, Uint64, Double, String, Array, Object };
+
+namespace detail {
+
+/**
+ * 一个 64 字节块的字符分类，第 i 位对应块内第 i 个字节
+ */
+struct JsonBlock {
+    uint64_t quote = 0;
+    uint64_t backslash = 0;
+    // { } [ ] : ,
+    uint64_t op = 0;
+    // 空格 \t \n \r
+    uint64_t ws = 0;
+    // 小于 0x20 的字节，字符串内不允许出现
+    uint64_t control = 0;
+};
+
+inline JsonBlock scanJsonBlockScalar(const char *block) noexcept {
+    JsonBlock b;
+    for (uint32_t i = 0; i < 64; i++) {
+        const auto c = static_cast<unsigned char>(block[i]);
+        const uint64_t bit = uint64_t(1) << i;
+        b.quote |= c == '"' ? bit : 0;
+        b.backslash |= c == '\\' ? bit : 0;
+        b.op |= (c == '{' || c == '}' || c == '[' || c == ']' || c == ':' || c == ',') ? bit : 0;
+        b.ws |= (c == ' ' || c == '\t' || c == '\n' || c == '\r') ? bit : 0;
+        b.control |= c < 0x20 ? bit : 0;
+    }
+    return b;
+}
+
+#if defined(__AVX2__)
+inline uint64_t jsonMask32(__m256i lo, __m256i hi, char c) noexcept {
+    const __m256i v = _mm256_set1_epi8(c);
+    return static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(lo, v))) |
+           (uint64_t(static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(hi, v)))) << 32);
+}
+
+inline JsonBlock scanJsonBlock(const char *block) noexcept {
+    const __m256i lo = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(block));
+    const __m256i hi = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(block + 32));
+    // '[' | 0x20 == '{'，']' | 0x20 == '}'，合并后少两次比较
+    const __m256i case20 = _mm256_set1_epi8(0x20);
+    const __m256i loFold = _mm256_or_si256(lo, case20);
+    const __m256i hiFold = _mm256_or_si256(hi, case20);
+    // 无符号 c <= 0x1F 等价于 max(c, 0x1F) == 0x1F
+    const __m256i limit = _mm256_set1_epi8(0x1F);
+    JsonBlock b;
+    b.quote = jsonMask32(lo, hi, '"');
+    b.backslash = jsonMask32(lo, hi, '\\');
+    b.op = jsonMask32(loFold, hiFold, '{') | jsonMask32(loFold, hiFold, '}') | jsonMask32(lo, hi, ':') |
+           jsonMask32(lo, hi, ',');
+    b.ws = jsonMask32(lo, hi, ' ') | jsonMask32(lo, hi, '\t') | jsonMask32(lo, hi, '\n') | jsonMask32(lo, hi, '\r');
+    b.control = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_max_epu8(lo, limit), limit))) |
+                (uint64_t(static_cast<uint32_t>(
+                     _mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_max_epu8(hi, limit), limit))))
+                 << 32);
+    return b;
+}
+#elif defined(__SSE2__)
+inline uint64_t jsonMask16(const __m128i *chunks, char c) noexcept {
+    const __m128i v = _mm_set1_epi8(c);
+    uint64_t mask = 0;
+    for (uint32_t i = 0; i < 4; i++) {
+        mask |= uint64_t(static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(chunks[i], v)))) << (16 * i);
+    }
+    return mask;
+}
+
+inline JsonBlock scanJsonBlock(const char *block) noexcept {
+    __m128i chunks[4];
+    __m128i folded[4];
+    uint64_t control = 0;
+    const __m128i limit = _mm_set1_epi8(0x1F);
+    for (uint32_t i = 0; i < 4; i++) {
+        chunks[i] = _mm_loadu_si128(reinterpret_cast<const __m128i *>(block + 16 * i));
+        folded[i] = _mm_or_si128(chunks[i], _mm_set1_epi8(0x20));
+        control |= uint64_t(static_cast<uint32_t>(
+                       _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_max_epu8(chunks[i], limit), limit))))
+                   << (16 * i);
+    }
+    JsonBlock b;
+    b.quote = jsonMask16(chunks, '"');
+    b.backslash = jsonMask16(chunks, '\\');
+    b.op = jsonMask16(folded, '{') | jsonMask16(folded, '}') | jsonMask16(chunks, ':') | jsonMask16(chunks, ',');
+    b.ws = jsonMask16(chunks, ' ') | jsonMask16(chunks, '\t') | jsonMask16(chunks, '\n') | jsonMask16(chunks, '\r');
+    b.control = control;
+    return b;
+}
+#else
+inline JsonBlock scanJsonBlock(const char *block) noexcept { return scanJsonBlockScalar(block); }
+#endif
+
+// 第 i 位变成第 0..i 位的异或，即该位置之前（含）出现过奇数个引号
+inline uint64_t prefixXor(uint64_t x) noexcept {
+#if defined(__PCLMUL__)
+    return static_cast<uint64_t>(
+        _mm_cvtsi128_si64(_mm_clmulepi64_si128(_mm_set_epi64x(0, static_cast<int64_t>(x)), _mm_set1_epi8(-1), 0)));
+#else
+    x ^= x << 1;
+    x ^= x << 2;
+    x ^= x << 4;
+    x ^= x << 8;
+    x ^= x << 16;
+    x ^= x << 32;
+    return x;
+#endif
+}
+
+/**
+ * 被反斜杠转义的字符：连续反斜杠按奇偶配对，只有奇数个反斜杠之后的字符被转义。
+ * prevEscaped 传入上一块末尾留下的“下一个字符被转义”，返回时更新为本块的
+ */
+inline uint64_t escapedMask(uint64_t backslash, uint64_t &prevEscaped) noexcept {
+    constexpr uint64_t EVEN = 0x5555555555555555ULL;
+    backslash &= ~prevEscaped;
+    const uint64_t followsEscape = (backslash << 1) | prevEscaped;
+    // 从奇数位开始的反斜杠序列，加上 backslash 后进位正好越过序列末尾
+    const uint64_t oddStarts = backslash & ~EVEN & ~followsEscape;
+    uint64_t evenStarts;
+    prevEscaped = __builtin_add_overflow(oddStarts, backslash, &evenStarts) ? 1 : 0;
+    const uint64_t invert = evenStarts << 1;
+    return (EVEN ^ invert) & followsEscape;
+}
+
+// 字符串内下一个引号或反斜杠的位置，没有时返回 end
+inline const char *findQuoteOrBackslash(const char *p, const char *end) noexcept {
+#if defined(__SSE2__)
+    const __m128i quote = _mm_set1_epi8('"');
+    const __m128i backslash = _mm_set1_epi8('\\');
+    for (; end - p >= 16; p += 16) {
+        const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+        const int32_t mask =
+            _mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(chunk, quote), _mm_cmpeq_epi8(chunk, backslash)));
+        if (mask != 0) {
+            return p + __builtin_ctz(static_cast<uint32_t>(mask));
+        }
+    }
+#endif
+    while (p != end && *p != '"' && *p != '\\') {
+        p++;
+    }
+    return p;
+}
+
+struct JsonTapeData {
+    // 高 8 位是标签，低 56 位是负载，见 JsonTapeParser
+    std::vector<uint64_t> tape;
+    // 带转义的字符串解码后放在这里
+    std::string strings;
+    const char *input = nullptr;
+};
+
+} // namespace detail
+
+/**
+ * 解析结果上的只读视图，不拷贝任何东西：字符串直接指向输入（有转义时指向解析器的解码缓冲）
+ *
+ * 只在 JsonTapeParser 下一次 parse 或析构之前、并且输入文本仍然存活时有效。
+ * 类型不符时抛出 std::invalid_argument，键或下标不存在时抛出 std::out_of_range
+ */
+class JsonValue {
+    friend class JsonTapeParser;
+
+    const detail::JsonTapeData *doc = nullptr;
+    size_t index = 0;
+
+    JsonValue(const detail::JsonTapeData *doc, size_t index) noexcept : doc(doc), index(index) {}
+
+    uint64_t word(size_t i) const noexcept { return doc->tape[i]; }
+
+    char tag() const noexcept { return static_cast<char>(word(index) >> 56); }
+
+    uint64_t payload() const noexcept { return word(index) & ((uint64_t(1) << 56) - 1); }
+
+    // 下一个兄弟值在 tape 中的位置
+    size_t next() const noexcept {
+        switch (tag()) {
+        case '{':
+        case '[':
+            return (payload() & 0xFFFFFFFF) + 1;
+        case '"':
+        case '\\':
+        case 'l':
+        case 'u':
+        case 'd':
+            return index + 2;
+        default:
+            return index + 1;
+        }
+    }
+
+    [[noreturn]] void typeError(const char *expected) const {
+        throw std::invalid_argument(std::string("json value is not ") + expected);
+    }
+
+  public:
+    JsonValue() = default;
+
+    JsonType type() const noexcept {
+        switch (tag()) {
+        case 't':
+        case 'f':
+            return JsonType::Bool;
+        case 'l':
+            return JsonType::Int64;
+        case 'u':
+            return JsonType::Uint64;
+        case 'd':
+            return JsonType::Double;
+        case '"':
+        case '\\':
+            return JsonType::String;
+        case '[':
+            return JsonType::Array;
+        case '{':
+            return JsonType::Object;
+        default:
+            return JsonType::Null;
+        }
+    }
+
+    bool isNull() const noexcept { return tag() == 'n'; }
+
+    bool isObject() const noexcept { return tag() == '{'; }
+
+    bool isArray() const noexcept { return tag() == '['; }
+
+    bool isString() const noexcept { return tag() == '"' || tag() == '\\'; }
+
+    bool isNumber() const noexcept { return tag() == 'l' || tag() == 'u' || tag() == 'd'; }
+
+    bool getBool() const {
+        if (tag() != 't' && tag() != 'f') {
+            typeError("a boolean");
+        }
+        return tag() == 't';
+    }
+
+    int64_t getInt64() const {
+        const uint64_t v = word(index + 1);
+        if (tag() == 'l' || (tag() == 'u' && v <= static_cast<uint64_t>(std::numeric_limits<int64_t>::max()))) {
+            return static_cast<int64_t>(v);
+        }
+        typeError("an int64");
+    }
+
+    uint64_t getUint64() const {
+        if (tag() != 'u') {
+            typeError("an uint64");
+        }
+        return word(index + 1);
+    }
+
+    // 整数也可以按浮点读取，与 nlohmann 的 get<double> 一致
+    double getDouble() const {
+        const uint64_t v = word(index + 1);
+        switch (tag()) {
+        case 'd': {
+            double d;
+            std::memcpy(&d, &v, sizeof(d));
+            return d;
+        }
+        case 'l':
+            return static_cast<double>(static_cast<int64_t>(v));
+        case 'u':
+            return static_cast<double>(v);
+        default:
+            typeError("a number");
+        }
+    }
+
+    std::string_view getString() const {
+        if (!isString()) {
+            typeError("a string");
+        }
+        const char *base = tag() == '"' ? doc->input : doc->strings.data();
+        return {base + payload(), static_cast<size_t>(word(index + 1))};
+    }
+
+    // 数组的元素个数或对象的键值对个数，其他类型为 0
+    size_t size() const noexcept {
+        if (!isArray() && !isObject()) {
+            return 0;
+        }
+        const size_t count = static_cast<size_t>(payload() >> 32);
+        if (count < 0xFFFFFF) {
+            return count;
+        }
+        // 计数饱和，数一遍
+        return static_cast<size_t>(std::distance(begin(), end()));
+    }
+
+    /**
+     * 数组元素，逐个跳过前面的元素，O(i)
+     */
+    JsonValue at(size_t i) const {
+        if (!isArray()) {
+            typeError("an array");
+        }
+        for (auto it = begin(); it != end(); ++it, i--) {
+            if (i == 0) {
+                return *it;
+            }
+        }
+        throw std::out_of_range("json array index out of range");
+    }
+
+    /**
+     * 按键查找对象成员，线性扫描；有重复键时取最后一个（与 nlohmann 一致）
+     */
+    std::optional<JsonValue> find(std::string_view key) const {
+        if (!isObject()) {
+            typeError("an object");
+        }
+        std::optional<JsonValue> found;
+        for (auto it = begin(); it != end(); ++it) {
+            if (it.key() == key) {
+                found = *it;
+            }
+        }
+        return found;
+    }
+
+    JsonValue operator[](std::string_view key) const {
+        auto v = find(key);
+        if (!v) {
+            throw std::out_of_range("json object has no key " + std::string(key));
+        }
+        return *v;
+    }
+
+    /**
+     * 遍历数组元素或对象的值；对象上 key() 返回当前的键
+     */
+    class Iterator {
+        friend class JsonValue;
+
+        const detail::JsonTapeData *doc = nullptr;
+        size_t index = 0;
+        bool object = false;
+
+        Iterator(const detail::JsonTapeData *doc, size_t index, bool object) noexcept
+            : doc(doc), index(index), object(object) {}
+
+      public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = JsonValue;
+        using difference_type = std::ptrdiff_t;
+        using pointer = void;
+        using reference = JsonValue;
+
+        Iterator() = default;
+
+        std::string_view key() const { return JsonValue(doc, index).getString(); }
+
+        JsonValue operator*() const noexcept { return JsonValue(doc, object ? index + 2 : index); }
+
+        Iterator &operator++() noexcept {
+            index = JsonValue(doc, object ? index + 2 : index).next();
+            return *this;
+        }
+
+        Iterator operator++(int) noexcept {
+            Iterator old = *this;
+            ++*this;
+            return old;
+        }
+
+        bool operator==(const Iterator &other) const noexcept { return index == other.index; }
+
+        bool operator!=(const Iterator &other) const noexcept { return index != other.index; }
+    };
+
+    Iterator begin() const noexcept {
+        return (isArray() || isObject()) ? Iterator(doc, index + 1, isObject()) : end();
+    }
+
+    Iterator end() const noexcept {
+        return Iterator(doc, (isArray() || isObject()) ? (payload() & 0xFFFFFFFF) : index, isObject());
+    }
+
+    /**
+     * 按需转换成 nlohmann::json，结果与 nlohmann::json::parse 相同（非负整数为 unsigned）
+     */
+    nlohmann::json toJsonTree() const {
+        switch (tag()) {
+        case 't':
+            return true;
+        case 'f':
+            return false;
+        case 'l':
+            return getInt64();
+        case 'u':
+            return getUint64();
+        case 'd':
+            return getDouble();
+        case '"':
+        case '\\':
+            return std::string(getString());
+        case '[': {
+            nlohmann::json j = nlohmann::json::array();
+            j.get_ref<nlohmann::json::array_t &>().reserve(size());
+            for (auto v : *this) {
+                j.push_back(v.toJsonTree());
+            }
+            return j;
+        }
+        case '{': {
+            nlohmann::json j = nlohmann::json::object();
+            for (auto it = begin(); it != end(); ++it) {
+                j[std::string(it.key())] = (*it).toJsonTree();
+            }
+            return j;
+        }
+        default:
+            return nullptr;
+        }
+    }
+};
+
+/**
+ * 两阶段 JSON 解析器，用于大报文的快速读取
+ *
+ * 第一阶段每次取 64 字节，用 SIMD 比较得到引号、反斜杠、运算符和空白的位掩码，算出字符串范围后
+ * 一次性得到所有结构字符（运算符、字符串开头、标量开头）的下标；第二阶段按下标顺序校验语法并写出 tape：
+ * - 对象/数组：开始项负载为 结束项下标 | 元素个数 << 32，结束项负载为开始项下标
+ * - 字符串：负载为偏移，下一个字是长度；没有转义时偏移指向输入，否则指向解码缓冲
+ * - 整数/浮点：下一个字是数值；true/false/null 只占一个字
+ *
+ * 结构下标、tape 和解码缓冲在多次 parse 之间复用，不再重新分配。不校验 UTF-8，
+ * 嵌套超过 MAX_DEPTH 层或输入超过 4GB 时报错。格式错误抛出 std::invalid_argument，消息带出错的偏移
+ */
+class JsonTapeParser {
+    detail::JsonTapeData data;
+    // 结构字符的下标，按输入长度分配且不做初始化，只在输入变长时重新分配
+    std::unique_ptr<uint32_t[]> structurals;
+    size_t structuralCapacity = 0;
+    size_t structuralCount = 0;
+    // 第二阶段中尚未闭合的容器在 tape 中的下标
+    std::vector<size_t> open;
+
+  public:
+    static constexpr size_t MAX_DEPTH = 1024;
+
+    JsonTapeParser() = default;
+
+    JsonTapeParser(const JsonTapeParser &) = delete;
+
+    JsonTapeParser &operator=(const JsonTapeParser &) = delete;
+
+    JsonValue parse(std::string_view json) {
+        if (json.size() >= std::numeric_limits<uint32_t>::max()) {
+            throw std::invalid_argument("json input larger than 4GB");
+        }
+        data.input = json.data();
+        data.tape.clear();
+        data.strings.clear();
+        findStructurals(json);
+        buildTape(json);
+        return JsonValue(&data, 0);
+    }
+
+    // tape 占用的字数，用于观察缓冲大小
+    size_t tapeSize() const noexcept { return data.tape.size(); }
+
+  private:
+    [[noreturn]] static void fail(const char *what, size_t offset) {
+        throw std::invalid_argument(std::string("json: ") + what + " at offset " + std::to_string(offset));
+    }
+
+    void findStructurals(std::string_view json) {
+        // 每个字节最多一个结构字符，按上限一次性分配，写入时不再检查容量
+        if (structuralCapacity < json.size() + 64) {
+            structuralCapacity = json.size() + 64;
+            structurals.reset(new uint32_t[structuralCapacity]);
+        }
+        uint32_t *out = structurals.get();
+        uint64_t prevEscaped = 0;
+        uint64_t prevInString = 0;
+        uint64_t prevScalar = 0;
+        char tail[64];
+        for (size_t base = 0; base < json.size(); base += 64) {
+            const char *block = json.data() + base;
+            if (json.size() - base < 64) {
+                // 最后不足 64 字节的部分用空白补齐
+                std::memset(tail, ' ', sizeof(tail));
+                std::memcpy(tail, block, json.size() - base);
+                block = tail;
+            }
+            const detail::JsonBlock b = detail::scanJsonBlock(block);
+            const uint64_t quote = b.quote & ~detail::escapedMask(b.backslash, prevEscaped);
+            // 含开头引号、不含结尾引号
+            const uint64_t inString = detail::prefixXor(quote) ^ prevInString;
+            prevInString = static_cast<uint64_t>(static_cast<int64_t>(inString) >> 63);
+            if ((b.control & inString) != 0) {
+                fail("control character in string", base + static_cast<size_t>(__builtin_ctzll(b.control & inString)));
+            }
+            // 标量（含字符串）的第一个字节：前一个字节不是非引号标量字符
+            const uint64_t scalar = ~(b.op | b.ws);
+            const uint64_t nonQuoteScalar = scalar & ~quote;
+            const uint64_t followsScalar = (nonQuoteScalar << 1) | prevScalar;
+            prevScalar = nonQuoteScalar >> 63;
+            uint64_t bits = (b.op | (scalar & ~followsScalar)) & ~(inString ^ quote);
+            while (bits != 0) {
+                *out++ = static_cast<uint32_t>(base) + static_cast<uint32_t>(__builtin_ctzll(bits));
+                bits &= bits - 1;
+            }
+        }
+        if (prevInString != 0) {
+            fail("unterminated string", json.size());
+        }
+        structuralCount = static_cast<size_t>(out - structurals.get());
+    }
+
+    void push(char tag, uint64_t payload) { data.tape.push_back((uint64_t(static_cast<unsigned char>(tag)) << 56) | payload); }
+
+    void openContainer(char tag, size_t offset) {
+        if (open.size() >= MAX_DEPTH) {
+            fail("nesting too deep", offset);
+        }
+        open.push_back(data.tape.size());
+        push(tag, 0);
+    }
+
+    void closeContainer(char tag) {
+        const size_t start = open.back();
+        open.pop_back();
+        const uint64_t count = data.tape[start] >> 32 & 0xFFFFFF;
+        data.tape[start] = (uint64_t(static_cast<unsigned char>(data.tape[start] >> 56)) << 56) | (count << 32) |
+                           static_cast<uint64_t>(data.tape.size());
+        push(tag, start);
+    }
+
+    // 当前容器的元素个数加一，到 0xFFFFFF 后不再增加
+    void countElement() {
+        uint64_t &w = data.tape[open.back()];
+        if ((w >> 32 & 0xFFFFFF) < 0xFFFFFF) {
+            w += uint64_t(1) << 32;
+        }
+    }
+
+    void buildTape(std::string_view json) {
+        enum class State { Value, ObjectFirst, ObjectKey, ArrayFirst, AfterValue };
+        open.clear();
+        const size_t n = structuralCount;
+        // 每个结构字符最多写两个字
+        data.tape.reserve(2 * n);
+        size_t pos = 0;
+        auto nextOffset = [&]() -> size_t {
+            if (pos == n) {
+                fail("unexpected end of input", json.size());
+            }
+            return structurals[pos++];
+        };
+        State state = State::Value;
+        while (true) {
+            switch (state) {
+            case State::Value: {
+                const size_t offset = nextOffset();
+                const char c = json[offset];
+                if (c == '{') {
+                    openContainer('{', offset);
+                    state = State::ObjectFirst;
+                } else if (c == '[') {
+                    openContainer('[', offset);
+                    state = State::ArrayFirst;
+                } else {
+                    parseScalar(json, offset);
+                    state = State::AfterValue;
+                }
+                break;
+            }
+            case State::ObjectFirst:
+                if (pos < n && json[structurals[pos]] == '}') {
+                    pos++;
+                    closeContainer('}');
+                    state = State::AfterValue;
+                    break;
+                }
+                state = State::ObjectKey;
+                [[fallthrough]];
+            case State::ObjectKey: {
+                const size_t offset = nextOffset();
+                if (json[offset] != '"') {
+                    fail("expected key", offset);
+                }
+                parseString(json, offset);
+                countElement();
+                const size_t colon = nextOffset();
+                if (json[colon] != ':') {
+                    fail("expected ':'", colon);
+                }
+                state = State::Value;
+                break;
+            }
+            case State::ArrayFirst:
+                if (pos < n && json[structurals[pos]] == ']') {
+                    pos++;
+                    closeContainer(']');
+                    state = State::AfterValue;
+                    break;
+                }
+                countElement();
+                state = State::Value;
+                break;
+            case State::AfterValue: {
+                if (open.empty()) {
+                    if (pos != n) {
+                        fail("unexpected trailing characters", structurals[pos]);
+                    }
+                    return;
+                }
+                const size_t offset = nextOffset();
+                const char c = json[offset];
+                const bool inObject = static_cast<char>(data.tape[open.back()] >> 56) == '{';
+                if (c == ',') {
+                    if (inObject) {
+                        state = State::ObjectKey;
+                    } else {
+                        countElement();
+                        state = State::Value;
+                    }
+                } else if (c == (inObject ? '}' : ']')) {
+                    closeContainer(c);
+                } else {
+                    fail(inObject ? "expected ',' or '}'" : "expected ',' or ']'", offset);
+                }
+                break;
+            }
+            }
+        }
+    }
+
+    // 标量后面必须紧跟空白、运算符或输入结尾
+    static void expectDelimiter(std::string_view json, size_t offset) {
+        if (offset < json.size()) {
+            const char c = json[offset];
+            if (c != ' ' && c != '\t' && c != '\n' && c != '\r' && c != ',' && c != ':' && c != ']' && c != '}' &&
+                c != '[' && c != '{') {
+                fail("invalid literal", offset);
+            }
+        }
+    }
+
+    void parseScalar(std::string_view json, size_t offset) {
+        const char c = json[offset];
+        const std::string_view rest = json.substr(offset);
+        if (c == '"') {
+            parseString(json, offset);
+        } else if (c == '-' || (c >= '0' && c <= '9')) {
+            parseNumber(json, offset);
+        } else if (rest.substr(0, 4) == "true") {
+            push('t', 0);
+            expectDelimiter(json, offset + 4);
+        } else if (rest.substr(0, 5) == "false") {
+            push('f', 0);
+            expectDelimiter(json, offset + 5);
+        } else if (rest.substr(0, 4) == "null") {
+            push('n', 0);
+            expectDelimiter(json, offset + 4);
+        } else {
+            fail("unexpected character", offset);
+        }
+    }
+
+    void parseString(std::string_view json, size_t offset) {
+        const char *begin = json.data() + offset + 1;
+        const char *end = json.data() + json.size();
+        const char *p = detail::findQuoteOrBackslash(begin, end);
+        // 第一阶段已经保证字符串闭合
+        if (*p == '"') {
+            push('"', static_cast<uint64_t>(begin - json.data()));
+            data.tape.push_back(static_cast<uint64_t>(p - begin));
+            return;
+        }
+        const size_t start = data.strings.size();
+        data.strings.append(begin, p);
+        while (*p != '"') {
+            if (*p != '\\') {
+                const char *run = p;
+                p = detail::findQuoteOrBackslash(p, end);
+                data.strings.append(run, p);
+                continue;
+            }
+            p++;
+            switch (*p++) {
+            case '"':
+                data.strings += '"';
+                break;
+            case '\\':
+                data.strings += '\\';
+                break;
+            case '/':
+                data.strings += '/';
+                break;
+            case 'b':
+                data.strings += '\b';
+                break;
+            case 'f':
+                data.strings += '\f';
+                break;
+            case 'n':
+                data.strings += '\n';
+                break;
+            case 'r':
+                data.strings += '\r';
+                break;
+            case 't':
+                data.strings += '\t';
+                break;
+            case 'u':
+                p = appendCodePoint(json, p);
+                break;
+            default:
+                fail("invalid escape", static_cast<size_t>(p - 1 - json.data()));
+            }
+        }
+        push('\\', start);
+        data.tape.push_back(data.strings.size() - start);
+    }
+
+    static bool readHex4(const char *p, const char *end, uint32_t &v) {
+        if (end - p < 4) {
+            return false;
+        }
+        v = 0;
+        for (int32_t i = 0; i < 4; i++) {
+            const char c = p[i];
+            v <<= 4;
+            if (c >= '0' && c <= '9') {
+                v |= static_cast<uint32_t>(c - '0');
+            } else if ((c | 0x20) >= 'a' && (c | 0x20) <= 'f') {
+                v |= static_cast<uint32_t>((c | 0x20) - 'a' + 10);
+            } else {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // p 指向 \u 之后，返回转义序列之后的位置
+    const char *appendCodePoint(std::string_view json, const char *p) {
+        const char *end = json.data() + json.size();
+        const size_t offset = static_cast<size_t>(p - 2 - json.data());
+        uint32_t cp;
+        if (!readHex4(p, end, cp)) {
+            fail("invalid \\u escape", offset);
+        }
+        p += 4;
+        if (cp >= 0xD800 && cp <= 0xDFFF) {
+            uint32_t low;
+            if (cp > 0xDBFF || end - p < 2 || p[0] != '\\' || p[1] != 'u' || !readHex4(p + 2, end, low) ||
+                low < 0xDC00 || low > 0xDFFF) {
+                fail("invalid surrogate pair", offset);
+            }
+            p += 6;
+            cp = 0x10000 + ((cp - 0xD800) << 10) + (low - 0xDC00);
+        }
+        std::string &out = data.strings;
+        if (cp < 0x80) {
+            out += static_cast<char>(cp);
+        } else if (cp < 0x800) {
+            out += static_cast<char>(0xC0 | (cp >> 6));
+            out += static_cast<char>(0x80 | (cp & 0x3F));
+        } else if (cp < 0x10000) {
+            out += static_cast<char>(0xE0 | (cp >> 12));
+            out += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+            out += static_cast<char>(0x80 | (cp & 0x3F));
+        } else {
+            out += static_cast<char>(0xF0 | (cp >> 18));
+            out += static_cast<char>(0x80 | ((cp >> 12) & 0x3F));
+            out += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+            out += static_cast<char>(0x80 | (cp & 0x3F));
+        }
+        return p;
+    }
+
+    // 按 JSON 语法校验：-?(0|[1-9][0-9]*)(\.[0-9]+)?([eE][+-]?[0-9]+)?
+    void parseNumber(std::string_view json, size_t offset) {
+        const char *begin = json.data() + offset;
+        const char *end = json.data() + json.size();
+        const char *p = begin;
+        const bool negative = *p == '-';
+        p += negative ? 1 : 0;
+        auto digit = [&](const char *q) { return q != end && *q >= '0' && *q <= '9'; };
+        if (!digit(p)) {
+            fail("invalid number", offset);
+        }
+        uint64_t mantissa = 0;
+        bool overflow = false;
+        if (*p == '0') {
+            p++;
+        } else {
+            for (; digit(p); p++) {
+                const auto d = static_cast<uint64_t>(*p - '0');
+                overflow |= mantissa > (std::numeric_limits<uint64_t>::max() - d) / 10;
+                mantissa = mantissa * 10 + d;
+            }
+        }
+        bool isFloat = false;
+        if (p != end && *p == '.') {
+            p++;
+            if (!digit(p)) {
+                fail("invalid number", offset);
+            }
+            while (digit(p)) {
+                p++;
+            }
+            isFloat = true;
+        }
+        if (p != end && (*p == 'e' || *p == 'E')) {
+            p++;
+            if (p != end && (*p == '+' || *p == '-')) {
+                p++;
+            }
+            if (!digit(p)) {
+                fail("invalid number", offset);
+            }
+            while (digit(p)) {
+                p++;
+            }
+            isFloat = true;
+        }
+        expectDelimiter(json, static_cast<size_t>(p - json.data()));
+        if (!isFloat && !overflow) {
+            if (!negative) {
+                push('u', 0);
+                data.tape.push_back(mantissa);
+                return;
+            }
+            if (mantissa <= uint64_t(1) << 63) {
+                push('l', 0);
+                data.tape.push_back(0 - mantissa);
+                return;
+            }
+        }
+        // 浮点数和超出 64 位的整数按 double 保存，与 nlohmann 一致
+        double v;
+        if (!parseJsonDouble(begin, p, v)) {
+            fail("number out of range", offset);
+        }
+        uint64_t bits;
+        std::memcpy(&bits, &v, sizeof(bits));
+        push('d', 0);
+        data.tape.push_back(bits);
+    }
+};
+
+RHINO_INLINE_NAMESPACE_END
+} // namespace rhino
@@ -1,6 +1,10 @@
 
 #pragma once
 
+#include <charconv>
+#include <cstdint>
+#include <memory_resource>
+#include <string>
 #include <nlohmann/json.hpp>
 #include <nlohmann/json_fwd.hpp>
 #include "common/Version.h"
@@ -39,11 +43,81 @@ template <> struct adl_serializer<void *> {
 
 namespace rhino {
 RHINO_INLINE_NAMESPACE_BEGIN
+/**
+ * 把已经按 JSON 语法校验过的数字 [first, last) 转成 double，只有上溢时返回 false
+ *
+ * from_chars 对上溢和下溢都报 result_out_of_range，这里与 nlohmann 一致把下溢读成 ±0.0
+ */
+inline bool parseJsonDouble(const char *first, const char *last, double &value) {
+    auto [ptr, ec] = std::from_chars(first, last, value);
+    if (ec == std::errc() && ptr == last) {
+        return true;
+    }
+    if (ec != std::errc::result_out_of_range) {
+        return false;
+    }
+    // 越界时数值离 1 至少差三百个数量级，用首个非零数字的位置加上指数就能分清上溢和下溢
+    const char *q = first;
+    const bool negative = *q == '-';
+    if (negative) {
+        q++;
+    }
+    int64_t magnitude = 0;
+    bool seenDigit = false;
+    bool fraction = false;
+    for (; q != last && *q != 'e' && *q != 'E'; q++) {
+        if (*q == '.') {
+            fraction = true;
+        } else if (!fraction) {
+            seenDigit = seenDigit || *q != '0';
+            magnitude += seenDigit ? 1 : 0;
+        } else if (!seenDigit) {
+            seenDigit = *q != '0';
+            magnitude -= seenDigit ? 0 : 1;
+        }
+    }
+    int64_t exponent = 0;
+    if (q != last) {
+        q++;
+        const bool negativeExponent = *q == '-';
+        if (*q == '+' || *q == '-') {
+            q++;
+        }
+        // 指数位数不限，饱和到一个足够大的值即可
+        for (; q != last && exponent < (int64_t(1) << 40); q++) {
+            exponent = exponent * 10 + (*q - '0');
+        }
+        exponent = negativeExponent ? -exponent : exponent;
+    }
+    if (magnitude + exponent > 0) {
+        return false;
+    }
+    value = negative ? -0.0 : 0.0;
+    return true;
+}
+
 template <typename T> std::string toJson(const T &obj, bool pretty = false) {
     nlohmann::json j = obj;
     return pretty ? j.dump(4) : j.dump();
 }
 
+/**
+ * 序列化结果写入从 mr 分配的字符串，配合 Arena 使用时输出缓冲的扩容不再走全局堆
+ *
+ * 注意中间的 nlohmann::json 树仍然使用默认分配器
+ */
+inline std::pmr::string fromJsonTree(const nlohmann::json &j, std::pmr::memory_resource *mr, bool pretty = false) {
+    std::pmr::string out(mr);
+    nlohmann::detail::serializer<nlohmann::json> serializer(
+        nlohmann::detail::output_adapter<char, std::pmr::string>(out), ' ');
+    serializer.dump(j, pretty, false, pretty ? 4 : 0);
+    return out;
+}
+
+template <typename T> std::pmr::string toJson(const T &obj, std::pmr::memory_resource *mr, bool pretty = false) {
+    return fromJsonTree(nlohmann::json(obj), mr, pretty);
+}
+
 template <typename T> T fromJson(const std::string &value) {
     return nlohmann::json::parse(value).get<T>();
 }
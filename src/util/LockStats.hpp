@@ -0,0 +1,196 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "common/Version.h"
+#include "util/Histogram.hpp"
+#include "util/MeasureUtil.hpp"
+
+namespace rhino {
+RHINO_INLINE_NAMESPACE_BEGIN
+
+// 单个锁实例的统计结果，时间单位均为纳秒
+struct LockReport {
+    std::string name;
+    uint64_t acquisitions{};
+    uint64_t contended{};
+    uint64_t waitTotalNs{};
+    uint64_t waitP50Ns{};
+    uint64_t waitP99Ns{};
+    uint64_t waitMaxNs{};
+    uint64_t holdP50Ns{};
+    uint64_t holdP99Ns{};
+    uint64_t holdMaxNs{};
+};
+
+class LockStats;
+
+/**
+ * 所有被插桩的锁实例的登记表，用于按需输出争用最严重的锁
+ */
+class LockRegistry {
+
+    mutable std::mutex mtx;
+    std::vector<const LockStats *> all;
+
+  public:
+    static LockRegistry &global() {
+        static LockRegistry registry;
+        return registry;
+    }
+
+    void add(const LockStats *stats) {
+        std::lock_guard<std::mutex> lock(mtx);
+        all.push_back(stats);
+    }
+
+    void remove(const LockStats *stats) {
+        std::lock_guard<std::mutex> lock(mtx);
+        all.erase(std::remove(all.begin(), all.end(), stats), all.end());
+    }
+
+    /**
+     * 按累计等待时间降序返回前 n 个锁
+     */
+    inline std::vector<LockReport> topContended(size_t n) const;
+
+    /**
+     * 可读的文本报表，便于直接打日志
+     */
+    std::string dump(size_t n = 10) const {
+        std::ostringstream os;
+        for (const auto &r : topContended(n)) {
+            os << r.name << ": acquisitions=" << r.acquisitions << " contended=" << r.contended
+               << " waitTotal=" << r.waitTotalNs << "ns waitP50=" << r.waitP50Ns
+               << "ns waitP99=" << r.waitP99Ns << "ns waitMax=" << r.waitMaxNs
+               << "ns holdP50=" << r.holdP50Ns << "ns holdP99=" << r.holdP99Ns
+               << "ns holdMax=" << r.holdMaxNs << "ns\n";
+        }
+        return os.str();
+    }
+};
+
+/**
+ * 单个锁实例的统计：等待时间和持有时间直方图（TSC 计数），争用次数
+ *
+ * 所有 record 都发生在持锁期间，天然只有一个写者，所以不需要原子 RMW
+ */
+class LockStats {
+
+    std::string name;
+    Histogram waitTicks;
+    Histogram holdTicks;
+    std::atomic<uint64_t> contended{0};
+
+  public:
+    explicit LockStats(const char *name) : name(name == nullptr ? "unnamed" : name) {
+        LockRegistry::global().add(this);
+    }
+
+    ~LockStats() { LockRegistry::global().remove(this); }
+
+    LockStats(const LockStats &) = delete;
+    LockStats &operator=(const LockStats &) = delete;
+
+    void recordAcquire(bool wasContended, uint64_t ticks) noexcept {
+        if (wasContended) {
+            contended.store(contended.load(std::memory_order_relaxed) + 1,
+                            std::memory_order_relaxed);
+        }
+        waitTicks.record(ticks);
+    }
+
+    void recordHold(uint64_t ticks) noexcept { holdTicks.record(ticks); }
+
+    LockReport report() const {
+        auto ns = [](uint64_t ticks) { return calc_time_nano(0, ticks); };
+        LockReport r;
+        r.name = name;
+        r.acquisitions = waitTicks.count();
+        r.contended = contended.load(std::memory_order_relaxed);
+        r.waitTotalNs = ns(waitTicks.totalSum());
+        r.waitP50Ns = ns(waitTicks.percentile(0.5));
+        r.waitP99Ns = ns(waitTicks.percentile(0.99));
+        r.waitMaxNs = ns(waitTicks.max());
+        r.holdP50Ns = ns(holdTicks.percentile(0.5));
+        r.holdP99Ns = ns(holdTicks.percentile(0.99));
+        r.holdMaxNs = ns(holdTicks.max());
+        return r;
+    }
+};
+
+inline std::vector<LockReport> LockRegistry::topContended(size_t n) const {
+    std::vector<LockReport> reports;
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        reports.reserve(all.size());
+        for (const auto *stats : all) {
+            reports.push_back(stats->report());
+        }
+    }
+    std::sort(reports.begin(), reports.end(), [](const LockReport &a, const LockReport &b) {
+        return a.waitTotalNs != b.waitTotalNs ? a.waitTotalNs > b.waitTotalNs
+                                              : a.contended > b.contended;
+    });
+    if (reports.size() > n) {
+        reports.resize(n);
+    }
+    return reports;
+}
+
+/**
+ * 不做任何统计的探针，编译后和直接调用 mutex 完全一样
+ */
+struct NullLockProbe {
+    explicit NullLockProbe(const char * = nullptr) noexcept {}
+
+    template <typename Mutex> void lock(Mutex &m) { m.lock(); }
+
+    template <typename Mutex> void unlock(Mutex &m) { m.unlock(); }
+};
+
+/**
+ * 插桩探针：先 try_lock 区分是否争用，争用时用 TSC 记录等待时间，释放时记录持有时间
+ */
+class InstrumentedLockProbe {
+
+    LockStats stats;
+    uint64_t acquiredAt{};
+
+  public:
+    explicit InstrumentedLockProbe(const char *name = nullptr) : stats(name) {}
+
+    template <typename Mutex> void lock(Mutex &m) {
+        if (m.try_lock()) {
+            acquiredAt = rdtsc();
+            stats.recordAcquire(false, 0);
+            return;
+        }
+        const uint64_t begin = rdtsc();
+        m.lock();
+        acquiredAt = rdtsc();
+        stats.recordAcquire(true, acquiredAt - begin);
+    }
+
+    template <typename Mutex> void unlock(Mutex &m) {
+        stats.recordHold(rdtsc() - acquiredAt);
+        m.unlock();
+    }
+
+    const LockStats &lockStats() const { return stats; }
+};
+
+// 编译时打开 RHINO_LOCK_STATS（cmake -DRHINO_LOCK_STATS=ON）后，所有未显式指定探针的 Locked 都会被插桩
+#if defined(RHINO_LOCK_STATS)
+using DefaultLockProbe = InstrumentedLockProbe;
+#else
+using DefaultLockProbe = NullLockProbe;
+#endif
+
+RHINO_INLINE_NAMESPACE_END
+} // namespace rhino
@@ -1,25 +1,142 @@
 #pragma once
 
 #include <mutex>
+#include <shared_mutex>
+#include <type_traits>
 #include "common/Version.h"
+#include "util/LockStats.hpp"
+#include "util/SeqLock.hpp"
 
 namespace rhino {
 RHINO_INLINE_NAMESPACE_BEGIN
-template <typename T> class Locked {
+/**
+ * 用互斥锁保护的对象，只能通过传入的函数访问
+ *
+ * @tparam Mutex 锁类型，短临界区可以换成 SpinMutex
+ * @tparam Probe 统计探针，InstrumentedLockProbe 会记录等待/持有时间并登记到 LockRegistry，
+ *               默认由编译开关 RHINO_LOCK_STATS 决定
+ */
+template <typename T, typename Mutex = std::mutex, typename Probe = DefaultLockProbe>
+class Locked {
 
     T obj;
-    mutable std::mutex mtx;
+    mutable Mutex mtx;
+    mutable Probe probe;
+
+    struct Guard {
+        Probe &probe;
+        Mutex &mtx;
+        Guard(Probe &probe, Mutex &mtx) : probe(probe), mtx(mtx) { probe.lock(mtx); }
+        ~Guard() { probe.unlock(mtx); }
+    };
 
   public:
+    Locked() : probe(nullptr) {}
+
+    /**
+     * @param name 实例名，插桩模式下用于在报表中区分各个锁
+     */
+    explicit Locked(const char *name) : probe(name) {}
+
     template <typename Func> auto operator()(Func f) const -> decltype(f(obj)) {
-        std::lock_guard<std::mutex> lock(mtx);
+        Guard lock(probe, mtx);
         return f(obj);
     }
 
     template <typename Func> auto operator()(Func f) -> decltype(f(obj)) {
-        std::lock_guard<std::mutex> lock(mtx);
+        Guard lock(probe, mtx);
         return f(obj);
     }
 };
+
+/**
+ * 读写锁版本的 Locked，用法和 Locked 一致
+ *
+ * 通过 const 引用调用走共享锁（读者之间并行），通过非 const 引用调用走独占锁，
+ * 所以只读的调用点需要拿到 const 引用，例如 std::as_const(shared)([](const T &t) {...})
+ */
+template <typename T> class SharedLocked {
+
+    T obj;
+    mutable std::shared_mutex mtx;
+
+  public:
+    template <typename Func>
+    auto operator()(Func f) const -> decltype(f(static_cast<const T &>(obj))) {
+        std::shared_lock<std::shared_mutex> lock(mtx);
+        return f(obj);
+    }
+
+    template <typename Func> auto operator()(Func f) -> decltype(f(obj)) {
+        std::lock_guard<std::shared_mutex> lock(mtx);
+        return f(obj);
+    }
+};
+
+/**
+ * 顺序锁版本的 Locked，只适用于可平凡拷贝的小对象（配置快照、计数器组等）
+ *
+ * - const 调用：读者从不阻塞写者，先无锁拷贝出一致的快照再把快照交给 f，
+ *   所以 f 看到的是副本，修改它不会影响共享数据
+ * - 非 const 调用：写者之间用 writeMutex 互斥，f 在顺序锁之外修改副本，返回后才进入写状态整体写回，
+ *   读者不会因为 f 执行得慢而自旋；f 抛出异常时不写回
+ *
+ * 对象越大读者重试的概率越高，大对象请使用 SharedLocked
+ */
+template <typename T> class SeqLocked {
+
+    static_assert(std::is_trivially_copyable<T>::value,
+                  "SeqLocked requires trivially copyable type");
+
+    T obj{};
+    mutable SeqLock seqLock;
+    // 写者之间互斥，持有期间 obj 只会被读者并发读取
+    std::mutex writeMutex;
+
+    void publish(const T &value) noexcept {
+        seqLock.writeLock();
+        seqStore(obj, value);
+        seqLock.writeUnlock();
+    }
+
+  public:
+    SeqLocked() = default;
+
+    explicit SeqLocked(const T &init) : obj(init) {}
+
+    template <typename Func>
+    auto operator()(Func f) const -> decltype(f(static_cast<const T &>(obj))) {
+        return f(static_cast<const T &>(load()));
+    }
+
+    template <typename Func> auto operator()(Func f) -> decltype(f(obj)) {
+        std::lock_guard<std::mutex> writer(writeMutex);
+        // 没有别的写者，直接读 obj 不会读到写了一半的值；读者可能在并发拷贝，所以写回仍然按字进行
+        T copy = obj;
+        if constexpr (std::is_void_v<decltype(f(copy))>) {
+            f(copy);
+            publish(copy);
+        } else {
+            decltype(auto) result = f(copy);
+            publish(copy);
+            return result;
+        }
+    }
+
+    T load() const noexcept {
+        T snapshot;
+        uint32_t seq;
+        do {
+            seq = seqLock.readBegin();
+            seqLoad(snapshot, obj);
+        } while (seqLock.readRetry(seq));
+        return snapshot;
+    }
+
+    void store(const T &value) {
+        std::lock_guard<std::mutex> writer(writeMutex);
+        publish(value);
+    }
+};
 RHINO_INLINE_NAMESPACE_END
 } // namespace rhino
@@ -75,7 +75,7 @@ inline uint64_t rdtsc() noexcept {
 }
 
 /**
- * TSC 频率校准（跨平台实现，假设已绑核）
+ * TSC 频率校准（跨平台实现，假设调用线程已绑核，见 topology::pinCurrentThread）
  * 
  * 通过测量固定时间内的 TSC 计数来计算 CPU 频率
  * 使用中位数减少异常值影响，使用方差检查确保校准质量
@@ -83,7 +83,7 @@ inline uint64_t rdtsc() noexcept {
  * 注意：
  * - 建议在程序启动时调用一次，结果缓存使用
  * - 需要 CPU 支持 TSC 且频率稳定（现代 CPU 通常满足）
- * - 在多核系统上建议绑定到特定核心
+ * - 在多核系统上建议先用 topology::pinCurrentThread 绑定到特定核心，避免校准期间迁核
  * 
  * @return TSC 频率（GHz），校准失败或非 x86 平台返回 0.0
  */
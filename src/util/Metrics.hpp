@@ -0,0 +1,134 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "common/Version.h"
+#include "util/Histogram.hpp"
+
+namespace rhino {
+RHINO_INLINE_NAMESPACE_BEGIN
+
+// 单个指标的快照，计数器只有 count 有意义
+struct MetricReport {
+    std::string name;
+    uint64_t count{};
+    double mean{};
+    uint64_t p50{};
+    uint64_t p99{};
+    uint64_t max{};
+};
+
+/**
+ * 进程内指标登记表：各组件把自己持有的直方图、计数器登记进来，由报表线程按需读取
+ *
+ * 登记的只是指针，指标的所有者负责在析构前 remove，记录路径上没有任何额外开销
+ */
+class MetricsRegistry {
+
+    struct Entry {
+        std::string name;
+        const Histogram *histogram;
+        const std::atomic<uint64_t> *counter;
+        // 读取时计算的计数器
+        const void *owner;
+        std::function<uint64_t()> read;
+    };
+
+    mutable std::mutex mtx;
+    std::vector<Entry> all;
+
+  public:
+    static MetricsRegistry &global() {
+        static MetricsRegistry registry;
+        return registry;
+    }
+
+    void add(std::string name, const Histogram *histogram) {
+        std::lock_guard<std::mutex> lock(mtx);
+        all.push_back(Entry{std::move(name), histogram, nullptr, nullptr, nullptr});
+    }
+
+    void add(std::string name, const std::atomic<uint64_t> *counter) {
+        std::lock_guard<std::mutex> lock(mtx);
+        all.push_back(Entry{std::move(name), nullptr, counter, nullptr, nullptr});
+    }
+
+    /**
+     * 登记一个读取时才计算的计数器（例如把各线程各自的计数加起来），remove(owner) 时移除
+     *
+     * read 在登记表的锁内调用，不能反过来调用 add / remove
+     */
+    void add(std::string name, const void *owner, std::function<uint64_t()> read) {
+        std::lock_guard<std::mutex> lock(mtx);
+        all.push_back(Entry{std::move(name), nullptr, nullptr, owner, std::move(read)});
+    }
+
+    /**
+     * 移除 owner 指向的指标（直方图或计数器），或以 owner 登记的计算型计数器
+     */
+    void remove(const void *owner) {
+        std::lock_guard<std::mutex> lock(mtx);
+        all.erase(std::remove_if(all.begin(), all.end(),
+                                 [owner](const Entry &e) {
+                                     return e.histogram == owner ||
+                                            static_cast<const void *>(e.counter) == owner || e.owner == owner;
+                                 }),
+                  all.end());
+    }
+
+    /**
+     * 按名字排序的快照，prefix 非空时只返回以 prefix 开头的指标
+     */
+    std::vector<MetricReport> snapshot(const std::string &prefix = "") const {
+        std::vector<MetricReport> reports;
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            for (const auto &e : all) {
+                if (e.name.compare(0, prefix.size(), prefix) != 0) {
+                    continue;
+                }
+                MetricReport r;
+                r.name = e.name;
+                if (e.histogram != nullptr) {
+                    r.count = e.histogram->count();
+                    r.mean = e.histogram->mean();
+                    r.p50 = e.histogram->percentile(0.5);
+                    r.p99 = e.histogram->percentile(0.99);
+                    r.max = e.histogram->max();
+                } else if (e.counter != nullptr) {
+                    r.count = e.counter->load(std::memory_order_relaxed);
+                } else {
+                    r.count = e.read();
+                }
+                reports.push_back(std::move(r));
+            }
+        }
+        std::sort(reports.begin(), reports.end(),
+                  [](const MetricReport &a, const MetricReport &b) { return a.name < b.name; });
+        return reports;
+    }
+
+    /**
+     * 可读的文本报表，便于直接打日志
+     */
+    std::string dump(const std::string &prefix = "") const {
+        std::ostringstream os;
+        for (const auto &r : snapshot(prefix)) {
+            os << r.name << ": count=" << r.count;
+            if (r.max > 0 || r.mean > 0) {
+                os << " mean=" << r.mean << " p50=" << r.p50 << " p99=" << r.p99 << " max=" << r.max;
+            }
+            os << "\n";
+        }
+        return os.str();
+    }
+};
+
+RHINO_INLINE_NAMESPACE_END
+} // namespace rhino
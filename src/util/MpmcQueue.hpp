@@ -0,0 +1,364 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include "common/Errs.h"
+#include "common/Ret.h"
+#include "common/Version.h"
+#include "util/AsymmetricFence.hpp"
+#include "util/CpuUtil.hpp"
+#include "util/Futex.hpp"
+
+namespace rhino {
+RHINO_INLINE_NAMESPACE_BEGIN
+
+/**
+ * 有界无锁多生产者多消费者队列（Vyukov 算法）
+ *
+ * 每个槽位带一个序号：seq == pos 表示槽位空闲可写，seq == pos + 1 表示已写入可读。
+ * 生产者和消费者各自只 CAS 自己的位置计数器，两个计数器分处不同缓存行，
+ * 队列不满不空时生产者和消费者之间没有共享写。
+ *
+ * - tryPush/tryPop：不阻塞，满/空时返回 Err::QUEUE_FULL/Err::QUEUE_EMPTY
+ * - pushN/popN：一次 CAS 占用多个连续槽位，返回实际处理的个数
+ * - push/pop：满/空时先自旋，再通过 futex 挂起，只有存在等待者时才会产生唤醒的系统调用；
+ *   入队/出队一侧检查等待者只需要编译器屏障，完整屏障由准备挂起的一侧承担（见 heavyFence）
+ *
+ * @tparam T 元素类型，需要可移动构造；tryPop(T &) 和 popN 还需要可移动赋值
+ */
+template <typename T> class MpmcQueue {
+
+    struct Cell {
+        std::atomic<size_t> seq;
+        typename std::aligned_storage<sizeof(T), alignof(T)>::type storage;
+
+        T *ptr() noexcept { return std::launder(reinterpret_cast<T *>(&storage)); }
+    };
+
+    static constexpr int32_t SPIN_BEFORE_PARK = 128;
+
+    Cell *cells;
+    size_t mask;
+
+    alignas(CACHE_LINE_SIZE) std::atomic<size_t> enqueuePos{0};
+    alignas(CACHE_LINE_SIZE) std::atomic<size_t> dequeuePos{0};
+
+    // 阻塞接口使用：epoch 是 futex 字，waiters 用于在没有等待者时跳过唤醒
+    alignas(CACHE_LINE_SIZE) std::atomic<uint32_t> pushEpoch{0};
+    std::atomic<uint32_t> pushWaiters{0};
+    alignas(CACHE_LINE_SIZE) std::atomic<uint32_t> popEpoch{0};
+    std::atomic<uint32_t> popWaiters{0};
+
+    static size_t roundUpPowerOfTwo(size_t v) {
+        size_t p = 2;
+        while (p < v) {
+            p <<= 1;
+        }
+        return p;
+    }
+
+  public:
+    /**
+     * @param capacity 容量，会向上取整到 2 的幂（至少为 2）
+     */
+    explicit MpmcQueue(size_t capacity) {
+        const size_t size = roundUpPowerOfTwo(capacity);
+        cells = static_cast<Cell *>(::operator new(sizeof(Cell) * size, std::align_val_t(CACHE_LINE_SIZE)));
+        for (size_t i = 0; i < size; i++) {
+            new (&cells[i].seq) std::atomic<size_t>(i);
+        }
+        mask = size - 1;
+    }
+
+    // 析构时不能再有其他线程访问，直接析构还留在队列里的元素
+    ~MpmcQueue() {
+        if constexpr (!std::is_trivially_destructible_v<T>) {
+            const size_t tail = enqueuePos.load(std::memory_order_relaxed);
+            for (size_t pos = dequeuePos.load(std::memory_order_relaxed); pos != tail; pos++) {
+                Cell &cell = cells[pos & mask];
+                if (cell.seq.load(std::memory_order_relaxed) == pos + 1) {
+                    cell.ptr()->~T();
+                }
+            }
+        }
+        ::operator delete(cells, std::align_val_t(CACHE_LINE_SIZE));
+    }
+
+    MpmcQueue(const MpmcQueue &) = delete;
+    MpmcQueue &operator=(const MpmcQueue &) = delete;
+
+    size_t capacity() const noexcept { return mask + 1; }
+
+    /**
+     * 近似长度，并发修改时只作参考
+     */
+    size_t sizeApprox() const noexcept {
+        auto tail = enqueuePos.load(std::memory_order_relaxed);
+        auto head = dequeuePos.load(std::memory_order_relaxed);
+        return tail > head ? tail - head : 0;
+    }
+
+    /**
+     * 原地构造入队，队列满时返回 false
+     */
+    template <typename... Args> bool tryEmplace(Args &&...args) {
+        Cell *cell;
+        size_t pos = enqueuePos.load(std::memory_order_relaxed);
+        for (;;) {
+            cell = &cells[pos & mask];
+            const size_t seq = cell->seq.load(std::memory_order_acquire);
+            const auto diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+            if (diff == 0) {
+                if (enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = enqueuePos.load(std::memory_order_relaxed);
+            }
+        }
+        new (&cell->storage) T(std::forward<Args>(args)...);
+        cell->seq.store(pos + 1, std::memory_order_release);
+        notifyConsumers();
+        return true;
+    }
+
+    Ret<void *> tryPush(const T &item) {
+        if (tryEmplace(item)) {
+            return Ret<void *>::with(nullptr);
+        }
+        return Ret<void *>::with(EGrp::INTERNAL, Err::QUEUE_FULL);
+    }
+
+    Ret<void *> tryPush(T &&item) {
+        if (tryEmplace(std::move(item))) {
+            return Ret<void *>::with(nullptr);
+        }
+        return Ret<void *>::with(EGrp::INTERNAL, Err::QUEUE_FULL);
+    }
+
+    /**
+     * 出队到 out，队列空时返回 false（热路径用这个版本，避免构造 Ret）
+     */
+    bool tryPop(T &out) {
+        size_t pos;
+        Cell *cell = claimPop(pos);
+        if (cell == nullptr) {
+            return false;
+        }
+        T *item = cell->ptr();
+        out = std::move(*item);
+        item->~T();
+        releasePop(cell, pos);
+        return true;
+    }
+
+    Ret<T> tryPop() {
+        size_t pos;
+        Cell *cell = claimPop(pos);
+        if (cell == nullptr) {
+            return Ret<T>::with(EGrp::INTERNAL, Err::QUEUE_EMPTY);
+        }
+        return Ret<T>::with(take(cell, pos));
+    }
+
+    /**
+     * 批量入队：一次 CAS 占用尽可能多的连续槽位
+     *
+     * @param items 待入队元素（会被移动）
+     * @param n 元素个数
+     * @return 实际入队个数，队列满时可能小于 n
+     */
+    size_t pushN(T *items, size_t n) {
+        size_t pos = enqueuePos.load(std::memory_order_relaxed);
+        size_t count;
+        for (;;) {
+            count = 0;
+            while (count < n) {
+                const size_t seq = cells[(pos + count) & mask].seq.load(std::memory_order_acquire);
+                if (seq != pos + count) {
+                    break;
+                }
+                count++;
+            }
+            if (count == 0) {
+                const size_t seq = cells[pos & mask].seq.load(std::memory_order_acquire);
+                if (static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos) < 0) {
+                    return 0;
+                }
+                pos = enqueuePos.load(std::memory_order_relaxed);
+                continue;
+            }
+            if (enqueuePos.compare_exchange_weak(pos, pos + count, std::memory_order_relaxed)) {
+                break;
+            }
+        }
+        for (size_t i = 0; i < count; i++) {
+            Cell &cell = cells[(pos + i) & mask];
+            new (&cell.storage) T(std::move(items[i]));
+            cell.seq.store(pos + i + 1, std::memory_order_release);
+        }
+        notifyConsumers();
+        return count;
+    }
+
+    /**
+     * 批量出队
+     *
+     * @param out 输出缓冲区，元素通过移动赋值写入
+     * @param maxCount 最多出队个数
+     * @return 实际出队个数
+     */
+    size_t popN(T *out, size_t maxCount) {
+        size_t pos = dequeuePos.load(std::memory_order_relaxed);
+        size_t count;
+        for (;;) {
+            count = 0;
+            while (count < maxCount) {
+                const size_t seq = cells[(pos + count) & mask].seq.load(std::memory_order_acquire);
+                if (seq != pos + count + 1) {
+                    break;
+                }
+                count++;
+            }
+            if (count == 0) {
+                const size_t seq = cells[pos & mask].seq.load(std::memory_order_acquire);
+                if (static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos + 1) < 0) {
+                    return 0;
+                }
+                pos = dequeuePos.load(std::memory_order_relaxed);
+                continue;
+            }
+            if (dequeuePos.compare_exchange_weak(pos, pos + count, std::memory_order_relaxed)) {
+                break;
+            }
+        }
+        for (size_t i = 0; i < count; i++) {
+            Cell &cell = cells[(pos + i) & mask];
+            T *item = cell.ptr();
+            out[i] = std::move(*item);
+            item->~T();
+            cell.seq.store(pos + i + mask + 1, std::memory_order_release);
+        }
+        notifyProducers();
+        return count;
+    }
+
+    /**
+     * 阻塞入队，队列满时等待消费者腾出空间
+     */
+    template <typename U> void push(U &&item) {
+        for (int32_t i = 0; i < SPIN_BEFORE_PARK; i++) {
+            if (tryEmplace(std::forward<U>(item))) {
+                return;
+            }
+            cpuRelax();
+        }
+        for (;;) {
+            const uint32_t epoch = pushEpoch.load(std::memory_order_acquire);
+            pushWaiters.fetch_add(1, std::memory_order_seq_cst);
+            heavyFence();
+            if (tryEmplace(std::forward<U>(item))) {
+                pushWaiters.fetch_sub(1, std::memory_order_relaxed);
+                return;
+            }
+            futexWait(&pushEpoch, epoch);
+            pushWaiters.fetch_sub(1, std::memory_order_relaxed);
+        }
+    }
+
+    /**
+     * 阻塞出队，队列空时等待生产者
+     */
+    T pop() {
+        size_t pos;
+        for (int32_t i = 0; i < SPIN_BEFORE_PARK; i++) {
+            if (Cell *cell = claimPop(pos)) {
+                return take(cell, pos);
+            }
+            cpuRelax();
+        }
+        for (;;) {
+            const uint32_t epoch = popEpoch.load(std::memory_order_acquire);
+            popWaiters.fetch_add(1, std::memory_order_seq_cst);
+            heavyFence();
+            if (Cell *cell = claimPop(pos)) {
+                popWaiters.fetch_sub(1, std::memory_order_relaxed);
+                return take(cell, pos);
+            }
+            futexWait(&popEpoch, epoch);
+            popWaiters.fetch_sub(1, std::memory_order_relaxed);
+        }
+    }
+
+    /**
+     * 唤醒所有阻塞在 pop 上的线程（例如关闭时配合外部的停止标志使用）
+     */
+    void wakeAll() noexcept {
+        popEpoch.fetch_add(1, std::memory_order_release);
+        futexWake(&popEpoch);
+        pushEpoch.fetch_add(1, std::memory_order_release);
+        futexWake(&pushEpoch);
+    }
+
+  private:
+    // 占住一个可读的槽位，队列空时返回 nullptr
+    Cell *claimPop(size_t &pos) noexcept {
+        pos = dequeuePos.load(std::memory_order_relaxed);
+        for (;;) {
+            Cell *cell = &cells[pos & mask];
+            const size_t seq = cell->seq.load(std::memory_order_acquire);
+            const auto diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos + 1);
+            if (diff == 0) {
+                if (dequeuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    return cell;
+                }
+            } else if (diff < 0) {
+                return nullptr;
+            } else {
+                pos = dequeuePos.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    // 元素已经移走并析构，把槽位还给生产者
+    void releasePop(Cell *cell, size_t pos) noexcept {
+        cell->seq.store(pos + mask + 1, std::memory_order_release);
+        notifyProducers();
+    }
+
+    // 移动构造出元素，不要求 T 可默认构造
+    T take(Cell *cell, size_t pos) {
+        T *item = cell->ptr();
+        T out(std::move(*item));
+        item->~T();
+        releasePop(cell, pos);
+        return out;
+    }
+
+    // 入队/出队的发布 + lightFence 与等待方的 waiters.fetch_add + heavyFence + 重试构成 Dekker 式握手：
+    // 要么等待方重试时看到数据，要么这里看到等待方。热路径上只有编译器屏障
+    void notifyConsumers() noexcept {
+        lightFence();
+        if (popWaiters.load(std::memory_order_relaxed) != 0) {
+            popEpoch.fetch_add(1, std::memory_order_release);
+            futexWake(&popEpoch);
+        }
+    }
+
+    void notifyProducers() noexcept {
+        lightFence();
+        if (pushWaiters.load(std::memory_order_relaxed) != 0) {
+            pushEpoch.fetch_add(1, std::memory_order_release);
+            futexWake(&pushEpoch);
+        }
+    }
+};
+
+RHINO_INLINE_NAMESPACE_END
+} // namespace rhino
@@ -0,0 +1,449 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <new>
+#include <utility>
+#include <vector>
+#include <sys/mman.h>
+#include <unistd.h>
+#include "common/Version.h"
+#include "util/CpuUtil.hpp"
+
+namespace rhino {
+RHINO_INLINE_NAMESPACE_BEGIN
+
+struct ObjectPoolOptions {
+    // slab 大小，向上取整到 2 的幂，不小于 64KB；2MB 正好是一个大页
+    size_t slabBytes = 2 << 20;
+    // 先尝试 MAP_HUGETLB（需要预留大页），失败后退回普通映射并 madvise(MADV_HUGEPAGE) 交给 THP
+    bool hugePages = true;
+    // 构造时预先映射并逐页触碰这么多个 slab，避免运行中的缺页
+    size_t prefaultSlabs = 0;
+    // 线程缓存和中心 depot 之间一次转移的对象数，线程缓存超过 2 * batch 时归还一批
+    size_t batch = 64;
+};
+
+namespace detail {
+
+struct SlabMapping {
+    void *ptr = nullptr;
+    size_t bytes = 0;
+    bool huge = false;
+};
+
+/**
+ * 映射一块按 bytes 对齐的内存（bytes 为 2 的幂），失败时抛 std::bad_alloc
+ */
+inline SlabMapping mapSlab(size_t bytes, bool hugePages, bool prefault) {
+    SlabMapping slab{nullptr, bytes, false};
+#if defined(MAP_HUGETLB)
+    // hugetlb 映射按大页对齐，bytes 不小于 2MB 时天然满足对齐要求
+    if (hugePages && bytes >= (2U << 20)) {
+        void *p = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        if (p != MAP_FAILED && reinterpret_cast<uintptr_t>(p) % bytes == 0) {
+            slab.ptr = p;
+            slab.huge = true;
+        } else if (p != MAP_FAILED) {
+            munmap(p, bytes);
+        }
+    }
+#endif
+    if (slab.ptr == nullptr) {
+        // 多映射一倍再裁掉首尾，得到按 bytes 对齐的区间
+        void *p = mmap(nullptr, bytes * 2, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (p == MAP_FAILED) {
+            throw std::bad_alloc();
+        }
+        const auto start = reinterpret_cast<uintptr_t>(p);
+        const uintptr_t aligned = (start + bytes - 1) & ~static_cast<uintptr_t>(bytes - 1);
+        if (aligned > start) {
+            munmap(p, aligned - start);
+        }
+        if (aligned + bytes < start + bytes * 2) {
+            munmap(reinterpret_cast<void *>(aligned + bytes), start + bytes * 2 - aligned - bytes);
+        }
+        slab.ptr = reinterpret_cast<void *>(aligned);
+#if defined(MADV_HUGEPAGE)
+        if (hugePages) {
+            madvise(slab.ptr, bytes, MADV_HUGEPAGE);
+        }
+#endif
+    }
+    if (prefault) {
+        const auto page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+        auto *p = static_cast<volatile char *>(slab.ptr);
+        for (size_t off = 0; off < bytes; off += page) {
+            p[off] = 0;
+        }
+    }
+    return slab;
+}
+
+} // namespace detail
+
+/**
+ * 定长对象池，替代高频 new/delete 同一种消息对象的场景
+ *
+ * - 每个线程有自己的空闲链表，分配和同线程释放只是链表头的进出，没有原子操作
+ * - 对象所在的 slab 记录分配它的线程缓存（slab 按大小对齐，从地址即可找到 slab 头）：
+ *   其他线程释放时压入该缓存的无锁栈，原线程空闲链表用完时一次性取走（exchange，没有 ABA 问题）。
+ *   释放不会为线程创建缓存，只释放不分配的线程总是走这条路径
+ * - 线程缓存过大时按 batch 个一批归还中心 depot，空了先从 depot 取一批，都没有才从 slab 切新对象
+ * - slab 用 mmap 申请，优先使用大页（见 ObjectPoolOptions），只在 ObjectPool 析构时归还
+ *
+ * 线程退出时缓存留给新线程复用，其中的空闲对象归还 depot。
+ * 用过某个 ObjectPool 的线程必须在它析构之前退出，析构时所有对象都应已归还（不会调用其析构函数）
+ */
+template <typename T> class ObjectPool {
+
+    struct FreeNode {
+        FreeNode *next;
+    };
+
+    static constexpr size_t ALIGN = std::max(alignof(T), alignof(FreeNode));
+    static constexpr size_t SLOT = (std::max(sizeof(T), sizeof(FreeNode)) + ALIGN - 1) / ALIGN * ALIGN;
+    static_assert(ALIGN <= 4096, "ObjectPool does not support over-aligned types beyond a page");
+
+  public:
+    explicit ObjectPool(ObjectPoolOptions options = ObjectPoolOptions())
+        : options(normalize(options)), id(nextId().fetch_add(1, std::memory_order_relaxed)) {
+        for (size_t i = 0; i < this->options.prefaultSlabs; i++) {
+            spare.push_back(newSlab(true));
+        }
+    }
+
+    ~ObjectPool() {
+        forgetLocal();
+        for (Cache *c = caches.load(std::memory_order_acquire); c != nullptr;) {
+            Cache *next = c->next;
+            delete c;
+            c = next;
+        }
+        for (Slab *s : slabs) {
+            munmap(s, s->bytes);
+        }
+    }
+
+    ObjectPool(const ObjectPool &) = delete;
+    ObjectPool &operator=(const ObjectPool &) = delete;
+
+    /**
+     * 分配一块未初始化的对象内存，内存不足时抛 std::bad_alloc
+     */
+    void *allocate() {
+        Cache &c = local();
+        if (c.local == nullptr) {
+            refill(c);
+        }
+        FreeNode *node = c.local;
+        c.local = node->next;
+        c.count--;
+        return node;
+    }
+
+    void deallocate(void *p) noexcept {
+        auto *node = static_cast<FreeNode *>(p);
+        Cache *owner = slabOf(p)->owner;
+        if (Cache *c = findLocal(); owner == c) {
+            node->next = c->local;
+            c->local = node;
+            if (++c->count > 2 * options.batch) {
+                flush(*c);
+            }
+            return;
+        }
+        // 跨线程释放（包括本线程还没有缓存或者正在退出）：压回分配它的缓存
+        node->next = owner->remote.load(std::memory_order_relaxed);
+        while (!owner->remote.compare_exchange_weak(node->next, node, std::memory_order_release,
+                                                    std::memory_order_relaxed)) {
+        }
+    }
+
+    template <typename... Args> T *create(Args &&...args) {
+        void *p = allocate();
+        try {
+            return new (p) T(std::forward<Args>(args)...);
+        } catch (...) {
+            deallocate(p);
+            throw;
+        }
+    }
+
+    void destroy(T *obj) noexcept {
+        if (obj != nullptr) {
+            obj->~T();
+            deallocate(obj);
+        }
+    }
+
+    size_t slabCount() const {
+        std::lock_guard<std::mutex> lock(slabMutex);
+        return slabs.size();
+    }
+
+    // 其中由 MAP_HUGETLB 映射的 slab 数
+    size_t hugeSlabCount() const {
+        std::lock_guard<std::mutex> lock(slabMutex);
+        return static_cast<size_t>(std::count_if(slabs.begin(), slabs.end(), [](const Slab *s) { return s->huge; }));
+    }
+
+    static constexpr size_t slotSize() noexcept { return SLOT; }
+
+  private:
+    struct Cache;
+
+    // slab 头放在 slab 起始位置，对象从头之后按 SLOT 切分
+    struct Slab {
+        Cache *owner;
+        size_t bytes;
+        bool huge;
+    };
+
+    // 每个线程一个缓存，线程退出后留在链表里供新线程复用，ObjectPool 析构时释放
+    struct alignas(CACHE_LINE_SIZE) Cache {
+        // 以下字段只由持有缓存的线程访问
+        FreeNode *local = nullptr;
+        size_t count = 0;
+        char *carve = nullptr;
+        char *carveEnd = nullptr;
+        Cache *next = nullptr;
+        // 其他线程释放的、属于本缓存 slab 的对象
+        alignas(CACHE_LINE_SIZE) std::atomic<FreeNode *> remote{nullptr};
+        std::atomic<bool> inUse{true};
+    };
+
+    // 线程退出时归还本线程在各个 ObjectPool 上持有的缓存
+    struct LocalCaches {
+        struct Entry {
+            uint64_t poolId;
+            ObjectPool *pool;
+            Cache *cache;
+        };
+        std::vector<Entry> entries;
+        uint64_t cachedId = 0;
+        Cache *cached = nullptr;
+
+        ~LocalCaches() {
+            for (auto &e : entries) {
+                e.pool->release(e.cache);
+            }
+            entries.clear();
+            destroyed() = true;
+        }
+
+        static bool &destroyed() noexcept {
+            static thread_local bool flag = false;
+            return flag;
+        }
+    };
+
+    static std::atomic<uint64_t> &nextId() noexcept {
+        static std::atomic<uint64_t> id{1};
+        return id;
+    }
+
+    static LocalCaches &localCaches() noexcept {
+        static thread_local LocalCaches local;
+        return local;
+    }
+
+    static ObjectPoolOptions normalize(ObjectPoolOptions options) {
+        size_t bytes = 64 << 10;
+        while (bytes < options.slabBytes || bytes < sizeof(Slab) + ALIGN + SLOT * 2) {
+            bytes <<= 1;
+        }
+        options.slabBytes = bytes;
+        options.batch = std::max<size_t>(options.batch, 1);
+        return options;
+    }
+
+    const ObjectPoolOptions options;
+    const uint64_t id;
+    alignas(CACHE_LINE_SIZE) std::atomic<Cache *> caches{nullptr};
+    mutable std::mutex slabMutex;
+    std::vector<Slab *> slabs;
+    // 预先映射、还没有分给线程缓存的 slab
+    std::vector<Slab *> spare;
+    std::mutex depotMutex;
+    // 每一项是一条 batch 个对象的链表
+    std::vector<FreeNode *> depot;
+
+    Slab *slabOf(void *p) const noexcept {
+        // 所有 slab 大小相同且按大小对齐
+        return reinterpret_cast<Slab *>(reinterpret_cast<uintptr_t>(p) & ~static_cast<uintptr_t>(options.slabBytes - 1));
+    }
+
+    Slab *newSlab(bool prefault) {
+        auto mapping = detail::mapSlab(options.slabBytes, options.hugePages, prefault);
+        auto *slab = new (mapping.ptr) Slab{nullptr, mapping.bytes, mapping.huge};
+        std::lock_guard<std::mutex> lock(slabMutex);
+        slabs.push_back(slab);
+        return slab;
+    }
+
+    Cache &local() {
+        LocalCaches &lc = localCaches();
+        if (lc.cachedId == id) {
+            return *lc.cached;
+        }
+        Cache *c = nullptr;
+        for (auto &e : lc.entries) {
+            if (e.poolId == id) {
+                c = e.cache;
+                break;
+            }
+        }
+        if (c == nullptr) {
+            c = acquire();
+            lc.entries.push_back(typename LocalCaches::Entry{id, this, c});
+        }
+        lc.cachedId = id;
+        lc.cached = c;
+        return *c;
+    }
+
+    // 只查找不创建：释放路径是 noexcept 的，不能在这里为线程分配缓存
+    Cache *findLocal() const noexcept {
+        if (LocalCaches::destroyed()) {
+            return nullptr;
+        }
+        LocalCaches &lc = localCaches();
+        if (lc.cachedId == id) {
+            return lc.cached;
+        }
+        for (auto &e : lc.entries) {
+            if (e.poolId == id) {
+                return e.cache;
+            }
+        }
+        return nullptr;
+    }
+
+    void forgetLocal() noexcept {
+        if (LocalCaches::destroyed()) {
+            return;
+        }
+        LocalCaches &lc = localCaches();
+        lc.entries.erase(std::remove_if(lc.entries.begin(), lc.entries.end(),
+                                        [this](const typename LocalCaches::Entry &e) { return e.poolId == id; }),
+                         lc.entries.end());
+        if (lc.cachedId == id) {
+            lc.cachedId = 0;
+            lc.cached = nullptr;
+        }
+    }
+
+    Cache *acquire() {
+        for (Cache *c = caches.load(std::memory_order_acquire); c != nullptr; c = c->next) {
+            bool expected = false;
+            if (!c->inUse.load(std::memory_order_relaxed) &&
+                c->inUse.compare_exchange_strong(expected, true, std::memory_order_acquire)) {
+                return c;
+            }
+        }
+        auto c = new Cache();
+        c->next = caches.load(std::memory_order_relaxed);
+        while (!caches.compare_exchange_weak(c->next, c, std::memory_order_release, std::memory_order_relaxed)) {
+        }
+        return c;
+    }
+
+    // 线程退出：空闲对象归还 depot，未切完的 slab 和 remote 栈随缓存留给下一个线程
+    void release(Cache *c) noexcept {
+        while (c->local != nullptr) {
+            flush(*c);
+        }
+        c->inUse.store(false, std::memory_order_release);
+    }
+
+    // 从本地链表摘下至多 batch 个对象作为一批交给 depot
+    void flush(Cache &c) noexcept {
+        FreeNode *first = c.local;
+        FreeNode *last = first;
+        size_t n = 1;
+        while (n < options.batch && last->next != nullptr) {
+            last = last->next;
+            n++;
+        }
+        c.local = last->next;
+        c.count -= n;
+        last->next = nullptr;
+        std::lock_guard<std::mutex> lock(depotMutex);
+        depot.push_back(first);
+    }
+
+    void refill(Cache &c) {
+        // 1. 其他线程还回来的
+        if (adopt(c, c.remote.exchange(nullptr, std::memory_order_acquire))) {
+            return;
+        }
+        // 2. depot 中的一批
+        {
+            std::lock_guard<std::mutex> lock(depotMutex);
+            if (!depot.empty()) {
+                FreeNode *batch = depot.back();
+                depot.pop_back();
+                adopt(c, batch);
+                return;
+            }
+        }
+        // 3. 已退出线程的缓存收到的跨线程释放
+        for (Cache *o = caches.load(std::memory_order_acquire); o != nullptr; o = o->next) {
+            if (o != &c && !o->inUse.load(std::memory_order_acquire) &&
+                adopt(c, o->remote.exchange(nullptr, std::memory_order_acquire))) {
+                return;
+            }
+        }
+        // 4. 从 slab 切一批新对象
+        for (size_t i = 0; i < options.batch; i++) {
+            if (c.carve + SLOT > c.carveEnd) {
+                if (c.local != nullptr) {
+                    break;
+                }
+                Slab *slab = takeSlab();
+                slab->owner = &c;
+                const auto begin = reinterpret_cast<uintptr_t>(slab) + sizeof(Slab);
+                c.carve = reinterpret_cast<char *>((begin + ALIGN - 1) & ~static_cast<uintptr_t>(ALIGN - 1));
+                c.carveEnd = reinterpret_cast<char *>(slab) + slab->bytes;
+            }
+            auto *node = reinterpret_cast<FreeNode *>(c.carve);
+            c.carve += SLOT;
+            node->next = c.local;
+            c.local = node;
+            c.count++;
+        }
+    }
+
+    bool adopt(Cache &c, FreeNode *list) noexcept {
+        if (list == nullptr) {
+            return false;
+        }
+        size_t n = 0;
+        for (FreeNode *p = list; p != nullptr; p = p->next) {
+            n++;
+        }
+        c.local = list;
+        c.count = n;
+        return true;
+    }
+
+    Slab *takeSlab() {
+        {
+            std::lock_guard<std::mutex> lock(slabMutex);
+            if (!spare.empty()) {
+                Slab *slab = spare.back();
+                spare.pop_back();
+                return slab;
+            }
+        }
+        return newSlab(false);
+    }
+};
+
+RHINO_INLINE_NAMESPACE_END
+} // namespace rhino
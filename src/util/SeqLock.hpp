@@ -0,0 +1,120 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include "common/Version.h"
+#include "util/CpuUtil.hpp"
+
+namespace rhino {
+RHINO_INLINE_NAMESPACE_BEGIN
+
+/**
+ * 顺序锁（seqlock）的序号部分
+ *
+ * 写者把序号加到奇数 -> 修改数据 -> 加回偶数；读者读前后两次序号，
+ * 两次相等且为偶数即说明读到的是一致的快照，否则重试。读者从不写共享内存，
+ * 所以读多写少时读侧不会产生缓存行争用。
+ *
+ * 注意：
+ * - 被保护的数据只能用 seqLoad/seqStore 拷贝（读者可能和写者并发访问同一块内存）
+ * - 多个写者之间通过 CAS 互斥，写者之间是自旋等待，所以写临界区必须很短
+ */
+class SeqLock {
+
+    std::atomic<uint32_t> seq{0};
+
+  public:
+    /**
+     * 读开始：等待没有写者后返回当前序号
+     */
+    uint32_t readBegin() const noexcept {
+        uint32_t s = seq.load(std::memory_order_acquire);
+        while (s & 1U) {
+            cpuRelax();
+            s = seq.load(std::memory_order_acquire);
+        }
+        return s;
+    }
+
+    /**
+     * 读结束：返回 true 说明读期间有写者介入，需要重读
+     */
+    bool readRetry(uint32_t start) const noexcept {
+        std::atomic_thread_fence(std::memory_order_acquire);
+        return seq.load(std::memory_order_relaxed) != start;
+    }
+
+    void writeLock() noexcept {
+        uint32_t s = seq.load(std::memory_order_relaxed);
+        for (;;) {
+            if (!(s & 1U) &&
+                seq.compare_exchange_weak(s, s + 1, std::memory_order_acquire,
+                                          std::memory_order_relaxed)) {
+                break;
+            }
+            cpuRelax();
+            s = seq.load(std::memory_order_relaxed);
+        }
+        std::atomic_thread_fence(std::memory_order_release);
+    }
+
+    void writeUnlock() noexcept {
+        seq.fetch_add(1, std::memory_order_release);
+    }
+
+    uint32_t sequence() const noexcept {
+        return seq.load(std::memory_order_relaxed);
+    }
+};
+
+namespace detail {
+
+// 以字为单位的 relaxed 原子拷贝，读者和写者并发访问时不构成数据竞争（TSan 干净）
+template <typename Word>
+inline void atomicCopyWords(void *dst, const void *src, size_t words) noexcept {
+    auto d = static_cast<Word *>(dst);
+    auto s = static_cast<const Word *>(src);
+    for (size_t i = 0; i < words; i++) {
+#if defined(__GNUC__) || defined(__clang__)
+        __atomic_store_n(d + i, __atomic_load_n(s + i, __ATOMIC_RELAXED),
+                         __ATOMIC_RELAXED);
+#else
+        d[i] = s[i];
+#endif
+    }
+}
+
+template <typename T> inline void atomicCopy(T &dst, const T &src) noexcept {
+    static_assert(std::is_trivially_copyable<T>::value,
+                  "seqlock protected data must be trivially copyable");
+    if constexpr (alignof(T) >= sizeof(uint64_t) &&
+                  sizeof(T) % sizeof(uint64_t) == 0) {
+        atomicCopyWords<uint64_t>(&dst, &src, sizeof(T) / sizeof(uint64_t));
+    } else if constexpr (alignof(T) >= sizeof(uint32_t) &&
+                         sizeof(T) % sizeof(uint32_t) == 0) {
+        atomicCopyWords<uint32_t>(&dst, &src, sizeof(T) / sizeof(uint32_t));
+    } else {
+        atomicCopyWords<unsigned char>(&dst, &src, sizeof(T));
+    }
+}
+
+} // namespace detail
+
+/**
+ * 在 seqlock 读临界区内拷贝共享数据（结果是否有效由 readRetry 判定）
+ */
+template <typename T> inline void seqLoad(T &dst, const T &shared) noexcept {
+    detail::atomicCopy(dst, shared);
+}
+
+/**
+ * 在 seqlock 写临界区内写入共享数据
+ */
+template <typename T> inline void seqStore(T &shared, const T &src) noexcept {
+    detail::atomicCopy(shared, src);
+}
+
+RHINO_INLINE_NAMESPACE_END
+} // namespace rhino
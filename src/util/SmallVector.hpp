@@ -0,0 +1,286 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include "common/Version.h"
+
+namespace rhino {
+RHINO_INLINE_NAMESPACE_BEGIN
+
+/**
+ * T 是否可以按字节搬到新地址并且不在旧地址析构（"平凡可重定位"）
+ *
+ * 默认只认平凡可复制的类型；std::string 等在 libstdc++ 中带有指向自身的指针，不能这样搬。
+ * 自己的类型如果只持有堆指针（例如 std::unique_ptr 成员），可以特化为 true_type 以获得 memcpy 搬迁
+ */
+template <typename T> struct IsTriviallyRelocatable : std::is_trivially_copyable<T> {};
+
+namespace detail {
+
+// 把 [src, src + n) 搬到未初始化的 dst，之后 src 中的对象视为已销毁
+template <typename T> void relocate(T *src, size_t n, T *dst) noexcept {
+    if constexpr (IsTriviallyRelocatable<T>::value) {
+        if (n > 0) {
+            std::memcpy(static_cast<void *>(dst), static_cast<const void *>(src), n * sizeof(T));
+        }
+    } else {
+        static_assert(std::is_nothrow_move_constructible_v<T>, "relocation requires a noexcept move constructor");
+        for (size_t i = 0; i < n; i++) {
+            new (dst + i) T(std::move(src[i]));
+            src[i].~T();
+        }
+    }
+}
+
+} // namespace detail
+
+/**
+ * 前 N 个元素存放在对象内部的 vector，超过 N 个才申请堆内存
+ *
+ * 适合大多数时候很短的列表（例如 splitView 的结果）：短列表没有堆分配，元素与容器在同一块内存上。
+ * 扩容和 move 时用 detail::relocate 搬迁元素，平凡可重定位的类型直接 memcpy。
+ * 与 std::vector 不同，内联存储时 move 之后原来的迭代器失效
+ */
+template <typename T, size_t N> class SmallVector {
+
+    static_assert(N > 0, "SmallVector needs at least one inline element");
+
+  public:
+    using value_type = T;
+    using size_type = size_t;
+    using reference = T &;
+    using const_reference = const T &;
+    using iterator = T *;
+    using const_iterator = const T *;
+
+    SmallVector() noexcept = default;
+
+    SmallVector(size_t count, const T &value) { assign(count, value); }
+
+    SmallVector(std::initializer_list<T> init) { append(init.begin(), init.end()); }
+
+    template <typename It, typename = typename std::iterator_traits<It>::iterator_category>
+    SmallVector(It first, It last) {
+        append(first, last);
+    }
+
+    SmallVector(const SmallVector &other) { append(other.begin(), other.end()); }
+
+    SmallVector(SmallVector &&other) noexcept { steal(other); }
+
+    ~SmallVector() {
+        clear();
+        freeHeap();
+    }
+
+    SmallVector &operator=(const SmallVector &other) {
+        if (this != &other) {
+            clear();
+            append(other.begin(), other.end());
+        }
+        return *this;
+    }
+
+    SmallVector &operator=(SmallVector &&other) noexcept {
+        if (this != &other) {
+            clear();
+            freeHeap();
+            steal(other);
+        }
+        return *this;
+    }
+
+    SmallVector &operator=(std::initializer_list<T> init) {
+        clear();
+        append(init.begin(), init.end());
+        return *this;
+    }
+
+    iterator begin() noexcept { return ptr; }
+    iterator end() noexcept { return ptr + count; }
+    const_iterator begin() const noexcept { return ptr; }
+    const_iterator end() const noexcept { return ptr + count; }
+
+    T *data() noexcept { return ptr; }
+    const T *data() const noexcept { return ptr; }
+
+    size_t size() const noexcept { return count; }
+    size_t capacity() const noexcept { return cap; }
+    bool empty() const noexcept { return count == 0; }
+
+    // 元素是否还在对象内部
+    bool isInline() const noexcept { return ptr == inlineData(); }
+
+    static constexpr size_t inlineCapacity() noexcept { return N; }
+
+    T &operator[](size_t i) noexcept { return ptr[i]; }
+    const T &operator[](size_t i) const noexcept { return ptr[i]; }
+
+    T &at(size_t i) {
+        if (i >= count) {
+            throw std::out_of_range("SmallVector::at");
+        }
+        return ptr[i];
+    }
+
+    const T &at(size_t i) const { return const_cast<SmallVector *>(this)->at(i); }
+
+    T &front() noexcept { return ptr[0]; }
+    const T &front() const noexcept { return ptr[0]; }
+    T &back() noexcept { return ptr[count - 1]; }
+    const T &back() const noexcept { return ptr[count - 1]; }
+
+    void reserve(size_t n) {
+        if (n > cap) {
+            grow(n);
+        }
+    }
+
+    template <typename... Args> T &emplace_back(Args &&...args) {
+        if (count == cap) {
+            // 先在新内存上构造，参数可能引用自身的元素
+            const size_t newCap = nextCapacity(count + 1);
+            T *mem = allocate(newCap);
+            try {
+                new (mem + count) T(std::forward<Args>(args)...);
+            } catch (...) {
+                ::operator delete(mem);
+                throw;
+            }
+            detail::relocate(ptr, count, mem);
+            freeHeap();
+            ptr = mem;
+            cap = newCap;
+        } else {
+            new (ptr + count) T(std::forward<Args>(args)...);
+        }
+        return ptr[count++];
+    }
+
+    void push_back(const T &value) { emplace_back(value); }
+
+    void push_back(T &&value) { emplace_back(std::move(value)); }
+
+    void pop_back() noexcept { ptr[--count].~T(); }
+
+    template <typename It> void append(It first, It last) {
+        if constexpr (std::is_base_of_v<std::forward_iterator_tag,
+                                        typename std::iterator_traits<It>::iterator_category>) {
+            reserve(count + static_cast<size_t>(std::distance(first, last)));
+        }
+        for (; first != last; ++first) {
+            emplace_back(*first);
+        }
+    }
+
+    void assign(size_t n, const T &value) {
+        clear();
+        reserve(n);
+        for (size_t i = 0; i < n; i++) {
+            new (ptr + i) T(value);
+            count++;
+        }
+    }
+
+    iterator insert(const_iterator pos, T value) {
+        const size_t index = static_cast<size_t>(pos - ptr);
+        emplace_back(std::move(value));
+        std::rotate(ptr + index, ptr + count - 1, ptr + count);
+        return ptr + index;
+    }
+
+    iterator erase(const_iterator pos) { return erase(pos, pos + 1); }
+
+    iterator erase(const_iterator first, const_iterator last) {
+        T *f = ptr + (first - ptr);
+        T *l = ptr + (last - ptr);
+        T *newEnd = std::move(l, end(), f);
+        for (T *p = newEnd; p != end(); ++p) {
+            p->~T();
+        }
+        count -= static_cast<size_t>(l - f);
+        return f;
+    }
+
+    void resize(size_t n) {
+        if (n < count) {
+            erase(ptr + n, end());
+            return;
+        }
+        reserve(n);
+        while (count < n) {
+            new (ptr + count) T();
+            count++;
+        }
+    }
+
+    void clear() noexcept {
+        if constexpr (!std::is_trivially_destructible_v<T>) {
+            for (size_t i = 0; i < count; i++) {
+                ptr[i].~T();
+            }
+        }
+        count = 0;
+    }
+
+    friend bool operator==(const SmallVector &a, const SmallVector &b) {
+        return a.size() == b.size() && std::equal(a.begin(), a.end(), b.begin());
+    }
+
+    friend bool operator!=(const SmallVector &a, const SmallVector &b) { return !(a == b); }
+
+  private:
+    alignas(T) unsigned char storage[N * sizeof(T)];
+    T *ptr = inlineData();
+    size_t count = 0;
+    size_t cap = N;
+
+    T *inlineData() noexcept { return reinterpret_cast<T *>(storage); }
+    const T *inlineData() const noexcept { return reinterpret_cast<const T *>(storage); }
+
+    static T *allocate(size_t n) { return static_cast<T *>(::operator new(n * sizeof(T))); }
+
+    size_t nextCapacity(size_t need) const noexcept { return std::max(need, cap * 2); }
+
+    void grow(size_t n) {
+        T *mem = allocate(n);
+        detail::relocate(ptr, count, mem);
+        freeHeap();
+        ptr = mem;
+        cap = n;
+    }
+
+    // 释放堆内存并回到内联存储，调用前元素已经销毁或搬走
+    void freeHeap() noexcept {
+        if (!isInline()) {
+            ::operator delete(ptr);
+            ptr = inlineData();
+            cap = N;
+        }
+    }
+
+    // 接管 other 的元素：堆上的直接拿走指针，内联的逐个搬迁；other 变为空
+    void steal(SmallVector &other) noexcept {
+        if (other.isInline()) {
+            detail::relocate(other.ptr, other.count, ptr);
+        } else {
+            ptr = other.ptr;
+            cap = other.cap;
+            other.ptr = other.inlineData();
+            other.cap = N;
+        }
+        count = other.count;
+        other.count = 0;
+    }
+};
+
+RHINO_INLINE_NAMESPACE_END
+} // namespace rhino
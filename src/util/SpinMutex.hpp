@@ -0,0 +1,71 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include "common/Version.h"
+#include "util/CpuUtil.hpp"
+#include "util/Futex.hpp"
+
+namespace rhino {
+RHINO_INLINE_NAMESPACE_BEGIN
+
+/**
+ * 自适应的先自旋后挂起的互斥锁，满足 Lockable，可替换 Locked 的 std::mutex
+ *
+ * 适合很短的临界区：持锁者通常很快释放，自旋一小段时间就能拿到锁，省掉一次
+ * futex 挂起/唤醒（微秒级）。自旋上限按最近几次成功自旋的步数做滑动平均，
+ * 临界区变长后自旋会自动缩短，不会一直白白烧 CPU。
+ *
+ * 状态：0 未加锁，1 已加锁无等待者，2 已加锁且可能有等待者（unlock 时需要 futexWake）
+ */
+class SpinMutex {
+
+    static constexpr int32_t MAX_SPIN = 4096;
+    static constexpr int32_t MIN_SPIN = 16;
+
+    std::atomic<uint32_t> state{0};
+    std::atomic<int32_t> spinLimit{256};
+
+  public:
+    SpinMutex() = default;
+    SpinMutex(const SpinMutex &) = delete;
+    SpinMutex &operator=(const SpinMutex &) = delete;
+
+    bool try_lock() noexcept {
+        uint32_t expected = 0;
+        return state.compare_exchange_strong(expected, 1, std::memory_order_acquire,
+                                             std::memory_order_relaxed);
+    }
+
+    void lock() noexcept {
+        if (try_lock()) {
+            return;
+        }
+        const int32_t limit = spinLimit.load(std::memory_order_relaxed);
+        for (int32_t spins = 1; spins <= limit; spins++) {
+            cpuRelax();
+            if (state.load(std::memory_order_relaxed) == 0 && try_lock()) {
+                // 成功自旋步数的 2 倍作为新的目标，1/8 权重做滑动平均
+                int32_t target = std::min(MAX_SPIN, std::max(MIN_SPIN, spins * 2));
+                spinLimit.store(limit + (target - limit) / 8, std::memory_order_relaxed);
+                return;
+            }
+        }
+        spinLimit.store(std::max(MIN_SPIN, limit - limit / 8), std::memory_order_relaxed);
+
+        // 自旋失败，标记有等待者后挂起
+        while (state.exchange(2, std::memory_order_acquire) != 0) {
+            futexWait(&state, 2);
+        }
+    }
+
+    void unlock() noexcept {
+        if (state.exchange(0, std::memory_order_release) == 2) {
+            futexWake(&state, 1);
+        }
+    }
+};
+
+RHINO_INLINE_NAMESPACE_END
+} // namespace rhino
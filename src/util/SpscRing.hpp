@@ -0,0 +1,204 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include "common/Errs.h"
+#include "common/Ret.h"
+#include "common/Version.h"
+#include "util/CpuUtil.hpp"
+
+namespace rhino {
+RHINO_INLINE_NAMESPACE_BEGIN
+
+/**
+ * 单生产者单消费者环形队列
+ *
+ * 和 boost::lockfree::spsc_queue 的区别：生产者缓存一份消费者的 head，消费者缓存一份生产者的 tail，
+ * 只有缓存值显示队列满/空时才去读对方的原子变量，所以稳态下每条消息不会在两个核之间来回搬运
+ * 对方的缓存行。生产者状态、消费者状态、数据区分别占用独立的缓存行。
+ *
+ * 批量零拷贝接口：
+ * - 生产者 claimWrite(n) 拿到一段连续的未初始化槽位，原地构造后 commitWrite(k) 发布
+ * - 消费者 claimRead(n) 拿到一段连续的已发布元素，处理完后 commitRead(k) 析构并归还
+ * 一段连续区域不会跨越环尾，所以返回的个数可能小于 n
+ *
+ * @tparam T 元素类型
+ * @tparam N 容量，必须是 2 的幂
+ */
+template <typename T, size_t N> class SpscRing {
+
+    static_assert(N >= 2 && (N & (N - 1)) == 0, "SpscRing capacity must be a power of two");
+
+    static constexpr size_t MASK = N - 1;
+
+    using Storage = typename std::aligned_storage<sizeof(T), alignof(T)>::type;
+
+    // 生产者独占的缓存行：tail 由生产者写、消费者偶尔读
+    alignas(CACHE_LINE_SIZE) std::atomic<size_t> tail{0};
+    size_t cachedHead{0};
+
+    // 消费者独占的缓存行
+    alignas(CACHE_LINE_SIZE) std::atomic<size_t> head{0};
+    size_t cachedTail{0};
+
+    alignas(CACHE_LINE_SIZE) Storage slots[N];
+
+    T *slot(size_t index) noexcept {
+        return std::launder(reinterpret_cast<T *>(&slots[index & MASK]));
+    }
+
+  public:
+    struct Claim {
+        T *data;
+        size_t count;
+    };
+
+    SpscRing() = default;
+
+    ~SpscRing() {
+        const size_t t = tail.load(std::memory_order_relaxed);
+        for (size_t h = head.load(std::memory_order_relaxed); h != t; h++) {
+            slot(h)->~T();
+        }
+    }
+
+    SpscRing(const SpscRing &) = delete;
+    SpscRing &operator=(const SpscRing &) = delete;
+
+    static constexpr size_t capacity() noexcept { return N; }
+
+    // ----------------------------- 生产者 -----------------------------
+
+    template <typename... Args> bool tryEmplace(Args &&...args) {
+        const size_t t = tail.load(std::memory_order_relaxed);
+        if (t - cachedHead == N) {
+            cachedHead = head.load(std::memory_order_acquire);
+            if (t - cachedHead == N) {
+                return false;
+            }
+        }
+        new (&slots[t & MASK]) T(std::forward<Args>(args)...);
+        tail.store(t + 1, std::memory_order_release);
+        return true;
+    }
+
+    Ret<void *> tryPush(const T &item) {
+        if (tryEmplace(item)) {
+            return Ret<void *>::with(nullptr);
+        }
+        return Ret<void *>::with(EGrp::INTERNAL, Err::QUEUE_FULL);
+    }
+
+    Ret<void *> tryPush(T &&item) {
+        if (tryEmplace(std::move(item))) {
+            return Ret<void *>::with(nullptr);
+        }
+        return Ret<void *>::with(EGrp::INTERNAL, Err::QUEUE_FULL);
+    }
+
+    /**
+     * 申请最多 n 个连续的未初始化槽位，调用方必须在 commitWrite 之前原地构造它们
+     */
+    Claim claimWrite(size_t n) noexcept {
+        const size_t t = tail.load(std::memory_order_relaxed);
+        size_t free = N - (t - cachedHead);
+        if (free < n) {
+            cachedHead = head.load(std::memory_order_acquire);
+            free = N - (t - cachedHead);
+        }
+        const size_t untilWrap = N - (t & MASK);
+        return Claim{reinterpret_cast<T *>(&slots[t & MASK]), std::min({n, free, untilWrap})};
+    }
+
+    /**
+     * 发布 claimWrite 申请到的前 n 个槽位
+     */
+    void commitWrite(size_t n) noexcept {
+        tail.store(tail.load(std::memory_order_relaxed) + n, std::memory_order_release);
+    }
+
+    // ----------------------------- 消费者 -----------------------------
+
+    /**
+     * 队头元素，队列空时返回 nullptr；处理完后调用 pop()
+     */
+    T *front() noexcept {
+        const size_t h = head.load(std::memory_order_relaxed);
+        if (h == cachedTail) {
+            cachedTail = tail.load(std::memory_order_acquire);
+            if (h == cachedTail) {
+                return nullptr;
+            }
+        }
+        return slot(h);
+    }
+
+    void pop() noexcept {
+        const size_t h = head.load(std::memory_order_relaxed);
+        slot(h)->~T();
+        head.store(h + 1, std::memory_order_release);
+    }
+
+    bool tryPop(T &out) {
+        T *item = front();
+        if (item == nullptr) {
+            return false;
+        }
+        out = std::move(*item);
+        pop();
+        return true;
+    }
+
+    Ret<T> tryPop() {
+        T *item = front();
+        if (item == nullptr) {
+            return Ret<T>::with(EGrp::INTERNAL, Err::QUEUE_EMPTY);
+        }
+        auto ret = Ret<T>::with(std::move(*item));
+        pop();
+        return ret;
+    }
+
+    /**
+     * 申请最多 n 个连续的已发布元素
+     */
+    Claim claimRead(size_t n) noexcept {
+        const size_t h = head.load(std::memory_order_relaxed);
+        size_t ready = cachedTail - h;
+        if (ready < n) {
+            cachedTail = tail.load(std::memory_order_acquire);
+            ready = cachedTail - h;
+        }
+        const size_t untilWrap = N - (h & MASK);
+        return Claim{slot(h), std::min({n, ready, untilWrap})};
+    }
+
+    /**
+     * 析构并归还 claimRead 拿到的前 n 个元素
+     */
+    void commitRead(size_t n) noexcept {
+        const size_t h = head.load(std::memory_order_relaxed);
+        if (!std::is_trivially_destructible<T>::value) {
+            for (size_t i = 0; i < n; i++) {
+                slot(h + i)->~T();
+            }
+        }
+        head.store(h + n, std::memory_order_release);
+    }
+
+    /**
+     * 近似长度，只在生产者或消费者线程上调用时有意义
+     */
+    size_t sizeApprox() const noexcept {
+        return tail.load(std::memory_order_acquire) - head.load(std::memory_order_acquire);
+    }
+
+    bool empty() const noexcept { return sizeApprox() == 0; }
+};
+
+RHINO_INLINE_NAMESPACE_END
+} // namespace rhino
@@ -1,11 +1,14 @@
 #pragma once
 #include <algorithm>
+#include <memory_resource>
 #include <string>
+#include <string_view>
 #include <vector>
 #include <cstring>
 #include "common/Ret.h"
 #include "common/Errs.h"
 #include "common/Version.h"
+#include "util/SmallVector.hpp"
 
 // SIMD support detection
 #if defined(__SSE2__) || (defined(_M_IX86) || defined(_M_X64))
@@ -45,6 +48,46 @@ inline std::vector<std::string> split(const std::string &s,
     return tokens;
 }
 
+/**
+ * split 的 pmr 版本，结果和其中的字符串都从 mr 分配，配合 Arena 使用时整个请求结束后一次性回收
+ */
+inline std::pmr::vector<std::pmr::string> split(std::string_view s, std::string_view delimiter,
+                                                std::pmr::memory_resource *mr) {
+    std::pmr::vector<std::pmr::string> tokens(mr);
+    size_t start = 0;
+    size_t end = s.find(delimiter);
+
+    while (end != std::string_view::npos) {
+        tokens.emplace_back(s.substr(start, end - start));
+        start = end + delimiter.length();
+        end = s.find(delimiter, start);
+    }
+
+    tokens.emplace_back(s.substr(start));
+
+    return tokens;
+}
+
+/**
+ * 不复制的 split：结果是指向 s 的 string_view，不超过 N 段时没有任何堆分配；s 必须比结果活得久
+ */
+template <size_t N = 8>
+inline SmallVector<std::string_view, N> splitView(std::string_view s, std::string_view delimiter) {
+    SmallVector<std::string_view, N> tokens;
+    size_t start = 0;
+    size_t end = s.find(delimiter);
+
+    while (end != std::string_view::npos) {
+        tokens.push_back(s.substr(start, end - start));
+        start = end + delimiter.length();
+        end = s.find(delimiter, start);
+    }
+
+    tokens.push_back(s.substr(start));
+
+    return tokens;
+}
+
 /**
  * Copy string pointer to array (SIMD optimized version: uses SSE2 instructions for batch copying)
  * @param src Source string pointer (const char*)
@@ -58,9 +101,7 @@ inline Ret<size_t> copyStringToArray(const char* src, char (&dest)[N]) {
     
     // Check if source pointer is null
     if (src == nullptr) {
-        EGrp eGrp = EGrp::INTERNAL;
-        Err err = Err::FORMAT_ERR;
-        return Ret<size_t>::with(eGrp, err, "Source string pointer is nullptr");
+        return Ret<size_t>::with(EGrp::INTERNAL, Err::FORMAT_ERR, "Source string pointer is nullptr");
     }
     
     const size_t maxCopy = N - 1; // Reserve space for null terminator
@@ -106,15 +147,13 @@ inline Ret<size_t> copyStringToArray(const char* src, char (&dest)[N]) {
             
             // Check if stopped early due to array being too small
             if (src[copied] != '\0') {
-                EGrp eGrp = EGrp::INTERNAL;
-                Err err = Err::FORMAT_ERR;
                 size_t srcLen = copied;
                 while (src[srcLen] != '\0') {
                     ++srcLen;
                 }
                 std::string errMsg = "Source string length (" + std::to_string(srcLen) + 
                                     ") exceeds destination array size (" + std::to_string(N) + ")";
-                return Ret<size_t>::with(eGrp, err, errMsg);
+                return Ret<size_t>::with(EGrp::INTERNAL, Err::FORMAT_ERR, errMsg);
             }
             
             return Ret<size_t>::with(copied);
@@ -143,8 +182,6 @@ inline Ret<size_t> copyStringToArray(const char* src, char (&dest)[N]) {
     
     // Check if stopped early due to array being too small (source string has remaining characters)
     if (src[copied] != '\0') {
-        EGrp eGrp = EGrp::INTERNAL;
-        Err err = Err::FORMAT_ERR;
         // Calculate full length only in error case (for error message)
         size_t srcLen = copied;
         while (src[srcLen] != '\0') {
@@ -152,7 +189,7 @@ inline Ret<size_t> copyStringToArray(const char* src, char (&dest)[N]) {
         }
         std::string errMsg = "Source string length (" + std::to_string(srcLen) + 
                             ") exceeds destination array size (" + std::to_string(N) + ")";
-        return Ret<size_t>::with(eGrp, err, errMsg);
+        return Ret<size_t>::with(EGrp::INTERNAL, Err::FORMAT_ERR, errMsg);
     }
     
     // Return success result with number of copied characters
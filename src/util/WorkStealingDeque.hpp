@@ -0,0 +1,100 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include "common/Version.h"
+#include "util/CpuUtil.hpp"
+
+namespace rhino {
+RHINO_INLINE_NAMESPACE_BEGIN
+
+/**
+ * Chase-Lev 工作窃取双端队列（固定容量版本，内存序参考 Lê 等人的 C11 实现）
+ *
+ * - 所属线程在底部 push/pop（LIFO，缓存友好）
+ * - 其他线程在顶部 steal（FIFO，偷走最老、通常也是最大的任务）
+ *
+ * 固定容量避免了扩容时旧数组的回收问题，push 返回 false 时由调用方自行兜底
+ * （例如放入全局队列或直接执行）。
+ *
+ * @tparam T 元素类型，一般是指针
+ */
+template <typename T> class WorkStealingDeque {
+
+    alignas(CACHE_LINE_SIZE) std::atomic<int64_t> top{0};
+    alignas(CACHE_LINE_SIZE) std::atomic<int64_t> bottom{0};
+    alignas(CACHE_LINE_SIZE) int64_t mask;
+    std::unique_ptr<std::atomic<T>[]> buffer;
+
+  public:
+    /**
+     * @param capacity 容量，必须是 2 的幂
+     */
+    explicit WorkStealingDeque(int64_t capacity = 4096)
+        : mask(capacity - 1), buffer(new std::atomic<T>[static_cast<size_t>(capacity)]) {}
+
+    WorkStealingDeque(const WorkStealingDeque &) = delete;
+    WorkStealingDeque &operator=(const WorkStealingDeque &) = delete;
+
+    /**
+     * 所属线程压入，满时返回 false
+     */
+    bool push(T item) noexcept {
+        const int64_t b = bottom.load(std::memory_order_relaxed);
+        const int64_t t = top.load(std::memory_order_acquire);
+        if (b - t > mask) {
+            return false;
+        }
+        buffer[b & mask].store(item, std::memory_order_relaxed);
+        // 原算法是 release 栅栏 + relaxed store，这里直接用 release store，x86 上开销相同且 TSan 能识别
+        bottom.store(b + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * 所属线程弹出最新的元素
+     */
+    bool pop(T &out) noexcept {
+        const int64_t b = bottom.load(std::memory_order_relaxed) - 1;
+        bottom.store(b, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t t = top.load(std::memory_order_relaxed);
+        if (t > b) {
+            bottom.store(b + 1, std::memory_order_relaxed);
+            return false;
+        }
+        out = buffer[b & mask].load(std::memory_order_relaxed);
+        if (t == b) {
+            // 只剩最后一个元素，和窃取者竞争
+            const bool won = top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst,
+                                                         std::memory_order_relaxed);
+            bottom.store(b + 1, std::memory_order_relaxed);
+            return won;
+        }
+        return true;
+    }
+
+    /**
+     * 其他线程窃取最老的元素，失败（空或竞争失败）返回 false
+     */
+    bool steal(T &out) noexcept {
+        int64_t t = top.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        const int64_t b = bottom.load(std::memory_order_acquire);
+        if (t >= b) {
+            return false;
+        }
+        out = buffer[t & mask].load(std::memory_order_relaxed);
+        return top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst,
+                                           std::memory_order_relaxed);
+    }
+
+    bool emptyApprox() const noexcept {
+        return bottom.load(std::memory_order_relaxed) <= top.load(std::memory_order_relaxed);
+    }
+};
+
+RHINO_INLINE_NAMESPACE_END
+} // namespace rhino
@@ -0,0 +1,229 @@
+#include "gtest/gtest.h"
+
+#include <chrono>
+#include <iostream>
+#include <map>
+#include <memory_resource>
+#include <string>
+#include <vector>
+
+#include "common/Validation.h"
+#include "util/Arena.hpp"
+#include "util/JsonUtil.hpp"
+#include "util/StringUtil.hpp"
+
+using namespace rhino;
+using namespace std;
+
+namespace {
+
+// 统计经过它的分配次数：作为 Arena 的 upstream 时就是 Arena 向上游申请的次数
+class CountingResource final : public std::pmr::memory_resource {
+  public:
+    size_t allocations = 0;
+    size_t deallocations = 0;
+
+  protected:
+    void *do_allocate(size_t bytes, size_t alignment) override {
+        allocations++;
+        return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+    }
+
+    void do_deallocate(void *p, size_t bytes, size_t alignment) override {
+        deallocations++;
+        std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override { return this == &other; }
+};
+
+// 一个典型的请求：解析 k=v;k=v 格式的参数，校验后输出 json
+const string REQUEST = "user=alice;email=alice@example.com;age=30;city=hangzhou;lang=zh-CN;"
+                       "tags=rust,cpp,go,java,python,kotlin,swift,scala;note=the quick brown fox jumps over the lazy dog";
+
+struct Profile {
+    string user;
+    int32_t age{};
+    vector<string> tags;
+    map<string, string> extra;
+    NLOHMANN_DEFINE_TYPE_INTRUSIVE(Profile, user, age, tags, extra)
+};
+
+struct PmrProfile {
+    std::pmr::string user;
+    int32_t age{};
+    std::pmr::vector<std::pmr::string> tags;
+    std::pmr::map<std::pmr::string, std::pmr::string> extra;
+
+    explicit PmrProfile(std::pmr::memory_resource *mr) : user(mr), tags(mr), extra(mr) {}
+};
+
+void to_json(nlohmann::json &j, const PmrProfile &p) {
+    j["user"] = p.user;
+    j["age"] = p.age;
+    j["tags"] = p.tags;
+    auto &extra = j["extra"];
+    extra = nlohmann::json::object();
+    for (const auto &[k, v] : p.extra) {
+        extra[std::string(k)] = v;
+    }
+}
+
+void validate(const string &user, int32_t age) {
+    {
+        const auto &value = user;
+        NotBlank("user must not be blank");
+    }
+    {
+        const auto value = age;
+        GreaterThan(0, "age must be positive") LessThan(200, "age must be less than 200")
+    }
+}
+
+string handle(const string &request) {
+    Profile p;
+    for (const auto &field : split(request, ";")) {
+        auto kv = split(field, "=");
+        if (kv[0] == "user") {
+            p.user = kv[1];
+        } else if (kv[0] == "age") {
+            p.age = std::stoi(kv[1]);
+        } else if (kv[0] == "tags") {
+            p.tags = split(kv[1], ",");
+        } else {
+            p.extra[kv[0]] = kv[1];
+        }
+    }
+    validate(p.user, p.age);
+    return toJson(p);
+}
+
+std::pmr::string handle(const string &request, std::pmr::memory_resource *mr) {
+    PmrProfile p(mr);
+    for (const auto &field : split(request, ";", mr)) {
+        auto kv = split(field, "=", mr);
+        if (kv[0] == "user") {
+            p.user = kv[1];
+        } else if (kv[0] == "age") {
+            p.age = std::stoi(string(kv[1]));
+        } else if (kv[0] == "tags") {
+            p.tags = split(kv[1], ",", mr);
+        } else {
+            p.extra[kv[0]] = kv[1];
+        }
+    }
+    validate(string(p.user), p.age);
+    return toJson(p, mr);
+}
+
+} // namespace
+
+TEST(ArenaTest, BumpAllocateAndReset) {
+    CountingResource upstream;
+    {
+        Arena arena(256, &upstream);
+        EXPECT_EQ(arena.chunkCount(), 0U);
+        void *a = arena.allocate(10, 1);
+        void *b = arena.allocate(8, 8);
+        EXPECT_EQ(reinterpret_cast<uintptr_t>(b) % 8, 0U);
+        EXPECT_GT(static_cast<char *>(b), static_cast<char *>(a));
+        EXPECT_EQ(arena.allocationCount(), 2U);
+        EXPECT_EQ(arena.bytesUsed(), 18U);
+        // 最后一次分配可以原地收回
+        arena.deallocate(b, 8, 8);
+        EXPECT_EQ(arena.allocate(8, 8), b);
+
+        // 超过块大小的分配单独申请
+        void *big = arena.allocate(4096, 64);
+        EXPECT_EQ(reinterpret_cast<uintptr_t>(big) % 64, 0U);
+        EXPECT_EQ(arena.chunkCount(), 2U);
+        EXPECT_EQ(upstream.allocations, 2U);
+
+        // reset 之后复用已有的块，不再向上游申请
+        arena.reset();
+        EXPECT_EQ(arena.bytesUsed(), 0U);
+        EXPECT_EQ(arena.allocate(10, 1), a);
+        EXPECT_EQ(arena.allocate(4096, 64), big);
+        EXPECT_EQ(upstream.allocations, 2U);
+
+        arena.release();
+        EXPECT_EQ(arena.chunkCount(), 0U);
+        EXPECT_EQ(arena.bytesReserved(), 0U);
+        EXPECT_EQ(upstream.deallocations, 2U);
+        EXPECT_NE(arena.allocate(1, 1), nullptr);
+    }
+    EXPECT_EQ(upstream.allocations, upstream.deallocations);
+}
+
+TEST(ArenaTest, InitialBufferAndPmrContainers) {
+    alignas(std::max_align_t) char buffer[1024];
+    CountingResource upstream;
+    Arena arena(buffer, sizeof(buffer), &upstream);
+    {
+        std::pmr::vector<std::pmr::string> v(&arena);
+        v.emplace_back("short");
+        EXPECT_GE(static_cast<const void *>(v.data()), static_cast<const void *>(buffer));
+        EXPECT_LT(static_cast<const void *>(v.data()), static_cast<const void *>(buffer + sizeof(buffer)));
+        EXPECT_EQ(upstream.allocations, 0U);
+        // 放不下之后向上游申请，元素的分配器跟随容器
+        for (int32_t i = 0; i < 100; i++) {
+            v.emplace_back("a string that is longer than the small string buffer " + std::to_string(i));
+        }
+        EXPECT_GT(upstream.allocations, 0U);
+        EXPECT_EQ(v.back().get_allocator().resource(), &arena);
+    }
+    arena.release();
+    EXPECT_EQ(arena.chunkCount(), 1U);
+    EXPECT_EQ(upstream.allocations, upstream.deallocations);
+}
+
+TEST(ArenaTest, PmrStringAndJsonUtilities) {
+    Arena arena;
+    auto parts = split("a,bb,,ccc", ",", &arena);
+    ASSERT_EQ(parts.size(), 4U);
+    EXPECT_EQ(parts[1], "bb");
+    EXPECT_EQ(parts[2], "");
+    EXPECT_EQ(parts[3].get_allocator().resource(), &arena);
+    EXPECT_EQ(split("abc", "--", &arena).size(), 1U);
+
+    const string expected = handle(REQUEST);
+    const std::pmr::string actual = handle(REQUEST, &arena);
+    EXPECT_EQ(string(actual), expected);
+    EXPECT_EQ(actual.get_allocator().resource(), &arena);
+    EXPECT_EQ(string(fromJsonTree(nlohmann::json::parse(expected), &arena, true)),
+              fromJsonTree(nlohmann::json::parse(expected), true));
+}
+
+TEST(ArenaTest, Benchmark) {
+    constexpr int32_t N = 100000;
+    size_t bytes = 0;
+
+    auto start = std::chrono::steady_clock::now();
+    for (int32_t i = 0; i < N; i++) {
+        bytes += handle(REQUEST).size();
+    }
+    auto heapNs = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+
+    // 同一份 pmr 代码直接走全局堆，统计每个请求的分配次数（nlohmann::json 树内部的分配两边都不计入）
+    CountingResource heap;
+    for (int32_t i = 0; i < N; i++) {
+        bytes += handle(REQUEST, &heap).size();
+    }
+
+    CountingResource upstream;
+    Arena arena(Arena::DEFAULT_CHUNK_SIZE, &upstream);
+    start = std::chrono::steady_clock::now();
+    for (int32_t i = 0; i < N; i++) {
+        bytes += handle(REQUEST, &arena).size();
+        arena.reset();
+    }
+    auto arenaNs = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << "全局堆: " << static_cast<double>(heapNs) / N << " ns/请求, "
+              << static_cast<double>(heap.allocations) / N << " 次分配/请求" << std::endl;
+    std::cout << "Arena: " << static_cast<double>(arenaNs) / N << " ns/请求, "
+              << static_cast<double>(upstream.allocations) / N << " 次分配/请求 (bytes=" << bytes
+              << ", 块数=" << arena.chunkCount() << ")" << std::endl;
+    EXPECT_LT(upstream.allocations, heap.allocations);
+    EXPECT_EQ(upstream.allocations, arena.chunkCount());
+}
@@ -0,0 +1,225 @@
+#include "gtest/gtest.h"
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "util/BTreeMap.hpp"
+
+using namespace rhino;
+using namespace std;
+
+namespace {
+
+// 统计 std::map 节点占用的字节数
+size_t mapBytes = 0;
+
+template <typename T> struct CountingAllocator {
+    using value_type = T;
+
+    CountingAllocator() = default;
+    template <typename U> CountingAllocator(const CountingAllocator<U> &) {}
+
+    T *allocate(size_t n) {
+        mapBytes += n * sizeof(T);
+        return std::allocator<T>().allocate(n);
+    }
+
+    void deallocate(T *p, size_t n) {
+        mapBytes -= n * sizeof(T);
+        std::allocator<T>().deallocate(p, n);
+    }
+
+    template <typename U> bool operator==(const CountingAllocator<U> &) const { return true; }
+    template <typename U> bool operator!=(const CountingAllocator<U> &) const { return false; }
+};
+
+template <typename Map> void expectSame(const Map &tree, const std::map<int64_t, int64_t> &expected) {
+    ASSERT_EQ(tree.size(), expected.size());
+    auto it = expected.begin();
+    for (auto [k, v] : tree) {
+        ASSERT_EQ(k, it->first);
+        ASSERT_EQ(v, it->second);
+        ++it;
+    }
+}
+
+} // namespace
+
+TEST(BTreeMapTest, InsertFindErase) {
+    BTreeMap<int32_t, std::string> map;
+    EXPECT_EQ(map.begin(), map.end());
+    EXPECT_TRUE(map.insert(2, "b").second);
+    EXPECT_TRUE(map.insert(1, "a").second);
+    EXPECT_FALSE(map.insert(1, "x").second);
+    EXPECT_EQ(*map.get(1), "a");
+    map.insertOrAssign(1, "x");
+    EXPECT_EQ(map.find(1)->second, "x");
+    map[3] = "c";
+    EXPECT_EQ(map.size(), 3U);
+    EXPECT_EQ(map.get(4), nullptr);
+    EXPECT_EQ(map.lowerBound(2).key(), 2);
+    EXPECT_EQ(map.upperBound(2).key(), 3);
+    EXPECT_EQ(map.upperBound(3), map.end());
+
+    EXPECT_EQ(map.erase(2), 1U);
+    EXPECT_EQ(map.erase(2), 0U);
+    EXPECT_FALSE(map.contains(2));
+    EXPECT_EQ(map.erase(1) + map.erase(3), 2U);
+    EXPECT_TRUE(map.empty());
+    EXPECT_EQ(map.height(), 0U);
+
+    // 负数和无符号的大数走 SIMD 比较时也要保持顺序
+    BTreeMap<int64_t, int32_t> negative;
+    BTreeMap<uint32_t, int32_t> unsignedKeys;
+    for (int32_t i = -100; i < 100; i++) {
+        negative.insert(i * 3, i);
+        unsignedKeys.insert(static_cast<uint32_t>(i), i);
+    }
+    EXPECT_EQ(negative.lowerBound(-7).key(), -6);
+    EXPECT_EQ(negative.begin().key(), -300);
+    EXPECT_EQ(unsignedKeys.begin().key(), 0U);
+    EXPECT_EQ(unsignedKeys.lowerBound(0x80000000U).key(), static_cast<uint32_t>(-100));
+}
+
+TEST(BTreeMapTest, RandomOpsMatchStdMap) {
+    // 小节点让分裂、借位和合并都频繁发生
+    BTreeMap<int64_t, int64_t, std::less<int64_t>, 128> tree;
+    std::map<int64_t, int64_t> expected;
+    std::mt19937_64 gen(7);
+    std::uniform_int_distribution<int64_t> key(-5000, 5000);
+    for (int32_t i = 0; i < 200000; i++) {
+        const int64_t k = key(gen);
+        if (gen() % 5 < 3) {
+            EXPECT_EQ(tree.insert(k, i).second, expected.emplace(k, i).second);
+        } else {
+            EXPECT_EQ(tree.erase(k), expected.erase(k));
+        }
+    }
+    expectSame(tree, expected);
+
+    int64_t sum = 0;
+    int64_t expectedSum = 0;
+    tree.forRange(-100, 100, [&](int64_t, int64_t v) { sum += v; });
+    for (auto it = expected.lower_bound(-100); it != expected.end() && it->first < 100; ++it) {
+        expectedSum += it->second;
+    }
+    EXPECT_EQ(sum, expectedSum);
+
+    auto copy = tree;
+    for (const auto &[k, v] : expected) {
+        tree.erase(k);
+    }
+    EXPECT_TRUE(tree.empty());
+    expectSame(copy, expected);
+}
+
+TEST(BTreeMapTest, FromSorted) {
+    std::vector<std::pair<int64_t, int64_t>> items;
+    std::map<int64_t, int64_t> expected;
+    for (int64_t i = 0; i < 100000; i++) {
+        items.emplace_back(i * 2, i);
+        expected.emplace(i * 2, i);
+    }
+    auto tree = BTreeMap<int64_t, int64_t>::fromSorted(items.begin(), items.end());
+    expectSame(tree, expected);
+    EXPECT_EQ(*tree.get(1000), 500);
+    EXPECT_GE(tree.height(), 2U);
+
+    // 批量构建后的树可以继续插入和删除
+    for (int64_t i = 0; i < 100000; i += 3) {
+        tree.insert(i * 2 + 1, -i);
+        expected.emplace(i * 2 + 1, -i);
+        tree.erase(i * 4);
+        expected.erase(i * 4);
+    }
+    expectSame(tree, expected);
+
+    items.emplace_back(0, 0);
+    EXPECT_THROW((BTreeMap<int64_t, int64_t>::fromSorted(items.begin(), items.end())), std::invalid_argument);
+    std::vector<std::pair<int64_t, int64_t>> none;
+    EXPECT_TRUE((BTreeMap<int64_t, int64_t>::fromSorted(none.begin(), none.end()).empty()));
+}
+
+TEST(BTreeMapTest, Benchmark) {
+    // 在更大的机器上可以把规模调到 1 亿
+    constexpr size_t N = 1000000;
+    std::vector<int64_t> keys(N);
+    std::mt19937_64 gen(1);
+    for (auto &k : keys) {
+        k = static_cast<int64_t>(gen() >> 1);
+    }
+    std::vector<int64_t> sorted = keys;
+    std::sort(sorted.begin(), sorted.end());
+    sorted.erase(std::unique(sorted.begin(), sorted.end()), sorted.end());
+
+    using Clock = std::chrono::steady_clock;
+    auto ms = [](Clock::time_point start) {
+        return std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() - start).count();
+    };
+
+    std::map<int64_t, int64_t, std::less<int64_t>, CountingAllocator<std::pair<const int64_t, int64_t>>> stdMap;
+    auto start = Clock::now();
+    for (int64_t k : keys) {
+        stdMap.emplace(k, k);
+    }
+    auto mapInsert = ms(start);
+
+    BTreeMap<int64_t, int64_t> tree;
+    start = Clock::now();
+    for (int64_t k : keys) {
+        tree.insert(k, k);
+    }
+    auto treeInsert = ms(start);
+
+    std::vector<std::pair<int64_t, int64_t>> items;
+    items.reserve(sorted.size());
+    for (int64_t k : sorted) {
+        items.emplace_back(k, k);
+    }
+    start = Clock::now();
+    auto bulk = BTreeMap<int64_t, int64_t>::fromSorted(items.begin(), items.end());
+    auto bulkLoad = ms(start);
+
+    std::shuffle(keys.begin(), keys.end(), gen);
+    int64_t sum = 0;
+    start = Clock::now();
+    for (int64_t k : keys) {
+        sum += stdMap.find(k)->second;
+    }
+    auto mapFind = ms(start);
+    start = Clock::now();
+    for (int64_t k : keys) {
+        sum -= *tree.get(k);
+    }
+    auto treeFind = ms(start);
+    EXPECT_EQ(sum, 0);
+
+    // 1000 次范围扫描，每次约 1000 个元素
+    const int64_t width = std::numeric_limits<int64_t>::max() / static_cast<int64_t>(N) * 1000;
+    start = Clock::now();
+    for (size_t i = 0; i < 1000; i++) {
+        for (auto it = stdMap.lower_bound(keys[i]); it != stdMap.end() && it->first < keys[i] + width; ++it) {
+            sum += it->second & 1;
+        }
+    }
+    auto mapScan = ms(start);
+    start = Clock::now();
+    for (size_t i = 0; i < 1000; i++) {
+        bulk.forRange(keys[i], keys[i] + width, [&](int64_t, int64_t v) { sum -= v & 1; });
+    }
+    auto treeScan = ms(start);
+    EXPECT_EQ(sum, 0);
+
+    std::cout << "数据量: " << stdMap.size() << ", B+ 树高度: " << tree.height() << std::endl;
+    std::cout << "插入 std::map: " << mapInsert << " ms, BTreeMap: " << treeInsert << " ms, 批量构建: " << bulkLoad
+              << " ms" << std::endl;
+    std::cout << "随机查找 std::map: " << mapFind << " ms, BTreeMap: " << treeFind << " ms" << std::endl;
+    std::cout << "范围扫描 std::map: " << mapScan << " ms, BTreeMap: " << treeScan << " ms" << std::endl;
+    std::cout << "内存 std::map: " << mapBytes / 1024 / 1024 << " MB, BTreeMap: " << tree.memoryBytes() / 1024 / 1024
+              << " MB, 批量构建: " << bulk.memoryBytes() / 1024 / 1024 << " MB" << std::endl;
+}
@@ -20,6 +20,8 @@
 #include <boost/multi_index/member.hpp>
 #include <boost/multi_index/mem_fun.hpp>
 #include <boost/multi_index/composite_key.hpp>
+
+#include "util/FlatMultiIndex.hpp"
 using namespace std;
 using namespace std::chrono;
 namespace bmi = boost::multi_index;
@@ -32,6 +34,38 @@ struct Data {
     Data(int i, const std::string& v) : id(i), value(v) {}
 };
 
+// 统计容器从分配器申请的字节数，Tag 区分不同容器（rebind 出来的节点分配器共用一个计数）
+template <int Tag>
+struct AllocatedBytes {
+    static inline size_t value = 0;
+};
+
+template <typename T, int Tag>
+struct CountingAllocator {
+    using value_type = T;
+
+    template <typename U> struct rebind { using other = CountingAllocator<U, Tag>; };
+
+    CountingAllocator() = default;
+    template <typename U> CountingAllocator(const CountingAllocator<U, Tag>&) {}
+
+    T* allocate(size_t n) {
+        AllocatedBytes<Tag>::value += n * sizeof(T);
+        return std::allocator<T>().allocate(n);
+    }
+
+    void deallocate(T* p, size_t n) {
+        AllocatedBytes<Tag>::value -= n * sizeof(T);
+        std::allocator<T>().deallocate(p, n);
+    }
+
+    template <typename U> bool operator==(const CountingAllocator<U, Tag>&) const { return true; }
+    template <typename U> bool operator!=(const CountingAllocator<U, Tag>&) const { return false; }
+};
+
+using UnorderedMapContainer = std::unordered_map<int, Data, std::hash<int>, std::equal_to<int>,
+                                                 CountingAllocator<std::pair<const int, Data>, 0>>;
+
 // Boost.MultiIndex 容器定义（仅使用hash索引）
 using BoostMultiIndexContainer = bmi::multi_index_container<
     Data,
@@ -39,14 +73,18 @@ using BoostMultiIndexContainer = bmi::multi_index_container<
         bmi::hashed_unique<
             bmi::member<Data, int, &Data::id>
         >
-    >
+    >,
+    CountingAllocator<Data, 1>
 >;
 
+using FlatMultiIndexContainer = rhino::FlatMultiIndex<Data, rhino::HashedUnique<rhino::MemberKey<&Data::id>>>;
+
 // 性能测试类
 class PerformanceTest {
 private:
-    std::unordered_map<int, Data> unordered_map_;
+    UnorderedMapContainer unordered_map_;
     BoostMultiIndexContainer multi_index_;
+    FlatMultiIndexContainer flat_index_;
     std::vector<int> test_keys_;
 
 public:
@@ -93,6 +131,18 @@ public:
         return duration_cast<microseconds>(end - start).count();
     }
 
+    // 测试FlatMultiIndex插入性能
+    long long test_flat_index_insert() {
+        auto start = high_resolution_clock::now();
+
+        for (int key : test_keys_) {
+            flat_index_.emplace(key, "value_" + std::to_string(key));
+        }
+
+        auto end = high_resolution_clock::now();
+        return duration_cast<microseconds>(end - start).count();
+    }
+
     // 测试unordered_map查找性能
     long long test_unordered_map_find() {
         auto start = high_resolution_clock::now();
@@ -132,6 +182,51 @@ public:
         return duration_cast<microseconds>(end - start).count();
     }
 
+    // 测试FlatMultiIndex查找性能
+    long long test_flat_index_find() {
+        auto start = high_resolution_clock::now();
+
+        size_t found_count = 0;
+        for (int key : test_keys_) {
+            if (flat_index_.find<0>(key) != nullptr) {
+                ++found_count;
+            }
+        }
+
+        auto end = high_resolution_clock::now();
+        std::cout << "FlatMultiIndex查找验证: " << found_count << "/" << test_keys_.size()
+                  << " 成功找到" << std::endl;
+        return duration_cast<microseconds>(end - start).count();
+    }
+
+    // 删除一半的键
+    long long test_unordered_map_erase() {
+        auto start = high_resolution_clock::now();
+        for (size_t i = 0; i < test_keys_.size(); i += 2) {
+            unordered_map_.erase(test_keys_[i]);
+        }
+        auto end = high_resolution_clock::now();
+        return duration_cast<microseconds>(end - start).count();
+    }
+
+    long long test_multi_index_erase() {
+        auto start = high_resolution_clock::now();
+        for (size_t i = 0; i < test_keys_.size(); i += 2) {
+            multi_index_.erase(test_keys_[i]);
+        }
+        auto end = high_resolution_clock::now();
+        return duration_cast<microseconds>(end - start).count();
+    }
+
+    long long test_flat_index_erase() {
+        auto start = high_resolution_clock::now();
+        for (size_t i = 0; i < test_keys_.size(); i += 2) {
+            flat_index_.eraseKey<0>(test_keys_[i]);
+        }
+        auto end = high_resolution_clock::now();
+        return duration_cast<microseconds>(end - start).count();
+    }
+
     // 运行完整测试
     void run_complete_test() {
         std::cout << "=== 性能测试开始 ===" << std::endl;
@@ -141,24 +236,40 @@ public:
         std::cout << "\n--- 插入性能测试 ---" << std::endl;
         auto um_insert_time = test_unordered_map_insert();
         auto mi_insert_time = test_multi_index_insert();
+        auto fi_insert_time = test_flat_index_insert();
 
         std::cout << "std::unordered_map 插入时间: " << um_insert_time << " μs" << std::endl;
         std::cout << "Boost.MultiIndex 插入时间: " << mi_insert_time << " μs" << std::endl;
+        std::cout << "FlatMultiIndex 插入时间: " << fi_insert_time << " μs" << std::endl;
         std::cout << "性能差异: " << (mi_insert_time * 100.0 / um_insert_time - 100) << "%" << std::endl;
 
         // 查找性能测试
         std::cout << "\n--- 查找性能测试 ---" << std::endl;
         auto um_find_time = test_unordered_map_find();
         auto mi_find_time = test_multi_index_find();
+        auto fi_find_time = test_flat_index_find();
 
         std::cout << "std::unordered_map 查找时间: " << um_find_time << " μs" << std::endl;
         std::cout << "Boost.MultiIndex 查找时间: " << mi_find_time << " μs" << std::endl;
+        std::cout << "FlatMultiIndex 查找时间: " << fi_find_time << " μs" << std::endl;
         std::cout << "性能差异: " << (mi_find_time * 100.0 / um_find_time - 100) << "%" << std::endl;
 
-        // 内存使用情况（估算）
-        std::cout << "\n--- 内存使用估算 ---" << std::endl;
-        std::cout << "std::unordered_map 大小: " << unordered_map_.size() << std::endl;
-        std::cout << "Boost.MultiIndex 大小: " << multi_index_.size() << std::endl;
+        // 内存使用情况（容器自身申请的字节数，value 都在 SSO 内，不含字符串堆内存）
+        std::cout << "\n--- 内存使用 ---" << std::endl;
+        std::cout << "std::unordered_map 大小: " << unordered_map_.size() << ", 占用 "
+                  << AllocatedBytes<0>::value << " 字节" << std::endl;
+        std::cout << "Boost.MultiIndex 大小: " << multi_index_.size() << ", 占用 "
+                  << AllocatedBytes<1>::value << " 字节" << std::endl;
+        std::cout << "FlatMultiIndex 大小: " << flat_index_.size() << ", 占用 " << flat_index_.memoryBytes()
+                  << " 字节" << std::endl;
+
+        // 删除性能测试
+        std::cout << "\n--- 删除性能测试 ---" << std::endl;
+        std::cout << "std::unordered_map 删除时间: " << test_unordered_map_erase() << " μs" << std::endl;
+        std::cout << "Boost.MultiIndex 删除时间: " << test_multi_index_erase() << " μs" << std::endl;
+        std::cout << "FlatMultiIndex 删除时间: " << test_flat_index_erase() << " μs" << std::endl;
+        EXPECT_EQ(flat_index_.size(), multi_index_.size());
+        EXPECT_EQ(flat_index_.size(), unordered_map_.size());
     }
 };
 
@@ -0,0 +1,303 @@
+#include "gtest/gtest.h"
+
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "util/Cache.hpp"
+
+using namespace rhino;
+using namespace std;
+
+namespace {
+
+// 每个条目固定按 100 字节计算，方便推算容量
+struct HundredBytes {
+    size_t operator()(const int64_t &, const int64_t &) const noexcept { return 100; }
+};
+
+CacheOptions smallCache(size_t capacityBytes) {
+    CacheOptions options;
+    options.capacityBytes = capacityBytes;
+    options.shards = 1;
+    return options;
+}
+
+uint64_t counterValue(const std::string &name) {
+    for (const auto &r : MetricsRegistry::global().snapshot(name)) {
+        if (r.name == name) {
+            return r.count;
+        }
+    }
+    return UINT64_MAX;
+}
+
+} // namespace
+
+TEST(CacheTest, BasicOperations) {
+    Cache<std::string, std::string> cache;
+    EXPECT_EQ(cache.get("a"), std::nullopt);
+    cache.put("a", "1");
+    cache.put("b", std::string(1000, 'x'));
+    EXPECT_EQ(cache.get("a"), "1");
+    EXPECT_EQ(cache.get("b")->size(), 1000U);
+    cache.put("a", "2");
+    EXPECT_EQ(cache.get("a"), "2");
+    EXPECT_EQ(cache.size(), 2U);
+    // 长字符串的堆内存也计入字节数
+    EXPECT_GT(cache.bytes(), 1000U);
+
+    EXPECT_TRUE(cache.erase("a"));
+    EXPECT_FALSE(cache.erase("a"));
+    EXPECT_EQ(cache.get("a"), std::nullopt);
+    EXPECT_EQ(cache.size(), 1U);
+
+    cache.clear();
+    EXPECT_EQ(cache.size(), 0U);
+    EXPECT_EQ(cache.bytes(), 0U);
+    auto stats = cache.stats();
+    EXPECT_EQ(stats.hits, 3U);
+    EXPECT_EQ(stats.misses, 2U);
+}
+
+TEST(CacheTest, ByteCapacity) {
+    Cache<int64_t, int64_t, FastHash<int64_t>, std::equal_to<int64_t>, HundredBytes> cache(smallCache(100 * 100));
+    for (int64_t i = 0; i < 1000; i++) {
+        cache.put(i, i);
+        ASSERT_LE(cache.bytes(), 100U * 100);
+    }
+    EXPECT_EQ(cache.size(), 100U);
+    EXPECT_EQ(cache.stats().evictions, 900U);
+    // 最近插入的还在
+    EXPECT_EQ(cache.get(999), 999);
+
+    // 反复覆盖和删除不会让死条目堆积在队列里
+    for (int64_t i = 0; i < 100000; i++) {
+        cache.put(i % 10, i);
+        cache.erase(i % 10);
+    }
+    EXPECT_LE(cache.bytes(), 100U * 100);
+
+    // 超过分片容量的条目不缓存
+    Cache<std::string, std::string> tiny(smallCache(1024));
+    tiny.put("big", std::string(4096, 'x'));
+    EXPECT_EQ(tiny.get("big"), std::nullopt);
+    EXPECT_EQ(tiny.size(), 0U);
+}
+
+TEST(CacheTest, ScanResistance) {
+    // 容量 1000 个条目，500 个热点键先各访问两次，之后每轮夹杂 2000 个只访问一次的键；
+    // LRU 在每轮扫描后都会丢光热点
+    Cache<int64_t, int64_t, FastHash<int64_t>, std::equal_to<int64_t>, HundredBytes> cache(smallCache(1000 * 100));
+    constexpr int64_t HOT = 500;
+    for (int32_t round = 0; round < 2; round++) {
+        for (int64_t k = 0; k < HOT; k++) {
+            if (!cache.get(k)) {
+                cache.put(k, k);
+            }
+        }
+    }
+    int64_t scan = 1000000;
+    int64_t hotHits = 0;
+    for (int32_t round = 0; round < 20; round++) {
+        for (int32_t i = 0; i < 2000; i++, scan++) {
+            if (!cache.get(scan)) {
+                cache.put(scan, scan);
+            }
+        }
+        for (int64_t k = 0; k < HOT; k++) {
+            if (cache.get(k)) {
+                hotHits++;
+            } else {
+                cache.put(k, k);
+            }
+        }
+    }
+    EXPECT_GE(hotHits, 20 * HOT * 95 / 100);
+}
+
+TEST(CacheTest, Ttl) {
+    std::atomic<int64_t> now{1000};
+    CacheOptions options;
+    options.name = "ttl_cache";
+    options.defaultTtl = std::chrono::milliseconds(100);
+    options.clock = [&] { return now.load(); };
+    Cache<int32_t, std::string> cache(options);
+
+    cache.put(1, "default");
+    cache.put(2, "short", std::chrono::milliseconds(10));
+    cache.put(3, "forever", std::chrono::milliseconds(0));
+    now += 50;
+    EXPECT_EQ(cache.get(1), "default");
+    EXPECT_EQ(cache.get(2), std::nullopt);
+    now += 50;
+    EXPECT_EQ(cache.get(1), std::nullopt);
+    now += 1000000;
+    EXPECT_EQ(cache.get(3), "forever");
+    EXPECT_EQ(cache.size(), 1U);
+    EXPECT_EQ(cache.stats().expirations, 2U);
+
+    // 过期后 getOrLoad 重新加载
+    int32_t calls = 0;
+    auto load = [&](int32_t k) {
+        calls++;
+        return std::to_string(k * calls);
+    };
+    EXPECT_EQ(cache.getOrLoad(7, load), "7");
+    EXPECT_EQ(cache.getOrLoad(7, load), "7");
+    now += 100;
+    EXPECT_EQ(cache.getOrLoad(7, load), "14");
+    EXPECT_EQ(calls, 2);
+}
+
+TEST(CacheTest, GetOrLoadCoalescesMisses) {
+    Cache<int32_t, int32_t> cache;
+    constexpr int32_t THREADS = 8;
+    std::atomic<int32_t> calls{0};
+    std::atomic<int32_t> waiting{0};
+    std::vector<std::thread> threads;
+    std::vector<int32_t> results(THREADS);
+    for (int32_t t = 0; t < THREADS; t++) {
+        threads.emplace_back([&, t] {
+            waiting++;
+            results[t] = cache.getOrLoad(42, [&](int32_t k) {
+                calls++;
+                // 等其余线程都到达后再返回，让它们撞上进行中的加载
+                auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(200);
+                while (waiting.load() < THREADS && std::chrono::steady_clock::now() < deadline) {
+                    std::this_thread::yield();
+                }
+                std::this_thread::sleep_for(std::chrono::milliseconds(20));
+                return k * 2;
+            });
+        });
+    }
+    for (auto &t : threads) {
+        t.join();
+    }
+    EXPECT_EQ(calls.load(), 1);
+    for (int32_t r : results) {
+        EXPECT_EQ(r, 84);
+    }
+    auto stats = cache.stats();
+    EXPECT_EQ(stats.loads, 1U);
+    EXPECT_EQ(stats.coalesced + stats.hits, THREADS - 1U);
+
+    // 异常抛给调用者且不缓存
+    EXPECT_THROW(cache.getOrLoad(1, [](int32_t) -> int32_t { throw std::runtime_error("load failed"); }),
+                 std::runtime_error);
+    EXPECT_EQ(cache.get(1), std::nullopt);
+
+    // 返回 optional 的 loader，nullopt 不缓存
+    auto none = cache.getOrLoad(2, [](int32_t) { return std::optional<int32_t>(); });
+    EXPECT_EQ(none, std::nullopt);
+    EXPECT_EQ(cache.size(), 1U);
+    auto some = cache.getOrLoad(2, [](int32_t k) { return std::optional<int32_t>(k); });
+    EXPECT_EQ(some, 2);
+    EXPECT_EQ(cache.get(2), 2);
+}
+
+TEST(CacheTest, LoadDoesNotOverwriteNewerWrites) {
+    Cache<int32_t, std::string> cache;
+    // 加载期间被 put 的键保留新值，调用者仍拿到自己加载的结果
+    auto loaded = cache.getOrLoad(1, [&cache](int32_t) {
+        cache.put(1, "new");
+        return std::string("old");
+    });
+    EXPECT_EQ(loaded, "old");
+    EXPECT_EQ(cache.get(1), "new");
+
+    // 加载期间被 erase / clear 的键不会被加载结果复活
+    cache.put(2, "stale");
+    cache.erase(2);
+    EXPECT_EQ(cache.getOrLoad(2, [&cache](int32_t) {
+        cache.erase(2);
+        return std::string("old");
+    }), "old");
+    EXPECT_EQ(cache.get(2), std::nullopt);
+    EXPECT_EQ(cache.getOrLoad(3, [&cache](int32_t) {
+        cache.clear();
+        return std::string("old");
+    }), "old");
+    EXPECT_EQ(cache.get(3), std::nullopt);
+
+    // 没有并发写入时照常缓存
+    EXPECT_EQ(cache.getOrLoad(4, [](int32_t) { return std::string("v"); }), "v");
+    EXPECT_EQ(cache.get(4), "v");
+}
+
+TEST(CacheTest, UnnamedCachesHaveDistinctMetrics) {
+    auto names = [] {
+        std::set<std::string> out;
+        for (const auto &r : MetricsRegistry::global().snapshot("cache-")) {
+            out.insert(r.name);
+        }
+        return out;
+    };
+    const size_t before = names().size();
+    {
+        Cache<int32_t, int32_t> a;
+        Cache<int32_t, int32_t> b;
+        a.put(1, 1);
+        EXPECT_EQ(a.get(1), 1);
+        // 每个缓存 6 个指标，互不重名
+        EXPECT_EQ(names().size(), before + 12);
+    }
+    EXPECT_EQ(names().size(), before);
+}
+
+TEST(CacheTest, Metrics) {
+    CacheOptions options;
+    options.name = "user_cache";
+    {
+        Cache<int32_t, int32_t> cache(options);
+        cache.put(1, 1);
+        cache.get(1);
+        cache.get(1);
+        cache.get(2);
+        cache.getOrLoad(3, [](int32_t k) { return k; });
+        EXPECT_EQ(counterValue("user_cache.hits"), 2U);
+        EXPECT_EQ(counterValue("user_cache.misses"), 2U);
+        EXPECT_EQ(counterValue("user_cache.loads"), 1U);
+        EXPECT_EQ(counterValue("user_cache.evictions"), 0U);
+    }
+    // 析构后指标被移除
+    EXPECT_EQ(counterValue("user_cache.hits"), UINT64_MAX);
+}
+
+TEST(CacheTest, Benchmark) {
+    // zipf 分布近似：key = N * u^3，热点集中在小编号上
+    constexpr int64_t KEYS = 1000000;
+    constexpr int64_t OPS = 2000000;
+    std::mt19937_64 gen(1);
+    std::uniform_real_distribution<double> u(0, 1);
+    std::vector<int64_t> trace(OPS);
+    for (auto &k : trace) {
+        const double x = u(gen);
+        k = static_cast<int64_t>(static_cast<double>(KEYS) * x * x * x);
+    }
+
+    for (size_t capacity : {10000, 100000}) {
+        CacheOptions options;
+        options.name = "bench_cache";
+        options.capacityBytes = capacity * 100;
+        Cache<int64_t, int64_t, FastHash<int64_t>, std::equal_to<int64_t>, HundredBytes> cache(options);
+        auto start = std::chrono::steady_clock::now();
+        for (int64_t k : trace) {
+            cache.getOrLoad(k, [](int64_t key) { return key; });
+        }
+        auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start)
+                      .count();
+        auto stats = cache.stats();
+        std::cout << "容量 " << capacity << " 条: 命中率 "
+                  << 100.0 * static_cast<double>(stats.hits) / static_cast<double>(OPS) << "%, 平均 "
+                  << ns / OPS << " ns/次, 淘汰 " << stats.evictions << std::endl;
+    }
+}
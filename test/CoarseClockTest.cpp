@@ -0,0 +1,85 @@
+#include "gtest/gtest.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <ctime>
+#include <iostream>
+#include <string>
+#include <thread>
+
+#include "util/CoarseClock.hpp"
+
+using namespace rhino;
+using namespace std;
+using namespace std::chrono;
+
+TEST(CoarseClockTest, PublishAndRead) {
+    CoarseClock clock;
+    clock.start(microseconds(500));
+
+    this_thread::sleep_for(milliseconds(20));
+    auto real = duration_cast<milliseconds>(system_clock::now().time_since_epoch()).count();
+    auto cached = clock.nowMs();
+    // 发布线程可能被调度延迟，这里放宽到 100ms
+    EXPECT_LE(std::abs(real - cached), 100);
+
+    auto snap = clock.snapshot();
+    EXPECT_EQ(snap.epochMs, snap.epochUs / 1000);
+    EXPECT_EQ(std::string(snap.date).size(), CoarseClock::DATE_SIZE - 1);
+    EXPECT_EQ(snap.date[19], '.');
+
+    clock.stop();
+    EXPECT_FALSE(clock.isRunning());
+}
+
+TEST(CoarseClockTest, ManualUpdate) {
+    CoarseClock clock;
+    auto before = clock.nowUs();
+    this_thread::sleep_for(milliseconds(2));
+    // 没有后台线程时时间不动，由调用方（例如事件循环）驱动
+    EXPECT_EQ(clock.nowUs(), before);
+    clock.update();
+    EXPECT_GT(clock.nowUs(), before);
+}
+
+template <typename Func> static double nanosPerCall(Func f, int64_t loops) {
+    auto start = high_resolution_clock::now();
+    int64_t sink = 0;
+    for (int64_t i = 0; i < loops; i++) {
+        sink += f();
+    }
+    auto end = high_resolution_clock::now();
+    volatile int64_t keep = sink;
+    (void)keep;
+    return static_cast<double>(duration_cast<nanoseconds>(end - start).count()) / loops;
+}
+
+TEST(CoarseClockTest, Benchmark) {
+    constexpr int64_t LOOPS = 2000000;
+    CoarseClock &clock = CoarseClock::global();
+    clock.start();
+
+    auto realtime = nanosPerCall([] {
+        timespec ts{};
+        clock_gettime(CLOCK_REALTIME, &ts);
+        return static_cast<int64_t>(ts.tv_nsec);
+    }, LOOPS);
+    auto coarse = nanosPerCall([] {
+        timespec ts{};
+        clock_gettime(CLOCK_REALTIME_COARSE, &ts);
+        return static_cast<int64_t>(ts.tv_nsec);
+    }, LOOPS);
+    auto chronoNow = nanosPerCall([] {
+        return static_cast<int64_t>(system_clock::now().time_since_epoch().count());
+    }, LOOPS);
+    auto cachedMs = nanosPerCall([&clock] { return clock.nowMs(); }, LOOPS);
+    auto cachedSnap = nanosPerCall([&clock] { return clock.snapshot().epochUs; }, LOOPS);
+
+    std::cout << "clock_gettime(CLOCK_REALTIME):        " << realtime << " ns/次" << std::endl;
+    std::cout << "clock_gettime(CLOCK_REALTIME_COARSE): " << coarse << " ns/次" << std::endl;
+    std::cout << "system_clock::now():                  " << chronoNow << " ns/次" << std::endl;
+    std::cout << "CoarseClock::nowMs():                 " << cachedMs << " ns/次" << std::endl;
+    std::cout << "CoarseClock::snapshot():              " << cachedSnap << " ns/次" << std::endl;
+
+    clock.stop();
+}
@@ -1,11 +1,105 @@
 #include "common/Errs.h"
 #include "common/Ret.h"
 #include "gtest/gtest.h"
+#include "util/Metrics.hpp"
+
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
 
 using namespace rhino;
 using namespace std;
 
 TEST(CommonTest, ErrsTest) {
     auto ret = Ret<void *>::with(EGrp::INTERNAL, Err::FORMAT_ERR, "格式化错误");
-    EXPECT_EQ(ret.success, false);
-}
\ No newline at end of file
+    EXPECT_TRUE(ret.failed());
+}
+
+TEST(CommonTest, ErrRegistryDetectsDuplicates) {
+    Err first(9001, "TEST_DUP", "first");
+    Err again(9001, "TEST_DUP", "again");
+    EXPECT_EQ(first.id, again.id);
+    EXPECT_EQ(ErrRegistry::global().err(first.id).msg, "first");
+    // 同一个错误码换了名字，或者同一个名字换了错误码
+    EXPECT_THROW(Err(9001, "TEST_OTHER", ""), std::runtime_error);
+    EXPECT_THROW(Err(9002, "TEST_DUP", ""), std::runtime_error);
+    EXPECT_THROW(EGrp(-1, "NOT_INTERNAL"), std::runtime_error);
+    EXPECT_EQ(EGrp(-1, "INTERNAL").id, EGrp::INTERNAL.id);
+}
+
+TEST(CommonTest, ErrCountersAcrossThreads) {
+    static Err counted(9003, "TEST_COUNTED", "counted");
+    auto &registry = ErrRegistry::global();
+    std::vector<std::thread> threads;
+    for (int32_t t = 0; t < 4; t++) {
+        threads.emplace_back([] {
+            for (int32_t i = 0; i < 1000; i++) {
+                EXPECT_TRUE(Ret<int32_t>::with(EGrp::INTERNAL, counted).failed());
+            }
+        });
+    }
+    for (auto &t : threads) {
+        t.join();
+    }
+    // 已退出线程的计数保留
+    EXPECT_EQ(registry.count(counted.id), 4000U);
+    auto ret = Ret<int32_t>::with(EGrp::INTERNAL, counted, "with message");
+    EXPECT_EQ(registry.count(counted.id), 4001U);
+    // 透传失败不算新的发生
+    EXPECT_TRUE(Ret<int64_t>::FailureTransfer(ret).failed());
+    EXPECT_EQ(registry.count(counted.id), 4001U);
+
+    auto reports = MetricsRegistry::global().snapshot("errors.TEST_COUNTED");
+    ASSERT_EQ(reports.size(), 1U);
+    EXPECT_EQ(reports[0].count, 4001U);
+}
+
+TEST(CommonTest, ErrorsDuringThreadExitAreCounted) {
+    static Err late(9005, "TEST_LATE", "late");
+    // 比计数槽位更早构造的 thread_local 更晚析构，析构时槽位已经归还
+    struct LateReporter {
+        ~LateReporter() { EXPECT_TRUE(Ret<void *>::with(EGrp::INTERNAL, late).failed()); }
+    };
+    std::thread([] {
+        static thread_local LateReporter reporter;
+        (void)reporter;
+        EXPECT_TRUE(Ret<void *>::with(EGrp::INTERNAL, late).failed());
+    }).join();
+    EXPECT_EQ(ErrRegistry::global().count(late.id), 2U);
+}
+
+// sink 和 clock 引用夹具的成员；TearDown 在成员析构前恢复默认配置，断言提前返回时也不会留下悬空的引用
+class ErrReportTest : public ::testing::Test {
+  protected:
+    std::atomic<int64_t> now{0};
+    std::vector<std::string> lines;
+
+    void TearDown() override { ErrRegistry::global().setReportOptions(ErrReportOptions()); }
+};
+
+TEST_F(ErrReportTest, ErrReportIsRateLimited) {
+    static Err noisy(9004, "TEST_NOISY", "noisy");
+    ErrReportOptions options;
+    options.perSecond = 3;
+    options.sink = [this](const std::string &line) { lines.push_back(line); };
+    options.clock = [this] { return now.load(); };
+    ErrRegistry::global().setReportOptions(options);
+
+    auto ret = Ret<void *>::with(EGrp::INTERNAL, noisy, "disk full");
+    for (int32_t i = 0; i < 100; i++) {
+        ret.report("write");
+    }
+    ASSERT_EQ(lines.size(), 3U);
+    EXPECT_EQ(lines[0], "write: disk full");
+    // 其他错误码有自己的配额
+    Ret<void *>::with(EGrp::INTERNAL, Err::IO_ERR).report("read");
+    EXPECT_EQ(lines.size(), 4U);
+
+    now += 1000;
+    ret.report("write");
+    ASSERT_EQ(lines.size(), 5U);
+    EXPECT_EQ(lines[4], "write: disk full (97 similar errors suppressed)");
+    Ret<int32_t>::with(1).report("success is not reported");
+    EXPECT_EQ(lines.size(), 5U);
+}
@@ -0,0 +1,238 @@
+#include "gtest/gtest.h"
+
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "util/ConcurrentHashMap.hpp"
+#include "util/Locked.hpp"
+
+using namespace rhino;
+using namespace std;
+
+TEST(ConcurrentHashMapTest, BasicOperations) {
+    ConcurrentHashMap<std::string, int32_t> map(ConcurrentHashMapOptions{4, 8, 2});
+    EXPECT_TRUE(map.insert("a", 1));
+    EXPECT_FALSE(map.insert("a", 2));
+    EXPECT_EQ(map.get("a"), 1);
+    // string_view / const char* 透明查找
+    EXPECT_TRUE(map.contains(std::string_view("a")));
+    EXPECT_FALSE(map.insertOrAssign("a", 3));
+    EXPECT_EQ(map.get("a"), 3);
+    EXPECT_TRUE(map.update("a", [](int32_t v) { return v * 10; }));
+    EXPECT_FALSE(map.update("b", [](int32_t v) { return v; }));
+    EXPECT_EQ(map.get("a"), 30);
+    EXPECT_EQ(map.get("b"), std::nullopt);
+
+    // 小分片反复扩容并渐进迁移，每一步都能读到所有键
+    for (int32_t i = 0; i < 5000; i++) {
+        EXPECT_TRUE(map.insert(std::to_string(i), i));
+        if (i % 97 == 0) {
+            for (int32_t j = 0; j <= i; j += 13) {
+                ASSERT_EQ(map.get(std::to_string(j)), j);
+            }
+        }
+    }
+    EXPECT_EQ(map.size(), 5001U);
+    for (int32_t i = 0; i < 5000; i += 2) {
+        EXPECT_TRUE(map.erase(std::to_string(i)));
+    }
+    EXPECT_FALSE(map.erase("0"));
+    EXPECT_EQ(map.size(), 2501U);
+
+    int64_t sum = 0;
+    size_t n = 0;
+    map.forEach([&](const std::string &, int32_t v) {
+        sum += v;
+        n++;
+    });
+    EXPECT_EQ(n, 2501U);
+    EXPECT_EQ(sum, 30 + 2500LL * 2500);
+
+    map.clear();
+    EXPECT_EQ(map.size(), 0U);
+    EXPECT_FALSE(map.contains("1"));
+    EXPECT_TRUE(map.insert("1", 1));
+}
+
+TEST(ConcurrentHashMapTest, ReadersNeverMissStableKeysDuringResize) {
+    // 少量分片让写者频繁触发扩容和迁移，读者查找的固定键必须一直能找到且值不变
+    ConcurrentHashMap<int64_t, int64_t> map(ConcurrentHashMapOptions{2, 8, 4});
+    constexpr int64_t STABLE = 1000;
+    for (int64_t i = 0; i < STABLE; i++) {
+        map.insert(i, i * 7);
+    }
+    std::atomic<bool> stop{false};
+    std::atomic<int64_t> misses{0};
+    std::vector<std::thread> readers;
+    for (int32_t t = 0; t < 3; t++) {
+        readers.emplace_back([&, t] {
+            std::mt19937_64 gen(t);
+            while (!stop.load(std::memory_order_relaxed)) {
+                const auto k = static_cast<int64_t>(gen() % STABLE);
+                if (map.get(k) != k * 7) {
+                    misses++;
+                }
+            }
+        });
+    }
+    std::thread writer([&] {
+        for (int32_t round = 0; round < 20; round++) {
+            for (int64_t i = 0; i < 2000; i++) {
+                map.insert(STABLE + round * 2000 + i, i);
+            }
+            for (int64_t i = 0; i < 2000; i++) {
+                map.erase(STABLE + round * 2000 + i);
+            }
+        }
+        stop = true;
+    });
+    writer.join();
+    for (auto &r : readers) {
+        r.join();
+    }
+    EXPECT_EQ(misses.load(), 0);
+    EXPECT_EQ(map.size(), static_cast<size_t>(STABLE));
+    epoch::Domain::global().reclaim();
+}
+
+TEST(ConcurrentHashMapTest, ConcurrentWritersKeepCounts) {
+    ConcurrentHashMap<int64_t, int64_t> map;
+    constexpr int32_t THREADS = 4;
+    constexpr int64_t PER_THREAD = 20000;
+    std::vector<std::thread> threads;
+    for (int32_t t = 0; t < THREADS; t++) {
+        threads.emplace_back([&, t] {
+            for (int64_t i = 0; i < PER_THREAD; i++) {
+                map.insert(t * PER_THREAD + i, i);
+                // 所有线程争抢同一批共享键
+                map.insertOrAssign(-(i % 100) - 1, t);
+                if (i % 3 == 0) {
+                    map.erase(t * PER_THREAD + i);
+                }
+            }
+        });
+    }
+    for (auto &t : threads) {
+        t.join();
+    }
+    EXPECT_EQ(map.size(), static_cast<size_t>(THREADS * (PER_THREAD - (PER_THREAD + 2) / 3) + 100));
+    for (int64_t i = 0; i < PER_THREAD; i++) {
+        EXPECT_EQ(map.contains(i), i % 3 != 0);
+    }
+}
+
+TEST(ConcurrentHashMapTest, EraseAndClearUnderHazardFallback) {
+    // 一个分片、一个停在临界区里的线程：epoch 推不动，回收只能走 hazard 扫描
+    ConcurrentHashMap<int64_t, std::string> map(ConcurrentHashMapOptions{1, 16, 4});
+    auto valueOf = [](int64_t key) { return std::string(64, static_cast<char>('a' + key % 26)); };
+    std::atomic<bool> stalled{false};
+    std::atomic<bool> done{false};
+    std::thread staller([&] {
+        epoch::Guard guard;
+        stalled = true;
+        while (!done.load()) {
+            std::this_thread::yield();
+        }
+    });
+    while (!stalled.load()) {
+        std::this_thread::yield();
+    }
+    std::atomic<int64_t> corrupted{0};
+    std::vector<std::thread> readers;
+    for (int32_t t = 0; t < 4; t++) {
+        readers.emplace_back([&, t] {
+            for (int64_t i = t; !done.load(); i++) {
+                auto v = map.get(i % 16);
+                if (v.has_value() && *v != valueOf(i % 16)) {
+                    corrupted++;
+                }
+            }
+        });
+    }
+    // 退休的节点远超 LIMBO_LIMIT，多次触发 hazard 扫描
+    for (int32_t round = 0; round < 20000; round++) {
+        for (int64_t k = 0; k < 16; k++) {
+            map.insert(k, valueOf(k));
+        }
+        for (int64_t k = 0; k < 16; k += 2) {
+            map.erase(k);
+        }
+        if (round % 2 == 0) {
+            map.clear();
+        }
+    }
+    done = true;
+    staller.join();
+    for (auto &r : readers) {
+        r.join();
+    }
+    EXPECT_EQ(corrupted.load(), 0);
+    epoch::Domain::global().reclaim();
+    epoch::Domain::global().reclaim();
+}
+
+namespace {
+
+// 每个线程执行 ops 次操作，其中 writePercent% 是写，返回总吞吐（百万次/秒）
+template <typename Get, typename Put>
+double runMix(int32_t threads, int32_t writePercent, int64_t keys, int64_t ops, Get get, Put put) {
+    std::vector<std::thread> workers;
+    std::atomic<int64_t> found{0};
+    auto start = std::chrono::steady_clock::now();
+    for (int32_t t = 0; t < threads; t++) {
+        workers.emplace_back([&, t] {
+            std::mt19937_64 gen(t);
+            int64_t hits = 0;
+            for (int64_t i = 0; i < ops; i++) {
+                const auto k = static_cast<int64_t>(gen() % static_cast<uint64_t>(keys));
+                if (static_cast<int32_t>(gen() % 100) < writePercent) {
+                    put(k, i);
+                } else {
+                    hits += get(k) ? 1 : 0;
+                }
+            }
+            found += hits;
+        });
+    }
+    for (auto &w : workers) {
+        w.join();
+    }
+    auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+    return static_cast<double>(threads * ops) * 1000.0 / static_cast<double>(ns);
+}
+
+} // namespace
+
+TEST(ConcurrentHashMapTest, Benchmark) {
+    constexpr int64_t KEYS = 100000;
+    // 总操作数固定，线程越多每个线程做得越少
+    constexpr int64_t TOTAL_OPS = 400000;
+    for (int32_t writePercent : {10, 50}) {
+        std::cout << "读写比 " << 100 - writePercent << "/" << writePercent << std::endl;
+        for (int32_t threads : {1, 2, 4, 8, 16, 32, 64}) {
+            const int64_t ops = TOTAL_OPS / threads;
+            ConcurrentHashMap<int64_t, int64_t> concurrent;
+            Locked<std::unordered_map<int64_t, int64_t>> locked;
+            for (int64_t k = 0; k < KEYS; k += 2) {
+                concurrent.insert(k, k);
+                locked([&](std::unordered_map<int64_t, int64_t> &m) { m.emplace(k, k); });
+            }
+            const double concurrentMops = runMix(
+                threads, writePercent, KEYS, ops, [&](int64_t k) { return concurrent.contains(k); },
+                [&](int64_t k, int64_t v) { concurrent.insertOrAssign(k, v); });
+            const double lockedMops = runMix(
+                threads, writePercent, KEYS, ops,
+                [&](int64_t k) { return locked([&](auto &m) { return m.count(k) > 0; }); },
+                [&](int64_t k, int64_t v) { locked([&](std::unordered_map<int64_t, int64_t> &m) { m[k] = v; }); });
+            std::cout << "  " << threads << " 线程: ConcurrentHashMap " << concurrentMops
+                      << " M/s, Locked<unordered_map> " << lockedMops << " M/s" << std::endl;
+        }
+    }
+    epoch::Domain::global().reclaim();
+}
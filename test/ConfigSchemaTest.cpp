@@ -0,0 +1,218 @@
+#include "gtest/gtest.h"
+
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+#include "config/AppConfig.h"
+#include "config/ConfigSchema.h"
+
+using namespace rhino;
+using namespace std;
+
+#define TEST_CONFIG(X)                                                                                        \
+    X(StringCfg, name, "name", "rhino", "服务名", NotBlank("name must not be blank"))                         \
+    X(Int32Cfg, port, "server.port", 8080, "监听端口",                                                        \
+      GreaterThan(0, "server.port must be > 0") LessThan(65536, "server.port must be < 65536"))               \
+    X(BoolCfg, verbose, "server.verbose", false, "详细日志")                                                  \
+    X(DoubleCfg, ratio, "pool.ratio", 0.5, "比例", GreaterOrEqualThan(0.0, "pool.ratio must be >= 0"))        \
+    X(Int32Cfg, first, "pool.sizes[0]", 1, "第一个池的大小")                                                  \
+    X(Int32Cfg, second, "pool.sizes[1]", 2, "第二个池的大小")
+
+RHINO_DEFINE_CONFIG(TestConfig, TEST_CONFIG)
+
+#define NESTED_CONFIG(X) X(Int32Cfg, weight, "backends[0].weight", 1, "权重")
+
+RHINO_DEFINE_CONFIG(NestedConfig, NESTED_CONFIG)
+
+#define SPARSE_CONFIG(X) X(Int32Cfg, second, "sizes[1]", 2, "第二个池的大小")
+
+RHINO_DEFINE_CONFIG(SparseConfig, SPARSE_CONFIG)
+
+static_assert(TestConfig::FIELD_COUNT == 6);
+static constexpr const char *DUPLICATED[] = {"a", "b.c", "a"};
+static_assert(!detail::uniqueKeys(DUPLICATED));
+
+namespace {
+
+template <typename Cfg, typename V> CfgValue cfg(V v) { return detail::makeCfg<Cfg>(v, ""); }
+
+} // namespace
+
+TEST(ConfigSchemaTest, DefaultsAndAccessors) {
+    TestConfig config;
+    EXPECT_EQ(config.get_name(), "rhino");
+    EXPECT_EQ(config.get_port(), 8080);
+    EXPECT_FALSE(config.get_verbose());
+    EXPECT_DOUBLE_EQ(config.get_ratio(), 0.5);
+    EXPECT_EQ(config.port_.desc, "监听端口");
+    EXPECT_EQ(config.port_.type, "int32");
+
+    config.set_port(9090);
+    EXPECT_EQ(config.get_port(), 9090);
+    EXPECT_THROW(config.set_port(0), std::invalid_argument);
+    EXPECT_THROW(config.set_name("  "), std::invalid_argument);
+    EXPECT_EQ(config.get_port(), 9090);
+}
+
+TEST(ConfigSchemaTest, LoadFromEntries) {
+    CfgEntries entries;
+    entries.emplace("server.port", cfg<Int32Cfg>(80));
+    // 整数可以读进 double 字段，未声明的 key 被忽略
+    entries.emplace("pool.ratio", cfg<Int32Cfg>(2));
+    entries.emplace("placement.loop.cpus", cfg<StringCfg>("0-3"));
+    auto ret = TestConfig::fromEntries(entries);
+    ASSERT_FALSE(ret.failed()) << ret.getErr().msg;
+    EXPECT_EQ(ret.value().get_port(), 80);
+    EXPECT_DOUBLE_EQ(ret.value().get_ratio(), 2.0);
+    EXPECT_EQ(ret.value().get_name(), "rhino");
+
+    CfgEntries wrongType;
+    wrongType.emplace("server.port", cfg<StringCfg>("80"));
+    auto mismatch = TestConfig::fromEntries(wrongType);
+    ASSERT_TRUE(mismatch.failed());
+    EXPECT_EQ(mismatch.getErr().code, Err::FORMAT_ERR.code);
+    EXPECT_EQ(mismatch.getErr().msg, "server.port must be int32");
+
+    CfgEntries invalid;
+    invalid.emplace("server.port", cfg<Int32Cfg>(70000));
+    auto rejected = TestConfig::fromEntries(invalid);
+    ASSERT_TRUE(rejected.failed());
+    EXPECT_EQ(rejected.getErr().code, Err::VALIDATION_ERR.code);
+    EXPECT_EQ(rejected.getErr().msg, "server.port must be < 65536");
+}
+
+TEST(ConfigSchemaTest, JsonAndTomlRoundTrip) {
+    TestConfig config;
+    config.set_port(443);
+    config.set_verbose(true);
+    const nlohmann::json json = config.toJson();
+    EXPECT_EQ(json["server"]["port"], 443);
+    EXPECT_EQ(json["pool"]["sizes"][0], 1);
+    auto back = TestConfig::fromJson(json);
+    ASSERT_FALSE(back.failed()) << back.getErr().msg;
+    EXPECT_EQ(back.value().toEntries().size(), TestConfig::FIELD_COUNT);
+    EXPECT_EQ(back.value().get_port(), 443);
+    EXPECT_TRUE(back.value().get_verbose());
+    EXPECT_TRUE(TestConfig::fromJson(nlohmann::json::parse(R"({"server": {"port": null}})")).failed());
+
+    const string toml = config.toToml();
+    EXPECT_EQ(toml.find("# 服务名\nname = \"rhino\"\n"), 0U) << toml;
+    EXPECT_NE(toml.find("[server]\n# 监听端口\nport = 443\n"), string::npos) << toml;
+    EXPECT_NE(toml.find("[pool]\n"), string::npos) << toml;
+    EXPECT_NE(toml.find("sizes = [\n    # 第一个池的大小\n    1,\n    # 第二个池的大小\n    2,\n]\n"), string::npos) << toml;
+
+    // 导出的 toml 能被重新加载，且值不变
+    config.set_ratio(0.125);
+    config.set_second(7);
+    const string path = ::testing::TempDir() + "config_schema_round_trip.toml";
+    {
+        std::ofstream out(path);
+        out << config.toToml();
+    }
+    auto entries = loadTomlFile(path);
+    std::remove(path.c_str());
+    ASSERT_FALSE(entries.failed()) << entries.getErr().msg << "\n" << config.toToml();
+    auto reloaded = TestConfig::fromEntries(entries.value());
+    ASSERT_FALSE(reloaded.failed()) << reloaded.getErr().msg;
+    EXPECT_TRUE(diffConfig(config.toEntries(), reloaded.value().toEntries()).empty());
+    EXPECT_EQ(reloaded.value().get_second(), 7);
+    EXPECT_DOUBLE_EQ(reloaded.value().get_ratio(), 0.125);
+
+    // 表数组和有空洞的数组无法表示为 toml
+    EXPECT_THROW((void)NestedConfig().toToml(), std::invalid_argument);
+    EXPECT_THROW((void)SparseConfig().toToml(), std::invalid_argument);
+
+    const string doc = TestConfig::schemaDoc();
+    EXPECT_NE(doc.find("| `server.port` | int32 | `8080` | 监听端口 |"), string::npos) << doc;
+    EXPECT_NE(AppConfig::schemaDoc().find("metrics.report_interval_s"), string::npos);
+}
+
+TEST(ConfigSchemaTest, TypedConfigFollowsReload) {
+    int32_t port = 1000;
+    TypedConfig<TestConfig> config("memory", [&port](const string &) {
+        CfgEntries entries;
+        entries.emplace("server.port", cfg<Int32Cfg>(port));
+        return Ret<CfgEntries>::with(entries);
+    });
+    epoch::Guard guard;
+    EXPECT_EQ(config.get(guard), nullptr);
+    ASSERT_FALSE(config.manager().reload().failed());
+    EXPECT_EQ(config.get(guard)->get_port(), 1000);
+
+    // schema 校验失败时保留旧配置
+    port = -1;
+    auto rejected = config.manager().reload();
+    ASSERT_TRUE(rejected.failed());
+    EXPECT_EQ(rejected.getErr().code, Err::VALIDATION_ERR.code);
+    EXPECT_EQ(config.get(guard)->get_port(), 1000);
+
+    port = 2000;
+    ASSERT_FALSE(config.manager().reload().failed());
+    EXPECT_EQ(config.get(guard)->get_port(), 2000);
+    ASSERT_FALSE(config.manager().rollback().failed());
+    EXPECT_EQ(config.get(guard)->get_port(), 1000);
+
+    // 后面的校验器拒绝时，已解析的 Schema 不会被发布
+    config.manager().addValidator([](const ConfigSnapshot &snapshot) {
+        if (snapshot.getInt32("server.port") == 3000) {
+            throw std::invalid_argument("3000 is reserved");
+        }
+    });
+    port = 3000;
+    ASSERT_TRUE(config.manager().reload().failed());
+    EXPECT_EQ(config.get(guard)->get_port(), 1000);
+    port = 4000;
+    ASSERT_FALSE(config.manager().reload().failed());
+    EXPECT_EQ(config.get(guard)->get_port(), 4000);
+    ASSERT_FALSE(config.manager().rollback().failed());
+    EXPECT_EQ(config.get(guard)->get_port(), 1000);
+
+    // 监听器里再次 reload 时，Schema 仍按发布顺序切换
+    bool nested = false;
+    config.manager().addListener([&](const ConfigSnapshot &snapshot, const vector<ConfigChange> &) {
+        if (snapshot.getInt32("server.port") == 5000 && !nested) {
+            nested = true;
+            port = 6000;
+            EXPECT_FALSE(config.manager().reload().failed());
+        }
+    });
+    port = 5000;
+    ASSERT_FALSE(config.manager().reload().failed());
+    EXPECT_EQ(config.get(guard)->get_port(), 6000);
+    ASSERT_FALSE(config.manager().rollback().failed());
+    EXPECT_EQ(config.get(guard)->get_port(), 5000);
+}
+
+TEST(ConfigSchemaTest, Benchmark) {
+    int32_t port = 8080;
+    TypedConfig<TestConfig> config("memory", [&port](const string &) {
+        CfgEntries entries;
+        entries.emplace("server.port", cfg<Int32Cfg>(port));
+        for (int32_t i = 0; i < 64; i++) {
+            entries.emplace("key" + std::to_string(i), cfg<Int32Cfg>(i));
+        }
+        return Ret<CfgEntries>::with(entries);
+    });
+    ASSERT_FALSE(config.manager().reload().failed());
+
+    constexpr int32_t N = 2000000;
+    const string key = "server.port";
+    int64_t sum = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int32_t i = 0; i < N; i++) {
+        epoch::Guard guard;
+        sum += config.manager().snapshot(guard)->getInt32(key);
+    }
+    auto mapNs = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+    start = std::chrono::steady_clock::now();
+    for (int32_t i = 0; i < N; i++) {
+        epoch::Guard guard;
+        sum += config.get(guard)->get_port();
+    }
+    auto typedNs = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "按 key 查找: " << static_cast<double>(mapNs) / N << " ns/次" << std::endl;
+    std::cout << "类型化成员读取: " << static_cast<double>(typedNs) / N << " ns/次 (sum=" << sum << ")" << std::endl;
+}
@@ -0,0 +1,286 @@
+#include "gtest/gtest.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "config/Config.h"
+#include "runtime/EventLoop.h"
+#include "util/Locked.hpp"
+
+using namespace rhino;
+using namespace std;
+
+namespace fs = std::filesystem;
+
+namespace {
+
+// 先写临时文件再 rename，和编辑器/配置下发的行为一致，读者不会看到写了一半的文件
+void writeConfig(const fs::path &path, const string &content) {
+    const fs::path tmp = path.string() + ".tmp";
+    std::ofstream(tmp) << content;
+    fs::rename(tmp, path);
+}
+
+fs::path configDir() {
+    fs::path dir = fs::temp_directory_path() / "rhino-config-test";
+    fs::create_directories(dir);
+    return dir;
+}
+
+} // namespace
+
+TEST(ConfigTest, LoadTypedEntries) {
+    const fs::path path = configDir() / "load.toml";
+    writeConfig(path, "name = \"rhino\"\n"
+                      "threads = 4\n"
+                      "verbose = true\n"
+                      "ratio = 0.5\n"
+                      "[server]\n"
+                      "port = 8080\n");
+    ConfigManager config(path.string());
+    epoch::Guard guard;
+    EXPECT_EQ(config.snapshot(guard), nullptr);
+
+    auto ret = config.reload();
+    ASSERT_FALSE(ret.failed()) << ret.getErr().msg;
+    EXPECT_EQ(ret.value().size(), 5U);
+    EXPECT_EQ(config.version(), 1U);
+
+    const ConfigSnapshot *snap = config.snapshot(guard);
+    ASSERT_NE(snap, nullptr);
+    EXPECT_EQ(snap->getString("name"), "rhino");
+    EXPECT_EQ(snap->getInt32("threads"), 4);
+    EXPECT_TRUE(snap->getBool("verbose"));
+    EXPECT_DOUBLE_EQ(snap->getDouble("ratio"), 0.5);
+    EXPECT_EQ(snap->getInt32("server.port"), 8080);
+    ASSERT_NE(snap->get<Int32Cfg>("server.port"), nullptr);
+    EXPECT_EQ(snap->get<Int32Cfg>("server.port")->type, "int32");
+    // 类型不符和不存在都返回默认值
+    EXPECT_EQ(snap->get<StringCfg>("threads"), nullptr);
+    EXPECT_EQ(snap->getInt32("missing", -1), -1);
+    fs::remove(path);
+}
+
+TEST(ConfigTest, ValidationFailureKeepsPreviousSnapshot) {
+    const fs::path path = configDir() / "validate.toml";
+    writeConfig(path, "threads = 4\nname = \"a\"\n");
+    ConfigManager config(path.string());
+    config.addValidator([](const ConfigSnapshot &s) {
+        if (s.getInt32("threads") <= 0) {
+            throw std::invalid_argument("threads must be positive");
+        }
+    });
+    vector<ConfigChange> seen;
+    config.addListener([&seen](const ConfigSnapshot &, const vector<ConfigChange> &changes) { seen = changes; });
+    ASSERT_FALSE(config.reload().failed());
+    // 只有一个快照时无法回滚
+    EXPECT_TRUE(config.rollback().failed());
+
+    writeConfig(path, "threads = 0\nname = \"a\"\n");
+    auto rejected = config.reload();
+    ASSERT_TRUE(rejected.failed());
+    EXPECT_EQ(rejected.getErr().code, Err::VALIDATION_ERR.code);
+    EXPECT_EQ(rejected.getErr().msg, "threads must be positive");
+    EXPECT_EQ(config.version(), 1U);
+
+    writeConfig(path, "threads = [\n");
+    auto malformed = config.reload();
+    ASSERT_TRUE(malformed.failed());
+    EXPECT_EQ(malformed.getErr().code, Err::FORMAT_ERR.code);
+
+    writeConfig(path, "threads = 8\nlevel = \"debug\"\n");
+    auto accepted = config.reload();
+    ASSERT_FALSE(accepted.failed());
+    EXPECT_EQ(config.version(), 2U);
+    ASSERT_EQ(accepted.value().size(), 3U);
+    EXPECT_EQ(accepted.value()[0].key, "level");
+    EXPECT_EQ(accepted.value()[0].before, "");
+    EXPECT_EQ(accepted.value()[0].after, "\"debug\"");
+    EXPECT_EQ(accepted.value()[1].key, "name");
+    EXPECT_EQ(accepted.value()[1].after, "");
+    EXPECT_EQ(accepted.value()[2].key, "threads");
+    EXPECT_EQ(accepted.value()[2].before, "4");
+    EXPECT_EQ(accepted.value()[2].after, "8");
+    EXPECT_EQ(seen.size(), 3U);
+
+    ASSERT_FALSE(config.rollback().failed());
+    EXPECT_EQ(config.version(), 1U);
+    epoch::Guard guard;
+    EXPECT_EQ(config.snapshot(guard)->getInt32("threads"), 4);
+    EXPECT_EQ(seen.size(), 3U);
+    fs::remove(path);
+}
+
+TEST(ConfigTest, ListenersMayReloadAndRollback) {
+    int32_t threads = 1;
+    ConfigManager config("memory", [&threads](const string &) {
+        Int32Cfg cfg;
+        cfg.val = threads;
+        return Ret<CfgEntries>::with(CfgEntries{{"threads", CfgValue(cfg)}});
+    });
+    // 监听器在写锁外调用，在里面 reload/rollback 不会死锁；嵌套产生的通知排在当前通知之后送达
+    vector<pair<int32_t, uint64_t>> seen;
+    config.addListener([&](const ConfigSnapshot &snapshot, const vector<ConfigChange> &) {
+        seen.emplace_back(0, snapshot.version());
+        if (snapshot.version() == 1 && seen.size() == 1) {
+            threads = 2;
+            EXPECT_FALSE(config.reload().failed());
+        } else if (snapshot.version() == 2) {
+            EXPECT_FALSE(config.rollback().failed());
+        }
+    });
+    config.addListener([&](const ConfigSnapshot &snapshot, const vector<ConfigChange> &) {
+        seen.emplace_back(1, snapshot.version());
+        EXPECT_EQ(snapshot.getInt32("threads"), static_cast<int32_t>(snapshot.version()));
+    });
+    ASSERT_FALSE(config.reload().failed());
+    const vector<pair<int32_t, uint64_t>> expected = {{0, 1}, {1, 1}, {0, 2}, {1, 2}, {0, 1}, {1, 1}};
+    EXPECT_EQ(seen, expected);
+    EXPECT_EQ(config.version(), 1U);
+}
+
+TEST(ConfigTest, DoubleChangesAreDetected) {
+    auto number = [](double v) {
+        DoubleCfg cfg;
+        cfg.val = v;
+        return CfgValue(cfg);
+    };
+    // 第 7 位有效数字的变化，默认 6 位精度渲染时两者相同
+    CfgEntries before{{"ratio", number(0.1234567)}, {"scale", number(2.0)}};
+    CfgEntries after{{"ratio", number(0.1234568)}, {"scale", number(2.0)}};
+    auto changes = diffConfig(before, after);
+    ASSERT_EQ(changes.size(), 1U);
+    EXPECT_EQ(changes[0].key, "ratio");
+    EXPECT_EQ(changes[0].before, "0.1234567");
+    EXPECT_EQ(changes[0].after, "0.1234568");
+    EXPECT_TRUE(diffConfig(before, before).empty());
+
+    // 渲染结果可还原，整数值仍是 toml 浮点字面量
+    EXPECT_EQ(renderCfg(number(0.123456789)), "0.123456789");
+    EXPECT_EQ(renderCfg(number(2.0)), "2.0");
+    EXPECT_EQ(renderCfg(number(-1e300)), "-1e+300");
+}
+
+TEST(ConfigTest, ReloadOnFileChange) {
+    const fs::path path = configDir() / "watch.toml";
+    writeConfig(path, "threads = 1\n");
+    ConfigManager config(path.string());
+    ASSERT_FALSE(config.reload().failed());
+
+    EventLoop loop;
+    ASSERT_FALSE(config.watch(loop).failed());
+    std::thread t([&loop] { loop.run(); });
+
+    auto waitVersion = [&config](uint64_t version) {
+        for (int32_t i = 0; i < 500 && config.version() < version; i++) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        return config.version() >= version;
+    };
+    // 目录中其他文件的变化不触发 reload
+    std::ofstream(configDir() / "other.toml") << "x = 1\n";
+    writeConfig(path, "threads = 2\n");
+    ASSERT_TRUE(waitVersion(2));
+    {
+        epoch::Guard guard;
+        EXPECT_EQ(config.snapshot(guard)->getInt32("threads"), 2);
+    }
+    // 原地写入同样会触发
+    std::ofstream(path) << "threads = 3\n";
+    ASSERT_TRUE(waitVersion(3));
+
+    ASSERT_FALSE(loop.defer([&config, &loop] {
+                         config.unwatch();
+                         loop.stop();
+                     })
+                     .failed());
+    t.join();
+    fs::remove(path);
+    fs::remove(configDir() / "other.toml");
+}
+
+TEST(ConfigTest, ConcurrentReadersSeeConsistentSnapshots) {
+    // 内存中的 loader：每次 reload 生成 a == b == 版本号 的配置
+    std::atomic<int32_t> generation{0};
+    ConfigManager config("memory", [&generation](const string &) {
+        CfgEntries entries;
+        Int32Cfg v;
+        v.val = ++generation;
+        entries.emplace("a", v);
+        entries.emplace("b", v);
+        return Ret<CfgEntries>::with(entries);
+    });
+    ASSERT_FALSE(config.reload().failed());
+
+    std::atomic<bool> stop{false};
+    std::atomic<uint64_t> reads{0};
+    vector<std::thread> readers;
+    for (int32_t t = 0; t < 3; t++) {
+        readers.emplace_back([&] {
+            uint64_t n = 0;
+            int32_t last = 0;
+            while (!stop.load(std::memory_order_relaxed)) {
+                epoch::Guard guard;
+                const ConfigSnapshot *snap = config.snapshot(guard);
+                const int32_t a = snap->getInt32("a");
+                EXPECT_EQ(a, snap->getInt32("b"));
+                // 版本只会前进
+                EXPECT_GE(a, last);
+                last = a;
+                n++;
+            }
+            reads += n;
+        });
+    }
+    for (int32_t i = 0; i < 2000; i++) {
+        ASSERT_FALSE(config.reload().failed());
+    }
+    stop = true;
+    for (auto &r : readers) {
+        r.join();
+    }
+    EXPECT_EQ(config.version(), 2001U);
+    EXPECT_GT(reads.load(), 0U);
+    epoch::Domain::global().reclaim();
+}
+
+TEST(ConfigTest, Benchmark) {
+    CfgEntries entries;
+    for (int32_t i = 0; i < 64; i++) {
+        Int32Cfg v;
+        v.val = i;
+        entries.emplace("key" + std::to_string(i), v);
+    }
+    ConfigManager config("memory", [&entries](const string &) { return Ret<CfgEntries>::with(entries); });
+    ASSERT_FALSE(config.reload().failed());
+    Locked<CfgEntries> locked;
+    locked([&entries](CfgEntries &m) { m = entries; });
+
+    constexpr int32_t N = 2000000;
+    const string key = "key42";
+    int64_t sum = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int32_t i = 0; i < N; i++) {
+        epoch::Guard guard;
+        sum += config.snapshot(guard)->getInt32(key);
+    }
+    auto snapshotNs = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+    start = std::chrono::steady_clock::now();
+    for (int32_t i = 0; i < N; i++) {
+        sum += locked([&key](CfgEntries &m) { return std::get<Int32Cfg>(m.at(key)).val; });
+    }
+    auto lockedNs = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "快照读取: " << static_cast<double>(snapshotNs) / N << " ns/次" << std::endl;
+    std::cout << "互斥锁读取: " << static_cast<double>(lockedNs) / N << " ns/次 (sum=" << sum << ")" << std::endl;
+}
@@ -0,0 +1,267 @@
+#include "gtest/gtest.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "util/Epoch.hpp"
+
+using namespace rhino;
+using namespace std;
+
+namespace {
+
+// 记录存活对象数，析构时把内容改写成毒值，读者读到毒值说明读到了已释放的节点
+struct Tracked {
+    static atomic<int64_t> live;
+    uint64_t value;
+    uint64_t check;
+    Tracked *next = nullptr;
+
+    explicit Tracked(uint64_t v) : value(v), check(~v) { live++; }
+
+    ~Tracked() {
+        value = 0xDEADBEEF;
+        check = 0;
+        live--;
+    }
+
+    bool intact() const { return check == ~value; }
+};
+
+atomic<int64_t> Tracked::live{0};
+
+} // namespace
+
+TEST(EpochTest, RetireWithoutReaders) {
+    {
+        epoch::Domain domain;
+        for (int32_t i = 0; i < 1000; i++) {
+            domain.retire(new Tracked(i));
+        }
+        // 没有读者时推进两次 epoch 就能回收全部节点
+        domain.reclaim();
+        domain.reclaim();
+        EXPECT_EQ(domain.pendingApprox(), 0U);
+        EXPECT_EQ(Tracked::live.load(), 0);
+        EXPECT_GE(domain.currentEpoch(), 3U);
+
+        // 回收剩余的节点交给析构函数
+        domain.retire(new Tracked(7));
+        EXPECT_EQ(Tracked::live.load(), 1);
+    }
+    EXPECT_EQ(Tracked::live.load(), 0);
+}
+
+TEST(EpochTest, StalledReaderDoesNotBlockUnprotectedNodes) {
+    epoch::Domain domain;
+    std::atomic<Tracked *> shared{new Tracked(1)};
+    std::atomic<int32_t> stage{0};
+
+    // 读者进入临界区、保护当前节点后一直不退出，epoch 无法推进
+    std::thread reader([&] {
+        epoch::Guard guard(domain);
+        Tracked *held = guard.protect(shared);
+        stage = 1;
+        while (stage.load() != 2) {
+            std::this_thread::yield();
+        }
+        EXPECT_TRUE(held->intact());
+        EXPECT_EQ(held->value, 1U);
+    });
+    while (stage.load() != 1) {
+        std::this_thread::yield();
+    }
+
+    const uint64_t stuck = domain.currentEpoch();
+    Tracked *first = shared.exchange(new Tracked(2));
+    domain.retire(first);
+    // 持续替换并退休，积压受 LIMBO_LIMIT 约束，不会因为读者卡住而无限增长
+    for (uint64_t i = 3; i < 100000; i++) {
+        domain.retire(shared.exchange(new Tracked(i)));
+        ASSERT_LE(domain.pendingApprox(), epoch::Domain::LIMBO_LIMIT + epoch::Domain::RETIRE_BATCH);
+    }
+    EXPECT_LE(domain.currentEpoch(), stuck + 1);
+    domain.reclaim();
+    // 只剩被读者保护的第一个节点
+    EXPECT_EQ(domain.pendingApprox(), 1U);
+    EXPECT_EQ(Tracked::live.load(), 2);
+
+    stage = 2;
+    reader.join();
+    domain.reclaim();
+    domain.reclaim();
+    EXPECT_EQ(domain.pendingApprox(), 0U);
+    delete shared.load();
+    EXPECT_EQ(Tracked::live.load(), 0);
+}
+
+TEST(EpochTest, NestedGuardsAndThreadExit) {
+    epoch::Domain domain;
+    std::atomic<Tracked *> shared{new Tracked(1)};
+    std::thread worker([&] {
+        epoch::Guard outer(domain);
+        {
+            epoch::Guard inner(domain);
+            EXPECT_TRUE(inner.protect(shared, 1)->intact());
+        }
+        // 内层 Guard 退出不影响外层
+        EXPECT_TRUE(outer.protect(shared)->intact());
+        // 退出线程时未回收的节点移交给 Domain
+        domain.retire(new Tracked(5));
+    });
+    worker.join();
+    EXPECT_EQ(Tracked::live.load(), 2);
+    domain.reclaim();
+    domain.reclaim();
+    EXPECT_EQ(Tracked::live.load(), 1);
+    delete shared.load();
+}
+
+TEST(EpochTest, NestedGuardsDoNotOverwriteOuterHazards) {
+    epoch::Domain domain;
+    std::atomic<Tracked *> a{new Tracked(1)};
+    std::atomic<Tracked *> b{new Tracked(2)};
+    {
+        epoch::Guard outer(domain);
+        Tracked *held = outer.protect(a);
+        {
+            // 内层用同样的槽号，占用的是外层之后的槽
+            epoch::Guard inner(domain);
+            EXPECT_TRUE(inner.protect(b)->intact());
+        }
+        Tracked *removed = a.exchange(nullptr);
+        domain.retire(removed);
+        // 本线程停在临界区里，epoch 推不动，只能靠 hazard 扫描：外层的保护还在，节点不能被释放
+        domain.reclaim();
+        domain.reclaim();
+        EXPECT_EQ(Tracked::live.load(), 2);
+        EXPECT_TRUE(held->intact());
+    }
+    domain.reclaim();
+    domain.reclaim();
+    EXPECT_EQ(Tracked::live.load(), 1);
+    delete b.load();
+}
+
+// Treiber 栈：pop 时读取 top->next 需要 top 在此期间不被释放，也不会因为地址复用而出现 ABA
+class Stack {
+    epoch::Domain &domain;
+    std::atomic<Tracked *> top{nullptr};
+
+  public:
+    explicit Stack(epoch::Domain &domain) : domain(domain) {}
+
+    ~Stack() {
+        for (Tracked *n = top.load(); n != nullptr;) {
+            Tracked *next = n->next;
+            delete n;
+            n = next;
+        }
+    }
+
+    void push(uint64_t v) {
+        auto node = new Tracked(v);
+        node->next = top.load(std::memory_order_relaxed);
+        while (!top.compare_exchange_weak(node->next, node, std::memory_order_release, std::memory_order_relaxed)) {
+        }
+    }
+
+    bool pop(uint64_t &out) {
+        Tracked *node = nullptr;
+        {
+            epoch::Guard guard(domain);
+            while (true) {
+                node = guard.protect(top);
+                if (node == nullptr) {
+                    return false;
+                }
+                EXPECT_TRUE(node->intact());
+                Tracked *next = node->next;
+                if (top.compare_exchange_strong(node, next, std::memory_order_acq_rel)) {
+                    break;
+                }
+            }
+            out = node->value;
+        }
+        domain.retire(node);
+        return true;
+    }
+};
+
+TEST(EpochTest, StressTreiberStackAndSnapshots) {
+    epoch::Domain domain;
+    constexpr int32_t THREADS = 4;
+    constexpr uint64_t OPS = 50000;
+    {
+        Stack stack(domain);
+        std::atomic<Tracked *> snapshot{new Tracked(0)};
+        std::atomic<uint64_t> popped{0};
+        std::atomic<uint64_t> pushedSum{0};
+        std::atomic<uint64_t> poppedSum{0};
+        std::vector<std::thread> threads;
+        for (int32_t t = 0; t < THREADS; t++) {
+            threads.emplace_back([&, t] {
+                for (uint64_t i = 0; i < OPS; i++) {
+                    const uint64_t v = static_cast<uint64_t>(t) * OPS + i + 1;
+                    stack.push(v);
+                    pushedSum += v;
+                    uint64_t out = 0;
+                    if (stack.pop(out)) {
+                        poppedSum += out;
+                        popped++;
+                    }
+                    // 配置快照式的读多写少：每 16 次读替换一次
+                    if (i % 16 == 0) {
+                        domain.retire(snapshot.exchange(new Tracked(v)));
+                    } else {
+                        epoch::Guard guard(domain);
+                        EXPECT_TRUE(guard.protect(snapshot)->intact());
+                    }
+                }
+            });
+        }
+        for (auto &th : threads) {
+            th.join();
+        }
+        uint64_t out = 0;
+        while (stack.pop(out)) {
+            poppedSum += out;
+            popped++;
+        }
+        EXPECT_EQ(popped.load(), THREADS * OPS);
+        EXPECT_EQ(poppedSum.load(), pushedSum.load());
+        domain.reclaim();
+        domain.reclaim();
+        EXPECT_EQ(domain.pendingApprox(), 0U);
+        delete snapshot.load();
+    }
+    EXPECT_EQ(Tracked::live.load(), 0);
+}
+
+TEST(EpochTest, Benchmark) {
+    epoch::Domain domain;
+    std::atomic<Tracked *> shared{new Tracked(1)};
+    constexpr int32_t N = 10000000;
+    auto start = std::chrono::steady_clock::now();
+    uint64_t sum = 0;
+    for (int32_t i = 0; i < N; i++) {
+        epoch::Guard guard(domain);
+        sum += guard.protect(shared)->value;
+    }
+    auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "Guard + protect 单次读: " << static_cast<double>(ns) / N << " ns (sum=" << sum << ")" << std::endl;
+
+    start = std::chrono::steady_clock::now();
+    for (int32_t i = 0; i < N / 10; i++) {
+        domain.retire(shared.exchange(new Tracked(i)));
+    }
+    domain.reclaim();
+    ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "替换 + retire 单次: " << static_cast<double>(ns) / (N / 10) << " ns" << std::endl;
+    delete shared.load();
+}
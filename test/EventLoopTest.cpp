@@ -0,0 +1,206 @@
+#include "gtest/gtest.h"
+
+#include <atomic>
+#include <chrono>
+#include <fcntl.h>
+#include <iostream>
+#include <stdexcept>
+#include <sys/epoll.h>
+#include <sys/resource.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+#include "runtime/EventLoop.h"
+#include "util/Metrics.hpp"
+
+using namespace rhino;
+using namespace std;
+using namespace std::chrono;
+
+// 边缘触发：一直读到 EAGAIN
+struct PipeReader : public IoHandler {
+    int32_t fd;
+    size_t bytes = 0;
+    int32_t wakeups = 0;
+
+    explicit PipeReader(int32_t fd) : fd(fd) {}
+
+    void onEvents(uint32_t) noexcept override {
+        wakeups++;
+        char buf[64];
+        ssize_t n;
+        while ((n = read(fd, buf, sizeof(buf))) > 0) {
+            bytes += static_cast<size_t>(n);
+        }
+    }
+};
+
+static void makePipe(int32_t fds[2]) {
+    ASSERT_EQ(pipe2(fds, O_NONBLOCK | O_CLOEXEC), 0);
+}
+
+TEST(EventLoopTest, FdEventsEdgeTriggered) {
+    EventLoop loop;
+    int32_t fds[2];
+    makePipe(fds);
+    PipeReader reader(fds[0]);
+    ASSERT_FALSE(loop.watch(fds[0], EPOLLIN, reader).failed());
+
+    EXPECT_EQ(loop.runOnce(), 0U);
+    ASSERT_EQ(write(fds[1], "hello", 5), 5);
+    ASSERT_EQ(write(fds[1], "world", 5), 5);
+    EXPECT_EQ(loop.runOnce(), 1U);
+    EXPECT_EQ(reader.bytes, 10U);
+    // 数据已经读完，边缘触发不会再次通知
+    EXPECT_EQ(loop.runOnce(), 0U);
+    EXPECT_EQ(reader.wakeups, 1);
+
+    ASSERT_FALSE(loop.unwatch(fds[0], reader).failed());
+    ASSERT_EQ(write(fds[1], "x", 1), 1);
+    EXPECT_EQ(loop.runOnce(), 0U);
+
+    // 重复 unwatch 返回系统错误
+    auto ret = loop.unwatch(fds[0], reader);
+    EXPECT_TRUE(ret.failed());
+    EXPECT_EQ(ret.getErr().code, Err::IO_ERR.code);
+    EXPECT_FALSE(ret.getErr().msg.empty());
+    close(fds[0]);
+    close(fds[1]);
+}
+
+TEST(EventLoopTest, UnwatchDuringDispatch) {
+    // 第一个 handler 的回调里摘掉并销毁第二个 handler，同一轮里第二个的事件不能再分发
+    EventLoop loop;
+    int32_t a[2], b[2];
+    makePipe(a);
+    makePipe(b);
+    auto second = std::make_unique<PipeReader>(b[0]);
+    struct Killer : public IoHandler {
+        EventLoop *loop;
+        std::unique_ptr<PipeReader> *victim;
+        int32_t fired = 0;
+        void onEvents(uint32_t) noexcept override {
+            fired++;
+            if (*victim) {
+                EXPECT_FALSE(loop->unwatch((*victim)->fd, **victim).failed());
+                victim->reset();
+            }
+        }
+    } first;
+    first.loop = &loop;
+    first.victim = &second;
+    ASSERT_FALSE(loop.watch(a[0], EPOLLIN, first).failed());
+    ASSERT_FALSE(loop.watch(b[0], EPOLLIN, *second).failed());
+    ASSERT_EQ(write(b[1], "1", 1), 1);
+    ASSERT_EQ(write(a[1], "1", 1), 1);
+    // 两个事件的先后顺序由内核决定，先到 second 时它正常读数据，不影响断言
+    loop.runOnce();
+    loop.runOnce();
+    EXPECT_EQ(first.fired, 1);
+    EXPECT_EQ(second, nullptr);
+    for (int32_t fd : {a[0], a[1], b[0], b[1]}) {
+        close(fd);
+    }
+}
+
+TEST(EventLoopTest, DeferAndTimersAcrossThreads) {
+    EventLoop loop;
+    std::thread thread([&loop] { loop.run(); });
+
+    // 其他线程投递的任务在事件循环线程上执行
+    atomic<int32_t> ran{0};
+    atomic<bool> onLoopThread{true};
+    for (int32_t i = 0; i < 1000; i++) {
+        while (loop.defer([&] {
+                       onLoopThread = onLoopThread && loop.inLoopThread() && EventLoop::current() == &loop;
+                       ran++;
+                   })
+                   .failed()) {
+            std::this_thread::yield();
+        }
+    }
+    while (ran < 1000) {
+        std::this_thread::yield();
+    }
+    EXPECT_TRUE(onLoopThread.load());
+
+    // 定时器只能在事件循环线程上操作，通过 defer 调度
+    atomic<int64_t> firedAfterMs{-1};
+    auto start = steady_clock::now();
+    FunctionTimer timer([&](TimerNode &) {
+        firedAfterMs = duration_cast<milliseconds>(steady_clock::now() - start).count();
+    });
+    ASSERT_FALSE(loop.defer([&] { loop.scheduleAfter(timer, milliseconds(20)); }).failed());
+    while (firedAfterMs < 0) {
+        std::this_thread::sleep_for(milliseconds(1));
+    }
+    EXPECT_GE(firedAfterMs.load(), 19);
+    EXPECT_LE(firedAfterMs.load(), 200);
+
+    loop.stop();
+    thread.join();
+    EXPECT_TRUE(loop.defer([] {}).failed());
+    EXPECT_GT(loop.iterationWork().count(), 0U);
+    EXPECT_NE(MetricsRegistry::global().dump(loop.name()).find(loop.name() + ".iteration_ns"), std::string::npos);
+
+    // 未命名的事件循环各自得到不同的指标前缀
+    EventLoop other;
+    EXPECT_NE(other.name(), loop.name());
+    EXPECT_NE(MetricsRegistry::global().dump(other.name()).find(other.name() + ".iteration_ns"), std::string::npos);
+}
+
+// 测量另一个线程投递任务到任务在事件循环上执行的延迟
+static void crossThreadLatency(LoopMode mode, const char *label) {
+    EventLoopOptions options;
+    options.mode = mode;
+    options.name = label;
+    EventLoop loop(options);
+    std::thread thread([&loop] { loop.run(); });
+
+    constexpr int32_t ROUNDS = 20000;
+    Histogram latency;
+    atomic<uint64_t> doneAt{0};
+    for (int32_t i = 0; i < ROUNDS; i++) {
+        doneAt.store(0, std::memory_order_relaxed);
+        const uint64_t begin = rdtsc();
+        ASSERT_FALSE(loop.defer([&doneAt] { doneAt.store(rdtsc(), std::memory_order_release); }).failed());
+        uint64_t end;
+        while ((end = doneAt.load(std::memory_order_acquire)) == 0) {
+            std::this_thread::yield();
+        }
+        latency.record(calc_time_nano(begin, end));
+    }
+    loop.stop();
+    thread.join();
+    std::cout << label << ": 跨线程投递延迟 p50=" << latency.percentile(0.5) << "ns p99=" << latency.percentile(0.99)
+              << "ns max=" << latency.max() << "ns" << std::endl;
+    std::cout << MetricsRegistry::global().dump(label);
+}
+
+TEST(EventLoopTest, InitFailureClosesFds) {
+    // 只给 epoll 留一个 fd，让 eventfd 失败
+    const int32_t lowest = open("/dev/null", O_RDONLY | O_CLOEXEC);
+    ASSERT_GE(lowest, 0);
+    close(lowest);
+    rlimit saved{};
+    ASSERT_EQ(getrlimit(RLIMIT_NOFILE, &saved), 0);
+    rlimit limited = saved;
+    limited.rlim_cur = static_cast<rlim_t>(lowest) + 1;
+    ASSERT_EQ(setrlimit(RLIMIT_NOFILE, &limited), 0);
+    EXPECT_THROW(EventLoop(), std::runtime_error);
+    ASSERT_EQ(setrlimit(RLIMIT_NOFILE, &saved), 0);
+
+    // epoll fd 已经关闭，最小的空闲 fd 没有变
+    const int32_t after = open("/dev/null", O_RDONLY | O_CLOEXEC);
+    EXPECT_EQ(after, lowest);
+    close(after);
+}
+
+TEST(EventLoopTest, Benchmark) {
+    crossThreadLatency(LoopMode::RUN_TO_COMPLETION, "loop-blocking");
+    // 忙轮询线程会占满一个核，单核机器上和投递线程互相抢占，测出来的没有意义
+    if (std::thread::hardware_concurrency() >= 2) {
+        crossThreadLatency(LoopMode::BUSY_POLL, "loop-busy-poll");
+    }
+}
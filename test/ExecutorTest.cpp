@@ -0,0 +1,288 @@
+#include "gtest/gtest.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <iostream>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <vector>
+
+#include "runtime/Executor.h"
+
+using namespace rhino;
+using namespace std;
+using namespace std::chrono;
+
+static ExecutorOptions withThreads(size_t threads) {
+    ExecutorOptions options;
+    options.threads = threads;
+    return options;
+}
+
+TEST(ExecutorTest, SubmitPropagatesRet) {
+    Executor executor(withThreads(2));
+
+    auto value = executor.submit([] { return 42; });
+    auto ret = executor.submit([] { return Ret<std::string>::with("ok"); });
+    auto failed = executor.submit([] { return Ret<int>::with(EGrp::INTERNAL, Err::FORMAT_ERR); });
+    atomic<int> sideEffect{0};
+    auto none = executor.submit([&sideEffect] { sideEffect = 1; });
+
+    EXPECT_EQ(value.get().value(), 42);
+    EXPECT_EQ(ret.get().value(), "ok");
+    auto f = failed.get();
+    EXPECT_TRUE(f.failed());
+    EXPECT_EQ(f.getErr().code, Err::FORMAT_ERR.code);
+    EXPECT_EQ(f.getEGrp().code, EGrp::INTERNAL.code);
+    EXPECT_FALSE(none.get().failed());
+    EXPECT_EQ(sideEffect.load(), 1);
+}
+
+static int64_t fib(Executor &executor, int n) {
+    if (n < 12) {
+        return n < 2 ? n : fib(executor, n - 1) + fib(executor, n - 2);
+    }
+    // 工作线程内部提交并等待，等待期间工作线程会继续执行其他任务，不会死锁
+    auto left = executor.submit([&executor, n] { return fib(executor, n - 1); });
+    auto right = fib(executor, n - 2);
+    return left.get().value() + right;
+}
+
+TEST(ExecutorTest, NestedForkJoin) {
+    Executor executor(withThreads(4));
+    auto ret = executor.submit([&executor] { return fib(executor, 24); });
+    EXPECT_EQ(ret.get().value(), 46368);
+    EXPECT_EQ(executor.workerIndex(), -1);
+}
+
+TEST(ExecutorTest, QueueFullAndShutdown) {
+    ExecutorOptions options;
+    options.threads = 1;
+    options.injectionCapacity = 2;
+    Executor executor(options);
+
+    // 卡住唯一的工作线程，然后把全局队列塞满
+    std::promise<void> gate;
+    auto gateFuture = gate.get_future().share();
+    atomic<bool> started{false};
+    auto blocker = executor.submit([gateFuture, &started] {
+        started = true;
+        gateFuture.wait();
+    });
+    while (!started) {
+        std::this_thread::yield();
+    }
+    vector<Future<int>> futures;
+    bool sawFull = false;
+    for (int i = 0; i < 8; i++) {
+        futures.push_back(executor.submit([i] { return i; }));
+        if (futures.back().ready() && futures.back().get().failed()) {
+            sawFull = true;
+            futures.pop_back();
+        }
+    }
+    EXPECT_TRUE(sawFull);
+    gate.set_value();
+    for (auto &f : futures) {
+        EXPECT_FALSE(f.get().failed());
+    }
+    executor.shutdown();
+    auto afterStop = executor.submit([] { return 1; });
+    EXPECT_EQ(afterStop.get().getErr().code, Err::QUEUE_FULL.code);
+}
+
+TEST(ExecutorTest, SubmitDuringShutdownCompletes) {
+    for (int32_t round = 0; round < 200; round++) {
+        Executor executor(withThreads(2));
+        constexpr int32_t SUBMITTERS = 4;
+        vector<vector<Future<int32_t>>> futures(SUBMITTERS);
+        atomic<int32_t> ready{0};
+        vector<thread> submitters;
+        for (int32_t t = 0; t < SUBMITTERS; t++) {
+            submitters.emplace_back([&, t] {
+                ready++;
+                for (int32_t i = 0; i < 2000; i++) {
+                    futures[t].push_back(executor.submit([i] { return i; }));
+                }
+            });
+        }
+        while (ready.load() < SUBMITTERS) {
+            std::this_thread::yield();
+        }
+        executor.shutdown();
+        for (auto &s : submitters) {
+            s.join();
+        }
+        // 关闭之前入队的执行完，之后的立即失败，不会有永远不完成的 Future
+        for (auto &list : futures) {
+            for (auto &f : list) {
+                ASSERT_TRUE(f.ready());
+                auto r = f.get();
+                if (r.failed()) {
+                    EXPECT_EQ(r.errCode(), Err::QUEUE_FULL.code);
+                }
+            }
+        }
+    }
+}
+
+TEST(ExecutorTest, ExternalBurstWakesSeveralWorkers) {
+    constexpr size_t THREADS = 4;
+    Executor executor(withThreads(THREADS));
+    // 让工作线程都挂起
+    std::this_thread::sleep_for(milliseconds(50));
+    std::mutex mtx;
+    std::set<int32_t> used;
+    vector<Future<void *>> futures;
+    for (int32_t i = 0; i < 32; i++) {
+        futures.push_back(executor.submit([&] {
+            {
+                std::lock_guard<std::mutex> lock(mtx);
+                used.insert(executor.workerIndex());
+            }
+            std::this_thread::sleep_for(milliseconds(5));
+        }));
+    }
+    for (auto &f : futures) {
+        EXPECT_FALSE(f.get().failed());
+    }
+    // 自旋的线程找到任务后接力唤醒，不会全部落在一个线程上
+    EXPECT_GT(used.size(), 1U);
+}
+
+// 对照组：互斥锁 + 条件变量的普通线程池
+class MutexPool {
+    std::mutex mtx;
+    std::condition_variable cv;
+    std::deque<std::function<void()>> tasks;
+    bool stop = false;
+    vector<thread> workers;
+
+  public:
+    explicit MutexPool(size_t n) {
+        for (size_t i = 0; i < n; i++) {
+            workers.emplace_back([this] {
+                for (;;) {
+                    std::function<void()> task;
+                    {
+                        std::unique_lock<std::mutex> lock(mtx);
+                        cv.wait(lock, [this] { return stop || !tasks.empty(); });
+                        if (stop && tasks.empty()) {
+                            return;
+                        }
+                        task = std::move(tasks.front());
+                        tasks.pop_front();
+                    }
+                    task();
+                }
+            });
+        }
+    }
+
+    ~MutexPool() {
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            stop = true;
+        }
+        cv.notify_all();
+        for (auto &w : workers) {
+            w.join();
+        }
+    }
+
+    void post(std::function<void()> task) {
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            tasks.push_back(std::move(task));
+        }
+        cv.notify_one();
+    }
+};
+
+// 简单的计数栅栏，等待所有小任务完成
+struct Latch {
+    atomic<int64_t> remaining;
+    explicit Latch(int64_t n) : remaining(n) {}
+    void countDown() { remaining.fetch_sub(1, std::memory_order_acq_rel); }
+    void wait() {
+        while (remaining.load(std::memory_order_acquire) > 0) {
+            std::this_thread::yield();
+        }
+    }
+};
+
+TEST(ExecutorTest, Benchmark) {
+    const size_t threads = std::max(2U, std::thread::hardware_concurrency());
+    constexpr int64_t SMALL_TASKS = 500000;
+
+    {
+        Executor executor(withThreads(threads));
+        Latch latch(SMALL_TASKS);
+        auto start = high_resolution_clock::now();
+        for (int64_t i = 0; i < SMALL_TASKS; i++) {
+            executor.post([&latch] { latch.countDown(); });
+        }
+        latch.wait();
+        auto executorNs = duration_cast<nanoseconds>(high_resolution_clock::now() - start).count();
+
+        MutexPool pool(threads);
+        Latch poolLatch(SMALL_TASKS);
+        start = high_resolution_clock::now();
+        for (int64_t i = 0; i < SMALL_TASKS; i++) {
+            pool.post([&poolLatch] { poolLatch.countDown(); });
+        }
+        poolLatch.wait();
+        auto poolNs = duration_cast<nanoseconds>(high_resolution_clock::now() - start).count();
+        std::cout << "大量小任务（外部提交）: Executor " << executorNs / SMALL_TASKS
+                  << " ns/任务, 互斥锁线程池 " << poolNs / SMALL_TASKS << " ns/任务" << std::endl;
+    }
+
+    {
+        // fork/join：任务内部递归拆分，互斥锁线程池在等待子任务时会占住线程，只能改成外部一次性展开
+        Executor executor(withThreads(threads));
+        auto start = high_resolution_clock::now();
+        auto ret = executor.submit([&executor] { return fib(executor, 30); }).get();
+        auto executorNs = duration_cast<nanoseconds>(high_resolution_clock::now() - start).count();
+
+        MutexPool pool(threads);
+        // fib(30) 展开 8 层得到的叶子交给线程池，与 Executor 版本计算量相同
+        int64_t leaves = 0;
+        std::function<void(int, int)> countLeaves = [&](int n, int depth) {
+            if (depth == 0 || n < 2) {
+                leaves++;
+                return;
+            }
+            countLeaves(n - 1, depth - 1);
+            countLeaves(n - 2, depth - 1);
+        };
+        countLeaves(30, 8);
+        start = high_resolution_clock::now();
+        atomic<int64_t> sum{0};
+        Latch latch(leaves);
+        std::function<void(int, int)> expand = [&](int n, int depth) {
+            if (depth == 0 || n < 2) {
+                pool.post([&sum, &latch, n] {
+                    std::function<int64_t(int)> f = [&f](int k) -> int64_t {
+                        return k < 2 ? k : f(k - 1) + f(k - 2);
+                    };
+                    sum += f(n);
+                    latch.countDown();
+                });
+                return;
+            }
+            expand(n - 1, depth - 1);
+            expand(n - 2, depth - 1);
+        };
+        expand(30, 8);
+        latch.wait();
+        auto poolNs = duration_cast<nanoseconds>(high_resolution_clock::now() - start).count();
+        EXPECT_EQ(ret.value(), sum.load());
+        std::cout << "fork/join fib(30): Executor " << executorNs / 1000 << " us, 互斥锁线程池 "
+                  << poolNs / 1000 << " us" << std::endl;
+    }
+}
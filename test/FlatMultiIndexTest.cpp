@@ -0,0 +1,168 @@
+#include "gtest/gtest.h"
+
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "util/FlatMultiIndex.hpp"
+
+using namespace rhino;
+using namespace std;
+
+namespace {
+
+struct Order {
+    int32_t id;
+    std::string symbol;
+    int64_t price;
+
+    Order(int32_t i, std::string s, int64_t p) : id(i), symbol(std::move(s)), price(p) {}
+};
+
+using OrderBook = FlatMultiIndex<Order, HashedUnique<MemberKey<&Order::id>>, HashedUnique<MemberKey<&Order::symbol>>,
+                                 OrderedNonUnique<MemberKey<&Order::price>>>;
+
+} // namespace
+
+TEST(FlatMultiIndexTest, InsertFindErase) {
+    OrderBook book;
+    auto [a, inserted] = book.emplace(1, "AAPL", 100);
+    EXPECT_TRUE(inserted);
+    book.emplace(2, "MSFT", 300);
+    book.emplace(3, "GOOG", 100);
+
+    // 任一唯一索引冲突都不插入，返回已有元素
+    auto [dup, dupInserted] = book.emplace(4, "AAPL", 1);
+    EXPECT_FALSE(dupInserted);
+    EXPECT_EQ(dup, a);
+    EXPECT_EQ(book.size(), 3U);
+
+    EXPECT_EQ(book.find<0>(2)->symbol, "MSFT");
+    // 字符串键可以用 string_view / const char* 透明查找
+    EXPECT_EQ(book.find<1>(std::string_view("GOOG"))->id, 3);
+    EXPECT_EQ(book.find<1>("NONE"), nullptr);
+    EXPECT_EQ(book.count<2>(100), 2U);
+    EXPECT_EQ(book.find<2>(100)->id, 1);
+
+    // 删除后最后一个元素搬到空位，其他 Handle 仍然有效
+    auto c = book.findHandle<0>(3);
+    EXPECT_TRUE(book.erase(a));
+    EXPECT_FALSE(book.erase(a));
+    EXPECT_EQ(book.get(a), nullptr);
+    EXPECT_EQ(book.get(c)->symbol, "GOOG");
+    EXPECT_EQ(book.find<0>(1), nullptr);
+    EXPECT_EQ(book.find<1>("GOOG")->id, 3);
+    EXPECT_EQ(book.count<2>(100), 1U);
+
+    // 槽位复用后旧 Handle 依然无效
+    auto [d, ok] = book.emplace(5, "TSLA", 200);
+    EXPECT_TRUE(ok);
+    EXPECT_EQ(d.slot, a.slot);
+    EXPECT_EQ(book.get(a), nullptr);
+
+    EXPECT_EQ(book.eraseKey<2>(200), 1U);
+    EXPECT_EQ(book.size(), 2U);
+    book.clear();
+    EXPECT_TRUE(book.empty());
+    EXPECT_EQ(book.get(c), nullptr);
+}
+
+TEST(FlatMultiIndexTest, ModifyAndOrderedRange) {
+    OrderBook book;
+    for (int32_t i = 0; i < 10; i++) {
+        book.emplace(i, "S" + std::to_string(i), (i % 5) * 10);
+    }
+
+    std::vector<int32_t> ids;
+    book.forRange<2>(10, 30, [&](const Order &o) { ids.push_back(o.id); });
+    EXPECT_EQ(ids, (std::vector<int32_t>{1, 6, 2, 7}));
+
+    auto h = book.findHandle<0>(6);
+    EXPECT_TRUE(book.modify(h, [](Order &o) {
+        o.price = 45;
+        o.symbol = "X6";
+    }));
+    EXPECT_EQ(book.find<1>("S6"), nullptr);
+    EXPECT_EQ(book.find<1>("X6")->id, 6);
+    EXPECT_EQ(book.find<2>(45)->id, 6);
+    EXPECT_EQ(book.count<2>(10), 1U);
+
+    // 只改非键字段，索引不动
+    EXPECT_TRUE(book.modify(h, [](Order &o) { o.price = 45; }));
+
+    // 与唯一索引冲突时元素被删除
+    EXPECT_FALSE(book.modify(h, [](Order &o) { o.id = 7; }));
+    EXPECT_EQ(book.get(h), nullptr);
+    EXPECT_EQ(book.size(), 9U);
+    EXPECT_EQ(book.find<0>(7)->symbol, "S7");
+    EXPECT_EQ(book.find<1>("X6"), nullptr);
+    EXPECT_EQ(book.count<2>(45), 0U);
+
+    int64_t last = -1;
+    size_t n = 0;
+    book.forEachOrdered<2>([&](const Order &o) {
+        EXPECT_LE(last, o.price);
+        last = o.price;
+        n++;
+    });
+    EXPECT_EQ(n, book.size());
+}
+
+TEST(FlatMultiIndexTest, RandomOpsMatchStdMap) {
+    using Index = FlatMultiIndex<std::pair<int32_t, int32_t>, HashedUnique<MemberKey<&std::pair<int32_t, int32_t>::first>>,
+                                 OrderedUnique<MemberKey<&std::pair<int32_t, int32_t>::second>>>;
+    Index index;
+    std::map<int32_t, int32_t> byFirst;
+    std::map<int32_t, int32_t> bySecond;
+    std::mt19937 gen(42);
+    std::uniform_int_distribution<int32_t> key(0, 2000);
+    for (int32_t i = 0; i < 50000; i++) {
+        const int32_t k = key(gen);
+        const int32_t v = key(gen);
+        switch (gen() % 3) {
+        case 0: {
+            const bool expected = byFirst.count(k) == 0 && bySecond.count(v) == 0;
+            EXPECT_EQ(index.emplace(k, v).second, expected);
+            if (expected) {
+                byFirst[k] = v;
+                bySecond[v] = k;
+            }
+            break;
+        }
+        case 1: {
+            auto it = byFirst.find(k);
+            EXPECT_EQ(index.eraseKey<0>(k), it == byFirst.end() ? 0U : 1U);
+            if (it != byFirst.end()) {
+                bySecond.erase(it->second);
+                byFirst.erase(it);
+            }
+            break;
+        }
+        default: {
+            auto it = byFirst.find(k);
+            const bool ok = index.modify(index.findHandle<0>(k), [&](auto &p) { p.second = v; });
+            if (it == byFirst.end()) {
+                EXPECT_FALSE(ok);
+            } else if (it->second == v || bySecond.count(v) == 0) {
+                EXPECT_TRUE(ok);
+                bySecond.erase(it->second);
+                bySecond[v] = k;
+                it->second = v;
+            } else {
+                EXPECT_FALSE(ok);
+                bySecond.erase(it->second);
+                byFirst.erase(it);
+            }
+        }
+        }
+    }
+    ASSERT_EQ(index.size(), byFirst.size());
+    for (const auto &[k, v] : byFirst) {
+        ASSERT_NE(index.find<0>(k), nullptr);
+        EXPECT_EQ(index.find<0>(k)->second, v);
+        EXPECT_EQ(index.find<1>(v)->first, k);
+    }
+    auto it = bySecond.begin();
+    index.forEachOrdered<1>([&](const auto &p) { EXPECT_EQ(p.second, (it++)->first); });
+}
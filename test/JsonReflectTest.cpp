@@ -0,0 +1,225 @@
+#include "gtest/gtest.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <limits>
+#include <map>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "util/JsonReflect.hpp"
+
+using namespace rhino;
+using namespace std;
+
+namespace {
+
+struct Address {
+    std::string city;
+    int32_t zip = 0;
+    RHINO_REFLECT(Address, city, zip)
+};
+
+struct User {
+    int64_t id = 0;
+    std::string name;
+    double score = 0;
+    bool active = false;
+    std::optional<std::string> email;
+    std::vector<int32_t> tags;
+    std::vector<Address> addresses;
+    std::optional<Address> home;
+    std::map<std::string, int64_t> counters;
+    RHINO_REFLECT(User, id, name, score, active, email, tags, addresses, home, counters)
+};
+
+User sampleUser(int64_t id) {
+    User u;
+    u.id = id;
+    u.name = "user-" + std::to_string(id) + " \"quoted\"\n";
+    u.score = 0.1 * static_cast<double>(id) + 3;
+    u.active = id % 2 == 0;
+    if (id % 3 != 0) {
+        u.email = "u" + std::to_string(id) + "@example.com";
+    }
+    u.tags = {1, 2, 3, static_cast<int32_t>(id)};
+    u.addresses = {{"北京", 100000}, {"Shanghai", 200000}};
+    u.home = Address{"Tab\tCity", 7};
+    u.counters = {{"login", id * 10}, {"logout", id}};
+    return u;
+}
+
+bool sameUser(const User &a, const User &b) {
+    auto sameAddress = [](const Address &x, const Address &y) { return x.city == y.city && x.zip == y.zip; };
+    if (a.addresses.size() != b.addresses.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < a.addresses.size(); i++) {
+        if (!sameAddress(a.addresses[i], b.addresses[i])) {
+            return false;
+        }
+    }
+    return a.id == b.id && a.name == b.name && a.score == b.score && a.active == b.active && a.email == b.email &&
+           a.tags == b.tags && a.home.has_value() == b.home.has_value() &&
+           (!a.home || sameAddress(*a.home, *b.home)) && a.counters == b.counters;
+}
+
+} // namespace
+
+TEST(JsonReflectTest, RoundTrip) {
+    for (int64_t id : {0, 1, 2, 3}) {
+        const User user = sampleUser(id);
+        std::string buffer;
+        writeJson(user, buffer);
+        EXPECT_TRUE(sameUser(readJson<User>(buffer), user)) << buffer;
+    }
+
+    std::string buffer;
+    writeJson(Address{"a", 1}, buffer);
+    EXPECT_EQ(buffer, R"({"city":"a","zip":1})");
+    // 复用 buffer 时先清空
+    writeJson(Address{"b", 2}, buffer);
+    EXPECT_EQ(buffer, R"({"city":"b","zip":2})");
+}
+
+TEST(JsonReflectTest, CompatibleWithNlohmann) {
+    const User user = sampleUser(4);
+    // 写出的 JSON 与 nlohmann 解析后的树相同，只是键的顺序不同
+    EXPECT_EQ(nlohmann::json::parse(writeJson(user)), nlohmann::json(user));
+    // nlohmann 写出的 JSON（按键名排序）也能直接读回
+    EXPECT_TRUE(sameUser(readJson<User>(toJson(user)), user));
+    EXPECT_TRUE(sameUser(readJson<User>(toJson(user, true)), user));
+    EXPECT_TRUE(sameUser(fromJson<User>(writeJson(user)), user));
+
+    // 浮点数和字符串的格式与 nlohmann 一致
+    for (double d : {0.0, 1.0, -2.5, 0.1, 1e20, 1e-7, 123456789.125}) {
+        EXPECT_EQ(writeJson(d), nlohmann::json(d).dump());
+    }
+    EXPECT_EQ(writeJson(std::numeric_limits<double>::quiet_NaN()), "null");
+    const std::string control = std::string("a\x01\x1f\"\\/\b\f\n\r\t中", 14);
+    EXPECT_EQ(writeJson(control), nlohmann::json(control).dump());
+}
+
+TEST(JsonReflectTest, ReaderDetails) {
+    // 未声明的键被跳过，任意空白
+    auto addr = readJson<Address>(
+        R"( { "extra" : {"nested": [1, "]", {"}": null}]}, "zip" : 12 , "ignored": "x\"y", "city" : "c" } )");
+    EXPECT_EQ(addr.city, "c");
+    EXPECT_EQ(addr.zip, 12);
+
+    // 转义和代理对
+    EXPECT_EQ(readJson<std::string>(R"("A中😀\/\\")"), "A中\xF0\x9F\x98\x80/\\");
+    // 带转义的键名
+    EXPECT_EQ(readJson<Address>(R"({"ci\u0074y":"x","zip":1})").city, "x");
+
+    // optional：null 和缺失都得到 nullopt
+    User user = sampleUser(1);
+    std::string json = R"({"id":1,"name":"n","score":1,"active":true,"email":null,"tags":[],"addresses":[],"counters":{}})";
+    readJson(json, user);
+    EXPECT_EQ(user.email, std::nullopt);
+    EXPECT_FALSE(user.home.has_value());
+    EXPECT_TRUE(user.tags.empty());
+    EXPECT_DOUBLE_EQ(user.score, 1.0);
+
+    // 浮点数读进整数时截断，与 nlohmann 一致
+    EXPECT_EQ(readJson<int32_t>("3.9"), 3);
+    EXPECT_EQ(readJson<std::vector<bool>>("[true,false]"), (std::vector<bool>{true, false}));
+    EXPECT_EQ(readJson<void *>("{\"a\":1}"), nullptr);
+}
+
+TEST(JsonReflectTest, Errors) {
+    EXPECT_THROW(readJson<Address>(R"({"city":"x"})"), std::invalid_argument);
+    EXPECT_THROW(readJson<Address>(R"({"city":"x","zip":"1"})"), std::invalid_argument);
+    EXPECT_THROW(readJson<Address>(R"({"city":"x","zip":1)"), std::invalid_argument);
+    EXPECT_THROW(readJson<Address>(R"({"city":"x","zip":1} x)"), std::invalid_argument);
+    EXPECT_THROW(readJson<Address>(R"({"city":null,"zip":1})"), std::invalid_argument);
+    EXPECT_THROW(readJson<std::string>(R"("abc)"), std::invalid_argument);
+    EXPECT_THROW(readJson<std::string>(R"("\ud83d")"), std::invalid_argument);
+    EXPECT_THROW(readJson<int8_t>("300"), std::invalid_argument);
+    EXPECT_THROW(readJson<std::vector<int32_t>>("[1,2"), std::invalid_argument);
+    // 只接受 RFC 8259 的数字语法，from_chars 能解析的其他写法都拒绝
+    for (const char *bad : {"nan", "inf", "-inf", "infinity", ".5", "1.", "-", "+1", "01", "1e", "1e+", "-.5", "0x10"}) {
+        EXPECT_THROW(readJson<double>(bad), std::invalid_argument) << bad;
+        EXPECT_THROW(readJson<int32_t>(bad), std::invalid_argument) << bad;
+    }
+    EXPECT_THROW(readJson<User>(R"({"id":1,"name":"n","score":nan,"active":true,"tags":[],"addresses":[],"counters":{}})"),
+                 std::invalid_argument);
+    EXPECT_THROW(readJson<double>("1e400"), std::invalid_argument);
+    EXPECT_THROW(readJson<double>("-1e400"), std::invalid_argument);
+    // 下溢与 nlohmann 一致读成 ±0.0
+    EXPECT_EQ(readJson<double>("1e-400"), 0.0);
+    EXPECT_TRUE(std::signbit(readJson<double>("-1e-400")));
+    EXPECT_EQ(readJson<double>("94857e-0224449119300"), nlohmann::json::parse("94857e-0224449119300").get<double>());
+    EXPECT_EQ(readJson<int32_t>("1e-400"), 0);
+    EXPECT_DOUBLE_EQ(readJson<double>("-0.5e-3"), -0.0005);
+    EXPECT_DOUBLE_EQ(readJson<double>("0"), 0.0);
+    EXPECT_DOUBLE_EQ(readJson<double>("2E+2"), 200.0);
+    EXPECT_EQ(readJson<int32_t>("-1.5e1"), -15);
+    try {
+        (void)readJson<Address>(R"({"city":"x","zip":tru})");
+        FAIL();
+    } catch (const std::invalid_argument &e) {
+        EXPECT_NE(std::string(e.what()).find("offset 18"), std::string::npos) << e.what();
+    }
+}
+
+TEST(JsonReflectTest, Benchmark) {
+    constexpr int32_t USERS = 2000;
+    constexpr int32_t ROUNDS = 20;
+    std::vector<User> users;
+    for (int32_t i = 0; i < USERS; i++) {
+        users.push_back(sampleUser(i));
+    }
+    std::vector<std::string> texts;
+    for (const auto &u : users) {
+        texts.push_back(writeJson(u));
+    }
+    using Clock = std::chrono::steady_clock;
+    auto ns = [](Clock::time_point start) {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count();
+    };
+    constexpr int64_t OPS = static_cast<int64_t>(USERS) * ROUNDS;
+
+    size_t sink = 0;
+    auto start = Clock::now();
+    for (int32_t r = 0; r < ROUNDS; r++) {
+        for (const auto &u : users) {
+            sink += toJson(u).size();
+        }
+    }
+    const auto toJsonNs = ns(start);
+    std::string buffer;
+    start = Clock::now();
+    for (int32_t r = 0; r < ROUNDS; r++) {
+        for (const auto &u : users) {
+            writeJson(u, buffer);
+            sink += buffer.size();
+        }
+    }
+    const auto writeNs = ns(start);
+
+    start = Clock::now();
+    for (int32_t r = 0; r < ROUNDS; r++) {
+        for (const auto &t : texts) {
+            sink += static_cast<size_t>(fromJson<User>(t).id);
+        }
+    }
+    const auto fromJsonNs = ns(start);
+    User user;
+    start = Clock::now();
+    for (int32_t r = 0; r < ROUNDS; r++) {
+        for (const auto &t : texts) {
+            readJson(t, user);
+            sink += static_cast<size_t>(user.id);
+        }
+    }
+    const auto readNs = ns(start);
+    EXPECT_GT(sink, 0U);
+    std::cout << "序列化: toJson " << toJsonNs / OPS << " ns/次, writeJson " << writeNs / OPS << " ns/次" << std::endl;
+    std::cout << "反序列化: fromJson " << fromJsonNs / OPS << " ns/次, readJson " << readNs / OPS << " ns/次"
+              << std::endl;
+}
@@ -0,0 +1,268 @@
+#include "gtest/gtest.h"
+
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "util/JsonTape.hpp"
+
+using namespace rhino;
+using namespace std;
+
+namespace {
+
+nlohmann::json randomJson(std::mt19937_64 &gen, int32_t depth) {
+    static const std::vector<std::string> pieces = {"a", "\"", "\\", "\\\\", "/", "\n", "\t", "\x01", "中文", "😀",
+                                                    "{", "}", "[", "]", ":", ",", " ", "\\\"", "\"\\"};
+    auto randomString = [&] {
+        std::string s;
+        const auto parts = gen() % 8;
+        for (uint64_t i = 0; i < parts; i++) {
+            s += pieces[gen() % pieces.size()];
+        }
+        return s;
+    };
+    switch (depth <= 0 ? gen() % 6 : gen() % 8) {
+    case 0:
+        return nullptr;
+    case 1:
+        return gen() % 2 == 0;
+    case 2:
+        return static_cast<int64_t>(gen());
+    case 3:
+        return static_cast<uint64_t>(gen() % 1000);
+    case 4:
+        return std::uniform_real_distribution<double>(-1e6, 1e6)(gen);
+    case 5:
+        return randomString();
+    case 6: {
+        nlohmann::json j = nlohmann::json::array();
+        const auto n = gen() % 6;
+        for (uint64_t i = 0; i < n; i++) {
+            j.push_back(randomJson(gen, depth - 1));
+        }
+        return j;
+    }
+    default: {
+        nlohmann::json j = nlohmann::json::object();
+        const auto n = gen() % 6;
+        for (uint64_t i = 0; i < n; i++) {
+            j[randomString()] = randomJson(gen, depth - 1);
+        }
+        return j;
+    }
+    }
+}
+
+// 近似 twitter.json：statuses 数组，每条带嵌套的 user、entities，大量短字符串和少量转义、中文
+std::string twitterLike(size_t statuses) {
+    std::mt19937_64 gen(7);
+    nlohmann::json root;
+    nlohmann::json &list = root["statuses"] = nlohmann::json::array();
+    for (size_t i = 0; i < statuses; i++) {
+        nlohmann::json s;
+        s["created_at"] = "Sun Aug 31 00:29:15 +0000 2014";
+        s["id"] = 505874924095815681ULL + i;
+        s["id_str"] = std::to_string(505874924095815681ULL + i);
+        s["text"] = "@aym0566x \n\n名前:前田あゆみ\n第一印象:なんか怖っ！\n今の印象:とりあえずキモい。 #" +
+                    std::to_string(gen() % 1000) + " \"quoted\" http:\\/\\/t.co\\/abc";
+        s["source"] = "<a href=\"http://twitter.com/download/iphone\" rel=\"nofollow\">Twitter for iPhone</a>";
+        s["truncated"] = false;
+        s["in_reply_to_status_id"] = nullptr;
+        s["in_reply_to_user_id"] = gen() % 2 == 0 ? nlohmann::json(866260188) : nlohmann::json(nullptr);
+        nlohmann::json &user = s["user"];
+        user["id"] = 1186275104 + gen() % 1000;
+        user["name"] = "AYUMI";
+        user["screen_name"] = "ayuu0123";
+        user["location"] = "";
+        user["description"] = "元野球部マネージャー❤︎…最高の夏をありがとう…❤︎";
+        user["followers_count"] = gen() % 100000;
+        user["friends_count"] = gen() % 1000;
+        user["verified"] = gen() % 10 == 0;
+        user["profile_background_color"] = "C0DEED";
+        user["profile_image_url"] = "http://pbs.twimg.com/profile_images/497760886795153410/LDjAwR_y_normal.jpeg";
+        s["geo"] = nullptr;
+        s["retweet_count"] = gen() % 100;
+        s["favorite_count"] = gen() % 100;
+        s["coordinates"] = {{"type", "Point"}, {"coordinates", {139.6917 + 0.001 * i, -35.6895}}};
+        nlohmann::json &entities = s["entities"];
+        entities["hashtags"] = nlohmann::json::array();
+        entities["urls"] = nlohmann::json::array();
+        entities["user_mentions"] = {{{"screen_name", "aym0566x"},
+                                      {"name", "前田あゆみ"},
+                                      {"id", 866260188},
+                                      {"indices", {0, 9}}}};
+        s["favorited"] = false;
+        s["lang"] = "ja";
+        list.push_back(std::move(s));
+    }
+    root["search_metadata"] = {{"completed_in", 0.087}, {"max_id", 505874924095815681ULL}, {"count", statuses}};
+    return root.dump(2);
+}
+
+} // namespace
+
+TEST(JsonTapeTest, MatchesNlohmann) {
+    const std::vector<std::string> docs = {
+        R"({"a":1,"b":[true,false,null],"c":{"d":"e"},"f":-2.5e3,"g":[],"h":{}})",
+        R"([0,-0,1,-1,9223372036854775807,-9223372036854775808,18446744073709551615,18446744073709551616,1e-5,1E+2])",
+        R"("A中😀\/\\\"\b\f\n\r\t\u0041\u4e2d\ud83d\ude00")",
+        "  \n\t42\r\n  ",
+        "null",
+        R"({"dup":1,"dup":2})",
+        // 下溢读成 ±0.0，次正规数照常保留
+        R"([1e-400,-1e-400,94857e-0224449119300,0.00001e-320,4.9e-324,1e-310])",
+        // 跨越 64 字节边界的字符串和反斜杠序列
+        "[\"" + std::string(61, 'x') + "\\\\\\\"" + std::string(70, 'y') + "\",\"" + std::string(63, '\\') +
+            "\\\"]",
+    };
+    JsonTapeParser parser;
+    for (const auto &doc : docs) {
+        EXPECT_EQ(parser.parse(doc).toJsonTree(), nlohmann::json::parse(doc)) << doc;
+    }
+
+    // 随机文档：紧凑和缩进两种格式，同一个解析器反复使用
+    std::mt19937_64 gen(42);
+    for (int32_t i = 0; i < 2000; i++) {
+        const nlohmann::json j = randomJson(gen, 4);
+        const std::string compact = j.dump();
+        ASSERT_EQ(parser.parse(compact).toJsonTree(), j) << compact;
+        const std::string pretty = j.dump(static_cast<int32_t>(i % 3));
+        ASSERT_EQ(parser.parse(pretty).toJsonTree(), j) << pretty;
+    }
+}
+
+TEST(JsonTapeTest, BlockScanMatchesScalar) {
+    std::mt19937_64 gen(1);
+    const std::string alphabet = "\"\\{}[]:, \t\n\rab01\x01\x1f\x7f\x80\xff";
+    char block[64];
+    for (int32_t i = 0; i < 10000; i++) {
+        for (char &c : block) {
+            c = alphabet[gen() % alphabet.size()];
+        }
+        const auto simd = detail::scanJsonBlock(block);
+        const auto scalar = detail::scanJsonBlockScalar(block);
+        ASSERT_EQ(simd.quote, scalar.quote);
+        ASSERT_EQ(simd.backslash, scalar.backslash);
+        ASSERT_EQ(simd.op, scalar.op);
+        ASSERT_EQ(simd.ws, scalar.ws);
+        ASSERT_EQ(simd.control, scalar.control);
+    }
+}
+
+TEST(JsonTapeTest, LazyView) {
+    const std::string doc =
+        R"({"name":"rhino","escaped":"a\nb","count":3,"neg":-7,"ratio":0.5,"ok":true,"none":null,"list":[1,"two",[3],{"four":4}],"empty":{}})";
+    JsonTapeParser parser;
+    const JsonValue root = parser.parse(doc);
+    ASSERT_TRUE(root.isObject());
+    EXPECT_EQ(root.size(), 9U);
+
+    // 没有转义的字符串直接指向输入
+    const std::string_view name = root["name"].getString();
+    EXPECT_EQ(name, "rhino");
+    EXPECT_GE(name.data(), doc.data());
+    EXPECT_LT(name.data(), doc.data() + doc.size());
+    EXPECT_EQ(root["escaped"].getString(), "a\nb");
+
+    EXPECT_EQ(root["count"].type(), JsonType::Uint64);
+    EXPECT_EQ(root["count"].getInt64(), 3);
+    EXPECT_EQ(root["neg"].getInt64(), -7);
+    EXPECT_DOUBLE_EQ(root["ratio"].getDouble(), 0.5);
+    EXPECT_DOUBLE_EQ(root["count"].getDouble(), 3.0);
+    EXPECT_TRUE(root["ok"].getBool());
+    EXPECT_TRUE(root["none"].isNull());
+    EXPECT_EQ(root.find("missing"), std::nullopt);
+    EXPECT_THROW(root["missing"], std::out_of_range);
+    EXPECT_THROW(root["name"].getInt64(), std::invalid_argument);
+    EXPECT_THROW(root["neg"].getUint64(), std::invalid_argument);
+
+    const JsonValue list = root["list"];
+    EXPECT_EQ(list.size(), 4U);
+    EXPECT_EQ(list.at(1).getString(), "two");
+    EXPECT_EQ(list.at(2).at(0).getInt64(), 3);
+    EXPECT_EQ(list.at(3)["four"].getInt64(), 4);
+    EXPECT_THROW(list.at(4), std::out_of_range);
+    EXPECT_EQ(root["empty"].size(), 0U);
+    EXPECT_EQ(root["empty"].begin(), root["empty"].end());
+
+    std::vector<std::string> keys;
+    for (auto it = root.begin(); it != root.end(); ++it) {
+        keys.emplace_back(it.key());
+    }
+    EXPECT_EQ(keys.front(), "name");
+    EXPECT_EQ(keys.back(), "empty");
+    int64_t arrayItems = 0;
+    for (JsonValue v : list) {
+        arrayItems += v.isNumber() ? 1 : 0;
+    }
+    EXPECT_EQ(arrayItems, 1);
+    EXPECT_EQ(list.toJsonTree(), nlohmann::json::parse(R"([1,"two",[3],{"four":4}])"));
+
+    // 解析器复用：第二次解析的结果覆盖第一次，tape 不重新分配
+    const size_t tape = parser.tapeSize();
+    EXPECT_EQ(parser.parse("[1,2]").size(), 2U);
+    EXPECT_LT(parser.tapeSize(), tape);
+}
+
+TEST(JsonTapeTest, Errors) {
+    const std::vector<std::string> bad = {
+        "", "   ", "{", "}", "[1,]", "[1 2]", "{\"a\" 1}", "{\"a\":}", "{\"a\":1,}", "{1:2}", "[tru]", "[truex]",
+        "nul", "01", "1.", "-", "1e", "+1", ".5", "1x", "\"abc", "\"a\nb\"", "\"\\x\"", "\"\\u12g4\"",
+        "\"\\ud83d\"", "[1]]", "[1] 2", "{\"a\":1}}", "[\"a\"\"b\"]", "1e400", "-1e400",
+        "0.001e0000000000000000000312", "[\"a\\\"]",
+    };
+    JsonTapeParser parser;
+    for (const auto &doc : bad) {
+        EXPECT_THROW(parser.parse(doc), std::invalid_argument) << doc;
+    }
+    EXPECT_THROW(parser.parse(std::string(2000, '[') + std::string(2000, ']')), std::invalid_argument);
+    try {
+        (void)parser.parse(R"({"a":[1,2,x]})");
+        FAIL();
+    } catch (const std::invalid_argument &e) {
+        EXPECT_NE(std::string(e.what()).find("offset 10"), std::string::npos) << e.what();
+    }
+    // 出错后仍可继续使用
+    EXPECT_EQ(parser.parse("[1]").at(0).getInt64(), 1);
+}
+
+TEST(JsonTapeTest, Benchmark) {
+    const std::string doc = twitterLike(2000);
+    constexpr int32_t ROUNDS = 10;
+    using Clock = std::chrono::steady_clock;
+    auto gbps = [&doc](Clock::time_point start) {
+        const auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count();
+        return static_cast<double>(doc.size()) * ROUNDS / static_cast<double>(ns);
+    };
+
+    size_t sink = 0;
+    auto start = Clock::now();
+    for (int32_t r = 0; r < ROUNDS; r++) {
+        sink += nlohmann::json::parse(doc).size();
+    }
+    const double nlohmannGbps = gbps(start);
+
+    JsonTapeParser parser;
+    start = Clock::now();
+    for (int32_t r = 0; r < ROUNDS; r++) {
+        sink += parser.parse(doc)["statuses"].size();
+    }
+    const double tapeGbps = gbps(start);
+
+    start = Clock::now();
+    for (int32_t r = 0; r < ROUNDS; r++) {
+        sink += parser.parse(doc).toJsonTree().size();
+    }
+    const double treeGbps = gbps(start);
+
+    EXPECT_EQ(parser.parse(doc).toJsonTree(), nlohmann::json::parse(doc));
+    EXPECT_GT(sink, 0U);
+    std::cout << "twitter 类文档 " << doc.size() / 1024 << " KB: nlohmann::json::parse " << nlohmannGbps
+              << " GB/s, JsonTapeParser " << tapeGbps << " GB/s, JsonTapeParser + toJsonTree " << treeGbps << " GB/s"
+              << std::endl;
+}
@@ -0,0 +1,200 @@
+#include "gtest/gtest.h"
+
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <stdexcept>
+#include <thread>
+#include <algorithm>
+#include <vector>
+
+#include "util/Locked.hpp"
+#include "util/SpinMutex.hpp"
+
+using namespace rhino;
+using namespace std;
+using namespace std::chrono;
+
+struct Pair {
+    int64_t a;
+    int64_t b;
+};
+
+TEST(LockedTest, SameFunctorApi) {
+    Locked<vector<int>> locked;
+    SharedLocked<vector<int>> shared;
+    locked([](vector<int> &v) { v.push_back(1); });
+    shared([](vector<int> &v) { v.push_back(1); });
+
+    const auto &constShared = shared;
+    auto size = constShared([](const vector<int> &v) { return v.size(); });
+    EXPECT_EQ(size, 1U);
+    EXPECT_EQ(locked([](const vector<int> &v) { return v.size(); }), 1U);
+}
+
+TEST(LockedTest, SeqLockedConsistentSnapshot) {
+    SeqLocked<Pair> seq(Pair{0, 0});
+    atomic<bool> stop{false};
+    thread writer([&] {
+        for (int64_t i = 1; i <= 100000; i++) {
+            seq([i](Pair &p) {
+                p.a = i;
+                p.b = -i;
+            });
+        }
+        stop = true;
+    });
+
+    const auto &reader = seq;
+    int64_t torn = 0;
+    while (!stop.load()) {
+        torn += reader([](const Pair &p) { return p.a + p.b != 0 ? 1 : 0; });
+    }
+    writer.join();
+    EXPECT_EQ(torn, 0);
+    EXPECT_EQ(seq.load().a, 100000);
+}
+
+TEST(LockedTest, SeqLockedWriterDoesNotBlockReaders) {
+    SeqLocked<Pair> seq(Pair{1, -1});
+    const auto &reader = seq;
+    // f 执行期间读者照常读到旧值，而不是等待写者
+    seq([&](Pair &p) {
+        p.a = 2;
+        atomic<bool> read{false};
+        Pair seen{};
+        thread t([&] {
+            seen = reader.load();
+            read = true;
+        });
+        auto deadline = steady_clock::now() + seconds(5);
+        while (!read.load() && steady_clock::now() < deadline) {
+            this_thread::yield();
+        }
+        EXPECT_TRUE(read.load());
+        t.join();
+        EXPECT_EQ(seen.a, 1);
+        p.b = -2;
+    });
+    EXPECT_EQ(seq.load().a, 2);
+
+    // f 抛出异常时不发布改了一半的副本
+    EXPECT_THROW(seq([](Pair &p) {
+        p.a = 3;
+        throw std::runtime_error("abort");
+    }), std::runtime_error);
+    EXPECT_EQ(seq.load().a, 2);
+    EXPECT_EQ(seq.load().b, -2);
+    EXPECT_EQ(seq([](Pair &p) { return p.a; }), 2);
+}
+
+// 读写比例不同情况下三种锁的吞吐对比：每个线程按比例随机执行读或写
+template <typename L> static double runMix(L &lock, int threads, int readPercent, int opsPerThread) {
+    vector<thread> workers;
+    auto start = high_resolution_clock::now();
+    for (int t = 0; t < threads; t++) {
+        workers.emplace_back([&lock, t, readPercent, opsPerThread] {
+            const L &reader = lock;
+            uint32_t seed = 2463534242U + t;
+            int64_t sink = 0;
+            for (int i = 0; i < opsPerThread; i++) {
+                seed ^= seed << 13;
+                seed ^= seed >> 17;
+                seed ^= seed << 5;
+                if (static_cast<int>(seed % 100) < readPercent) {
+                    sink += reader([](const Pair &p) { return p.a + p.b; });
+                } else {
+                    lock([i](Pair &p) {
+                        p.a = i;
+                        p.b = i;
+                    });
+                }
+            }
+            volatile int64_t keep = sink;
+            (void)keep;
+        });
+    }
+    for (auto &w : workers) {
+        w.join();
+    }
+    auto end = high_resolution_clock::now();
+    auto ns = duration_cast<nanoseconds>(end - start).count();
+    return static_cast<double>(threads) * opsPerThread * 1e3 / ns;
+}
+
+TEST(LockedTest, ContentionBenchmark) {
+    const int threads = std::max(2U, std::thread::hardware_concurrency());
+    constexpr int OPS = 200000;
+    std::cout << "线程数: " << threads << "，吞吐单位: Mops/s" << std::endl;
+    for (int readPercent : {50, 90, 99, 100}) {
+        Locked<Pair> locked;
+        SharedLocked<Pair> shared;
+        SeqLocked<Pair> seq;
+        auto l = runMix(locked, threads, readPercent, OPS);
+        auto s = runMix(shared, threads, readPercent, OPS);
+        auto q = runMix(seq, threads, readPercent, OPS);
+        std::cout << "读比例 " << readPercent << "%: Locked " << l << ", SharedLocked " << s
+                  << ", SeqLocked " << q << std::endl;
+    }
+}
+
+TEST(LockedTest, SpinMutexExclusive) {
+    Locked<int64_t, SpinMutex> counter;
+    counter([](int64_t &c) { c = 0; });
+    vector<thread> workers;
+    for (int t = 0; t < 4; t++) {
+        workers.emplace_back([&counter] {
+            for (int i = 0; i < 50000; i++) {
+                counter([](int64_t &c) { c++; });
+            }
+        });
+    }
+    for (auto &w : workers) {
+        w.join();
+    }
+    EXPECT_EQ(counter([](int64_t c) { return c; }), 200000);
+}
+
+TEST(LockedTest, InstrumentedReport) {
+    Locked<vector<int>, std::mutex, InstrumentedLockProbe> hot("hotLock");
+    Locked<vector<int>, std::mutex, InstrumentedLockProbe> cold("coldLock");
+    vector<thread> workers;
+    for (int t = 0; t < 4; t++) {
+        workers.emplace_back([&hot] {
+            for (int i = 0; i < 2000; i++) {
+                hot([i](vector<int> &v) {
+                    v.push_back(i);
+                    this_thread::yield();
+                });
+            }
+        });
+    }
+    cold([](vector<int> &v) { v.push_back(1); });
+    for (auto &w : workers) {
+        w.join();
+    }
+
+    auto top = LockRegistry::global().topContended(10);
+    ASSERT_GE(top.size(), 2U);
+    uint64_t hotAcquisitions = 0;
+    for (const auto &r : top) {
+        if (r.name == "hotLock") {
+            hotAcquisitions = r.acquisitions;
+        }
+    }
+    EXPECT_EQ(hotAcquisitions, 8000U);
+    std::cout << LockRegistry::global().dump(2);
+}
+
+TEST(LockedTest, ShortCriticalSectionBenchmark) {
+    const int threads = std::max(2U, std::thread::hardware_concurrency());
+    constexpr int OPS = 200000;
+    Locked<Pair> mutexLocked;
+    Locked<Pair, SpinMutex> spinLocked;
+    Locked<Pair, std::mutex, InstrumentedLockProbe> instrumented("benchmark");
+    auto m = runMix(mutexLocked, threads, 0, OPS);
+    auto s = runMix(spinLocked, threads, 0, OPS);
+    auto i = runMix(instrumented, threads, 0, OPS);
+    std::cout << "短临界区纯写（Mops/s）: std::mutex " << m << ", SpinMutex " << s
+              << ", std::mutex+插桩 " << i << std::endl;
+}
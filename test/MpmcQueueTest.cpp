@@ -0,0 +1,219 @@
+#include "gtest/gtest.h"
+
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "boost/lockfree/queue.hpp"
+
+#include "util/Histogram.hpp"
+#include "util/Locked.hpp"
+#include "util/MeasureUtil.hpp"
+#include "util/MpmcQueue.hpp"
+
+using namespace rhino;
+using namespace std;
+using namespace std::chrono;
+
+TEST(MpmcQueueTest, FullAndEmpty) {
+    MpmcQueue<int> queue(4);
+    EXPECT_EQ(queue.capacity(), 4U);
+    for (int i = 0; i < 4; i++) {
+        EXPECT_FALSE(queue.tryPush(i).failed());
+    }
+    auto full = queue.tryPush(4);
+    EXPECT_TRUE(full.failed());
+    EXPECT_EQ(full.getErr().code, Err::QUEUE_FULL.code);
+
+    for (int i = 0; i < 4; i++) {
+        auto ret = queue.tryPop();
+        ASSERT_FALSE(ret.failed());
+        EXPECT_EQ(ret.value(), i);
+    }
+    auto empty = queue.tryPop();
+    EXPECT_TRUE(empty.failed());
+    EXPECT_EQ(empty.getErr().code, Err::QUEUE_EMPTY.code);
+}
+
+TEST(MpmcQueueTest, Batch) {
+    MpmcQueue<std::string> queue(8);
+    vector<std::string> in{"a", "b", "c", "d", "e", "f", "g", "h", "i", "j"};
+    EXPECT_EQ(queue.pushN(in.data(), in.size()), 8U);
+    std::string out[16];
+    EXPECT_EQ(queue.popN(out, 3), 3U);
+    EXPECT_EQ(out[0], "a");
+    EXPECT_EQ(out[2], "c");
+    EXPECT_EQ(queue.popN(out, 16), 5U);
+    EXPECT_EQ(out[4], "h");
+    EXPECT_EQ(queue.popN(out, 16), 0U);
+}
+
+TEST(MpmcQueueTest, NonDefaultConstructible) {
+    // 只能移动构造、没有默认构造函数的元素；析构时队列里剩下的元素也要析构
+    struct Item {
+        std::unique_ptr<int> value;
+        explicit Item(int v) : value(std::make_unique<int>(v)) {}
+    };
+    {
+        MpmcQueue<Item> queue(4);
+        EXPECT_TRUE(queue.tryEmplace(1));
+        EXPECT_TRUE(queue.tryEmplace(2));
+        EXPECT_TRUE(queue.tryEmplace(3));
+        auto ret = queue.tryPop();
+        ASSERT_FALSE(ret.failed());
+        EXPECT_EQ(*ret.value().value, 1);
+        EXPECT_EQ(*queue.pop().value, 2);
+    }
+    auto shared = std::make_shared<int>(7);
+    {
+        MpmcQueue<std::shared_ptr<int>> queue(4);
+        queue.push(shared);
+        queue.push(shared);
+        EXPECT_EQ(shared.use_count(), 3);
+    }
+    EXPECT_EQ(shared.use_count(), 1);
+}
+
+TEST(MpmcQueueTest, BlockingMultiProducerMultiConsumer) {
+    constexpr int PRODUCERS = 3;
+    constexpr int CONSUMERS = 3;
+    constexpr int64_t PER_PRODUCER = 100000;
+    MpmcQueue<int64_t> queue(64);
+    atomic<int64_t> sum{0};
+
+    vector<thread> threads;
+    for (int p = 0; p < PRODUCERS; p++) {
+        threads.emplace_back([&queue] {
+            for (int64_t i = 1; i <= PER_PRODUCER; i++) {
+                queue.push(i);
+            }
+        });
+    }
+    for (int c = 0; c < CONSUMERS; c++) {
+        threads.emplace_back([&queue, &sum] {
+            int64_t local = 0;
+            for (int64_t i = 0; i < PER_PRODUCER; i++) {
+                local += queue.pop();
+            }
+            sum += local;
+        });
+    }
+    for (auto &t : threads) {
+        t.join();
+    }
+    EXPECT_EQ(sum.load(), PRODUCERS * PER_PRODUCER * (PER_PRODUCER + 1) / 2);
+}
+
+// 各队列统一成 push/pop 接口，队列满/空时让出 CPU
+struct RhinoAdapter {
+    MpmcQueue<uint64_t> queue{1024};
+    void push(uint64_t v) {
+        while (!queue.tryEmplace(v)) {
+            std::this_thread::yield();
+        }
+    }
+    uint64_t pop() {
+        uint64_t v = 0;
+        while (!queue.tryPop(v)) {
+            std::this_thread::yield();
+        }
+        return v;
+    }
+};
+
+// 阻塞接口：自旋后 futex 挂起
+struct RhinoBlockingAdapter {
+    MpmcQueue<uint64_t> queue{1024};
+    void push(uint64_t v) { queue.push(v); }
+    uint64_t pop() { return queue.pop(); }
+};
+
+struct LockedDequeAdapter {
+    Locked<std::deque<uint64_t>> queue;
+    void push(uint64_t v) {
+        queue([v](std::deque<uint64_t> &q) { q.push_back(v); });
+    }
+    uint64_t pop() {
+        for (;;) {
+            uint64_t v = 0;
+            bool ok = queue([&v](std::deque<uint64_t> &q) {
+                if (q.empty()) {
+                    return false;
+                }
+                v = q.front();
+                q.pop_front();
+                return true;
+            });
+            if (ok) {
+                return v;
+            }
+            std::this_thread::yield();
+        }
+    }
+};
+
+struct BoostAdapter {
+    boost::lockfree::queue<uint64_t, boost::lockfree::capacity<1024>> queue;
+    void push(uint64_t v) {
+        while (!queue.bounded_push(v)) {
+            std::this_thread::yield();
+        }
+    }
+    uint64_t pop() {
+        uint64_t v = 0;
+        while (!queue.pop(v)) {
+            std::this_thread::yield();
+        }
+        return v;
+    }
+};
+
+// 生产者写入 rdtsc 时间戳，消费者计算端到端延迟
+template <typename Q> static void runBenchmark(const char *name, int producers, int consumers, int64_t total) {
+    Q q;
+    Histogram latency;
+    const int64_t perProducer = total / producers;
+    const int64_t perConsumer = perProducer * producers / consumers;
+
+    auto start = high_resolution_clock::now();
+    vector<thread> threads;
+    for (int p = 0; p < producers; p++) {
+        threads.emplace_back([&q, perProducer] {
+            for (int64_t i = 0; i < perProducer; i++) {
+                q.push(rdtsc());
+            }
+        });
+    }
+    for (int c = 0; c < consumers; c++) {
+        threads.emplace_back([&q, &latency, perConsumer] {
+            for (int64_t i = 0; i < perConsumer; i++) {
+                auto sent = q.pop();
+                auto now = rdtsc();
+                latency.recordConcurrent(now > sent ? now - sent : 0);
+            }
+        });
+    }
+    for (auto &t : threads) {
+        t.join();
+    }
+    auto ns = duration_cast<nanoseconds>(high_resolution_clock::now() - start).count();
+    std::cout << name << " " << producers << "P" << consumers << "C: "
+              << static_cast<double>(perProducer * producers) * 1e3 / ns << " Mops/s, 延迟 p50 "
+              << calc_time_nano(0, latency.percentile(0.5)) << " ns, p99 "
+              << calc_time_nano(0, latency.percentile(0.99)) << " ns" << std::endl;
+}
+
+TEST(MpmcQueueTest, Benchmark) {
+    constexpr int64_t TOTAL = 400000;
+    for (auto pc : {std::make_pair(1, 1), std::make_pair(2, 2), std::make_pair(4, 4)}) {
+        runBenchmark<RhinoAdapter>("MpmcQueue          ", pc.first, pc.second, TOTAL);
+        runBenchmark<RhinoBlockingAdapter>("MpmcQueue(阻塞)    ", pc.first, pc.second, TOTAL);
+        runBenchmark<LockedDequeAdapter>("Locked<std::deque> ", pc.first, pc.second, TOTAL);
+        runBenchmark<BoostAdapter>("boost::lockfree    ", pc.first, pc.second, TOTAL);
+    }
+}
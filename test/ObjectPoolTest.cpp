@@ -0,0 +1,236 @@
+#include "gtest/gtest.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "util/ObjectPool.hpp"
+#include "util/SpscRing.hpp"
+
+using namespace rhino;
+using namespace std;
+
+namespace {
+
+struct Message {
+    uint64_t id;
+    int32_t type;
+    char payload[100];
+
+    Message(uint64_t id, int32_t type) : id(id), type(type) { payload[0] = '\0'; }
+};
+
+ObjectPoolOptions smallSlabs() {
+    ObjectPoolOptions options;
+    options.slabBytes = 64 << 10;
+    options.hugePages = false;
+    options.batch = 16;
+    return options;
+}
+
+} // namespace
+
+TEST(ObjectPoolTest, AllocateReuseAndSlabGrowth) {
+    ObjectPool<Message> pool(smallSlabs());
+    EXPECT_EQ(pool.slabCount(), 0U);
+    EXPECT_EQ(ObjectPool<Message>::slotSize() % alignof(Message), 0U);
+
+    Message *m = pool.create(1, 2);
+    EXPECT_EQ(m->id, 1U);
+    EXPECT_EQ(m->type, 2);
+    pool.destroy(m);
+    // 同线程释放后立即被复用
+    Message *again = pool.create(3, 4);
+    EXPECT_EQ(again, m);
+    pool.destroy(again);
+
+    const size_t perSlab = (64 << 10) / ObjectPool<Message>::slotSize();
+    vector<Message *> live;
+    set<Message *> unique;
+    for (size_t i = 0; i < perSlab * 3; i++) {
+        live.push_back(pool.create(i, 0));
+        unique.insert(live.back());
+    }
+    EXPECT_EQ(unique.size(), live.size());
+    EXPECT_GE(pool.slabCount(), 3U);
+    EXPECT_LE(pool.slabCount(), 4U);
+    for (Message *p : live) {
+        EXPECT_EQ(reinterpret_cast<uintptr_t>(p) % alignof(Message), 0U);
+        pool.destroy(p);
+    }
+    // 全部归还后再次分配不需要新的 slab
+    const size_t slabs = pool.slabCount();
+    for (size_t i = 0; i < perSlab * 3; i++) {
+        live[i] = pool.create(i, 0);
+    }
+    EXPECT_EQ(pool.slabCount(), slabs);
+    for (Message *p : live) {
+        pool.destroy(p);
+    }
+}
+
+TEST(ObjectPoolTest, CrossThreadFreeReturnsToOwner) {
+    ObjectPool<Message> pool(smallSlabs());
+    constexpr size_t N = 1000;
+    vector<Message *> made;
+    for (size_t i = 0; i < N; i++) {
+        made.push_back(pool.create(i, 0));
+    }
+    const size_t slabs = pool.slabCount();
+    std::thread([&] {
+        for (Message *m : made) {
+            pool.destroy(m);
+        }
+    }).join();
+    // 另一个线程释放的对象经 remote 栈回到本线程
+    set<Message *> before(made.begin(), made.end());
+    for (size_t i = 0; i < N; i++) {
+        made[i] = pool.create(i, 1);
+        EXPECT_EQ(before.count(made[i]), 1U);
+    }
+    EXPECT_EQ(pool.slabCount(), slabs);
+
+    // 线程退出时空闲对象归还 depot，其他线程可以拿到
+    std::thread([&] {
+        vector<Message *> own;
+        for (size_t i = 0; i < N; i++) {
+            own.push_back(pool.create(i, 2));
+        }
+        for (Message *m : own) {
+            pool.destroy(m);
+        }
+    }).join();
+    const size_t afterExit = pool.slabCount();
+    std::thread([&] {
+        vector<Message *> own;
+        for (size_t i = 0; i < N; i++) {
+            own.push_back(pool.create(i, 3));
+        }
+        for (Message *m : own) {
+            pool.destroy(m);
+        }
+    }).join();
+    EXPECT_EQ(pool.slabCount(), afterExit);
+    for (Message *m : made) {
+        pool.destroy(m);
+    }
+}
+
+TEST(ObjectPoolTest, PrefaultAndHugePages) {
+    ObjectPoolOptions options;
+    options.prefaultSlabs = 2;
+    ObjectPool<Message> pool(options);
+    EXPECT_EQ(pool.slabCount(), 2U);
+    // 没有预留大页时退回 THP，两种情况都能正常分配
+    EXPECT_LE(pool.hugeSlabCount(), 2U);
+    std::cout << "大页 slab: " << pool.hugeSlabCount() << "/" << pool.slabCount() << std::endl;
+    Message *m = pool.create(7, 7);
+    EXPECT_EQ(m->id, 7U);
+    pool.destroy(m);
+    EXPECT_EQ(pool.slabCount(), 2U);
+}
+
+TEST(ObjectPoolTest, ConcurrentProducersAndConsumers) {
+    ObjectPool<Message> pool(smallSlabs());
+    constexpr int32_t PAIRS = 2;
+    constexpr uint64_t N = 50000;
+    std::atomic<uint64_t> checksum{0};
+    vector<std::thread> threads;
+    vector<std::unique_ptr<SpscRing<Message *, 256>>> rings;
+    for (int32_t p = 0; p < PAIRS; p++) {
+        rings.push_back(std::make_unique<SpscRing<Message *, 256>>());
+    }
+    for (int32_t p = 0; p < PAIRS; p++) {
+        auto &ring = *rings[p];
+        threads.emplace_back([&pool, &ring] {
+            for (uint64_t i = 1; i <= N; i++) {
+                Message *m = pool.create(i, 0);
+                while (!ring.tryEmplace(m)) {
+                    std::this_thread::yield();
+                }
+            }
+        });
+        threads.emplace_back([&pool, &ring, &checksum] {
+            uint64_t sum = 0;
+            for (uint64_t i = 0; i < N; i++) {
+                Message *m = nullptr;
+                while (!ring.tryPop(m)) {
+                    std::this_thread::yield();
+                }
+                sum += m->id;
+                // 消费者自己也分配和释放一些对象
+                pool.destroy(pool.create(i, 1));
+                pool.destroy(m);
+            }
+            checksum += sum;
+        });
+    }
+    for (auto &t : threads) {
+        t.join();
+    }
+    EXPECT_EQ(checksum.load(), PAIRS * N * (N + 1) / 2);
+}
+
+TEST(ObjectPoolTest, Benchmark) {
+    constexpr uint64_t N = 1000000;
+    ObjectPool<Message> pool;
+
+    auto run = [](auto &&alloc, auto &&release) {
+        SpscRing<Message *, 1024> ring;
+        auto start = std::chrono::steady_clock::now();
+        std::thread consumer([&] {
+            for (uint64_t i = 0; i < N; i++) {
+                Message *m = nullptr;
+                while (!ring.tryPop(m)) {
+                    std::this_thread::yield();
+                }
+                release(m);
+            }
+        });
+        for (uint64_t i = 0; i < N; i++) {
+            Message *m = alloc(i);
+            while (!ring.tryEmplace(m)) {
+                std::this_thread::yield();
+            }
+        }
+        consumer.join();
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+    };
+
+    auto sameThread = [](auto &&alloc, auto &&release) {
+        vector<Message *> window(64);
+        auto start = std::chrono::steady_clock::now();
+        for (uint64_t i = 0; i < N; i++) {
+            Message *&slot = window[i % window.size()];
+            if (slot != nullptr) {
+                release(slot);
+            }
+            slot = alloc(i);
+        }
+        for (Message *m : window) {
+            release(m);
+        }
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+    };
+
+    auto mallocAlloc = [](uint64_t i) { return new Message(i, 0); };
+    auto mallocFree = [](Message *m) { delete m; };
+    auto poolAlloc = [&pool](uint64_t i) { return pool.create(i, 0); };
+    auto poolFree = [&pool](Message *m) { pool.destroy(m); };
+
+    const auto mallocLocal = sameThread(mallocAlloc, mallocFree);
+    const auto poolLocal = sameThread(poolAlloc, poolFree);
+    std::cout << "同线程 malloc: " << static_cast<double>(mallocLocal) / N << " ns/次" << std::endl;
+    std::cout << "同线程 ObjectPool: " << static_cast<double>(poolLocal) / N << " ns/次" << std::endl;
+    const auto mallocCross = run(mallocAlloc, mallocFree);
+    const auto poolCross = run(poolAlloc, poolFree);
+    std::cout << "生产者分配/消费者释放 malloc: " << static_cast<double>(mallocCross) / N << " ns/次" << std::endl;
+    std::cout << "生产者分配/消费者释放 ObjectPool: " << static_cast<double>(poolCross) / N << " ns/次 (slab 数 "
+              << pool.slabCount() << ")" << std::endl;
+}
@@ -0,0 +1,201 @@
+#include "gtest/gtest.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <numeric>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "runtime/Parallel.h"
+
+using namespace rhino;
+using namespace std;
+using namespace std::chrono;
+
+static ExecutorOptions withThreads(size_t threads) {
+    ExecutorOptions options;
+    options.threads = threads;
+    return options;
+}
+
+static ParallelOptions on(Executor &executor) {
+    ParallelOptions options;
+    options.executor = &executor;
+    return options;
+}
+
+TEST(ParallelTest, ForAndTransform) {
+    Executor executor(withThreads(4));
+    vector<int64_t> v(100000, 0);
+    parallel_for(size_t(0), v.size(), [&v](size_t i) { v[i] = static_cast<int64_t>(i); }, on(executor));
+    for (size_t i = 0; i < v.size(); i++) {
+        ASSERT_EQ(v[i], static_cast<int64_t>(i));
+    }
+
+    parallel_for(v.begin(), v.end(), [](int64_t &x) { x *= 2; }, on(executor));
+    vector<int64_t> out(v.size());
+    parallel_transform(v.begin(), v.end(), out.begin(), [](int64_t x) { return x + 1; }, on(executor));
+    for (size_t i = 0; i < v.size(); i++) {
+        ASSERT_EQ(out[i], static_cast<int64_t>(i) * 2 + 1);
+    }
+
+    // 空区间和很小的区间
+    parallel_for(0, 0, [](int) { FAIL(); }, on(executor));
+    int sum = 0;
+    parallel_for(0, 10, [&sum](int i) { sum += i; }, on(executor));
+    EXPECT_EQ(sum, 45);
+}
+
+TEST(ParallelTest, Reduce) {
+    Executor executor(withThreads(4));
+    vector<int64_t> v(1000003);
+    std::iota(v.begin(), v.end(), 1);
+    const int64_t n = static_cast<int64_t>(v.size());
+
+    auto plus = [](int64_t a, int64_t b) { return a + b; };
+    EXPECT_EQ(parallel_reduce(v.begin(), v.end(), int64_t(0), plus, on(executor)), n * (n + 1) / 2);
+    EXPECT_EQ(parallel_reduce(v.begin(), v.end(), int64_t(10), plus, on(executor)), n * (n + 1) / 2 + 10);
+    auto squares = parallel_reduce(
+        v.begin(), v.begin() + 1000, int64_t(0), plus, [](int64_t x) { return x * x; }, on(executor));
+    EXPECT_EQ(squares, 1000LL * 1001 * 2001 / 6);
+    EXPECT_EQ(parallel_reduce(v.begin(), v.begin(), int64_t(7), plus, on(executor)), 7);
+
+    // 非交换的规约（字符串拼接）必须按顺序合并
+    vector<string> words(5000);
+    for (size_t i = 0; i < words.size(); i++) {
+        words[i] = std::to_string(i % 10);
+    }
+    string expected = std::accumulate(words.begin(), words.end(), string());
+    auto concat = [](string a, const string &b) { return a + b; };
+    EXPECT_EQ(parallel_reduce(words.begin(), words.end(), string(), concat, on(executor)), expected);
+}
+
+TEST(ParallelTest, DeterministicReduce) {
+    mt19937_64 rng(7);
+    uniform_real_distribution<double> dist(-1e6, 1e6);
+    vector<double> v(500000);
+    for (auto &x : v) {
+        x = dist(rng) * std::pow(10.0, static_cast<double>(rng() % 12) - 6);
+    }
+    auto plus = [](double a, double b) { return a + b; };
+
+    // 不同线程数下确定性模式的浮点和逐位相同
+    vector<double> sums;
+    for (size_t threads : {1, 2, 3, 4}) {
+        Executor executor(withThreads(threads));
+        ParallelOptions options = on(executor);
+        options.deterministic = true;
+        for (int round = 0; round < 3; round++) {
+            sums.push_back(parallel_reduce(v.begin(), v.end(), 0.0, plus, options));
+        }
+    }
+    for (double s : sums) {
+        EXPECT_EQ(std::memcmp(&s, &sums[0], sizeof(double)), 0);
+    }
+}
+
+TEST(ParallelTest, Sort) {
+    Executor executor(withThreads(4));
+    mt19937_64 rng(42);
+    for (size_t n : {size_t(0), size_t(1), size_t(100), size_t(5000), size_t(100000), size_t(1000003)}) {
+        vector<uint64_t> v(n);
+        for (auto &x : v) {
+            x = rng() % (n / 2 + 1);
+        }
+        vector<uint64_t> expected = v;
+        std::sort(expected.begin(), expected.end());
+        parallel_sort(v.begin(), v.end(), on(executor));
+        ASSERT_EQ(v, expected) << n;
+
+        parallel_sort(v.begin(), v.end(), std::greater<uint64_t>(), on(executor));
+        ASSERT_TRUE(std::is_sorted(v.begin(), v.end(), std::greater<uint64_t>())) << n;
+    }
+
+    // 只能移动的元素
+    vector<unique_ptr<int>> ptrs;
+    for (int i = 0; i < 50000; i++) {
+        ptrs.push_back(std::make_unique<int>(static_cast<int>(rng() % 1000)));
+    }
+    parallel_sort(
+        ptrs.begin(), ptrs.end(), [](const unique_ptr<int> &a, const unique_ptr<int> &b) { return *a < *b; },
+        on(executor));
+    ASSERT_TRUE(std::is_sorted(ptrs.begin(), ptrs.end(),
+                               [](const unique_ptr<int> &a, const unique_ptr<int> &b) { return *a < *b; }));
+}
+
+TEST(ParallelTest, NestedInsideExecutor) {
+    // 在工作线程内部再调用并行算法，等待期间工作线程会帮忙执行任务，不会死锁
+    Executor executor(withThreads(3));
+    auto ret = executor.submit([&executor] {
+        int64_t total = 0;
+        for (int i = 0; i < 8; i++) {
+            total += parallel_reduce(
+                0, 100000, int64_t(0), [](int64_t a, int64_t b) { return a + b; },
+                [](int x) { return static_cast<int64_t>(x); }, on(executor));
+        }
+        return total;
+    });
+    EXPECT_EQ(ret.get().value(), 8LL * 99999 * 100000 / 2);
+}
+
+template <typename F> static int64_t timeUs(F &&f) {
+    auto start = high_resolution_clock::now();
+    f();
+    return duration_cast<microseconds>(high_resolution_clock::now() - start).count();
+}
+
+TEST(ParallelTest, Benchmark) {
+    constexpr size_t N = 1 << 23;
+    mt19937_64 rng(1);
+    vector<double> data(N);
+    for (auto &x : data) {
+        x = static_cast<double>(rng() % 1000000) / 7.0;
+    }
+    vector<double> out(N);
+    const size_t maxThreads = std::max(2U, std::thread::hardware_concurrency());
+
+    std::cout << "数据量 " << N << "，单位 us（括号内为相对单线程的加速比）" << std::endl;
+    std::cout << "线程数\tfor\treduce\ttransform\tsort" << std::endl;
+    int64_t base[4] = {0, 0, 0, 0};
+    vector<size_t> counts;
+    for (size_t threads = 1; threads < maxThreads; threads *= 2) {
+        counts.push_back(threads);
+    }
+    counts.push_back(maxThreads);
+    for (size_t threads : counts) {
+        Executor executor(withThreads(threads));
+        ParallelOptions options = on(executor);
+        int64_t us[4];
+        us[0] = timeUs([&] {
+            parallel_for(size_t(0), N, [&](size_t i) { out[i] = std::sqrt(data[i]) * 1.5; }, options);
+        });
+        double sum = 0;
+        us[1] = timeUs([&] {
+            sum = parallel_reduce(data.begin(), data.end(), 0.0, [](double a, double b) { return a + b; },
+                                  options);
+        });
+        us[2] = timeUs([&] {
+            parallel_transform(data.begin(), data.end(), out.begin(),
+                               [](double x) { return std::log1p(x); }, options);
+        });
+        vector<double> toSort = data;
+        us[3] = timeUs([&] { parallel_sort(toSort.begin(), toSort.end(), options); });
+        EXPECT_TRUE(std::is_sorted(toSort.begin(), toSort.end()));
+        EXPECT_GT(sum, 0);
+
+        std::cout << threads;
+        for (int k = 0; k < 4; k++) {
+            if (threads == 1) {
+                base[k] = us[k];
+            }
+            double speedup = static_cast<double>(base[k]) / static_cast<double>(std::max<int64_t>(1, us[k]));
+            std::cout << "\t" << us[k] << "(" << speedup << "x)";
+        }
+        std::cout << std::endl;
+    }
+}
@@ -0,0 +1,244 @@
+#include "gtest/gtest.h"
+
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <string>
+
+#include "common/Errs.h"
+#include "common/Ret.h"
+#include "util/JsonUtil.hpp"
+
+using namespace rhino;
+using namespace std;
+
+namespace {
+
+// 重新设计之前的 Ret：每个对象都带着 EGrp 和 Err 的字符串，仅用于对比开销
+template <class T> struct LegacyRet {
+    bool success = true;
+    T data{};
+    bool sysErr = false;
+    EGrp eGrp{};
+    Err err{};
+
+    LegacyRet() = default;
+
+    explicit LegacyRet(T data) : data(std::move(data)) {}
+
+    LegacyRet(bool success, bool sysErr, EGrp eGrp, Err err)
+        : success(success), sysErr(sysErr), eGrp(std::move(eGrp)), err(std::move(err)) {}
+
+    bool failed() const { return !success; }
+
+    static LegacyRet with(T data) { return LegacyRet(std::move(data)); }
+
+    static LegacyRet with(EGrp &eGrp, Err &err, std::string errMsg) {
+        err.msg = std::move(errMsg);
+        return LegacyRet(false, err.sysErr, eGrp, err);
+    }
+
+    template <typename S> static LegacyRet FailureTransfer(const LegacyRet<S> &source) {
+        return LegacyRet(source.success, source.sysErr, source.eGrp, source.err);
+    }
+};
+
+template <class T> const T &valueOf(const LegacyRet<T> &r) { return r.data; }
+
+template <class T> const T &valueOf(const Ret<T> &r) { return r.value(); }
+
+// 五层调用链，每层检查失败并向上透传；fail 为 true 时最内层带自定义消息失败
+template <template <class> class R> __attribute__((noinline)) R<int64_t> leaf(int64_t x, bool fail) {
+    if (fail) {
+        EGrp eGrp = EGrp::INTERNAL;
+        Err err = Err::FORMAT_ERR;
+        return R<int64_t>::with(eGrp, err, "bad input " + std::to_string(x));
+    }
+    return R<int64_t>::with(x + 1);
+}
+
+template <template <class> class R, int DEPTH> __attribute__((noinline)) R<int64_t> chain(int64_t x, bool fail) {
+    if constexpr (DEPTH == 0) {
+        return leaf<R>(x, fail);
+    } else {
+        auto inner = chain<R, DEPTH - 1>(x, fail);
+        if (inner.failed()) {
+            return R<int64_t>::FailureTransfer(std::move(inner));
+        }
+        return R<int64_t>::with(valueOf(inner) * 2);
+    }
+}
+
+template <template <class> class R> int64_t runChain(int64_t n, bool fail) {
+    int64_t sum = 0;
+    for (int64_t i = 0; i < n; i++) {
+        auto r = chain<R, 4>(i, fail);
+        sum += r.failed() ? 1 : valueOf(r);
+    }
+    return sum;
+}
+
+} // namespace
+
+TEST(RetTest, CompactLayout) {
+    EXPECT_EQ(sizeof(Ret<int64_t>), 16U);
+    EXPECT_EQ(sizeof(Ret<void *>), 16U);
+    EXPECT_EQ(sizeof(Ret<std::string>), sizeof(std::string) + 8);
+    EXPECT_GT(sizeof(LegacyRet<int64_t>), 100U);
+}
+
+TEST(RetTest, SuccessAndFailure) {
+    auto ok = Ret<std::string>::with("ok");
+    EXPECT_FALSE(ok.failed());
+    EXPECT_EQ(ok.value(), "ok");
+    EXPECT_EQ(ok.errCode(), 0);
+    EXPECT_TRUE(ok.message().empty());
+
+    auto plain = Ret<int32_t>::with(EGrp::INTERNAL, Err::QUEUE_FULL);
+    EXPECT_TRUE(plain.failed());
+    EXPECT_EQ(plain.errCode(), Err::QUEUE_FULL.code);
+    EXPECT_EQ(plain.message(), Err::QUEUE_FULL.msg);
+    EXPECT_EQ(plain.getEGrp().code, EGrp::INTERNAL.code);
+    EXPECT_FALSE(plain.sysErr());
+
+    auto custom = Ret<int32_t>::with(EGrp::INTERNAL, Err::IO_ERR, "open: No such file");
+    EXPECT_TRUE(custom.sysErr());
+    EXPECT_EQ(custom.getErr().msg, "open: No such file");
+    EXPECT_EQ(custom.getErr().semanticCode, "IO_ERR");
+    // 共享的静态 Err 不会被改写
+    EXPECT_EQ(Err::IO_ERR.msg, "system io call failed, please check errno");
+
+    // 拷贝和赋值各自持有消息
+    auto copy = custom;
+    custom = Ret<int32_t>::with(7);
+    EXPECT_EQ(copy.message(), "open: No such file");
+    EXPECT_EQ(custom.value(), 7);
+    auto moved = std::move(copy);
+    EXPECT_EQ(moved.message(), "open: No such file");
+    auto transferred = Ret<std::string>::FailureTransfer(moved);
+    EXPECT_EQ(transferred.errCode(), Err::IO_ERR.code);
+    EXPECT_EQ(transferred.message(), "open: No such file");
+}
+
+TEST(RetTest, MoveOnlyValue) {
+    auto ret = Ret<std::unique_ptr<int32_t>>::with(std::make_unique<int32_t>(5));
+    auto other = std::move(ret);
+    EXPECT_EQ(*other.value(), 5);
+    std::unique_ptr<int32_t> p = std::move(other).value();
+    EXPECT_EQ(*p, 5);
+    auto doubled = Ret<std::unique_ptr<int32_t>>::with(std::move(p)).map([](std::unique_ptr<int32_t> &&v) {
+        return *v * 2;
+    });
+    EXPECT_EQ(doubled.value(), 10);
+}
+
+TEST(RetTest, Monadic) {
+    auto parse = [](const std::string &s) -> Ret<int32_t> {
+        if (s.empty()) {
+            return Ret<int32_t>::with(EGrp::INTERNAL, Err::FORMAT_ERR, "empty input");
+        }
+        return Ret<int32_t>::with(std::stoi(s));
+    };
+    auto positive = [](int32_t v) {
+        return v > 0 ? Ret<int32_t>::with(v) : Ret<int32_t>::with(EGrp::INTERNAL, Err::VALIDATION_ERR);
+    };
+
+    auto good = Ret<std::string>::with("21").andThen(parse).andThen(positive).map([](int32_t v) { return v * 2.0; });
+    EXPECT_DOUBLE_EQ(good.value(), 42.0);
+
+    auto empty = Ret<std::string>::with("").andThen(parse).andThen(positive).map([](int32_t v) { return v * 2.0; });
+    EXPECT_TRUE(empty.failed());
+    EXPECT_EQ(empty.errCode(), Err::FORMAT_ERR.code);
+    EXPECT_EQ(empty.message(), "empty input");
+
+    auto negative = Ret<std::string>::with("-1").andThen(parse).andThen(positive);
+    EXPECT_EQ(negative.errCode(), Err::VALIDATION_ERR.code);
+    auto recovered = negative.orElse([](const Err &err) {
+        return Ret<int32_t>::with(err.code == Err::VALIDATION_ERR.code ? 0 : -1);
+    });
+    EXPECT_EQ(recovered.value(), 0);
+    EXPECT_EQ(good.orElse([](const Err &) { return Ret<double>::with(0); }).value(), 42.0);
+
+    int32_t seen = 0;
+    Ret<void *> done = Ret<int32_t>::with(3).map([&seen](int32_t v) { seen = v; });
+    EXPECT_FALSE(done.failed());
+    EXPECT_EQ(seen, 3);
+}
+
+TEST(RetTest, JsonWireFormat) {
+    auto ok = Ret<int32_t>::with(5);
+    EXPECT_EQ(toJson(ok), R"({"data":5,"eGrp":{"code":0,"semanticCode":""},"err":{"code":0,"msg":"","semanticCode":"","sysErr":false},"success":true,"sysErr":false})");
+    auto failed = Ret<int32_t>::with(EGrp::INTERNAL, Err::FORMAT_ERR, "bad");
+    const std::string wire = toJson(failed);
+    EXPECT_EQ(wire, R"({"data":0,"eGrp":{"code":-1,"semanticCode":"INTERNAL"},"err":{"code":1,"msg":"bad","semanticCode":"FORMAT_ERR","sysErr":false},"success":false,"sysErr":false})");
+
+    auto back = fromJson<Ret<int32_t>>(wire);
+    EXPECT_EQ(back.errorId(), failed.errorId());
+    EXPECT_EQ(back.message(), "bad");
+    EXPECT_EQ(fromJson<Ret<int32_t>>(toJson(ok)).value(), 5);
+
+    // 对端发来本进程没有登记过的错误码时原样保留 (code, semanticCode, msg)
+    auto remote = fromJson<Ret<int32_t>>(
+        R"({"data":0,"eGrp":{"code":9,"semanticCode":"REMOTE"},"err":{"code":1001,"msg":"remote failure","semanticCode":"REMOTE_ERR","sysErr":false},"success":false,"sysErr":false})");
+    EXPECT_EQ(remote.errCode(), 1001);
+    EXPECT_EQ(remote.getEGrp().semanticCode, "REMOTE");
+    EXPECT_EQ(remote.message(), "remote failure");
+    EXPECT_EQ(toJson(fromJson<Ret<int32_t>>(toJson(remote))), toJson(remote));
+}
+
+TEST(RetTest, ForeignErrorsAreNotRegistered) {
+    auto &registry = ErrRegistry::global();
+    // 错误码与本地的 VALIDATION_ERR 相同、名字不同：不抛异常，也不登记
+    const std::string clash =
+        R"({"data":0,"eGrp":{"code":-1,"semanticCode":"INTERNAL"},"err":{"code":4,"msg":"peer says no","semanticCode":"PEER_ERR","sysErr":false},"success":false,"sysErr":false})";
+    Ret<int32_t> peer;
+    ASSERT_NO_THROW(peer = fromJson<Ret<int32_t>>(clash));
+    EXPECT_TRUE(peer.failed());
+    EXPECT_EQ(peer.errorId(), ErrRegistry::UNKNOWN_ID);
+    EXPECT_EQ(peer.errCode(), 4);
+    EXPECT_EQ(peer.getErr().semanticCode, "PEER_ERR");
+    EXPECT_EQ(peer.message(), "peer says no");
+    // 错误组是认识的
+    EXPECT_EQ(peer.getEGrp().id, EGrp::INTERNAL.id);
+    EXPECT_EQ(registry.err(Err::VALIDATION_ERR.id).semanticCode, "VALIDATION_ERR");
+    Err probe;
+    probe.code = 4;
+    probe.semanticCode = "PEER_ERR";
+    EXPECT_EQ(registry.find(probe), 0);
+    EXPECT_EQ(toJson(peer), clash);
+    auto transferred = Ret<std::string>::FailureTransfer(peer);
+    EXPECT_EQ(transferred.getErr().semanticCode, "PEER_ERR");
+    EXPECT_EQ(toJson(Ret<int32_t>::FailureTransfer(transferred)), clash);
+
+    // 大量不同的未知错误码不会占满登记表
+    for (int32_t code = 100000; code < 100000 + 2 * ErrRegistry::MAX_IDS; code++) {
+        const std::string wire = R"({"data":0,"eGrp":{"code":77,"semanticCode":"PEER_GRP"},"err":{"code":)" +
+                                 std::to_string(code) + R"(,"msg":"m","semanticCode":"PEER_)" + std::to_string(code) +
+                                 R"(","sysErr":true},"success":false,"sysErr":true})";
+        auto r = fromJson<Ret<int32_t>>(wire);
+        ASSERT_EQ(r.errCode(), code);
+        ASSERT_TRUE(r.sysErr());
+        ASSERT_EQ(r.getEGrp().semanticCode, "PEER_GRP");
+    }
+    EXPECT_NO_THROW(Err(9100, "TEST_AFTER_FOREIGN", "still room"));
+}
+
+TEST(RetTest, Benchmark) {
+    constexpr int64_t N = 2000000;
+    using Clock = std::chrono::steady_clock;
+    auto ns = [](Clock::time_point start) {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count();
+    };
+    for (bool fail : {false, true}) {
+        auto start = Clock::now();
+        const int64_t legacy = runChain<LegacyRet>(N, fail);
+        const auto legacyNs = ns(start);
+        start = Clock::now();
+        const int64_t compact = runChain<Ret>(N, fail);
+        const auto compactNs = ns(start);
+        EXPECT_EQ(legacy, compact);
+        std::cout << (fail ? "失败路径" : "成功路径") << " 5 层调用链: 旧 Ret " << legacyNs / N << " ns/次, 新 Ret "
+                  << compactNs / N << " ns/次" << std::endl;
+    }
+}
@@ -0,0 +1,225 @@
+#include "gtest/gtest.h"
+
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <memory_resource>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "runtime/ShardRuntime.h"
+#include "util/Locked.hpp"
+
+using namespace rhino;
+using namespace std;
+using namespace std::chrono;
+
+static ShardRuntimeOptions withShards(size_t n) {
+    ShardRuntimeOptions options;
+    options.shards = n;
+    // 测试机器的核数不确定，不绑核
+    options.pin = false;
+    return options;
+}
+
+TEST(ShardRuntimeTest, SubmitToRunsOnTargetShard) {
+    ShardRuntime runtime(withShards(4));
+    ASSERT_EQ(runtime.size(), 4U);
+    EXPECT_EQ(runtime.currentShard(), -1);
+    for (size_t i = 0; i < runtime.size(); i++) {
+        auto ret = runtime.submit_to(i, [&runtime] { return runtime.currentShard(); }).get();
+        EXPECT_EQ(ret.value(), static_cast<int32_t>(i));
+    }
+
+    // 分片 0 上再向分片 1 提交并等待，分片 1 又回调分片 0：等待期间会处理信箱，不会死锁
+    auto nested = runtime.submit_to(0, [&runtime] {
+        return runtime
+            .submit_to(1,
+                       [&runtime] {
+                           auto back = runtime.submit_to(0, [&runtime] { return runtime.currentShard() * 10; });
+                           return back.get().value() + runtime.currentShard();
+                       })
+            .get()
+            .value();
+    });
+    EXPECT_EQ(nested.get().value(), 1);
+
+    // 分片自己的内存池
+    auto sum = runtime.submit_to(2, [&runtime] {
+        std::pmr::vector<int64_t> v(runtime.resource(2));
+        for (int64_t i = 0; i < 1000; i++) {
+            v.push_back(i);
+        }
+        int64_t s = 0;
+        for (auto x : v) {
+            s += x;
+        }
+        return s;
+    });
+    EXPECT_EQ(sum.get().value(), 999 * 1000 / 2);
+
+    runtime.stop();
+    EXPECT_TRUE(runtime.submit_to(0, [] { return 1; }).get().failed());
+    EXPECT_FALSE(runtime.post_to(0, [] {}));
+}
+
+TEST(ShardRuntimeTest, SubmitDuringStopCompletes) {
+    for (int32_t round = 0; round < 100; round++) {
+        ShardRuntime runtime(withShards(2));
+        constexpr int32_t SUBMITTERS = 4;
+        vector<vector<Future<int32_t>>> futures(SUBMITTERS);
+        atomic<int32_t> ready{0};
+        vector<thread> submitters;
+        for (int32_t t = 0; t < SUBMITTERS; t++) {
+            submitters.emplace_back([&, t] {
+                ready++;
+                for (int32_t i = 0; i < 1000; i++) {
+                    futures[t].push_back(runtime.submit_to(static_cast<size_t>(i) % 2, [i] { return i; }));
+                }
+            });
+        }
+        while (ready.load() < SUBMITTERS) {
+            std::this_thread::yield();
+        }
+        runtime.stop();
+        for (auto &s : submitters) {
+            s.join();
+        }
+        // 停止之前投递的执行完，之后的立即失败，不会有永远不完成的 Future
+        for (auto &list : futures) {
+            for (auto &f : list) {
+                ASSERT_TRUE(f.ready());
+                auto r = f.get();
+                if (r.failed()) {
+                    EXPECT_EQ(r.errCode(), Err::QUEUE_FULL.code);
+                }
+            }
+        }
+    }
+}
+
+TEST(ShardRuntimeTest, MailboxOrderingBetweenShards) {
+    ShardRuntime runtime(withShards(2));
+    constexpr int32_t N = 100000;
+    vector<int32_t> received;
+    received.reserve(N);
+    atomic<bool> done{false};
+    runtime.post_to(0, [&] {
+        for (int32_t i = 0; i < N; i++) {
+            // 信箱满时处理自己的消息退避，消息在信箱里保持顺序
+            while (!runtime.post_to(1, [&received, i] { received.push_back(i); })) {
+                runtime.pollOnce();
+            }
+        }
+        runtime.post_to(1, [&done] { done = true; });
+    });
+    while (!done) {
+        std::this_thread::yield();
+    }
+    ASSERT_EQ(received.size(), static_cast<size_t>(N));
+    size_t outOfOrder = 0;
+    for (int32_t i = 1; i < N; i++) {
+        outOfOrder += received[i] < received[i - 1];
+    }
+    // 溢出到 MPMC 队列的消息可能乱序，但绝大部分应当有序
+    EXPECT_LT(outOfOrder, static_cast<size_t>(N / 10));
+}
+
+// KV 微基准：80% 读 20% 写，key 均匀分布
+TEST(ShardRuntimeTest, Benchmark) {
+    const size_t threads = std::max(2U, std::thread::hardware_concurrency());
+    constexpr size_t OPS_PER_THREAD = 200000;
+    constexpr uint64_t KEYS = 1 << 20;
+
+    // 对照组：std::mutex 保护的全局 unordered_map
+    Locked<unordered_map<uint64_t, uint64_t>> locked;
+    atomic<uint64_t> hits{0};
+    auto start = steady_clock::now();
+    {
+        vector<thread> workers;
+        for (size_t t = 0; t < threads; t++) {
+            workers.emplace_back([&, t] {
+                mt19937_64 rng(t);
+                uint64_t localHits = 0;
+                for (size_t i = 0; i < OPS_PER_THREAD; i++) {
+                    uint64_t key = rng() % KEYS;
+                    bool write = rng() % 5 == 0;
+                    locked([&](unordered_map<uint64_t, uint64_t> &m) {
+                        if (write) {
+                            m[key] = i;
+                        } else {
+                            localHits += m.count(key);
+                        }
+                    });
+                }
+                hits += localHits;
+            });
+        }
+        for (auto &w : workers) {
+            w.join();
+        }
+    }
+    auto lockedNs = duration_cast<nanoseconds>(steady_clock::now() - start).count();
+
+    // 分片：每个分片拥有 key % shards 对应的子表，其他分片的 key 通过信箱发给所属分片
+    ShardRuntime runtime(withShards(threads));
+    using Map = std::pmr::unordered_map<uint64_t, uint64_t>;
+    vector<Map *> maps(threads);
+    for (size_t s = 0; s < threads; s++) {
+        maps[s] = runtime.submit_to(s, [&runtime, s] { return new Map(runtime.resource(s)); }).get().value();
+    }
+    atomic<uint64_t> completed{0};
+    atomic<uint64_t> shardHits{0};
+    start = steady_clock::now();
+    vector<Future<void *>> generators;
+    for (size_t s = 0; s < threads; s++) {
+        generators.push_back(runtime.submit_to(s, [&, s] {
+            mt19937_64 rng(s);
+            uint64_t localDone = 0;
+            for (size_t i = 0; i < OPS_PER_THREAD; i++) {
+                uint64_t key = rng() % KEYS;
+                bool write = rng() % 5 == 0;
+                size_t owner = key % threads;
+                if (owner == s) {
+                    if (write) {
+                        (*maps[s])[key] = i;
+                    } else {
+                        shardHits.fetch_add(maps[s]->count(key), std::memory_order_relaxed);
+                    }
+                    localDone++;
+                    continue;
+                }
+                auto op = [&, key, write, owner, i] {
+                    if (write) {
+                        (*maps[owner])[key] = i;
+                    } else {
+                        shardHits.fetch_add(maps[owner]->count(key), std::memory_order_relaxed);
+                    }
+                    completed.fetch_add(1, std::memory_order_relaxed);
+                };
+                while (!runtime.post_to(owner, op)) {
+                    runtime.pollOnce();
+                }
+            }
+            completed.fetch_add(localDone, std::memory_order_relaxed);
+        }));
+    }
+    for (auto &g : generators) {
+        EXPECT_FALSE(g.get().failed());
+    }
+    while (completed.load() < threads * OPS_PER_THREAD) {
+        std::this_thread::yield();
+    }
+    auto shardNs = duration_cast<nanoseconds>(steady_clock::now() - start).count();
+    for (size_t s = 0; s < threads; s++) {
+        EXPECT_FALSE(runtime.submit_to(s, [&maps, s] { delete maps[s]; }).get().failed());
+    }
+
+    const double totalOps = static_cast<double>(threads * OPS_PER_THREAD);
+    std::cout << threads << " 线程/分片, 每个 " << OPS_PER_THREAD << " 次操作" << std::endl;
+    std::cout << "mutex + unordered_map: " << totalOps / static_cast<double>(lockedNs) * 1000 << " Mops/s" << std::endl;
+    std::cout << "分片 + SPSC 信箱: " << totalOps / static_cast<double>(shardNs) * 1000 << " Mops/s" << std::endl;
+}
@@ -0,0 +1,200 @@
+#include "gtest/gtest.h"
+
+#include <chrono>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "util/InlineFunction.hpp"
+#include "util/SmallVector.hpp"
+#include "util/StringUtil.hpp"
+
+using namespace rhino;
+using namespace std;
+
+namespace {
+
+// 记录构造/析构次数，检查元素没有泄漏或重复析构
+struct Tracked {
+    static int32_t alive;
+    std::string value;
+
+    explicit Tracked(std::string v = "") : value(std::move(v)) { alive++; }
+    Tracked(const Tracked &other) : value(other.value) { alive++; }
+    Tracked(Tracked &&other) noexcept : value(std::move(other.value)) { alive++; }
+    Tracked &operator=(const Tracked &) = default;
+    Tracked &operator=(Tracked &&) noexcept = default;
+    ~Tracked() { alive--; }
+};
+
+int32_t Tracked::alive = 0;
+
+} // namespace
+
+TEST(SmallVectorTest, InlineThenSpill) {
+    SmallVector<int32_t, 4> v;
+    EXPECT_TRUE(v.isInline());
+    for (int32_t i = 0; i < 4; i++) {
+        v.push_back(i);
+    }
+    EXPECT_TRUE(v.isInline());
+    EXPECT_EQ(v.capacity(), 4U);
+    v.push_back(4);
+    EXPECT_FALSE(v.isInline());
+    EXPECT_EQ(v.size(), 5U);
+    for (int32_t i = 0; i < 5; i++) {
+        EXPECT_EQ(v[i], i);
+    }
+
+    // 参数引用自身元素时扩容也是安全的
+    SmallVector<std::string, 2> s{"a", "b"};
+    s.push_back(s[0]);
+    EXPECT_EQ(s.back(), "a");
+
+    v.erase(v.begin() + 1, v.begin() + 3);
+    EXPECT_EQ(v, (SmallVector<int32_t, 4>{0, 3, 4}));
+    v.insert(v.begin(), -1);
+    EXPECT_EQ(v, (SmallVector<int32_t, 4>{-1, 0, 3, 4}));
+    v.resize(2);
+    EXPECT_EQ(v, (SmallVector<int32_t, 4>{-1, 0}));
+    EXPECT_THROW(v.at(2), std::out_of_range);
+}
+
+TEST(SmallVectorTest, CopyMoveAndLifetimes) {
+    {
+        SmallVector<Tracked, 2> a;
+        a.emplace_back("x");
+        a.emplace_back("y");
+        SmallVector<Tracked, 2> inlineMoved(std::move(a));
+        EXPECT_TRUE(a.empty());
+        EXPECT_EQ(inlineMoved[1].value, "y");
+        EXPECT_EQ(Tracked::alive, 2);
+
+        inlineMoved.emplace_back("z");
+        const Tracked *heap = inlineMoved.data();
+        SmallVector<Tracked, 2> heapMoved;
+        heapMoved = std::move(inlineMoved);
+        // 堆上的元素直接转移，不搬迁
+        EXPECT_EQ(heapMoved.data(), heap);
+        EXPECT_TRUE(inlineMoved.isInline());
+
+        SmallVector<Tracked, 2> copy = heapMoved;
+        EXPECT_EQ(copy[2].value, "z");
+        EXPECT_EQ(Tracked::alive, 6);
+        copy.pop_back();
+        copy.clear();
+        EXPECT_EQ(Tracked::alive, 3);
+    }
+    EXPECT_EQ(Tracked::alive, 0);
+
+    // 只能移动的元素
+    SmallVector<std::unique_ptr<int32_t>, 1> owned;
+    owned.push_back(std::make_unique<int32_t>(1));
+    owned.push_back(std::make_unique<int32_t>(2));
+    EXPECT_EQ(*owned[1], 2);
+
+    static_assert(IsTriviallyRelocatable<int32_t>::value);
+    static_assert(!IsTriviallyRelocatable<std::string>::value);
+}
+
+TEST(SmallVectorTest, SplitView) {
+    const std::string s = "a,bb,,ccc";
+    auto parts = splitView(s, ",");
+    ASSERT_EQ(parts.size(), 4U);
+    EXPECT_TRUE(parts.isInline());
+    EXPECT_EQ(parts[1], "bb");
+    EXPECT_EQ(parts[2], "");
+    EXPECT_EQ(parts[3].data(), s.data() + 6);
+    EXPECT_EQ(splitView<2>("1.2.3", ".").size(), 3U);
+    EXPECT_EQ(splitView("abc", "--").size(), 1U);
+}
+
+TEST(InlineFunctionTest, CallMoveAndReset) {
+    InlineFunction<int32_t(int32_t)> empty;
+    EXPECT_FALSE(empty);
+    EXPECT_THROW(empty(1), std::bad_function_call);
+
+    int32_t base = 10;
+    InlineFunction<int32_t(int32_t)> add = [base](int32_t x) { return base + x; };
+    EXPECT_TRUE(add);
+    EXPECT_EQ(add(5), 15);
+
+    // 只能移动的捕获，不平凡可重定位，经 relocate 函数搬迁
+    auto counter = std::make_shared<int32_t>(0);
+    InlineFunction<void()> f = [p = std::make_unique<int32_t>(3), counter] { *counter += *p; };
+    InlineFunction<void()> g = std::move(f);
+    EXPECT_FALSE(f);
+    g();
+    g();
+    EXPECT_EQ(*counter, 6);
+    EXPECT_EQ(counter.use_count(), 2);
+    g = nullptr;
+    EXPECT_EQ(counter.use_count(), 1);
+
+    // 可变状态的 lambda
+    InlineFunction<int32_t(), 16> next = [n = 0]() mutable { return ++n; };
+    next();
+    EXPECT_EQ(next(), 2);
+    static_assert(InlineFunction<void(), 16>::capacity() == 16);
+}
+
+TEST(SmallVectorTest, Benchmark) {
+    constexpr int32_t N = 1000000;
+    const std::string line = "GET,/api/v1/users,200,12ms";
+    size_t total = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int32_t i = 0; i < N; i++) {
+        total += split(line, ",").size();
+    }
+    auto splitNs = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+    start = std::chrono::steady_clock::now();
+    for (int32_t i = 0; i < N; i++) {
+        total += splitView(line, ",").size();
+    }
+    auto viewNs = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+
+    start = std::chrono::steady_clock::now();
+    for (int32_t i = 0; i < N; i++) {
+        std::vector<int32_t> v;
+        for (int32_t j = 0; j < 6; j++) {
+            v.push_back(i + j);
+        }
+        total += v.size();
+    }
+    auto vectorNs = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+    start = std::chrono::steady_clock::now();
+    for (int32_t i = 0; i < N; i++) {
+        SmallVector<int32_t, 8> v;
+        for (int32_t j = 0; j < 6; j++) {
+            v.push_back(i + j);
+        }
+        total += v.size();
+    }
+    auto smallNs = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+
+    // 捕获超过 std::function 小对象缓冲（libstdc++ 为 16 字节）的 lambda
+    int64_t a = 1, b = 2, c = 3;
+    start = std::chrono::steady_clock::now();
+    for (int32_t i = 0; i < N; i++) {
+        std::function<int64_t(int64_t)> fn = [a, b, c](int64_t x) { return a + b + c + x; };
+        std::function<int64_t(int64_t)> moved = std::move(fn);
+        total += static_cast<size_t>(moved(i));
+    }
+    auto functionNs = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+    start = std::chrono::steady_clock::now();
+    for (int32_t i = 0; i < N; i++) {
+        InlineFunction<int64_t(int64_t)> fn = [a, b, c](int64_t x) { return a + b + c + x; };
+        InlineFunction<int64_t(int64_t)> moved = std::move(fn);
+        total += static_cast<size_t>(moved(i));
+    }
+    auto inlineNs = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << "split: " << static_cast<double>(splitNs) / N << " ns/次, splitView: "
+              << static_cast<double>(viewNs) / N << " ns/次" << std::endl;
+    std::cout << "std::vector: " << static_cast<double>(vectorNs) / N << " ns/次, SmallVector: "
+              << static_cast<double>(smallNs) / N << " ns/次" << std::endl;
+    std::cout << "std::function: " << static_cast<double>(functionNs) / N << " ns/次, InlineFunction: "
+              << static_cast<double>(inlineNs) / N << " ns/次 (total=" << total << ")" << std::endl;
+}
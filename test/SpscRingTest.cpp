@@ -0,0 +1,186 @@
+#include "gtest/gtest.h"
+
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <pthread.h>
+#include <sched.h>
+#include <string>
+#include <thread>
+
+#include "boost/lockfree/spsc_queue.hpp"
+
+#include "util/CpuUtil.hpp"
+#include "util/SpscRing.hpp"
+
+using namespace rhino;
+using namespace std;
+using namespace std::chrono;
+
+TEST(SpscRingTest, PushPop) {
+    SpscRing<std::string, 4> ring;
+    EXPECT_TRUE(ring.tryEmplace(3, 'a'));
+    EXPECT_FALSE(ring.tryPush(std::string("b")).failed());
+    EXPECT_TRUE(ring.tryEmplace("c"));
+    EXPECT_TRUE(ring.tryEmplace("d"));
+    auto full = ring.tryPush(std::string("e"));
+    EXPECT_TRUE(full.failed());
+    EXPECT_EQ(full.getErr().code, Err::QUEUE_FULL.code);
+
+    ASSERT_NE(ring.front(), nullptr);
+    EXPECT_EQ(*ring.front(), "aaa");
+    ring.pop();
+    std::string out;
+    EXPECT_TRUE(ring.tryPop(out));
+    EXPECT_EQ(out, "b");
+    EXPECT_EQ(ring.tryPop().value(), "c");
+    EXPECT_EQ(ring.tryPop().value(), "d");
+    EXPECT_EQ(ring.tryPop().getErr().code, Err::QUEUE_EMPTY.code);
+}
+
+TEST(SpscRingTest, ClaimCommitWrapsAround) {
+    SpscRing<int, 8> ring;
+    for (int round = 0; round < 10; round++) {
+        auto w = ring.claimWrite(5);
+        for (size_t i = 0; i < w.count; i++) {
+            new (&w.data[i]) int(round * 10 + static_cast<int>(i));
+        }
+        ring.commitWrite(w.count);
+
+        size_t read = 0;
+        while (read < w.count) {
+            auto r = ring.claimRead(8);
+            ASSERT_GT(r.count, 0U);
+            for (size_t i = 0; i < r.count; i++) {
+                EXPECT_EQ(r.data[i], round * 10 + static_cast<int>(read + i));
+            }
+            read += r.count;
+            ring.commitRead(r.count);
+        }
+        EXPECT_TRUE(ring.empty());
+    }
+}
+
+TEST(SpscRingTest, ProducerConsumerBatch) {
+    constexpr int64_t TOTAL = 1000000;
+    auto ring = std::make_unique<SpscRing<int64_t, 1024>>();
+    int64_t sum = 0;
+    thread consumer([&ring, &sum] {
+        int64_t received = 0;
+        while (received < TOTAL) {
+            auto r = ring->claimRead(64);
+            if (r.count == 0) {
+                std::this_thread::yield();
+                continue;
+            }
+            for (size_t i = 0; i < r.count; i++) {
+                sum += r.data[i];
+            }
+            received += static_cast<int64_t>(r.count);
+            ring->commitRead(r.count);
+        }
+    });
+    for (int64_t i = 0; i < TOTAL;) {
+        auto w = ring->claimWrite(64);
+        if (w.count == 0) {
+            std::this_thread::yield();
+            continue;
+        }
+        // 最后一批可能用不完申请到的槽位，只发布写过的
+        size_t written = 0;
+        for (; written < w.count && i < TOTAL; written++, i++) {
+            w.data[written] = i;
+        }
+        ring->commitWrite(written);
+    }
+    consumer.join();
+    EXPECT_EQ(sum, TOTAL * (TOTAL - 1) / 2);
+}
+
+static void pinTo(unsigned cpu) {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+}
+
+// 只有一个核时自旋等待对方毫无意义，退化为 yield
+static void waitABit(bool singleCore) {
+    if (singleCore) {
+        std::this_thread::yield();
+    } else {
+        cpuRelax();
+    }
+}
+
+/**
+ * 乒乓延迟：两个线程分别绑在两个核上，一来一回为一次往返，单程交接时间 = 往返 / 2
+ */
+template <typename Send, typename Recv>
+static double pingPongNanos(int64_t rounds, Send send, Recv recv) {
+    const bool singleCore = std::thread::hardware_concurrency() < 2;
+    thread echo([&] {
+        if (!singleCore) {
+            pinTo(1);
+        }
+        for (int64_t i = 0; i < rounds; i++) {
+            int64_t v;
+            while (!recv(1, v)) {
+                waitABit(singleCore);
+            }
+            while (!send(1, v)) {
+                waitABit(singleCore);
+            }
+        }
+    });
+    // 主线程测完要恢复原来的亲和性，否则之后的用例和它们创建的线程都只能跑在 0 号核上
+    cpu_set_t saved;
+    const bool restore = !singleCore && pthread_getaffinity_np(pthread_self(), sizeof(saved), &saved) == 0;
+    if (!singleCore) {
+        pinTo(0);
+    }
+    auto start = high_resolution_clock::now();
+    for (int64_t i = 0; i < rounds; i++) {
+        while (!send(0, i)) {
+            waitABit(singleCore);
+        }
+        int64_t v;
+        while (!recv(0, v)) {
+            waitABit(singleCore);
+        }
+    }
+    auto ns = duration_cast<nanoseconds>(high_resolution_clock::now() - start).count();
+    echo.join();
+    if (restore) {
+        pthread_setaffinity_np(pthread_self(), sizeof(saved), &saved);
+    }
+    return static_cast<double>(ns) / static_cast<double>(rounds) / 2;
+}
+
+TEST(SpscRingTest, PingPongBenchmark) {
+    const int64_t rounds = std::thread::hardware_concurrency() < 2 ? 20000 : 1000000;
+    cpu_set_t before;
+    ASSERT_EQ(pthread_getaffinity_np(pthread_self(), sizeof(before), &before), 0);
+
+    // side 0 发送到 ping、从 pong 接收；side 1 反之
+    auto ping = std::make_unique<SpscRing<int64_t, 1024>>();
+    auto pong = std::make_unique<SpscRing<int64_t, 1024>>();
+    auto rhinoNs = pingPongNanos(
+        rounds,
+        [&](int side, int64_t v) { return (side == 0 ? *ping : *pong).tryEmplace(v); },
+        [&](int side, int64_t &v) { return (side == 0 ? *pong : *ping).tryPop(v); });
+
+    boost::lockfree::spsc_queue<int64_t, boost::lockfree::capacity<1024>> bPing;
+    boost::lockfree::spsc_queue<int64_t, boost::lockfree::capacity<1024>> bPong;
+    auto boostNs = pingPongNanos(
+        rounds, [&](int side, int64_t v) { return (side == 0 ? bPing : bPong).push(v); },
+        [&](int side, int64_t &v) { return (side == 0 ? bPong : bPing).pop(v); });
+
+    // 测完恢复了主线程的亲和性
+    cpu_set_t after;
+    ASSERT_EQ(pthread_getaffinity_np(pthread_self(), sizeof(after), &after), 0);
+    EXPECT_TRUE(CPU_EQUAL(&before, &after));
+
+    std::cout << "单程交接延迟: SpscRing " << rhinoNs << " ns, boost::lockfree::spsc_queue "
+              << boostNs << " ns" << std::endl;
+}
@@ -0,0 +1,255 @@
+#include "gtest/gtest.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <map>
+#include <queue>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "runtime/TimerWheel.h"
+#include "util/Locked.hpp"
+
+using namespace rhino;
+using namespace std;
+using namespace std::chrono;
+
+struct TestTimer : public TimerNode {
+    uint64_t id = 0;
+    uint64_t firedAt = 0;
+    int32_t fired = 0;
+};
+
+TEST(TimerWheelTest, FiresAtExactTick) {
+    TimerWheel wheel(1000);
+    mt19937_64 rng(3);
+    constexpr size_t N = 20000;
+    vector<TestTimer> timers(N);
+    multimap<uint64_t, size_t> expected;
+    for (size_t i = 0; i < N; i++) {
+        timers[i].id = i;
+        // 覆盖各层：0 ~ 2^26 个 tick
+        uint64_t delay = rng() % (uint64_t(1) << (rng() % 27));
+        wheel.schedule(timers[i], wheel.now() + delay);
+        expected.emplace(timers[i].expireTick(), i);
+    }
+    // 随机取消一部分
+    for (size_t i = 0; i < N; i += 7) {
+        EXPECT_TRUE(wheel.cancel(timers[i]));
+        EXPECT_FALSE(wheel.cancel(timers[i]));
+    }
+    EXPECT_EQ(wheel.size(), N - (N + 6) / 7);
+
+    uint64_t tick = wheel.now();
+    const uint64_t end = tick + (uint64_t(1) << 26) + 10;
+    size_t fired = 0;
+    while (tick < end) {
+        // 步长随机，既有逐 tick 推进也有大段跳跃
+        tick = std::min(end, tick + 1 + rng() % (rng() % 4 == 0 ? 100000 : 70));
+        fired += wheel.advance(tick, [&wheel](TimerNode *const *nodes, size_t count) {
+            for (size_t i = 0; i < count; i++) {
+                auto *t = static_cast<TestTimer *>(nodes[i]);
+                EXPECT_FALSE(t->scheduled());
+                t->fired++;
+                t->firedAt = wheel.now();
+            }
+        });
+    }
+    EXPECT_EQ(fired, N - (N + 6) / 7);
+    EXPECT_TRUE(wheel.empty());
+    for (auto &[expire, i] : expected) {
+        if (i % 7 == 0) {
+            EXPECT_EQ(timers[i].fired, 0);
+        } else {
+            ASSERT_EQ(timers[i].fired, 1) << i;
+            ASSERT_EQ(timers[i].firedAt, expire) << i;
+        }
+    }
+}
+
+TEST(TimerWheelTest, RescheduleAndLifetime) {
+    TimerWheel wheel;
+    int32_t count = 0;
+    // 回调里重新调度自己：每 10 个 tick 触发一次
+    FunctionTimer periodic([&wheel, &count](TimerNode &self) {
+        count++;
+        wheel.scheduleAfter(self, 10);
+    });
+    wheel.scheduleAfter(periodic, 10);
+    wheel.advance(100);
+    EXPECT_EQ(count, 10);
+    EXPECT_TRUE(periodic.scheduled());
+
+    // 已经过期的时间在下一个 tick 触发
+    TestTimer late;
+    wheel.schedule(late, 5);
+    EXPECT_EQ(late.expireTick(), 101U);
+
+    // 重新调度会移动位置
+    wheel.schedule(late, 5000);
+    EXPECT_EQ(wheel.advance(200), 10U);
+    EXPECT_TRUE(late.scheduled());
+
+    // 超出范围的定时器先挂在最高层，最终在正确的 tick 触发
+    TimerWheel far;
+    TestTimer huge;
+    const uint64_t expire = TimerWheel::MAX_DELTA * 2 + 12345;
+    far.schedule(huge, expire);
+    far.advance(expire - 1);
+    EXPECT_TRUE(huge.scheduled());
+    far.advance(expire);
+    EXPECT_FALSE(huge.scheduled());
+
+    // 节点析构时自动摘除
+    {
+        TestTimer scoped;
+        wheel.scheduleAfter(scoped, 3);
+        EXPECT_EQ(wheel.size(), 3U);
+    }
+    EXPECT_EQ(wheel.size(), 2U);
+    EXPECT_TRUE(wheel.cancel(periodic));
+}
+
+TEST(TimerWheelTest, TicksUntilNext) {
+    TimerWheel wheel(10);
+    EXPECT_EQ(wheel.ticksUntilNext(1000), 1000U);
+    TestTimer t;
+    wheel.schedule(t, 15);
+    EXPECT_EQ(wheel.ticksUntilNext(1000), 5U);
+    wheel.schedule(t, 500);
+    // 在第 1 层上，第 0 层为空，下一次需要醒来的是该槽重新分配的 tick（448）
+    EXPECT_EQ(wheel.ticksUntilNext(1000), 438U);
+    wheel.advance(447);
+    EXPECT_EQ(wheel.ticksUntilNext(1000), 1U);
+    wheel.advance(448);
+    EXPECT_EQ(wheel.ticksUntilNext(1000), 52U);
+}
+
+TEST(TimerWheelTest, TscTickSource) {
+    TscTickSource source(1000000);
+    EXPECT_EQ(source.toTicks(milliseconds(5)), 5U);
+    EXPECT_EQ(source.toTicks(microseconds(5001)), 6U);
+    uint64_t start = source.now();
+    std::this_thread::sleep_for(milliseconds(30));
+    uint64_t elapsed = source.now() - start;
+    EXPECT_GE(elapsed, 25U);
+    EXPECT_LE(elapsed, 200U);
+}
+
+TEST(TimerWheelTest, Sharded) {
+    constexpr size_t SHARDS = 4;
+    constexpr size_t PER_THREAD = 20000;
+    ShardedTimerWheel wheel(SHARDS);
+    atomic<size_t> fired{0};
+    struct CountingTimer : public TimerNode {
+        atomic<size_t> *fired = nullptr;
+        void onExpire() noexcept override { fired->fetch_add(1, std::memory_order_relaxed); }
+    };
+    vector<vector<CountingTimer>> timers(SHARDS);
+    atomic<bool> stop{false};
+    atomic<uint64_t> now{0};
+
+    // 一个线程推进所有分片，其他线程各自调度/取消
+    thread ticker([&] {
+        while (!stop.load()) {
+            wheel.advanceAll(now.fetch_add(1) + 1);
+        }
+    });
+    vector<thread> producers;
+    atomic<size_t> cancelled{0};
+    for (size_t p = 0; p < SHARDS; p++) {
+        timers[p] = vector<CountingTimer>(PER_THREAD);
+        producers.emplace_back([&, p] {
+            mt19937_64 rng(p);
+            for (size_t i = 0; i < PER_THREAD; i++) {
+                timers[p][i].fired = &fired;
+                wheel.schedule(timers[p][i], now.load() + 1 + rng() % 2000);
+                if (i >= 10 && rng() % 4 == 0 && wheel.cancel(timers[p][i - 10])) {
+                    cancelled++;
+                }
+            }
+        });
+    }
+    for (auto &t : producers) {
+        t.join();
+    }
+    while (wheel.size() > 0) {
+        std::this_thread::yield();
+    }
+    stop = true;
+    ticker.join();
+    EXPECT_EQ(fired.load() + cancelled.load(), SHARDS * PER_THREAD);
+}
+
+TEST(TimerWheelTest, Benchmark) {
+    constexpr size_t N = 1000000;
+    mt19937_64 rng(11);
+    vector<uint64_t> delays(N);
+    for (auto &d : delays) {
+        // 请求超时：大部分在几秒内，少量长时间的会话过期
+        d = rng() % 10 == 0 ? 60000 + rng() % 3600000 : 100 + rng() % 5000;
+    }
+
+    // 时间轮：调度 N 个，取消一半（请求正常完成），剩余的推进到全部到期
+    vector<TestTimer> timers(N);
+    TimerWheel wheel;
+    auto start = high_resolution_clock::now();
+    for (size_t i = 0; i < N; i++) {
+        wheel.schedule(timers[i], delays[i]);
+    }
+    auto scheduled = high_resolution_clock::now();
+    for (size_t i = 0; i < N; i += 2) {
+        wheel.cancel(timers[i]);
+    }
+    auto cancelledAt = high_resolution_clock::now();
+    size_t fired = 0;
+    for (uint64_t tick = 1; !wheel.empty(); tick += 1) {
+        fired += wheel.advance(tick, [](TimerNode *const *, size_t) {});
+    }
+    auto end = high_resolution_clock::now();
+    EXPECT_EQ(fired, N / 2);
+
+    // 对照组：Locked<priority_queue>，取消只能打标记，到期时跳过
+    struct Entry {
+        uint64_t expire;
+        size_t id;
+        bool operator>(const Entry &o) const { return expire > o.expire; }
+    };
+    using Heap = priority_queue<Entry, vector<Entry>, greater<Entry>>;
+    Locked<Heap> heap;
+    vector<uint8_t> cancelFlags(N, 0);
+    auto hstart = high_resolution_clock::now();
+    for (size_t i = 0; i < N; i++) {
+        heap([&](Heap &q) { q.push(Entry{delays[i], i}); });
+    }
+    auto hscheduled = high_resolution_clock::now();
+    for (size_t i = 0; i < N; i += 2) {
+        cancelFlags[i] = 1;
+    }
+    auto hcancelled = high_resolution_clock::now();
+    size_t hfired = 0;
+    bool empty = false;
+    for (uint64_t tick = 1; !empty; tick += 1) {
+        heap([&](Heap &q) {
+            while (!q.empty() && q.top().expire <= tick) {
+                hfired += cancelFlags[q.top().id] == 0;
+                q.pop();
+            }
+            empty = q.empty();
+        });
+    }
+    auto hend = high_resolution_clock::now();
+    EXPECT_EQ(hfired, N / 2);
+
+    auto perOp = [](auto a, auto b, size_t n) {
+        return duration_cast<nanoseconds>(b - a).count() / static_cast<int64_t>(n);
+    };
+    std::cout << "时间轮: 调度 " << perOp(start, scheduled, N) << " ns/个, 取消 " << perOp(scheduled, cancelledAt, N / 2)
+              << " ns/个, 推进到期 " << duration_cast<milliseconds>(end - cancelledAt).count() << " ms" << std::endl;
+    std::cout << "Locked<priority_queue>: 调度 " << perOp(hstart, hscheduled, N) << " ns/个, 取消(打标记) "
+              << perOp(hscheduled, hcancelled, N / 2) << " ns/个, 推进到期 "
+              << duration_cast<milliseconds>(hend - hcancelled).count() << " ms" << std::endl;
+}
@@ -0,0 +1,173 @@
+#include "gtest/gtest.h"
+
+#include <cerrno>
+#include <filesystem>
+#include <fstream>
+#include <pthread.h>
+#include <sched.h>
+#include <string>
+#include <sys/mman.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+#include "config/PlacementConfig.h"
+#include "runtime/Topology.h"
+
+using namespace rhino;
+using namespace std;
+
+namespace fs = std::filesystem;
+
+TEST(TopologyTest, ParseCpuList) {
+    EXPECT_EQ(topology::parseCpuList("0-3,8,10-11\n"), (vector<int32_t>{0, 1, 2, 3, 8, 10, 11}));
+    EXPECT_EQ(topology::parseCpuList("5"), (vector<int32_t>{5}));
+    EXPECT_EQ(topology::parseCpuList("x,2-1,3"), (vector<int32_t>{3}));
+    EXPECT_TRUE(topology::parseCpuList("").empty());
+}
+
+TEST(TopologyTest, DiscoverFakeSysfs) {
+    // 2 个 NUMA 节点，每个节点 2 个物理核，每核 2 个超线程：cpu i 与 i+4 是兄弟；每个节点一个 L3
+    fs::path root = fs::temp_directory_path() / "rhino-fake-cpu";
+    fs::remove_all(root);
+    fs::create_directories(root);
+    std::ofstream(root / "online") << "0-7\n";
+    for (int32_t cpu = 0; cpu < 8; cpu++) {
+        const int32_t node = (cpu % 4) / 2;
+        fs::path dir = root / ("cpu" + std::to_string(cpu));
+        fs::create_directories(dir / "topology");
+        std::ofstream(dir / "topology" / "core_id") << (cpu % 4) << "\n";
+        std::ofstream(dir / "topology" / "physical_package_id") << node << "\n";
+        fs::create_directories(dir / ("node" + std::to_string(node)));
+        fs::create_directories(dir / "cache" / "index0");
+        std::ofstream(dir / "cache" / "index0" / "level") << "1\n";
+        fs::create_directories(dir / "cache" / "index3");
+        std::ofstream(dir / "cache" / "index3" / "level") << "3\n";
+        std::ofstream(dir / "cache" / "index3" / "shared_cpu_list")
+            << (node == 0 ? "0-1,4-5\n" : "2-3,6-7\n");
+    }
+
+    auto cpus = topology::discover(root.string());
+    ASSERT_EQ(cpus.size(), 8U);
+    EXPECT_EQ(cpus[5].core, 1);
+    EXPECT_EQ(cpus[5].node, 0);
+    EXPECT_EQ(cpus[6].node, 1);
+    EXPECT_EQ(cpus[6].l3, 2);
+    EXPECT_EQ(topology::physicalCores(cpus), 4U);
+    EXPECT_EQ(topology::numaNodes(cpus), 2U);
+    EXPECT_EQ(topology::siblingsOf(cpus, 1), (vector<int32_t>{1, 5}));
+    EXPECT_EQ(topology::l3DomainOf(cpus, 7), (vector<int32_t>{2, 3, 6, 7}));
+    EXPECT_EQ(topology::cpusOfNode(cpus, 0), (vector<int32_t>{0, 1, 4, 5}));
+    EXPECT_EQ(topology::nodeOfCpu(cpus, 3), 1);
+    EXPECT_EQ(topology::nodeOfCpu(cpus, 42), -1);
+
+    // 4 个分片：每个物理核一个，节点 0 的在前
+    auto picked = topology::pickShardCpus(cpus, 4);
+    ASSERT_EQ(picked.size(), 4U);
+    EXPECT_EQ(picked[0].cpu, 0);
+    EXPECT_EQ(picked[1].cpu, 1);
+    EXPECT_EQ(picked[2].cpu, 2);
+    EXPECT_EQ(picked[3].cpu, 3);
+    // 6 个分片：用上两个超线程兄弟，仍按节点聚集
+    picked = topology::pickShardCpus(cpus, 6);
+    vector<int32_t> nodes;
+    for (auto &c : picked) {
+        nodes.push_back(c.node);
+    }
+    EXPECT_EQ(nodes, (vector<int32_t>{0, 0, 0, 0, 1, 1}));
+
+    // 目录不存在时退化为扁平拓扑
+    EXPECT_FALSE(topology::discover((root / "missing").string()).empty());
+    fs::remove_all(root);
+}
+
+TEST(TopologyTest, PinAndNameCurrentThread) {
+    auto cpus = topology::discover();
+    const int32_t target = cpus.back().cpu;
+    std::thread t([target] {
+        ASSERT_FALSE(topology::pinCurrentThread(target).failed());
+        EXPECT_EQ(sched_getcpu(), target);
+        EXPECT_TRUE(topology::pinCurrentThread(-1).failed());
+
+        ASSERT_FALSE(topology::nameCurrentThread("rhino-topology-test-7").failed());
+        char name[16] = {};
+        pthread_getname_np(pthread_self(), name, sizeof(name));
+        EXPECT_STREQ(name, "topology-test-7");
+    });
+    t.join();
+}
+
+TEST(TopologyTest, SchedulingAndMemoryPolicy) {
+    std::thread t([] {
+        // 降级到 BATCH 不需要特权
+        ASSERT_FALSE(topology::scheduleCurrentThread(topology::SchedPolicy::BATCH).failed());
+        EXPECT_EQ(sched_getscheduler(0), SCHED_BATCH);
+        ASSERT_FALSE(topology::scheduleCurrentThread(topology::SchedPolicy::OTHER).failed());
+
+        // 容器里 set_mempolicy/mbind 可能被禁用，只要求失败时带上错误信息
+        auto bound = topology::bindCurrentThreadMemory(0);
+        if (bound.failed()) {
+            EXPECT_EQ(bound.getErr().code, Err::IO_ERR.code);
+            EXPECT_NE(bound.getErr().msg.find("set_mempolicy"), std::string::npos);
+        } else {
+            EXPECT_FALSE(topology::bindCurrentThreadMemory(topology::MEM_NODE_NONE).failed());
+        }
+        const size_t len = static_cast<size_t>(sysconf(_SC_PAGESIZE)) * 4;
+        void *addr = mmap(nullptr, len, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        ASSERT_NE(addr, MAP_FAILED);
+        auto mbound = topology::bindMemory(addr, len, 0);
+        if (mbound.failed()) {
+            EXPECT_NE(mbound.getErr().msg.find("mbind"), std::string::npos);
+        }
+        munmap(addr, len);
+    });
+    t.join();
+}
+
+TEST(TopologyTest, StartThreadAppliesPlacement) {
+    topology::ThreadPlacement placement;
+    placement.name = "placed";
+    placement.cpus = {topology::discover().front().cpu};
+    int32_t ranOn = -1;
+    char name[16] = {};
+    auto t = topology::startThread(placement, [&] {
+        ranOn = sched_getcpu();
+        pthread_getname_np(pthread_self(), name, sizeof(name));
+    });
+    t.join();
+    EXPECT_EQ(ranOn, placement.cpus.front());
+    EXPECT_STREQ(name, "placed");
+}
+
+TEST(TopologyTest, LoadPlacementFromToml) {
+    fs::path path = fs::temp_directory_path() / "rhino-placement.toml";
+    std::ofstream(path) << "[placement.io]\n"
+                           "cpus = \"0-1\"\n"
+                           "policy = \"batch\"\n"
+                           "mem_node = \"local\"\n"
+                           "strict_memory = true\n"
+                           "[placement.bad]\n"
+                           "policy = \"realtime\"\n";
+
+    auto io = loadPlacement(path.string(), "io");
+    ASSERT_FALSE(io.failed());
+    EXPECT_EQ(io.value().name, "io");
+    EXPECT_EQ(io.value().cpus, (vector<int32_t>{0, 1}));
+    EXPECT_EQ(io.value().policy, topology::SchedPolicy::BATCH);
+    EXPECT_EQ(io.value().memNode, topology::MEM_NODE_LOCAL);
+    EXPECT_TRUE(io.value().strictMemory);
+
+    // 没有配置的角色不改变任何设置
+    auto missing = loadPlacement(path.string(), "none");
+    ASSERT_FALSE(missing.failed());
+    EXPECT_TRUE(missing.value().cpus.empty());
+    EXPECT_EQ(missing.value().memNode, topology::MEM_NODE_NONE);
+
+    auto bad = loadPlacement(path.string(), "bad");
+    ASSERT_TRUE(bad.failed());
+    EXPECT_EQ(bad.getErr().code, Err::FORMAT_ERR.code);
+    EXPECT_NE(bad.getErr().msg.find("placement.bad.policy"), std::string::npos);
+
+    EXPECT_TRUE(loadPlacement((fs::temp_directory_path() / "rhino-missing.toml").string(), "io").failed());
+    fs::remove(path);
+}
@@ -6,8 +6,12 @@
 #include "sqlite_orm/sqlite_orm.h"
 
 #include "gtest/gtest.h"
+#include <cstdio>
 #include <iostream>
 #include <memory>
+#include <optional>
+
+#include "util/Cache.hpp"
 
 using std::cout;
 using std::endl;
@@ -89,4 +93,40 @@ void sqlite_orm_demo() {
 
 TEST(SQLite3Test, demo_test) {
     sqlite_orm_demo();
-}
\ No newline at end of file
+}
+
+// 数据库文件放在临时目录，用例前后都删除
+class SQLite3CacheTest : public ::testing::Test {
+  protected:
+    const std::string dbFile = ::testing::TempDir() + "rhino_cache_demo.db";
+
+    void SetUp() override { std::remove(dbFile.c_str()); }
+
+    void TearDown() override { std::remove(dbFile.c_str()); }
+};
+
+TEST_F(SQLite3CacheTest, cached_lookup_test) {
+    auto storage = create_storage(dbFile);
+    storage.sync_schema();
+    const int aliceId = storage.insert(User{0, "Alice", 30});
+
+    // 按 id 查询用户，前面挡一层缓存；不存在的 id 不缓存
+    rhino::Cache<int, User> cache;
+    int queries = 0;
+    auto load = [&](int id) -> std::optional<User> {
+        queries++;
+        auto user = storage.get_pointer<User>(id);
+        return user ? std::optional<User>(*user) : std::nullopt;
+    };
+    EXPECT_EQ(cache.getOrLoad(aliceId, load)->name, "Alice");
+    EXPECT_EQ(cache.getOrLoad(aliceId, load)->age, 30);
+    EXPECT_EQ(queries, 1);
+    EXPECT_FALSE(cache.getOrLoad(aliceId + 1, load).has_value());
+    EXPECT_EQ(queries, 2);
+
+    // 更新数据库后让缓存失效
+    storage.update(User{aliceId, "Alice", 31});
+    cache.erase(aliceId);
+    EXPECT_EQ(cache.getOrLoad(aliceId, load)->age, 31);
+    EXPECT_EQ(queries, 3);
+}